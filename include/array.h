@@ -1,91 +1,411 @@
-#ifndef ARRAY_H
-#define ARRAY_H
-
-#include <stddef.h>
-
-// Define an enum for error codes
-typedef enum {
-    ARRAY_SUCCESS = 0,
-    ARRAY_ERROR_NULL_POINTER,
-    ARRAY_ERROR_INVALID_DIMENSION,
-    ARRAY_ERROR_MEMORY_ALLOCATION,
-    // Add more error codes as needed
-} ArrayError;
-
-// Define a type for the array structure
-typedef struct {
-    float *data;
-    int *shape;
-    int *strides;
-    int ndim;
-    size_t size;
-    size_t itemsize;
-} ArrayType;
-
-// Define a type for shape information
-typedef struct {
-    int *shape;
-    int ndim;
-} ShapeInfo;
-
-// Function prototypes for array operations
-
-/**
- * Creates a new array with the given shape and number of dimensions.
- * 
- * @param shape Array containing the size of each dimension.
- * @param ndim Number of dimensions.
- * @param error Pointer to an error code variable.
- * @return Pointer to the newly created array or NULL if an error occurred.
- */
-ArrayType* create_array(const int *shape, int ndim, ArrayError *error);
-
-/**
- * Frees the memory allocated for an array.
- * 
- * @param arr Pointer to the array to be freed.
- */
-void free_array(ArrayType *arr);
-
-/**
- * Adds two arrays element-wise and stores the result in a third array.
- * 
- * @param result Pointer to the array where the result will be stored.
- * @param a Pointer to the first array.
- * @param b Pointer to the second array.
- * @return Error code indicating success or failure.
- */
-ArrayError add_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b);
-
-
-/**
- * Multiplies two arrays element-wise and stores the result in a third array.
- * 
- * @param result Pointer to the array where the result will be stored.
- * @param a Pointer to the first array.
- * @param b Pointer to the second array.
- * @return Error code indicating success or failure.
- */
-ArrayError multiply_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b);
-
-/**
- * Compares the shapes of two arrays and determines the broadcast shape.
- * 
- * @param a Pointer to the first array.
- * @param b Pointer to the second array.
- * @return Pointer to a ShapeInfo struct containing the broadcast shape or NULL if the shapes are not compatible.
- */
-ShapeInfo* compare_shapes(const ArrayType *a, const ArrayType *b);
-
-/**
- * Calculates the linear index from multidimensional indices.
- * 
- * @param indices Array of indices.
- * @param shape Array of shape dimensions.
- * @param strides Array of strides.
- * @param ndim Number of dimensions.
- * @return Linear index.
- */
-size_t calculate_index(const int *indices, const int *shape, const int *strides, int ndim);
-
-#endif // ARRAY_H
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Maximum number of dimensions supported by an array
+#define ARRAY_MAX_DIMS 32
+
+// Define an enum for error codes
+typedef enum {
+    ARRAY_SUCCESS = 0,
+    ARRAY_ERROR_NULL_POINTER,
+    ARRAY_ERROR_INVALID_DIMENSION,
+    ARRAY_ERROR_MEMORY_ALLOCATION,
+    ARRAY_ERROR_INVALID_ARGUMENT,
+    ARRAY_ERROR_INVALID_DTYPE,
+    ARRAY_ERROR_SINGULAR_MATRIX,
+    ARRAY_ERROR_NOT_POSITIVE_DEFINITE,
+    ARRAY_ERROR_SYSTEM,  // An operating system call failed; errno holds the cause
+    // Add more error codes as needed
+} ArrayError;
+
+// Element types an array can hold
+typedef enum {
+    ARRAY_DTYPE_FLOAT32 = 0,  // One float per element
+    ARRAY_DTYPE_COMPLEX64,    // Two floats per element: real part, then imaginary part
+    ARRAY_DTYPE_INT8,         // One signed byte per element, quantized with scale and zero_point
+    ARRAY_DTYPE_UINT8         // One unsigned byte per element, quantized with scale and zero_point
+} ArrayDType;
+
+/**
+ * Callback releasing the memory of a buffer once its last reference is dropped.
+ *
+ * @param data Memory held by the buffer.
+ * @param nbytes Size of the buffer in bytes.
+ * @param ctx Context pointer given when the buffer was created.
+ */
+typedef void (*ArrayReleaseFn)(void *data, size_t nbytes, void *ctx);
+
+// Reference-counted storage shared by array handles. The count is updated with
+// atomic operations, so handles on one buffer may be used and freed from
+// different threads.
+typedef struct {
+    void *data;
+    size_t nbytes;
+    int refcount;
+    ArrayReleaseFn release;  // NULL when the memory belongs to someone else
+    void *release_ctx;
+    int write_shared;        // Non-zero when writes go to the memory itself even while other
+                             // handles share it, as for shared memory; no copy-on-write
+} ArrayBuffer;
+
+// Define a type for the array structure
+typedef struct {
+    float *data;
+    int *shape;
+    int *strides;
+    int ndim;
+    size_t size;
+    size_t itemsize;
+    ArrayDType dtype;
+    ArrayBuffer *buffer;  // Storage data points into, possibly shared with other handles
+    int view;             // Non-zero for strided views such as sliding windows; views are read-only
+    uint64_t *validity;   // Arrow-style bitmap owned by this handle: bit i % 64 of word i / 64 is
+                          // set when element i (row-major) is valid; NULL when all are valid
+    float scale;          // Quantized dtypes: element q stands for scale * (q - zero_point)
+    int32_t zero_point;
+} ArrayType;
+
+// Define a type for shape information
+typedef struct {
+    int *shape;
+    int ndim;
+} ShapeInfo;
+
+/**
+ * Kernel applied by unary_operation to a contiguous block of elements.
+ *
+ * @param out Output block of n elements.
+ * @param in Input block of n elements (may alias out).
+ * @param n Number of elements in the block.
+ * @param ctx Kernel-specific parameters, may be NULL.
+ */
+typedef void (*UnaryKernel)(float *out, const float *in, size_t n, const void *ctx);
+
+// Function prototypes for array operations
+
+/**
+ * Creates a new array with the given shape and number of dimensions.
+ * 
+ * @param shape Array containing the size of each dimension; may be NULL when ndim is 0.
+ * @param ndim Number of dimensions; 0 creates a 0-d array holding a single element.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the newly created array or NULL if an error occurred.
+ */
+ArrayType* create_array(const int *shape, int ndim, ArrayError *error);
+
+/**
+ * Creates a new zero-filled array with the given shape and element type.
+ * Complex arrays store each element as two consecutive floats, so data
+ * holds 2 * size floats; shape, strides and size count complex elements.
+ * Quantized int8 and uint8 arrays hold one byte per element behind data
+ * (cast it to int8_t* or uint8_t*) and start with scale 1 and zero point 0.
+ * Only operations documented as accepting complex or quantized arrays do so;
+ * the element-wise operations return ARRAY_ERROR_INVALID_DTYPE for them.
+ *
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @param dtype Element type.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the newly created array or NULL if an error occurred.
+ */
+ArrayType* create_array_dtype(const int *shape, int ndim, ArrayDType dtype, ArrayError *error);
+
+/**
+ * Creates a new array without initializing its elements. The pages of a large
+ * array are not touched until first written, so filling it with a parallel
+ * loop places each page on the NUMA node of the thread that writes it.
+ *
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the newly created array or NULL if an error occurred.
+ */
+ArrayType* array_empty(const int *shape, int ndim, ArrayError *error);
+
+/**
+ * Makes *result an array of the given shape, reusing it when it already has
+ * that shape and otherwise freeing it and creating a new one. A reused array
+ * whose buffer is shared is detached with array_make_writable. The result's
+ * validity bitmap is dropped; operations that propagate masks set it afterwards.
+ *
+ * @param result Pointer to the result array pointer (may point to NULL).
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @return Error code indicating success or failure.
+ */
+ArrayError prepare_result(ArrayType **result, const int *shape, int ndim);
+
+/**
+ * Makes *result an array of the given shape and element type, reusing it
+ * when it already matches and otherwise freeing it and creating a new one.
+ *
+ * @param result Pointer to the result array pointer (may point to NULL).
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @param dtype Element type.
+ * @return Error code indicating success or failure.
+ */
+ArrayError prepare_result_dtype(ArrayType **result, const int *shape, int ndim, ArrayDType dtype);
+
+/**
+ * Frees the memory allocated for an array.
+ * 
+ * @param arr Pointer to the array to be freed.
+ */
+void free_array(ArrayType *arr);
+
+/**
+ * Creates a new handle on the data of an array in O(1): the two handles share
+ * one reference-counted buffer. Writing through either handle first gives it
+ * a private copy (copy-on-write), so neither ever sees the other's changes,
+ * unless the buffer is marked write_shared, as shared memory is: then every
+ * handle writes to and sees the same memory.
+ *
+ * @param a Pointer to the array or view to share.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the new handle or NULL if an error occurred.
+ */
+ArrayType* array_share(const ArrayType *a, ArrayError *error);
+
+/**
+ * Creates an array over existing contiguous memory without copying it.
+ * release is called with data, its size and ctx once the last handle on the
+ * buffer is freed; with a NULL release the caller keeps ownership of data and
+ * must keep it alive for as long as any handle on it.
+ *
+ * @param data Memory holding the elements in row-major order.
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @param release Callback freeing data, or NULL.
+ * @param ctx Context pointer passed to release.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the new array or NULL if an error occurred; release is
+ *         not called on failure.
+ */
+ArrayType* array_wrap(float *data, const int *shape, int ndim, ArrayReleaseFn release, void *ctx, ArrayError *error);
+
+/**
+ * Creates an array of a given element type over existing contiguous memory
+ * without copying it; see array_wrap.
+ *
+ * @param data Memory holding the elements in row-major order.
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @param dtype Element type of the data.
+ * @param release Callback freeing data, or NULL.
+ * @param ctx Context pointer passed to release.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the new array or NULL if an error occurred; release is
+ *         not called on failure.
+ */
+ArrayType* array_wrap_dtype(float *data, const int *shape, int ndim, ArrayDType dtype,
+                            ArrayReleaseFn release, void *ctx, ArrayError *error);
+
+/**
+ * Makes arr the only handle on its buffer, copying the data when it is
+ * shared and not marked write_shared. Every operation that writes into an existing array calls this
+ * first; prepare_result does so when it reuses *result.
+ *
+ * @param arr Pointer to the array about to be written.
+ * @return Error code indicating success or failure; ARRAY_ERROR_INVALID_ARGUMENT
+ *         for views, which are read-only.
+ */
+ArrayError array_make_writable(ArrayType *arr);
+
+/**
+ * Copies an array into a new contiguous array, following the strides of a so
+ * that views such as those from sliding_window_view are materialized.
+ *
+ * @param result Pointer to the array where the copy will be stored.
+ * @param a Pointer to the array or view to copy.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_copy(ArrayType **result, const ArrayType *a);
+
+/**
+ * Adds two arrays element-wise and stores the result in a third array.
+ * Shapes broadcast as in NumPy: they are aligned from the right, missing
+ * leading axes count as length 1, and an axis of length 1 is repeated along
+ * the other operand's axis without being copied. The result may be one of the
+ * operands; it is replaced by a new array when its shape changes.
+ * 
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the first array.
+ * @param b Pointer to the second array.
+ * @return Error code indicating success or failure; ARRAY_ERROR_INVALID_DIMENSION
+ *         when the shapes do not broadcast.
+ */
+ArrayError add_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b);
+
+
+/**
+ * Multiplies two arrays element-wise and stores the result in a third array,
+ * broadcasting their shapes as add_arrays does.
+ * 
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the first array.
+ * @param b Pointer to the second array.
+ * @return Error code indicating success or failure; ARRAY_ERROR_INVALID_DIMENSION
+ *         when the shapes do not broadcast.
+ */
+ArrayError multiply_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b);
+
+/**
+ * Creates a read-only view of an array broadcast to a shape (NumPy
+ * broadcast_to) without copying: repeated axes have stride 0. Element-wise
+ * operations, array_copy and einsum read such views directly, so operands
+ * never need to be expanded beforehand; operations that expect contiguous
+ * input return ARRAY_ERROR_INVALID_ARGUMENT for views. Validity bitmaps are
+ * not carried over.
+ *
+ * @param view Pointer to the array where the view will be stored.
+ * @param a Pointer to the array or view to broadcast.
+ * @param shape Target shape; a broadcasts to it when, aligned from the right,
+ *              each of its axes has the target length or length 1.
+ * @param ndim Number of dimensions of the target shape, at least a->ndim.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_broadcast_to(ArrayType **view, const ArrayType *a, const int *shape, int ndim);
+
+/**
+ * Adds count independent pairs of arrays, results[i] = a[i] + b[i], in a
+ * single parallel region. Shapes are checked and results prepared once up
+ * front. All pairs are then split into blocks of at most ARRAY_BLOCK_SIZE
+ * elements, and each thread takes one contiguous range of blocks. This
+ * amortizes the per-call cost of add_arrays over many small arrays such as
+ * 16x16 tiles. Pairs of different shapes, or with a view operand, fall back to
+ * add_arrays. A single stacked pair with a leading batch dimension needs only
+ * add_arrays.
+ *
+ * @param results Array of count result pointers, each handled like the result of add_arrays.
+ * @param a Array of count pointers to first operands.
+ * @param b Array of count pointers to second operands.
+ * @param count Number of pairs.
+ * @return Error code indicating success or failure; the first failing pair's error.
+ */
+ArrayError add_arrays_batched(ArrayType **results, const ArrayType *const *a, const ArrayType *const *b, int count);
+
+/**
+ * Multiplies count independent pairs of arrays, results[i] = a[i] * b[i], in
+ * a single parallel region; see add_arrays_batched.
+ *
+ * @param results Array of count result pointers, each handled like the result of multiply_arrays.
+ * @param a Array of count pointers to first operands.
+ * @param b Array of count pointers to second operands.
+ * @param count Number of pairs.
+ * @return Error code indicating success or failure; the first failing pair's error.
+ */
+ArrayError multiply_arrays_batched(ArrayType **results, const ArrayType *const *a, const ArrayType *const *b, int count);
+
+/**
+ * Applies a kernel element-wise to an array, splitting the work into blocks
+ * that are distributed across OpenMP threads.
+ *
+ * @param result Pointer to the array where the result will be stored. It is
+ *               (re)created with the shape of a if needed; it may be a itself.
+ * @param a Pointer to the input array.
+ * @param kernel Kernel applied to each block.
+ * @param ctx Parameters forwarded to the kernel, may be NULL.
+ * @return Error code indicating success or failure.
+ */
+ArrayError unary_operation(ArrayType **result, const ArrayType *a, UnaryKernel kernel, const void *ctx);
+
+/**
+ * Computes a * b + c element-wise with broadcasting, in a single pass and with
+ * a single rounding per element (fused multiply-add).
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the first factor.
+ * @param b Pointer to the second factor.
+ * @param c Pointer to the addend.
+ * @return Error code indicating success or failure.
+ */
+ArrayError fma_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b, const ArrayType *c);
+
+/**
+ * Computes alpha * x + y element-wise with broadcasting, using a fused multiply-add.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param alpha Scalar factor applied to x.
+ * @param x Pointer to the scaled array.
+ * @param y Pointer to the added array.
+ * @return Error code indicating success or failure.
+ */
+ArrayError axpy_arrays(ArrayType **result, float alpha, const ArrayType *x, const ArrayType *y);
+
+/**
+ * Selects elements from x where cond is non-zero and from y elsewhere, with broadcasting.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param cond Pointer to the condition array.
+ * @param x Pointer to the array selected where cond is non-zero.
+ * @param y Pointer to the array selected where cond is zero.
+ * @return Error code indicating success or failure.
+ */
+ArrayError where_arrays(ArrayType **result, const ArrayType *cond, const ArrayType *x, const ArrayType *y);
+
+/**
+ * Limits the values of an array to the interval [lo, hi]. NaN values are preserved.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param lo Lower bound.
+ * @param hi Upper bound; takes precedence when lo > hi.
+ * @return Error code indicating success or failure.
+ */
+ArrayError clip_array(ArrayType **result, const ArrayType *a, float lo, float hi);
+
+/**
+ * Compares the shapes of two arrays and determines the broadcast shape.
+ * 
+ * @param a Pointer to the first array.
+ * @param b Pointer to the second array.
+ * @return Pointer to a ShapeInfo struct containing the broadcast shape or NULL if the shapes are not compatible.
+ */
+ShapeInfo* compare_shapes(const ArrayType *a, const ArrayType *b);
+
+/**
+ * Maps an axis index, which may be negative to count from the end, onto [0, ndim).
+ *
+ * @param axis Axis index.
+ * @param ndim Number of dimensions.
+ * @return The normalized axis, or -1 if it is out of range.
+ */
+int normalize_axis(int axis, int ndim);
+
+/**
+ * Turns deterministic mode on or off for every subsequent call. Operations
+ * whose floating-point results could depend on the number of OpenMP threads
+ * (the parallel scans of cumsum and cumprod, the nan* reductions and
+ * scatter_add) then split their work into chunks of
+ * ARRAY_DETERMINISTIC_CHUNK elements and combine the partial results in a
+ * fixed order, so a given build on a given CPU produces bit-identical
+ * results for any thread count. Other operations, including sgemm and the
+ * element-wise operations, always are. Off by default.
+ *
+ * @param enabled Non-zero to enable deterministic mode.
+ */
+void array_set_deterministic(int enabled);
+
+/**
+ * Tells whether deterministic mode is enabled.
+ *
+ * @return 1 if deterministic mode is enabled, 0 otherwise.
+ */
+int array_get_deterministic(void);
+
+/**
+ * Calculates the linear index from multidimensional indices.
+ * 
+ * @param indices Array of indices.
+ * @param shape Array of shape dimensions.
+ * @param strides Array of strides.
+ * @param ndim Number of dimensions.
+ * @return Linear index.
+ */
+size_t calculate_index(const int *indices, const int *shape, const int *strides, int ndim);
+
+#endif // ARRAY_H
@@ -0,0 +1,127 @@
+#ifndef CONVOLVE_H
+#define CONVOLVE_H
+
+#include "array.h"
+
+// Size of a convolution or correlation output relative to the input
+typedef enum {
+    CONVOLVE_FULL = 0,  // Every position where input and kernel overlap
+    CONVOLVE_SAME,      // Same size as the input, centered on the full output
+    CONVOLVE_VALID      // Only positions where the kernel lies entirely inside the input
+} ConvolveMode;
+
+// Function prototypes for convolution and sliding-window operations
+//
+// Inputs are zero-padded for the full and same modes. As in scipy.signal,
+// the same mode drops (m - 1) / 2 leading elements of the full output for a
+// kernel of length m along each axis. The valid mode requires the kernel to
+// be no larger than the input along each convolved axis. The result may not
+// be one of the operands.
+
+/**
+ * Convolves every 1-D line of an array along an axis with a 1-D kernel.
+ * Short kernels, including 3 and 5 taps, use unrolled kernels vectorized over
+ * the outputs; longer ones accumulate register-blocked tiles of outputs.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param kernel Pointer to the 1-D kernel.
+ * @param axis Axis to convolve along; negative values count from the end.
+ * @param mode Output size.
+ * @return Error code indicating success or failure.
+ */
+ArrayError convolve1d_array(ArrayType **result, const ArrayType *a, const ArrayType *kernel, int axis, ConvolveMode mode);
+
+/**
+ * Cross-correlates every 1-D line of an array along an axis with a 1-D
+ * kernel, that is, convolves with the reversed kernel.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param kernel Pointer to the 1-D kernel.
+ * @param axis Axis to correlate along; negative values count from the end.
+ * @param mode Output size.
+ * @return Error code indicating success or failure.
+ */
+ArrayError correlate1d_array(ArrayType **result, const ArrayType *a, const ArrayType *kernel, int axis, ConvolveMode mode);
+
+/**
+ * Convolves the images in the last two axes of an array with a 2-D kernel
+ * of shape [kh, kw], or with a bank of filters of shape [f, kh, kw]. Leading
+ * axes of the input are batch axes; a filter bank adds an axis of length f
+ * just before the two image axes of the result.
+ *
+ * Filters of up to 25 taps, such as 3x3 and 5x5, are applied directly with
+ * kernels vectorized along image rows. Larger filters are lowered to sgemm:
+ * tiles of the image are unfolded into columns (im2col) and multiplied by the
+ * filter bank.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param image Pointer to the input array, with at least two dimensions.
+ * @param kernel Pointer to the 2-D kernel or 3-D filter bank.
+ * @param mode Output size.
+ * @return Error code indicating success or failure.
+ */
+ArrayError convolve2d_array(ArrayType **result, const ArrayType *image, const ArrayType *kernel, ConvolveMode mode);
+
+/**
+ * Cross-correlates the images in the last two axes of an array with a 2-D
+ * kernel or a bank of filters, as convolve2d_array does with the filters
+ * reversed along both axes.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param image Pointer to the input array, with at least two dimensions.
+ * @param kernel Pointer to the 2-D kernel or 3-D filter bank.
+ * @param mode Output size.
+ * @return Error code indicating success or failure.
+ */
+ArrayError correlate2d_array(ArrayType **result, const ArrayType *image, const ArrayType *kernel, ConvolveMode mode);
+
+/**
+ * Creates a view of the sliding windows of length window along an axis,
+ * without copying. The view has the shape of a with the axis shortened to
+ * shape[axis] - window + 1 and a new last axis of length window; its strides
+ * revisit the data of a, so the windows overlap in memory.
+ *
+ * The view shares the buffer of a (see array_share), so it stays valid after a
+ * is freed, and it is read-only. Operations that broadcast (fma_arrays, where_arrays,
+ * axpy_arrays) and array_copy follow its strides; other operations expect
+ * contiguous arrays and reject views with ARRAY_ERROR_INVALID_ARGUMENT, so
+ * materialize the view with array_copy first. The view has no validity
+ * bitmap, even when a has one.
+ *
+ * @param view Pointer to the view pointer; a previous array there is freed.
+ * @param a Pointer to the array or view to take windows of.
+ * @param window Window length, between 1 and shape[axis].
+ * @param axis Axis to slide along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError sliding_window_view(ArrayType **view, const ArrayType *a, int window, int axis);
+
+/**
+ * Computes the mean of every window of length window along an axis. The
+ * result has the axis shortened to shape[axis] - window + 1. Window sums are
+ * updated incrementally in double precision, restarting every block of
+ * outputs so rounding error does not build up along long signals.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param window Window length, between 1 and shape[axis].
+ * @param axis Axis to slide along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError moving_average_array(ArrayType **result, const ArrayType *a, int window, int axis);
+
+/**
+ * Computes the population standard deviation of every window of length
+ * window along an axis, with the same shape and method as moving_average_array.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param window Window length, between 1 and shape[axis].
+ * @param axis Axis to slide along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError moving_std_array(ArrayType **result, const ArrayType *a, int window, int axis);
+
+#endif // CONVOLVE_H
@@ -0,0 +1,84 @@
+#ifndef CREATION_H
+#define CREATION_H
+
+#include "array.h"
+
+// Function prototypes for array creation routines
+//
+// Each routine allocates with array_empty and writes every element exactly
+// once, in a parallel loop over blocks of ARRAY_BLOCK_SIZE elements with a
+// static schedule. No separate zeroing pass is made. The first write to each
+// page happens on the thread that covers that range in other statically
+// scheduled loops, which keeps pages local on NUMA systems.
+
+/**
+ * Generator called by array_fill_fn for one contiguous block of elements.
+ *
+ * @param out Output block of n elements.
+ * @param start Flat (row-major) index of out[0] within the array.
+ * @param n Number of elements in the block.
+ * @param ctx Generator-specific parameters, may be NULL.
+ */
+typedef void (*ArrayFillFn)(float *out, size_t start, size_t n, const void *ctx);
+
+/**
+ * Creates an array with every element set to a value.
+ *
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @param value Value of every element.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the newly created array or NULL if an error occurred.
+ */
+ArrayType* array_full(const int *shape, int ndim, float value, ArrayError *error);
+
+/**
+ * Creates the 1-D array start, start + step, ... of the values below stop (or
+ * above it for a negative step). Element i is computed as start + i * step,
+ * so rounding errors do not accumulate.
+ *
+ * @param start First value.
+ * @param stop End of the interval, excluded.
+ * @param step Spacing between values; must be non-zero.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the newly created array or NULL if an error occurred.
+ */
+ArrayType* array_arange(float start, float stop, float step, ArrayError *error);
+
+/**
+ * Creates a 1-D array of num evenly spaced values over [start, stop], or over
+ * [start, stop) when endpoint is 0. With endpoint set the last element is
+ * exactly stop.
+ *
+ * @param start First value.
+ * @param stop Last value, or the excluded end when endpoint is 0.
+ * @param num Number of values; must be positive.
+ * @param endpoint Whether stop is included.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the newly created array or NULL if an error occurred.
+ */
+ArrayType* array_linspace(float start, float stop, int num, int endpoint, ArrayError *error);
+
+/**
+ * Creates a rows x cols array with ones on a diagonal and zeros elsewhere.
+ *
+ * @param rows Number of rows.
+ * @param cols Number of columns.
+ * @param k Diagonal offset: 0 is the main diagonal, positive values are above it.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the newly created array or NULL if an error occurred.
+ */
+ArrayType* array_eye(int rows, int cols, int k, ArrayError *error);
+
+/**
+ * Fills an array by calling a generator on blocks of elements in parallel.
+ * Blocks are disjoint and may be generated in any order and on any thread.
+ *
+ * @param a Pointer to the array to fill; it must own its data.
+ * @param fn Generator writing one block.
+ * @param ctx Generator-specific parameters passed to fn, may be NULL.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_fill_fn(ArrayType *a, ArrayFillFn fn, const void *ctx);
+
+#endif // CREATION_H
@@ -0,0 +1,55 @@
+#ifndef EINSUM_H
+#define EINSUM_H
+
+#include "array.h"
+
+// Function prototypes for tensor contractions
+//
+// Operands are contracted two at a time. At every step the pair whose result
+// frees the most memory is taken next (ties go to the cheaper pair in
+// multiply-adds), and pairs sharing no label are only taken once no other
+// pair is left, as in the greedy strategy of opt_einsum. Labels that no later
+// step needs are summed out of an operand before it is contracted. Each
+// pairwise contraction groups its labels into batch, row, contracted and
+// column labels: operands already laid out in one of the four orders sgemm
+// reads, transposed or not, are used in place, and others are copied once
+// into that order. Large products go to sgemm; batched dot products, outer
+// products and small matrices use vectorized loops parallel over the batch.
+
+/**
+ * Evaluates an Einstein summation over float32 arrays (NumPy einsum), for
+ * example "ij,jk->ik" (matmul), "bij,bjk->bik" (batched matmul), "ii->i"
+ * (diagonal), "ij->ji" (transpose) or "i,i->" (dot product). Labels are
+ * letters; a label repeated within one operand takes its diagonal, and every
+ * label not in the output is summed over. Without "->" the output holds the
+ * labels that appear exactly once, in alphabetical order. Ellipses are not
+ * supported.
+ *
+ * @param result Pointer to the array where the result will be stored; shape {1}
+ *               when every label is summed over.
+ * @param subscripts Comma-separated labels of each operand, optionally followed by
+ *                   "->" and the labels of the output.
+ * @param operands Array of pointers to the operands; views are accepted.
+ * @param count Number of operands.
+ * @return Error code indicating success or failure; ARRAY_ERROR_INVALID_ARGUMENT for
+ *         malformed subscripts, ARRAY_ERROR_INVALID_DIMENSION when the labels do not
+ *         match the operands or a label has different lengths.
+ */
+ArrayError einsum_arrays(ArrayType **result, const char *subscripts, const ArrayType *const *operands, int count);
+
+/**
+ * Sums products over pairs of axes of two arrays (NumPy tensordot). The
+ * result has the remaining axes of a followed by the remaining axes of b.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the first array.
+ * @param b Pointer to the second array.
+ * @param axes_a Axes of a to contract; negative values count from the end.
+ * @param axes_b Axes of b to contract, paired with axes_a and of equal lengths.
+ * @param naxes Number of axis pairs; 0 gives the outer product.
+ * @return Error code indicating success or failure.
+ */
+ArrayError tensordot_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b,
+                            const int *axes_a, const int *axes_b, int naxes);
+
+#endif // EINSUM_H
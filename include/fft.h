@@ -0,0 +1,80 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include "array.h"
+
+// Function prototypes for discrete Fourier transforms
+//
+// Transforms run along one axis of an array and are batched over all the
+// other axes, with the lines distributed across OpenMP threads; a single
+// long line is instead parallelized within each pass of the transform.
+// Lengths whose prime factors are 2, 3, 5, 7, 11 and 13 use a self-sorting
+// (Stockham) mixed-radix algorithm with radix-4, 2, 3 and 5 butterflies;
+// other lengths use Bluestein's algorithm on a power-of-two transform.
+// Plans (factorizations and twiddle tables) are built once per length and
+// cached for the life of the process or until fft_clear_plan_cache.
+//
+// The forward transforms are unnormalized and the inverse transforms scale
+// by 1 / n, as in NumPy. Outputs are ARRAY_DTYPE_COMPLEX64 except for
+// irfft_array. Inputs may be ARRAY_DTYPE_FLOAT32, read as real values, or
+// ARRAY_DTYPE_COMPLEX64.
+
+/**
+ * Computes the discrete Fourier transform along an axis.
+ *
+ * @param result Pointer to the complex array where the result will be stored;
+ *               it may be a itself when a is complex, and must not be
+ *               when a is real.
+ * @param a Pointer to the input array.
+ * @param axis Axis to transform along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError fft_array(ArrayType **result, const ArrayType *a, int axis);
+
+/**
+ * Computes the inverse discrete Fourier transform along an axis.
+ *
+ * @param result Pointer to the complex array where the result will be stored;
+ *               it may be a itself when a is complex, and must not be
+ *               when a is real.
+ * @param a Pointer to the input array.
+ * @param axis Axis to transform along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError ifft_array(ArrayType **result, const ArrayType *a, int axis);
+
+/**
+ * Computes the discrete Fourier transform of real input along an axis,
+ * returning only the n / 2 + 1 non-negative frequency terms. Even lengths
+ * are computed with a complex transform of half the length.
+ *
+ * @param result Pointer to the complex array where the result will be stored;
+ *               it must not be a itself.
+ * @param a Pointer to the real (ARRAY_DTYPE_FLOAT32) input array.
+ * @param axis Axis to transform along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError rfft_array(ArrayType **result, const ArrayType *a, int axis);
+
+/**
+ * Computes the inverse of rfft_array: the real signal of length n whose
+ * non-negative frequency terms are given along an axis. The input is
+ * truncated or zero-padded to n / 2 + 1 terms, and the imaginary parts of the
+ * zero and (for even n) Nyquist terms are ignored.
+ *
+ * @param result Pointer to the real array where the result will be stored;
+ *               it must not be a itself.
+ * @param a Pointer to the complex input array.
+ * @param n Length of the output along the axis, or 0 for 2 * (m - 1) where m
+ *          is the input length.
+ * @param axis Axis to transform along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError irfft_array(ArrayType **result, const ArrayType *a, int n, int axis);
+
+/**
+ * Frees every cached plan. It must not be called while a transform is running.
+ */
+void fft_clear_plan_cache(void);
+
+#endif // FFT_H
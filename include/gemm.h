@@ -0,0 +1,57 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "array.h"
+
+// Whether a matrix operand of sgemm is used as stored or transposed
+typedef enum {
+    GEMM_NO_TRANS = 0,
+    GEMM_TRANS
+} GemmTranspose;
+
+// Function prototypes for matrix multiplication
+
+/**
+ * Computes C = alpha * op(A) * op(B) + beta * C for row-major single-precision
+ * matrices, where op(A) is m x k, op(B) is k x n and C is m x n.
+ *
+ * Panels of B and blocks of A are packed into contiguous buffers so that a
+ * register-blocked micro-kernel streams through them; on x86 a copy of the
+ * micro-kernel compiled for AVX2/FMA is selected at run time. Tiles of C are
+ * distributed across OpenMP threads unless the call is made from inside a
+ * parallel region, in which case it runs on the calling thread. When beta is
+ * zero, C is not read.
+ *
+ * @param trans_a Whether A is transposed.
+ * @param trans_b Whether B is transposed.
+ * @param m Number of rows of op(A) and C.
+ * @param n Number of columns of op(B) and C.
+ * @param k Number of columns of op(A) and rows of op(B).
+ * @param alpha Scalar factor applied to op(A) * op(B).
+ * @param a Pointer to the first element of A.
+ * @param lda Distance between rows of A as stored.
+ * @param b Pointer to the first element of B.
+ * @param ldb Distance between rows of B as stored.
+ * @param beta Scalar factor applied to C.
+ * @param c Pointer to the first element of C.
+ * @param ldc Distance between rows of C.
+ * @return Error code indicating success or failure.
+ */
+ArrayError sgemm(GemmTranspose trans_a, GemmTranspose trans_b, int m, int n, int k,
+                 float alpha, const float *a, int lda, const float *b, int ldb,
+                 float beta, float *c, int ldc);
+
+/**
+ * Multiplies matrices (NumPy matmul). a has shape [..., m, k] and b has shape
+ * [..., k, n] with the same leading dimensions, or shape [k, n] to be shared
+ * by every matrix of a. The result has shape [..., m, n] and may not be an
+ * operand.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the left operand.
+ * @param b Pointer to the right operand.
+ * @return Error code indicating success or failure.
+ */
+ArrayError matmul_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b);
+
+#endif // GEMM_H
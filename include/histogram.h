@@ -0,0 +1,65 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "array.h"
+
+// Function prototypes for counting operations
+//
+// Counting is privatized: every OpenMP thread counts into its own histogram
+// and the histograms are summed bin by bin in parallel at the end, so the hot
+// loop has no atomics or shared cache lines. Fixed-width bin indices are
+// computed for a block of elements at a time in a vectorized loop before
+// the increments. Count buffers allocated by these functions replace any
+// buffer already stored in the output pointer; the caller releases them
+// with free().
+
+/**
+ * Counts the occurrences of each non-negative integer value (NumPy bincount).
+ *
+ * @param counts Pointer to the count buffer; counts[v] is the number of elements equal to v.
+ * @param nbins Receives the number of bins: the larger of max(a) + 1 and minlength.
+ * @param a Pointer to an array of non-negative integral values.
+ * @param minlength Minimum number of bins.
+ * @return Error code indicating success or failure; ARRAY_ERROR_INVALID_ARGUMENT
+ *         if a holds a negative, fractional or non-finite value.
+ */
+ArrayError bincount_array(size_t **counts, size_t *nbins, const ArrayType *a, size_t minlength);
+
+/**
+ * Counts the elements falling into nbins equal-width bins spanning [lo, hi].
+ * The last bin includes hi; values outside the range and NaNs are not counted.
+ *
+ * @param counts Caller-provided buffer of nbins counts, overwritten.
+ * @param nbins Number of bins.
+ * @param a Pointer to the input array.
+ * @param lo Lower edge of the first bin.
+ * @param hi Upper edge of the last bin; must be greater than lo.
+ * @return Error code indicating success or failure.
+ */
+ArrayError histogram_uniform(size_t *counts, int nbins, const ArrayType *a, float lo, float hi);
+
+/**
+ * Counts the elements falling between consecutive bin edges. Bin b covers
+ * [edges[b], edges[b + 1]), except the last bin which also includes its
+ * upper edge. Values outside the edges and NaNs are not counted.
+ *
+ * @param counts Caller-provided buffer of nedges - 1 counts, overwritten.
+ * @param edges Strictly increasing bin edges.
+ * @param nedges Number of edges, at least 2.
+ * @param a Pointer to the input array.
+ * @return Error code indicating success or failure.
+ */
+ArrayError histogram_edges(size_t *counts, const float *edges, int nedges, const ArrayType *a);
+
+/**
+ * Finds the sorted unique values of an array and how often each occurs. All
+ * NaNs are collapsed into a single trailing value.
+ *
+ * @param values Pointer to the 1-D array where the unique values will be stored.
+ * @param counts Pointer to the count buffer, one count per unique value. May be NULL.
+ * @param a Pointer to the input array.
+ * @return Error code indicating success or failure.
+ */
+ArrayError unique_array(ArrayType **values, size_t **counts, const ArrayType *a);
+
+#endif // HISTOGRAM_H
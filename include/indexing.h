@@ -0,0 +1,73 @@
+#ifndef INDEXING_H
+#define INDEXING_H
+
+#include "array.h"
+
+// Function prototypes for integer and boolean-mask indexing
+//
+// Integer indices select positions along one axis; negative values count
+// from the end as in NumPy. All indices are validated before anything is
+// written, so an out-of-range index leaves the output untouched and
+// returns ARRAY_ERROR_INVALID_ARGUMENT. Results and values may not be the
+// array they are taken from or written to.
+
+/**
+ * Gathers slices of an array along an axis (NumPy take). The result has the
+ * shape of a with the axis replaced by n_indices. Gathering along axis 0 of a
+ * 2-D table copies whole contiguous rows, as in an embedding lookup.
+ *
+ * @param result Pointer to the array where the gathered values will be stored.
+ * @param a Pointer to the source array.
+ * @param indices Positions along the axis to gather.
+ * @param n_indices Number of indices.
+ * @param axis Axis to gather along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError take_array(ArrayType **result, const ArrayType *a, const int *indices, size_t n_indices, int axis);
+
+/**
+ * Writes slices of values into an array along an axis; the inverse of
+ * take_array. When an index repeats, which of its slices ends up stored is
+ * unspecified.
+ *
+ * @param a Pointer to the array to write into.
+ * @param indices Positions along the axis to write.
+ * @param n_indices Number of indices.
+ * @param values Pointer to the values, shaped like the result of take_array.
+ * @param axis Axis to write along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError put_array(ArrayType *a, const int *indices, size_t n_indices, const ArrayType *values, int axis);
+
+/**
+ * Adds slices of values into an array along an axis, accumulating every
+ * occurrence of a repeated index (NumPy add.at).
+ *
+ * Wide slices are split by column across threads so no two threads touch the
+ * same element. Narrow slices are accumulated into per-thread copies of the
+ * target that are summed at the end, or with atomic adds when the target is
+ * too large to replicate. In deterministic mode narrow slices are instead
+ * grouped by target row with a counting sort, and each row is accumulated by
+ * one thread in index order, which matches the serial result bit for bit.
+ *
+ * @param a Pointer to the array to accumulate into.
+ * @param indices Positions along the axis to accumulate into.
+ * @param n_indices Number of indices.
+ * @param values Pointer to the values, shaped like the result of take_array.
+ * @param axis Axis to accumulate along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError scatter_add_array(ArrayType *a, const int *indices, size_t n_indices, const ArrayType *values, int axis);
+
+/**
+ * Selects the elements of an array where a mask of the same shape is non-zero,
+ * in row-major order, into a 1-D result (NumPy a[mask]).
+ *
+ * @param result Pointer to the array where the selected values will be stored.
+ * @param a Pointer to the source array.
+ * @param mask Pointer to the mask array.
+ * @return Error code indicating success or failure.
+ */
+ArrayError compress_array(ArrayType **result, const ArrayType *a, const ArrayType *mask);
+
+#endif // INDEXING_H
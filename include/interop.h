@@ -0,0 +1,81 @@
+#ifndef INTEROP_H
+#define INTEROP_H
+
+#include "array.h"
+#include "arrow_c_data.h"
+#include "dlpack.h"
+
+// Function prototypes for zero-copy exchange with other libraries
+//
+// Exports hand out the array's buffer itself. The exported structure holds a
+// reference on the buffer, so the data stays alive until the consumer calls
+// the deleter or release callback, even after the array has been freed. Since
+// the buffer is then shared, the next write through the original array copies
+// it first (see array_share). The consumer's data is never changed behind its
+// back.
+//
+// Imports wrap the producer's memory without copying and take ownership of
+// the exported structure only on success. Its deleter or release callback is
+// called once the last handle on the imported buffer is freed. On failure the
+// structure is left untouched, and the caller still owns it.
+
+/**
+ * Exports an array as a DLPack tensor on the CPU: float32 as kDLFloat/32,
+ * complex64 as kDLComplex/64 and the quantized types as kDLInt/8 and
+ * kDLUInt/8 (their scale and zero point are not carried), with explicit
+ * strides so views are exported as they are.
+ *
+ * @param a Pointer to the array or view to export.
+ * @param out Pointer to receive the tensor; call its deleter when done.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_to_dlpack(const ArrayType *a, DLManagedTensor **out);
+
+/**
+ * Imports a DLPack tensor. It must live on the CPU, hold lane-1 float32,
+ * complex64, int8 or uint8 elements, and be compact and row-major (strides
+ * NULL or matching). A 0-d tensor becomes an array of shape {1}; int8 and
+ * uint8 tensors get scale 1 and zero point 0.
+ *
+ * @param tensor Pointer to the tensor; owned by the array on success.
+ * @param error Pointer to an error code variable; ARRAY_ERROR_INVALID_DTYPE for
+ *              other element types, ARRAY_ERROR_INVALID_ARGUMENT for other
+ *              devices or layouts.
+ * @return Pointer to the new array or NULL if an error occurred.
+ */
+ArrayType* array_from_dlpack(DLManagedTensor *tensor, ArrayError *error);
+
+/**
+ * Exports a contiguous float32 array through the Arrow C Data Interface. A
+ * 1-D array becomes a primitive float array ("f"), and a 0-d array one of
+ * length 1. An array with more
+ * dimensions becomes an arrow.fixed_shape_tensor extension array: one
+ * fixed-size list ("+w:N") per index of the first dimension, with the
+ * remaining dimensions recorded in the extension metadata. The validity
+ * bitmap, if any, is exported as the float array's validity buffer.
+ *
+ * @param a Pointer to the array to export.
+ * @param schema Pointer to the schema to fill; release it when done.
+ * @param array Pointer to the array to fill; release it when done.
+ * @return Error code indicating success or failure; ARRAY_ERROR_INVALID_DTYPE
+ *         for complex64, which Arrow has no type for, and
+ *         ARRAY_ERROR_INVALID_ARGUMENT for views.
+ */
+ArrayError array_to_arrow(const ArrayType *a, struct ArrowSchema *schema, struct ArrowArray *array);
+
+/**
+ * Imports an Arrow float array ("f") or a fixed-size list of floats ("+w:N"),
+ * with or without the arrow.fixed_shape_tensor extension, as produced by
+ * array_to_arrow. The floats' validity buffer is copied into the array's
+ * validity bitmap. Null lists and tensors with a permutation are rejected.
+ * Without the extension a list array becomes a length x N array.
+ *
+ * @param schema Pointer to the schema describing array; only read, the caller keeps it.
+ * @param array Pointer to the array; moved into the result on success, which
+ *              marks it released.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the new array or NULL if an error occurred.
+ */
+ArrayType* array_from_arrow(const struct ArrowSchema *schema, struct ArrowArray *array, ArrayError *error);
+
+#endif // INTEROP_H
@@ -0,0 +1,80 @@
+#ifndef LINALG_H
+#define LINALG_H
+
+#include "array.h"
+
+// Function prototypes for dense linear algebra
+//
+// Matrices occupy the last two axes of an array; any leading axes are batch
+// axes, as in numpy.linalg. Large matrices are factored with blocked,
+// right-looking algorithms whose trailing updates run through sgemm and are
+// parallelized with OpenMP. Batches of matrices are spread across threads.
+// Batches of matrices up to 64 x 64 take a dedicated path. Groups of 16
+// matrices are interleaved element by element into per-thread buffers, so
+// every step is vectorized across the group with no per-matrix allocation.
+//
+// Pivot buffers are allocated with malloc and replace any buffer already
+// stored in *pivots; the caller releases them with free().
+
+/**
+ * Computes the LU factorization with partial pivoting, P A = L U, of square
+ * matrices. L (unit lower triangular, diagonal not stored) and U are packed
+ * into one matrix. Singular matrices are factored too, leaving a zero on the
+ * diagonal of U.
+ *
+ * @param lu Pointer to the array where the packed factors will be stored.
+ * @param pivots Pointer to the pivot buffer: n entries per matrix, where row i
+ *               was interchanged with row pivots[i], in order of increasing i.
+ * @param a Pointer to the input array of shape [..., n, n].
+ * @return Error code indicating success or failure.
+ */
+ArrayError lu_array(ArrayType **lu, int **pivots, const ArrayType *a);
+
+/**
+ * Computes the Cholesky factor L, with A = L L^T, of symmetric positive
+ * definite matrices. Only the lower triangle of a is read; the upper triangle
+ * of the result is zero.
+ *
+ * @param result Pointer to the array where L will be stored.
+ * @param a Pointer to the input array of shape [..., n, n].
+ * @return Error code indicating success or failure;
+ *         ARRAY_ERROR_NOT_POSITIVE_DEFINITE if a matrix is not positive definite.
+ */
+ArrayError cholesky_array(ArrayType **result, const ArrayType *a);
+
+/**
+ * Computes the reduced QR factorization, A = Q R, with blocked Householder
+ * reflections applied in compact WY form. For an m x n matrix and
+ * k = min(m, n), Q is m x k with orthonormal columns and R is k x n upper
+ * triangular.
+ *
+ * @param q Pointer to the array where Q will be stored. May be NULL.
+ * @param r Pointer to the array where R will be stored. May be NULL.
+ * @param a Pointer to the input array of shape [..., m, n].
+ * @return Error code indicating success or failure.
+ */
+ArrayError qr_array(ArrayType **q, ArrayType **r, const ArrayType *a);
+
+/**
+ * Solves A X = B through an LU factorization with partial pivoting.
+ *
+ * @param result Pointer to the array where X will be stored, shaped like b.
+ * @param a Pointer to the coefficient matrices, of shape [..., n, n].
+ * @param b Pointer to the right-hand sides, of shape [..., n, k], or [..., n]
+ *          for a single vector per matrix.
+ * @return Error code indicating success or failure;
+ *         ARRAY_ERROR_SINGULAR_MATRIX if a matrix is singular.
+ */
+ArrayError solve_array(ArrayType **result, const ArrayType *a, const ArrayType *b);
+
+/**
+ * Computes the inverse of square matrices through an LU factorization.
+ *
+ * @param result Pointer to the array where the inverses will be stored.
+ * @param a Pointer to the input array of shape [..., n, n].
+ * @return Error code indicating success or failure;
+ *         ARRAY_ERROR_SINGULAR_MATRIX if a matrix is singular.
+ */
+ArrayError inv_array(ArrayType **result, const ArrayType *a);
+
+#endif // LINALG_H
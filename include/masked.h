@@ -0,0 +1,95 @@
+#ifndef MASKED_H
+#define MASKED_H
+
+#include <stdint.h>
+#include "array.h"
+
+// Function prototypes for validity bitmaps and NaN-aware reductions
+//
+// An array may carry an Arrow-style validity bitmap (ArrayType.validity), one
+// bit per element, set for valid elements. Without one every element is
+// valid. The data under invalid elements is unspecified. Element-wise
+// operations (add_arrays, multiply_arrays, fma_arrays, axpy_arrays,
+// where_arrays, array_copy, unary_operation and the batched forms) give their
+// result the AND of their operands' bitmaps. Operands of the result's shape
+// are combined a 64-bit word at a time. Other operations drop the bitmap of
+// the result they write.
+//
+// The nan* reductions skip both NaNs and invalid elements. A bitmap word of
+// zero skips its 64 elements without reading them, and a word of ones takes
+// a dense path. Mixed words are blended with branch-free selects, so every
+// path vectorizes. Long rows split across threads are reduced in chunks of
+// ARRAY_DETERMINISTIC_CHUNK elements combined pairwise; in deterministic mode
+// every row is, so results do not depend on the number of threads.
+
+/**
+ * Sets or drops the validity bitmap of an array.
+ *
+ * @param a Pointer to the array.
+ * @param bitmap Arrow-style bitmap (bit i % 8 of byte i / 8, LSB first) to copy, or NULL to
+ *               mark every element valid.
+ * @param offset Bit of bitmap holding the validity of element 0.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_set_validity(ArrayType *a, const uint8_t *bitmap, size_t offset);
+
+/**
+ * Marks the NaN elements of a float32 array invalid, keeping elements already
+ * marked invalid.
+ *
+ * @param a Pointer to the array.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_validity_from_nan(ArrayType *a);
+
+/**
+ * Counts the invalid elements of an array.
+ *
+ * @param a Pointer to the array.
+ * @return Number of elements whose validity bit is clear; 0 without a bitmap.
+ */
+size_t array_null_count(const ArrayType *a);
+
+/**
+ * Tells whether an element of an array is valid.
+ *
+ * @param a Pointer to the array.
+ * @param index Flat (row-major) index of the element.
+ * @return 1 if the element is valid, 0 otherwise.
+ */
+int array_is_valid(const ArrayType *a, size_t index);
+
+/**
+ * Sums the valid, non-NaN elements of an array along an axis; empty sums are 0.
+ *
+ * @param result Pointer to the array where the result will be stored: the
+ *               shape of a without the axis, or {1} for 1-D input.
+ * @param a Pointer to the contiguous float32 input array.
+ * @param axis Axis to reduce; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError nansum_array(ArrayType **result, const ArrayType *a, int axis);
+
+/**
+ * Averages the valid, non-NaN elements of an array along an axis; empty means
+ * are NaN.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the contiguous float32 input array.
+ * @param axis Axis to reduce; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError nanmean_array(ArrayType **result, const ArrayType *a, int axis);
+
+/**
+ * Takes the maximum of the valid, non-NaN elements of an array along an axis;
+ * empty maxima are NaN.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the contiguous float32 input array.
+ * @param axis Axis to reduce; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError nanmax_array(ArrayType **result, const ArrayType *a, int axis);
+
+#endif // MASKED_H
@@ -1,49 +1,204 @@
-#ifndef MEMORY_H
-#define MEMORY_H
-
-#include <stddef.h>
-
-// Define an enum for memory error codes
-typedef enum {
-    MEMORY_SUCCESS = 0,
-    MEMORY_ERROR_NULL_POINTER,
-    MEMORY_ERROR_ALLOCATION_FAILED,
-    MEMORY_ERROR_OUT_OF_MEMORY,
-    // Add more error codes as needed
-} MemoryError;
-
-// Define a type for the memory pool
-typedef struct {
-    void *start;
-    void *current;
-    size_t size;
-    size_t used;
-} MemoryPoolType;
-
-// Function prototypes for memory management
-
-/**
- * @brief Creates a memory pool of the specified size.
- *
- * @param size The size of the memory pool to create.
- * @return Pointer to the newly created memory pool, or NULL if an error occurred.
- */
-MemoryPoolType* create_memory_pool(size_t size);
-
-/**
- * @brief Allocates memory from the memory pool.
- *
- * @param pool Pointer to the memory pool.
- * @param size The size of the memory to allocate.
- * @return Pointer to the allocated memory, or NULL if an error occurred.
- */
-void* allocate_from_pool(MemoryPoolType* pool, size_t size);
-
-/**
- * @brief Destroys the memory pool and frees all associated memory.
- *
- * @param pool Pointer to the memory pool to destroy.
- */
-void destroy_memory_pool(MemoryPoolType* pool);
-
-#endif // MEMORY_H
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stddef.h>
+
+// Define an enum for memory error codes
+typedef enum {
+    MEMORY_SUCCESS = 0,
+    MEMORY_ERROR_NULL_POINTER,
+    MEMORY_ERROR_ALLOCATION_FAILED,
+    MEMORY_ERROR_OUT_OF_MEMORY,
+    // Add more error codes as needed
+} MemoryError;
+
+// Define a type for the memory pool
+typedef struct {
+    void *start;
+    void *current;
+    size_t size;
+    size_t used;
+} MemoryPoolType;
+
+// Allocator for array data buffers. create_array and every operation that
+// allocates a result take their data from the current allocator, and buffers
+// remember the allocator they came from, so they are freed through it even
+// after another one is installed.
+typedef struct {
+    // Returns size bytes aligned to alignment, zero-filled when zero is set
+    void* (*alloc)(size_t size, size_t alignment, int zero, void *ctx);
+    // Frees a block returned by alloc or realloc with the size it was requested with
+    void (*free)(void *ptr, size_t size, void *ctx);
+    // Resizes a block, keeping its contents up to the smaller size; may be NULL
+    void* (*realloc)(void *ptr, size_t old_size, size_t new_size, size_t alignment, void *ctx);
+    size_t alignment;  // Alignment of every block in bytes, a power of two
+    void *ctx;         // Passed to every callback
+} ArrayAllocator;
+
+// Ways array_allocator_hugepage obtains 2 MB pages
+typedef enum {
+    HUGEPAGE_TRANSPARENT = 0,  // 2 MB-aligned anonymous mappings with madvise(MADV_HUGEPAGE)
+    HUGEPAGE_HUGETLB           // MAP_HUGETLB from the reserved pool, falling back to transparent pages
+} HugePageMode;
+
+// Blocks below this size come from malloc even with the huge-page allocator
+#define HUGEPAGE_MIN_SIZE ((size_t)2 << 20)
+
+// Default allocator: calloc, malloc, realloc and free with 16-byte alignment
+extern const ArrayAllocator array_allocator_malloc;
+
+// Buffer cache: every thread keeps freed array buffers of at least
+// ARRAY_CACHE_MIN_SIZE bytes on size-class free lists (four classes per power
+// of two) and hands them to the next allocation of a compatible size from an
+// allocator with the same callbacks, context and alignment, instead of
+// unmapping and faulting the memory in again. A block serves requests up to
+// its own size and down to half of it. Each thread's cache holds at most its
+// limit; blocks that do not fit are freed immediately. Blocks are matched by
+// callbacks and context rather than by allocator address, so allocator
+// descriptions may go out of scope while their blocks are cached; a custom
+// allocator whose context is destroyed must have its blocks trimmed first.
+#define ARRAY_CACHE_MIN_SIZE ((size_t)64 << 10)
+
+// Limit of threads that have not set their own
+#define ARRAY_CACHE_DEFAULT_LIMIT ((size_t)256 << 20)
+
+// Counters of the calling thread's buffer cache
+typedef struct {
+    size_t cached_bytes;  // Bytes currently held
+    size_t limit;         // Maximum number of bytes held
+    size_t hits;          // Allocations served from the cache
+    size_t misses;        // Cacheable allocations passed on to the allocator
+} ArrayCacheStats;
+
+// Function prototypes for memory management
+
+/**
+ * @brief Creates a memory pool of the specified size.
+ *
+ * @param size The size of the memory pool to create.
+ * @return Pointer to the newly created memory pool, or NULL if an error occurred.
+ */
+MemoryPoolType* create_memory_pool(size_t size);
+
+/**
+ * @brief Allocates memory from the memory pool.
+ *
+ * @param pool Pointer to the memory pool.
+ * @param size The size of the memory to allocate.
+ * @return Pointer to the allocated memory, or NULL if an error occurred.
+ */
+void* allocate_from_pool(MemoryPoolType* pool, size_t size);
+
+/**
+ * @brief Destroys the memory pool and frees all associated memory. Blocks of
+ * the pool held by the calling thread's buffer cache are dropped with it;
+ * other threads drop the pool blocks they cache, of any pool, the next time
+ * they use their cache, without touching the freed memory.
+ *
+ * @param pool Pointer to the memory pool to destroy.
+ */
+void destroy_memory_pool(MemoryPoolType* pool);
+
+/**
+ * @brief Installs the allocator used for new array data. The structure is
+ * used in place, not copied, and must stay valid until every array allocated
+ * through it has been freed.
+ *
+ * @param allocator Pointer to the allocator, or NULL for array_allocator_malloc.
+ */
+void array_set_allocator(const ArrayAllocator *allocator);
+
+/**
+ * @brief Returns the allocator used for new array data.
+ *
+ * @return Pointer to the current allocator; never NULL.
+ */
+const ArrayAllocator* array_get_allocator(void);
+
+/**
+ * @brief Describes an allocator returning blocks aligned with posix_memalign,
+ * for example to cache lines (64) or pages (4096).
+ *
+ * @param alignment Alignment in bytes; a power of two no smaller than sizeof(void*).
+ * @return The allocator description.
+ */
+ArrayAllocator array_allocator_aligned(size_t alignment);
+
+/**
+ * @brief Describes an allocator backing blocks of HUGEPAGE_MIN_SIZE bytes or
+ * more with 2 MB pages, which cuts TLB misses on large strided and broadcast
+ * walks. Smaller blocks come from malloc. Fresh mappings are already zero, so
+ * zero-filled requests cost nothing extra. Where mmap is unavailable this is
+ * the 64-byte aligned allocator.
+ *
+ * @param mode How huge pages are obtained.
+ * @return The allocator description.
+ */
+ArrayAllocator array_allocator_hugepage(HugePageMode mode);
+
+/**
+ * @brief Describes an allocator carving blocks out of a memory pool. Blocks are
+ * never returned individually; their memory is reclaimed by
+ * destroy_memory_pool, which must only be called once every array allocated
+ * from the pool has been freed.
+ *
+ * @param pool Pointer to the memory pool.
+ * @return The allocator description; alloc returns NULL once the pool is exhausted.
+ *         Pools are not thread-safe, so arrays must not be allocated from one
+ *         pool by several threads at once.
+ */
+ArrayAllocator array_allocator_pool(MemoryPoolType *pool);
+
+/**
+ * @brief Allocates a block through the calling thread's buffer cache, falling
+ * back to the allocator when no cached block fits.
+ *
+ * @param allocator Pointer to the allocator.
+ * @param size Pointer to the requested size in bytes; set to the size of the
+ * returned block, which must be passed to array_cache_free or the allocator.
+ * @param zero Non-zero to get zero-filled memory; cached blocks are cleared with memset.
+ * @return Pointer to the block, or NULL if the allocation failed.
+ */
+void* array_cache_alloc(const ArrayAllocator *allocator, size_t *size, int zero);
+
+/**
+ * @brief Returns a block to the calling thread's buffer cache, or to the
+ * allocator when it is too small or the cache is full.
+ *
+ * @param allocator Pointer to the allocator the block came from.
+ * @param ptr Pointer to the block.
+ * @param size Size of the block as reported by array_cache_alloc.
+ */
+void array_cache_free(const ArrayAllocator *allocator, void *ptr, size_t size);
+
+/**
+ * @brief Sets the most memory the calling thread's buffer cache may hold,
+ * trimming it if it holds more. A limit of 0 disables the cache.
+ *
+ * @param bytes Limit in bytes.
+ */
+void array_cache_set_limit(size_t bytes);
+
+/**
+ * @brief Sets the limit of threads that have not called array_cache_set_limit.
+ *
+ * @param bytes Limit in bytes.
+ */
+void array_cache_set_default_limit(size_t bytes);
+
+/**
+ * @brief Frees cached blocks of the calling thread, largest first, until at
+ * most a number of bytes remain cached.
+ *
+ * @param keep_bytes Bytes that may stay cached; 0 empties the cache.
+ */
+void array_cache_trim(size_t keep_bytes);
+
+/**
+ * @brief Reports the counters of the calling thread's buffer cache.
+ *
+ * @param stats Pointer to the structure to fill.
+ */
+void array_cache_get_stats(ArrayCacheStats *stats);
+
+#endif // MEMORY_H
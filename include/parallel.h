@@ -0,0 +1,34 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// Minimum number of elements before a loop is worth opening an OpenMP parallel region
+#define ARRAY_PARALLEL_THRESHOLD 32768
+
+// Number of elements handed to a kernel at a time by the blocked element-wise loops
+#define ARRAY_BLOCK_SIZE 4096
+
+// Vectorization hints that compile away when OpenMP is not enabled
+#ifdef _OPENMP
+#define ARRAY_PRAGMA(x) _Pragma(#x)
+#define ARRAY_OMP_SIMD _Pragma("omp simd")
+#define ARRAY_OMP_SIMD_REDUCTION(clause) ARRAY_PRAGMA(omp simd reduction(clause))
+#else
+#define ARRAY_OMP_SIMD
+#define ARRAY_OMP_SIMD_REDUCTION(clause)
+#endif
+
+// Elements per chunk of a scan or reduction in deterministic mode; partial results of
+// chunks are combined in a fixed order whatever the number of threads
+#define ARRAY_DETERMINISTIC_CHUNK 65536
+
+// Distance, in elements, that gather/scatter loops prefetch ahead of the current index
+#define ARRAY_PREFETCH_DISTANCE 16
+
+// Read prefetch hint for irregular access patterns
+#if defined(__GNUC__)
+#define ARRAY_PREFETCH(addr) __builtin_prefetch((addr), 0, 1)
+#else
+#define ARRAY_PREFETCH(addr) ((void)(addr))
+#endif
+
+#endif // PARALLEL_H
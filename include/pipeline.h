@@ -0,0 +1,107 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "array.h"
+#include "memory.h"
+
+// Function prototypes for producer/consumer pipelines
+//
+// A pipeline runs a chain of stages, for example ingest -> transform -> write,
+// with every stage on threads of its own so that I/O and compute overlap.
+// Between two consecutive stages sits a ring of `depth` preallocated arrays
+// carved from a memory pool: the upstream stage takes a free array from the
+// ring, fills it and hands it on, and the downstream stage gives it back once
+// it has consumed it. Hand-offs go through bounded lock-free queues (Vyukov's
+// multi-producer multi-consumer queue, which with one worker on each side is
+// a single-producer single-consumer queue). A stage that finds no free array
+// waits for its consumer, so a slow stage holds back the ones before it
+// (backpressure) and memory stays bounded by the rings.
+//
+// Each stage runs on one OpenMP thread per worker. When fewer threads are
+// available, or without OpenMP, a thread steps several workers in turn, so
+// the pipeline still completes, only without the overlap. Operations called
+// from a stage run on its thread unless nested parallelism is enabled.
+
+// Opaque pipeline handle
+typedef struct Pipeline Pipeline;
+
+/**
+ * Function run by a stage on every item.
+ *
+ * @param in Array handed on by the previous stage; NULL for the first stage.
+ *           It goes back to its ring when the function returns.
+ * @param out Pointer to an array of the stage's ring to fill, with the shape
+ *            given to pipeline_create; NULL for the last stage. It may be passed
+ *            as the result of an operation, which writes it in place when the
+ *            shape matches.
+ * @param index Index of the item, from 0 to the number of items run minus 1.
+ *              With several workers on a stage, items may reach later stages
+ *              out of order.
+ * @param ctx Context pointer given with the stage.
+ * @return Error code; any error stops the pipeline.
+ */
+typedef ArrayError (*PipelineStageFn)(const ArrayType *in, ArrayType **out, long index, void *ctx);
+
+// Description of one stage
+typedef struct {
+    PipelineStageFn fn;
+    void *ctx;
+    const int *shape;  // Shape of the arrays the stage fills; ignored for the last stage
+    int ndim;
+    int workers;       // Threads running the stage, at least 1
+} PipelineStage;
+
+// Counters of one stage over the last run; times are in seconds
+typedef struct {
+    long items;                // Items processed
+    long input_stalls;         // Times a worker found no item waiting (the stage was starved)
+    long output_stalls;        // Times a worker found no free output array (backpressure)
+    double input_wait;         // Time workers spent waiting for an item
+    double output_wait;        // Time workers spent waiting for a free output array
+    double busy;               // Time spent in the stage function
+    double max_latency;        // Longest single call of the stage function
+    double queue_latency;      // Total time items waited in the input queue before being taken
+    double max_queue_latency;  // Longest such wait
+} PipelineStats;
+
+/**
+ * Creates a pipeline and preallocates the arrays of its rings.
+ *
+ * @param stages Array of stage descriptions, from first to last.
+ * @param nstages Number of stages, at least 2.
+ * @param depth Number of arrays in each ring, at least 1; 2 double-buffers.
+ * @param pool Memory pool to carve the arrays from, or NULL for the pipeline to
+ *             create its own. A given pool must outlive the pipeline.
+ * @param error Pointer to an error code variable.
+ * @return Pointer to the new pipeline or NULL if an error occurred.
+ */
+Pipeline* pipeline_create(const PipelineStage *stages, int nstages, int depth, MemoryPoolType *pool, ArrayError *error);
+
+/**
+ * Runs items through the pipeline and returns once the last stage has
+ * processed all of them or a stage has failed. A pipeline can be run again.
+ *
+ * @param p Pointer to the pipeline.
+ * @param items Number of items the first stage produces.
+ * @return Error code of the first stage that failed, or ARRAY_SUCCESS.
+ */
+ArrayError pipeline_run(Pipeline *p, long items);
+
+/**
+ * Reads the counters of a stage over the last run.
+ *
+ * @param p Pointer to the pipeline.
+ * @param stage Index of the stage.
+ * @param stats Pointer to the structure receiving the counters.
+ * @return Error code indicating success or failure.
+ */
+ArrayError pipeline_get_stats(const Pipeline *p, int stage, PipelineStats *stats);
+
+/**
+ * Frees a pipeline, its arrays and the memory pool it created.
+ *
+ * @param p Pointer to the pipeline.
+ */
+void pipeline_free(Pipeline *p);
+
+#endif // PIPELINE_H
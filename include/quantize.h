@@ -0,0 +1,97 @@
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+#include "array.h"
+
+// Function prototypes for quantized int8/uint8 arithmetic
+//
+// A quantized array (ARRAY_DTYPE_INT8 or ARRAY_DTYPE_UINT8) stores one byte
+// per element and a per-tensor affine mapping: the byte q stands for the real
+// value scale * (q - zero_point). Arithmetic subtracts the zero points in
+// 16- and 32-bit integers and rescales with fixed-point multipliers, so no
+// float is touched per element and results saturate to the output type;
+// they are within one step of the exactly rounded value.
+// Quantized inputs must be contiguous; validity bitmaps are not propagated.
+
+/**
+ * Chooses the scale and zero point that map the range of an array, widened to
+ * include 0, onto a quantized type: symmetric with zero point 0 for int8 and
+ * asymmetric over [min, max] for uint8. NaNs and infinities are ignored.
+ *
+ * @param a Pointer to the contiguous float32 array.
+ * @param dtype ARRAY_DTYPE_INT8 or ARRAY_DTYPE_UINT8.
+ * @param scale Pointer to receive the scale; 1 for an all-zero array.
+ * @param zero_point Pointer to receive the zero point.
+ * @return Error code indicating success or failure.
+ */
+ArrayError quantize_params(const ArrayType *a, ArrayDType dtype, float *scale, int *zero_point);
+
+/**
+ * Quantizes a float32 array: q = round(x / scale) + zero_point, rounding
+ * halves to even and saturating to the range of the type. NaNs become the
+ * zero point.
+ *
+ * @param result Pointer to the array where the quantized array will be stored.
+ * @param a Pointer to the contiguous float32 array.
+ * @param dtype ARRAY_DTYPE_INT8 or ARRAY_DTYPE_UINT8.
+ * @param scale Positive, finite scale.
+ * @param zero_point Zero point, within the range of the type.
+ * @return Error code indicating success or failure.
+ */
+ArrayError quantize_array(ArrayType **result, const ArrayType *a, ArrayDType dtype, float scale, int zero_point);
+
+/**
+ * Dequantizes an array: x = scale * (q - zero_point).
+ *
+ * @param result Pointer to the float32 array where the result will be stored.
+ * @param q Pointer to the quantized array.
+ * @return Error code indicating success or failure.
+ */
+ArrayError dequantize_array(ArrayType **result, const ArrayType *q);
+
+/**
+ * Adds two quantized arrays of the same shape and type element-wise and
+ * requantizes the sums to a given scale and zero point.
+ *
+ * @param result Pointer to the array where the result will be stored; it has
+ *               the type of a and may be a or b.
+ * @param a Pointer to the first quantized array.
+ * @param b Pointer to the second quantized array.
+ * @param scale Scale of the result.
+ * @param zero_point Zero point of the result.
+ * @return Error code indicating success or failure.
+ */
+ArrayError quantized_add_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b,
+                                float scale, int zero_point);
+
+/**
+ * Multiplies two quantized arrays of the same shape and type element-wise and
+ * requantizes the products to a given scale and zero point.
+ *
+ * @param result Pointer to the array where the result will be stored; it has
+ *               the type of a and may be a or b.
+ * @param a Pointer to the first quantized array.
+ * @param b Pointer to the second quantized array.
+ * @param scale Scale of the result.
+ * @param zero_point Zero point of the result.
+ * @return Error code indicating success or failure.
+ */
+ArrayError quantized_multiply_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b,
+                                     float scale, int zero_point);
+
+/**
+ * Computes the dot products of every row of a with every row of b, for
+ * example queries against an embedding table. Products are accumulated
+ * exactly in integers (AVX-VNNI or AVX-512 VNNI dot-product instructions when
+ * available) and scaled to float32 once per output.
+ *
+ * @param result Pointer to the float32 array where the result will be stored:
+ *               shape {m, n} for a of shape {m, k} and b of shape {n, k}, with the
+ *               axis of a 1-D operand dropped, or {1} for two vectors.
+ * @param a Pointer to the quantized 1-D or 2-D array.
+ * @param b Pointer to the quantized 1-D or 2-D array, of either quantized type.
+ * @return Error code indicating success or failure.
+ */
+ArrayError quantized_dot_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b);
+
+#endif // QUANTIZE_H
@@ -0,0 +1,85 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+#include "array.h"
+
+// Function prototypes for random number generation
+//
+// Numbers come from the Philox4x32-10 counter-based generator: each 128-bit
+// counter block is encrypted under the key into four independent 32-bit
+// words. Element i of a fill is computed from a block at a fixed offset from
+// the state's counter, so work is split into chunks across OpenMP threads
+// with no shared state. The output is bit-identical for every thread count.
+// Jumping ahead is an addition on the counter.
+//
+// Each fill advances state->counter past the blocks it used. Successive
+// fills therefore draw fresh numbers, and the same seed and sequence of calls
+// always reproduces the same arrays. Fills write every element of a float32
+// array that owns its data; views are rejected.
+
+// Generator state: a key and a position in one of 2^32 independent streams
+typedef struct {
+    uint32_t key[2];    // Philox key, taken from the seed
+    uint32_t stream;    // Stream selector, held in the upper counter words
+    uint64_t counter;   // Index of the next unused 128-bit block in the stream
+} RandomState;
+
+/**
+ * Initializes a generator state at the start of a stream.
+ *
+ * @param state Pointer to the state to initialize.
+ * @param seed Seed; distinct seeds give unrelated sequences.
+ * @param stream Stream number; distinct streams of one seed never overlap.
+ */
+void random_seed(RandomState *state, uint64_t seed, uint32_t stream);
+
+/**
+ * Advances a generator state by a number of 128-bit blocks (four 32-bit
+ * words each) without generating them.
+ *
+ * @param state Pointer to the state to advance.
+ * @param blocks Number of blocks to skip.
+ */
+void random_skip(RandomState *state, uint64_t blocks);
+
+/**
+ * Fills an array with numbers uniformly distributed over [low, high), built
+ * from the upper 24 bits of one word per element. Uses ceil(size / 4) blocks.
+ *
+ * @param a Pointer to the array to fill.
+ * @param state Pointer to the generator state.
+ * @param low Lower bound, included.
+ * @param high Upper bound, excluded.
+ * @return Error code indicating success or failure.
+ */
+ArrayError random_uniform(ArrayType *a, RandomState *state, float low, float high);
+
+/**
+ * Fills an array with normally distributed numbers. A vectorized Box-Muller
+ * transform turns each pair of words into two values, so samples reach about
+ * 5.9 standard deviations from the mean. Uses ceil(size / 4) blocks.
+ *
+ * @param a Pointer to the array to fill.
+ * @param state Pointer to the generator state.
+ * @param mean Mean of the distribution.
+ * @param stddev Standard deviation of the distribution, not negative.
+ * @return Error code indicating success or failure.
+ */
+ArrayError random_normal(ArrayType *a, RandomState *state, float mean, float stddev);
+
+/**
+ * Fills an array with integers uniformly distributed over [low, high). Each
+ * element is reduced from a 64-bit draw, so the bias is below 2^-38.
+ * The bounds must lie within +-2^24, where floats hold integers exactly.
+ * Uses ceil(size / 2) blocks.
+ *
+ * @param a Pointer to the array to fill.
+ * @param state Pointer to the generator state.
+ * @param low Lowest value, included.
+ * @param high Upper bound, excluded; must be greater than low.
+ * @return Error code indicating success or failure.
+ */
+ArrayError random_integers(ArrayType *a, RandomState *state, int32_t low, int32_t high);
+
+#endif // RANDOM_H
@@ -0,0 +1,39 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "array.h"
+
+// Function prototypes for cumulative (scan) operations
+
+/**
+ * Computes the cumulative sum of an array along an axis.
+ *
+ * Along the last axis, long rows are split into per-thread chunks: a
+ * vectorized reduction computes each chunk's total, the totals are
+ * scanned to give each chunk its starting offset, and every chunk is then
+ * scanned independently. Along outer axes whole rows are accumulated at
+ * once so the inner loop is vectorized over the contiguous trailing axes.
+ * In deterministic mode every row along the last axis is split into chunks
+ * of ARRAY_DETERMINISTIC_CHUNK elements instead, whatever its length and
+ * the number of threads. Every chunk is then read twice even on one thread,
+ * which makes single-threaded scans about a third slower.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param axis Axis to accumulate along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError cumsum_array(ArrayType **result, const ArrayType *a, int axis);
+
+/**
+ * Computes the cumulative product of an array along an axis, using the
+ * same parallel strategy as cumsum_array.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param axis Axis to accumulate along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError cumprod_array(ArrayType **result, const ArrayType *a, int axis);
+
+#endif // SCAN_H
@@ -0,0 +1,97 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <stdint.h>
+#include "array.h"
+
+// Function prototypes for arrays in POSIX shared memory
+//
+// A shared array is a shm_open object holding a header followed by the
+// elements. The header records the dtype, shape and strides, so another
+// process can attach by name alone. Every process maps the same physical
+// pages, and nothing is copied when data passes between processes. The data
+// starts on a page boundary.
+//
+// Writers and readers coordinate through a sequence lock in the header. A
+// writer makes the sequence odd while it writes and even again when it has
+// finished. A reader that sees the same even value before and after reading
+// has a consistent snapshot. Writers exclude each other; readers never block
+// writers and retry instead.
+//
+// The mapping lives until the last handle on it is freed, including handles
+// from array_share and views. Writes through any of these handles go to the
+// mapping itself rather than to a private copy. The name lives until array_unlink_shared.
+
+/**
+ * Creates a zero-filled array in a new shared memory object.
+ *
+ * @param name Name of the object, "/" followed by up to 254 characters without
+ *             further slashes; fails if it already exists.
+ * @param shape Array containing the size of each dimension.
+ * @param ndim Number of dimensions.
+ * @param dtype Element type.
+ * @param error Pointer to an error code variable; ARRAY_ERROR_SYSTEM if the
+ *              object cannot be created or mapped.
+ * @return Pointer to the new array or NULL if an error occurred.
+ */
+ArrayType* array_create_shared(const char *name, const int *shape, int ndim, ArrayDType dtype, ArrayError *error);
+
+/**
+ * Maps an existing shared array created by array_create_shared, in this or
+ * another process.
+ *
+ * @param name Name the array was created with.
+ * @param error Pointer to an error code variable; ARRAY_ERROR_SYSTEM if the
+ *              object cannot be opened or mapped, ARRAY_ERROR_INVALID_ARGUMENT
+ *              if it does not hold a complete shared array header.
+ * @return Pointer to an array over the shared elements or NULL if an error occurred.
+ */
+ArrayType* array_attach_shared(const char *name, ArrayError *error);
+
+/**
+ * Removes the name of a shared array. Existing mappings stay valid until
+ * their handles are freed.
+ *
+ * @param name Name the array was created with.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_unlink_shared(const char *name);
+
+/**
+ * Starts a write: waits for other writers and makes the sequence odd.
+ *
+ * @param arr Pointer to a shared array or a handle sharing its buffer.
+ * @return Error code indicating success or failure; ARRAY_ERROR_INVALID_ARGUMENT
+ *         if the array is not backed by shared memory.
+ */
+ArrayError array_shared_write_begin(ArrayType *arr);
+
+/**
+ * Ends a write started by array_shared_write_begin, making the sequence even.
+ *
+ * @param arr Pointer to the shared array.
+ * @return Error code indicating success or failure.
+ */
+ArrayError array_shared_write_end(ArrayType *arr);
+
+/**
+ * Starts a read: waits until no write is in progress.
+ *
+ * @param arr Pointer to the shared array.
+ * @return Sequence to pass to array_shared_read_validate; half of it is the
+ *         number of completed writes. 0 if the array is not shared.
+ */
+uint64_t array_shared_read_begin(const ArrayType *arr);
+
+/**
+ * Checks whether a read started by array_shared_read_begin saw a consistent
+ * snapshot, that is, no write started in the meantime.
+ *
+ * @param arr Pointer to the shared array.
+ * @param sequence Value returned by array_shared_read_begin.
+ * @return 1 if the data read is consistent, 0 if the read must be retried or
+ *         the array is not shared.
+ */
+int array_shared_read_validate(const ArrayType *arr, uint64_t sequence);
+
+#endif // SHM_H
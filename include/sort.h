@@ -0,0 +1,70 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include "array.h"
+
+// Function prototypes for sorting and selection along an axis
+//
+// Every row along the chosen axis is sorted independently. Values are mapped
+// to 64-bit keys that hold an order-preserving encoding of the float in the
+// high half and the element's position in the low half, so all sorts are
+// stable and argsort comes for free. NaNs order after +inf and -0.0 equals
+// 0.0, as in NumPy.
+//
+// Rows of up to 32 elements go through a branch-free sorting network and
+// longer rows through an LSD radix sort. Batches of rows are spread over
+// OpenMP threads. A single long row is split into per-thread chunks that are
+// sorted in parallel and then merged pairwise, with every merge partitioned
+// along its merge path so all threads stay busy until the last round.
+//
+// Index buffers are allocated with malloc and replace any buffer already
+// stored in *indices; the caller releases them with free().
+
+/**
+ * Sorts an array along an axis in ascending order.
+ *
+ * @param result Pointer to the array where the sorted values will be stored.
+ * @param a Pointer to the input array.
+ * @param axis Axis to sort along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError sort_array(ArrayType **result, const ArrayType *a, int axis);
+
+/**
+ * Computes the indices that would sort an array along an axis (stable).
+ *
+ * @param indices Pointer to the index buffer, laid out with the shape of a.
+ * @param a Pointer to the input array.
+ * @param axis Axis to sort along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError argsort_array(int **indices, const ArrayType *a, int axis);
+
+/**
+ * Partially sorts an array along an axis so that the element at position kth
+ * is the one a full sort would put there, every element before it is not
+ * greater and every element after it is not smaller (nth_element).
+ *
+ * @param result Pointer to the array where the partitioned values will be stored.
+ * @param a Pointer to the input array.
+ * @param kth Position of the pivot element along the axis.
+ * @param axis Axis to partition along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError partition_array(ArrayType **result, const ArrayType *a, int kth, int axis);
+
+/**
+ * Finds the k largest elements along an axis, in descending order. Ties are
+ * broken in favour of the lower index and NaN counts as the largest value.
+ *
+ * @param values Pointer to the array where the values will be stored; it has the
+ *               shape of a with the axis reduced to k, and may not be a. May be NULL.
+ * @param indices Pointer to the index buffer, laid out like values. May be NULL.
+ * @param a Pointer to the input array.
+ * @param k Number of elements to select, between 1 and the length of the axis.
+ * @param axis Axis to select along; negative values count from the end.
+ * @return Error code indicating success or failure.
+ */
+ArrayError topk_array(ArrayType **values, int **indices, const ArrayType *a, int k, int axis);
+
+#endif // SORT_H
@@ -0,0 +1,94 @@
+#ifndef STENCIL_H
+#define STENCIL_H
+
+#include "array.h"
+
+// How a stencil reads cells beyond the edges of the grid (as in scipy.ndimage)
+typedef enum {
+    STENCIL_CONSTANT = 0,  // Cells outside hold a constant value
+    STENCIL_NEAREST,       // Cells outside repeat the edge cell:  a a a | a b c d
+    STENCIL_REFLECT,       // Cells outside mirror the grid:       c b a | a b c d
+    STENCIL_WRAP           // Cells outside wrap around the grid:  b c d | a b c d
+} StencilBoundary;
+
+// Function prototypes for stencils and image filters
+//
+// A stencil replaces every cell of the 2-D grids in the last two axes, or the
+// 3-D grids in the last three, by a weighted sum of its neighbours; leading
+// axes are batch axes and the result has the shape of the input. Grids are
+// cut into tiles processed in parallel. Each thread loads a tile with a halo
+// of neighbouring cells, applying the boundary rule there, into a small
+// buffer and runs the stencil over it, so a sweep streams the grid from
+// memory once whatever the number of taps. Iterated stencils fuse several
+// steps per sweep (temporal blocking): the halo is widened by the radius for
+// each fused step and the tile is stepped in place in cache before being
+// written back. Every cell is computed in the same order however the grid is
+// tiled, so results are bit-identical to running the steps one at a time and
+// do not depend on the thread count.
+//
+// Inputs must be contiguous float32 arrays and the result may not be the
+// input; validity bitmaps are not propagated.
+
+/**
+ * Applies a stencil given by its weights, once or repeatedly, correlating
+ * as scipy.ndimage.correlate does: for a 2-D stencil of shape [kh, kw],
+ * result[y][x] = sum over i, j of weights[i][j] * a[y + i - kh / 2][x + j - kw / 2].
+ * Zero weights are skipped, so a 5-point stencil written as 3 x 3 costs five
+ * taps per cell.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array, with at least as many dimensions as weights.
+ * @param weights Pointer to the 2-D or 3-D weights, of odd length along every axis.
+ * @param iterations Number of times the stencil is applied, at least 1.
+ * @param boundary How cells beyond the edges are read.
+ * @param cval Value of the cells beyond the edges for STENCIL_CONSTANT.
+ * @return Error code indicating success or failure.
+ */
+ArrayError stencil_array(ArrayType **result, const ArrayType *a, const ArrayType *weights,
+                         int iterations, StencilBoundary boundary, float cval);
+
+/**
+ * Computes the discrete Laplacian with the 5-point stencil in 2-D or the
+ * 7-point stencil in 3-D (scipy.ndimage.laplace).
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param dims 2 for the last two axes or 3 for the last three.
+ * @param boundary How cells beyond the edges are read.
+ * @param cval Value of the cells beyond the edges for STENCIL_CONSTANT.
+ * @return Error code indicating success or failure.
+ */
+ArrayError laplacian_array(ArrayType **result, const ArrayType *a, int dims, StencilBoundary boundary, float cval);
+
+/**
+ * Blurs with a Gaussian of standard deviation sigma, truncated at a radius of
+ * 4 sigma and normalized to sum to 1 (scipy.ndimage.gaussian_filter). The
+ * filter is separable and is applied as one 1-D pass per axis.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param sigma Standard deviation in cells, positive.
+ * @param dims 2 for the last two axes or 3 for the last three.
+ * @param boundary How cells beyond the edges are read.
+ * @param cval Value of the cells beyond the edges for STENCIL_CONSTANT.
+ * @return Error code indicating success or failure.
+ */
+ArrayError gaussian_filter_array(ArrayType **result, const ArrayType *a, float sigma, int dims,
+                                 StencilBoundary boundary, float cval);
+
+/**
+ * Replaces every cell by the mean of the size x size (x size) box centred on
+ * it (scipy.ndimage.uniform_filter), as one 1-D pass per axis.
+ *
+ * @param result Pointer to the array where the result will be stored.
+ * @param a Pointer to the input array.
+ * @param size Odd box length.
+ * @param dims 2 for the last two axes or 3 for the last three.
+ * @param boundary How cells beyond the edges are read.
+ * @param cval Value of the cells beyond the edges for STENCIL_CONSTANT.
+ * @return Error code indicating success or failure.
+ */
+ArrayError box_filter_array(ArrayType **result, const ArrayType *a, int size, int dims,
+                            StencilBoundary boundary, float cval);
+
+#endif // STENCIL_H
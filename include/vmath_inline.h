@@ -0,0 +1,92 @@
+#ifndef VMATH_INLINE_H
+#define VMATH_INLINE_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Branch-free scalar kernels shared by the vectorized math functions and the
+// random number generators. Loops that call them vectorize; see vmath.h for
+// their accuracy.
+
+// Helper functions to reinterpret float bits without breaking aliasing rules
+static inline uint32_t float_to_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bits_to_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// log: x = m * 2^e with m in [sqrt(1/2), sqrt(2)), degree 9 polynomial for log(m)
+static inline float fast_log(float x) {
+    float in = x;
+    int subnormal = x < 1.17549435e-38f;
+    x = subnormal ? x * 8388608.0f : x;
+
+    uint32_t bits = float_to_bits(x);
+    float e = (float)((int32_t)((bits >> 23) & 0xff) - 126) - (subnormal ? 23.0f : 0.0f);
+    float m = bits_to_float((bits & 0x807fffffu) | 0x3f000000u);
+
+    int small = m < 0.707106781186547524f;
+    e = small ? e - 1.0f : e;
+    m = small ? m + m - 1.0f : m - 1.0f;
+
+    float z = m * m;
+    float y = 7.0376836292e-2f;
+    y = y * m - 1.1514610310e-1f;
+    y = y * m + 1.1676998740e-1f;
+    y = y * m - 1.2420140846e-1f;
+    y = y * m + 1.4249322787e-1f;
+    y = y * m - 1.6668057665e-1f;
+    y = y * m + 2.0000714765e-1f;
+    y = y * m - 2.4999993993e-1f;
+    y = y * m + 3.3333331174e-1f;
+    y = y * m * z;
+    y += e * -2.12194440e-4f;
+    y += -0.5f * z;
+    float result = m + y + e * 0.693359375f;
+
+    result = (in == 0.0f) ? -INFINITY : result;
+    result = (in == INFINITY) ? INFINITY : result;
+    result = (in < 0.0f || in != in) ? NAN : result;
+    return result;
+}
+
+// Shared sin/cos core: reduce by pi/4 into an octant and pick the sine or cosine polynomial
+static inline float fast_sincos(float x, int quadrant_shift) {
+    float sign = x < 0.0f ? -1.0f : 1.0f;
+    x = fabsf(x);
+    if (quadrant_shift) sign = 1.0f;
+
+    int32_t j = (int32_t)(x * 1.27323954473516f);
+    j += j & 1;
+    float y = (float)j;
+    j = (j + 2 * quadrant_shift) & 7;
+
+    sign = (j > 3) ? -sign : sign;
+    j = (j > 3) ? j - 4 : j;
+
+    // Near multiples of pi/2 the remainder cancels most bits of x, so it is taken in double:
+    // y has at most 7 significant bits and y * pi/4 stays exact to well below a float ULP of r
+    float r = (float)((double)x - (double)y * 0.78539816339744830962);
+    float z = r * r;
+
+    float c = 2.443315711809948e-5f;
+    c = c * z - 1.388731625493765e-3f;
+    c = c * z + 4.166664568298827e-2f;
+    c = c * z * z - 0.5f * z + 1.0f;
+
+    float s = -1.9515295891e-4f;
+    s = s * z + 8.3321608736e-3f;
+    s = s * z - 1.6666654611e-1f;
+    s = s * z * r + r;
+
+    return sign * ((j == 1 || j == 2) ? c : s);
+}
+
+#endif // VMATH_INLINE_H
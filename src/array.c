@@ -1,212 +1,896 @@
-#include "array.h"
-#include <stdlib.h>
-#include <string.h>
-
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
-// Helper function to handle memory allocation errors
-static void free_array_memory(ArrayType *arr) {
-    if (arr) {
-        free(arr->data);
-        free(arr->shape);
-        free(arr->strides);
-        free(arr);
-    }
-}
-
-// Function to calculate strides
-void calculate_strides(const int *shape, int ndim, int *strides) {
-    strides[ndim - 1] = 1;
-    for (int i = ndim - 2; i >= 0; i--) {
-        strides[i] = strides[i + 1] * shape[i + 1];
-    }
-}
-
-// Function to create a new array
-ArrayType* create_array(const int *shape, int ndim, ArrayError *error) {
-    if (ndim <= 0 || shape == NULL) {
-        if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
-        return NULL;
-    }
-
-    ArrayType *arr = (ArrayType*)malloc(sizeof(ArrayType));
-    if (!arr) {
-        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
-        return NULL;
-    }
-
-    arr->ndim = ndim;
-    arr->shape = (int*)calloc(ndim, sizeof(int));
-    arr->strides = (int*)calloc(ndim, sizeof(int));
-    if (!arr->shape || !arr->strides) {
-        free_array_memory(arr);
-        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
-        return NULL;
-    }
-
-    arr->size = 1;
-    for (int i = 0; i < ndim; i++) {
-        arr->shape[i] = shape[i];
-        arr->size *= shape[i];
-    }
-
-    arr->itemsize = sizeof(float);
-    arr->data = (float*)calloc(arr->size, arr->itemsize);
-    if (!arr->data) {
-        free_array_memory(arr);
-        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
-        return NULL;
-    }
-
-    calculate_strides(arr->shape, ndim, arr->strides);
-
-    if (error) *error = ARRAY_SUCCESS;
-    return arr;
-}
-
-// Function to free an array
-void free_array(ArrayType *arr) {
-    free_array_memory(arr);
-}
-
-// Function to compare shapes and determine the broadcast shape
-ShapeInfo* compare_shapes(const ArrayType *a, const ArrayType *b) {
-    int max_ndim = (a->ndim > b->ndim) ? a->ndim : b->ndim;
-    int *shape = (int*)calloc(max_ndim, sizeof(int));
-    if (!shape) {
-        return NULL;
-    }
-
-    for (int i = 0; i < max_ndim; i++) {
-        int a_dim = (i < max_ndim - a->ndim) ? 1 : a->shape[i - (max_ndim - a->ndim)];
-        int b_dim = (i < max_ndim - b->ndim) ? 1 : b->shape[i - (max_ndim - b->ndim)];
-        if (a_dim != b_dim && a_dim != 1 && b_dim != 1) {
-            free(shape);
-            return NULL;  // Shapes are not compatible for broadcasting
-        }
-        shape[i] = (a_dim > b_dim) ? a_dim : b_dim;
-    }
-
-    ShapeInfo *info = (ShapeInfo*)malloc(sizeof(ShapeInfo));
-    if (!info) {
-        free(shape);
-        return NULL;
-    }
-
-    info->ndim = max_ndim;
-    info->shape = shape;
-    return info;
-}
-
-// Function to calculate the linear index from multidimensional indices
-size_t calculate_index(const int *indices, const int *shape, const int *strides, int ndim) {
-    size_t index = 0;
-    for (int i = 0; i < ndim; i++) {
-        index += indices[i] * strides[i];
-    }
-    return index;
-}
-
-// Helper function for element-wise operations with broadcasting
-ArrayError elementwise_operation(ArrayType **result, const ArrayType *a, const ArrayType *b, char op) {
-    ShapeInfo *broadcast_shape = compare_shapes(a, b);
-    if (!broadcast_shape) {
-        return ARRAY_ERROR_INVALID_DIMENSION;
-    }
-
-    int error_flag = 0;  // Flag to check if any error occurs
-
-    // Create result array if it's NULL or has incorrect shape
-    if (!*result || (*result)->ndim != broadcast_shape->ndim) {
-        free_array(*result);
-        *result = create_array(broadcast_shape->shape, broadcast_shape->ndim, NULL);
-        if (!*result) {
-            free(broadcast_shape->shape);
-            free(broadcast_shape);
-            return ARRAY_ERROR_MEMORY_ALLOCATION;
-        }
-    }
-
-    int *strides_a = (int*)malloc(a->ndim * sizeof(int));
-    int *strides_b = (int*)malloc(b->ndim * sizeof(int));
-    int *strides_result = (int*)malloc((*result)->ndim * sizeof(int));
-
-    if (!strides_a || !strides_b || !strides_result) {
-        free(strides_a);
-        free(strides_b);
-        free(strides_result);
-        free(broadcast_shape->shape);
-        free(broadcast_shape);
-        return ARRAY_ERROR_MEMORY_ALLOCATION;
-    }
-
-    calculate_strides(a->shape, a->ndim, strides_a);
-    calculate_strides(b->shape, b->ndim, strides_b);
-    calculate_strides((*result)->shape, (*result)->ndim, strides_result);
-
-    int *indices = (int*)calloc((*result)->ndim, sizeof(int));
-    if (!indices) {
-        free(strides_a);
-        free(strides_b);
-        free(strides_result);
-        free(broadcast_shape->shape);
-        free(broadcast_shape);
-        return ARRAY_ERROR_MEMORY_ALLOCATION;
-    }
-
-    // Initialize the result array to ensure no leftover values
-    memset((*result)->data, 0, (*result)->size * sizeof(float));
-
-#ifdef _OPENMP
-    #pragma omp parallel for shared(error_flag)
-#endif
-    for (size_t i = 0; i < (*result)->size; i++) {
-        if (error_flag) continue;  // Skip computation if an error has occurred
-
-        // Calculate indices for a and b considering broadcasting
-        size_t index_a = 0;
-        size_t index_b = 0;
-        size_t index_result = i;
-
-        for (int j = 0; j < (*result)->ndim; j++) {
-            size_t dim_index = (index_result / strides_result[j]) % (*result)->shape[j];
-            if (j < a->ndim) index_a += (dim_index % a->shape[j]) * strides_a[j];
-            if (j < b->ndim) index_b += (dim_index % b->shape[j]) * strides_b[j];
-        }
-
-        switch (op) {
-            case '+':
-                (*result)->data[i] = a->data[index_a] + b->data[index_b];
-                break;
-            case '*':
-                (*result)->data[i] = a->data[index_a] * b->data[index_b];
-                break;
-            default:
-                error_flag = 1;
-                break;
-        }
-    }
-
-    free(indices);
-    free(strides_a);
-    free(strides_b);
-    free(strides_result);
-    free(broadcast_shape->shape);
-    free(broadcast_shape);
-
-    if (error_flag) return ARRAY_ERROR_INVALID_DIMENSION;
-
-    return ARRAY_SUCCESS;
-}
-
-// Function to add arrays element-wise with broadcasting
-ArrayError add_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b) {
-    return elementwise_operation(result, a, b, '+');
-}
-
-// Function to multiply arrays element-wise with broadcasting
-ArrayError multiply_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b) {
-    return elementwise_operation(result, a, b, '*');
-}
+#include "array.h"
+#include "memory.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Release callback for buffers taken from an allocator; ctx is the allocator.
+// Large blocks go to the calling thread's buffer cache for the next allocation.
+static void release_to_allocator(void *data, size_t nbytes, void *ctx) {
+    array_cache_free((const ArrayAllocator*)ctx, data, nbytes);
+}
+
+// Helper function to wrap memory in a buffer holding one reference
+static ArrayBuffer* buffer_create(void *data, size_t nbytes, ArrayReleaseFn release, void *ctx) {
+    ArrayBuffer *buffer = (ArrayBuffer*)malloc(sizeof(ArrayBuffer));
+    if (!buffer) return NULL;
+    buffer->data = data;
+    buffer->nbytes = nbytes;
+    buffer->refcount = 1;
+    buffer->release = release;
+    buffer->release_ctx = ctx;
+    buffer->write_shared = 0;
+    return buffer;
+}
+
+// Helper function to take a buffer of at least nbytes from the current allocator
+// through the buffer cache; nbytes records the size of the block actually returned
+static ArrayBuffer* allocate_buffer(size_t nbytes, int zero) {
+    const ArrayAllocator *allocator = array_get_allocator();
+    void *data = array_cache_alloc(allocator, &nbytes, zero);
+    if (!data) return NULL;
+    ArrayBuffer *buffer = buffer_create(data, nbytes, release_to_allocator, (void*)allocator);
+    if (!buffer) array_cache_free(allocator, data, nbytes);
+    return buffer;
+}
+
+static void buffer_retain(ArrayBuffer *buffer) {
+    __atomic_fetch_add(&buffer->refcount, 1, __ATOMIC_RELAXED);
+}
+
+// The last handle to let go releases the memory; acquire-release ordering makes
+// every write made through the other handles visible to the release callback
+static void buffer_release(ArrayBuffer *buffer) {
+    if (__atomic_sub_fetch(&buffer->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        if (buffer->release) buffer->release(buffer->data, buffer->nbytes, buffer->release_ctx);
+        free(buffer);
+    }
+}
+
+// Helper function to handle memory allocation errors
+static void free_array_memory(ArrayType *arr) {
+    if (arr) {
+        if (arr->buffer) buffer_release(arr->buffer);
+        free(arr->validity);
+        free(arr->shape);
+        free(arr->strides);
+        free(arr);
+    }
+}
+
+// Function to calculate strides
+void calculate_strides(const int *shape, int ndim, int *strides) {
+    if (ndim <= 0) return;
+    strides[ndim - 1] = 1;
+    for (int i = ndim - 2; i >= 0; i--) {
+        strides[i] = strides[i + 1] * shape[i + 1];
+    }
+}
+
+// Function to create a new array
+ArrayType* create_array(const int *shape, int ndim, ArrayError *error) {
+    return create_array_dtype(shape, ndim, ARRAY_DTYPE_FLOAT32, error);
+}
+
+// Helper function to get the size of one element of a dtype in bytes, 0 if unknown
+static size_t dtype_itemsize(ArrayDType dtype) {
+    switch (dtype) {
+        case ARRAY_DTYPE_FLOAT32: return sizeof(float);
+        case ARRAY_DTYPE_COMPLEX64: return 2 * sizeof(float);
+        case ARRAY_DTYPE_INT8: return sizeof(int8_t);
+        case ARRAY_DTYPE_UINT8: return sizeof(uint8_t);
+    }
+    return 0;
+}
+
+// Helper function to create an array handle with no storage attached yet
+static ArrayType* create_handle(const int *shape, int ndim, ArrayDType dtype, ArrayError *error) {
+    if (dtype_itemsize(dtype) == 0) {
+        if (error) *error = ARRAY_ERROR_INVALID_DTYPE;
+        return NULL;
+    }
+    if (ndim < 0 || ndim > ARRAY_MAX_DIMS || (shape == NULL && ndim > 0)) {
+        if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
+        return NULL;
+    }
+
+    ArrayType *arr = (ArrayType*)malloc(sizeof(ArrayType));
+    if (!arr) {
+        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        return NULL;
+    }
+
+    arr->ndim = ndim;
+    arr->data = NULL;
+    arr->buffer = NULL;
+    arr->view = 0;
+    arr->validity = NULL;
+    // 0-d arrays hold one element and keep a one-entry shape so the pointers are never NULL
+    arr->shape = (int*)calloc(ndim > 0 ? ndim : 1, sizeof(int));
+    arr->strides = (int*)calloc(ndim > 0 ? ndim : 1, sizeof(int));
+    if (!arr->shape || !arr->strides) {
+        free_array_memory(arr);
+        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        return NULL;
+    }
+
+    arr->size = 1;
+    for (int i = 0; i < ndim; i++) {
+        arr->shape[i] = shape[i];
+        arr->size *= shape[i];
+    }
+
+    arr->dtype = dtype;
+    arr->itemsize = dtype_itemsize(dtype);
+    arr->scale = 1.0f;
+    arr->zero_point = 0;
+    calculate_strides(arr->shape, ndim, arr->strides);
+
+    if (error) *error = ARRAY_SUCCESS;
+    return arr;
+}
+
+// Helper function to allocate an array, zero-filled or left uninitialized
+static ArrayType* allocate_array(const int *shape, int ndim, ArrayDType dtype, int zero, ArrayError *error) {
+    ArrayType *arr = create_handle(shape, ndim, dtype, error);
+    if (!arr) return NULL;
+
+    arr->buffer = allocate_buffer(arr->size * arr->itemsize, zero);
+    if (!arr->buffer) {
+        free_array_memory(arr);
+        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        return NULL;
+    }
+    arr->data = (float*)arr->buffer->data;
+    return arr;
+}
+
+// Function to create a new array with a given element type
+ArrayType* create_array_dtype(const int *shape, int ndim, ArrayDType dtype, ArrayError *error) {
+    return allocate_array(shape, ndim, dtype, 1, error);
+}
+
+// Function to create a new array without initializing its elements
+ArrayType* array_empty(const int *shape, int ndim, ArrayError *error) {
+    return allocate_array(shape, ndim, ARRAY_DTYPE_FLOAT32, 0, error);
+}
+
+// Function to create another handle on the buffer of an array
+ArrayType* array_share(const ArrayType *a, ArrayError *error) {
+    if (!a) {
+        if (error) *error = ARRAY_ERROR_NULL_POINTER;
+        return NULL;
+    }
+    ArrayType *arr = create_handle(a->shape, a->ndim, a->dtype, error);
+    if (!arr) return NULL;
+
+    memcpy(arr->strides, a->strides, a->ndim * sizeof(int));
+    arr->size = a->size;
+    arr->view = a->view;
+    arr->scale = a->scale;
+    arr->zero_point = a->zero_point;
+    if (a->validity) {
+        size_t nbytes = (a->size + 63) / 64 * sizeof(uint64_t);
+        arr->validity = (uint64_t*)malloc(nbytes);
+        if (!arr->validity) {
+            free_array_memory(arr);
+            if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+            return NULL;
+        }
+        memcpy(arr->validity, a->validity, nbytes);
+    }
+    arr->data = a->data;
+    arr->buffer = a->buffer;
+    if (arr->buffer) buffer_retain(arr->buffer);
+    return arr;
+}
+
+// Function to create an array over caller-provided memory
+ArrayType* array_wrap(float *data, const int *shape, int ndim, ArrayReleaseFn release, void *ctx, ArrayError *error) {
+    return array_wrap_dtype(data, shape, ndim, ARRAY_DTYPE_FLOAT32, release, ctx, error);
+}
+
+// Function to create an array of a given dtype over existing memory
+ArrayType* array_wrap_dtype(float *data, const int *shape, int ndim, ArrayDType dtype,
+                            ArrayReleaseFn release, void *ctx, ArrayError *error) {
+    if (!data) {
+        if (error) *error = ARRAY_ERROR_NULL_POINTER;
+        return NULL;
+    }
+    ArrayType *arr = create_handle(shape, ndim, dtype, error);
+    if (!arr) return NULL;
+
+    arr->buffer = buffer_create(data, arr->size * arr->itemsize, release, ctx);
+    if (!arr->buffer) {
+        free_array_memory(arr);
+        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        return NULL;
+    }
+    arr->data = data;
+    return arr;
+}
+
+// Function to give an array a private copy of a shared buffer before it is written
+ArrayError array_make_writable(ArrayType *arr) {
+    if (!arr) return ARRAY_ERROR_NULL_POINTER;
+    if (arr->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (!arr->buffer || arr->buffer->write_shared) return ARRAY_SUCCESS;
+    if (__atomic_load_n(&arr->buffer->refcount, __ATOMIC_ACQUIRE) == 1) return ARRAY_SUCCESS;
+
+    ArrayBuffer *buffer = allocate_buffer(arr->size * arr->itemsize, 0);
+    if (!buffer) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    memcpy(buffer->data, arr->data, arr->size * arr->itemsize);
+    buffer_release(arr->buffer);
+    arr->buffer = buffer;
+    arr->data = (float*)buffer->data;
+    return ARRAY_SUCCESS;
+}
+
+// Function to free an array
+void free_array(ArrayType *arr) {
+    free_array_memory(arr);
+}
+
+// Helper function to check whether an array already has the given shape
+static int shape_matches(const ArrayType *arr, const int *shape, int ndim) {
+    if (arr->ndim != ndim) return 0;
+    for (int i = 0; i < ndim; i++) {
+        if (arr->shape[i] != shape[i]) return 0;
+    }
+    return 1;
+}
+
+// Helper function to give an unshared result a new shape in place by resizing its
+// buffer with the allocator's realloc. Returns 0 when the array has to be recreated.
+static int resize_result(ArrayType *arr, const int *shape, int ndim, ArrayDType dtype) {
+    ArrayBuffer *buffer = arr->buffer;
+    const ArrayAllocator *allocator = array_get_allocator();
+    if (arr->view || arr->dtype != dtype || arr->ndim != ndim || !buffer) return 0;
+    if (buffer->release != release_to_allocator || buffer->release_ctx != (const void*)allocator) return 0;
+    if (!allocator->realloc || __atomic_load_n(&buffer->refcount, __ATOMIC_ACQUIRE) != 1) return 0;
+
+    size_t size = 1;
+    for (int i = 0; i < ndim; i++) size *= shape[i];
+    size_t nbytes = size * arr->itemsize;
+    void *data = allocator->realloc(buffer->data, buffer->nbytes, nbytes, allocator->alignment, allocator->ctx);
+    if (!data) return 0;
+
+    buffer->data = data;
+    buffer->nbytes = nbytes;
+    arr->data = (float*)data;
+    arr->size = size;
+    memcpy(arr->shape, shape, ndim * sizeof(int));
+    calculate_strides(arr->shape, ndim, arr->strides);
+    return 1;
+}
+
+// Function to (re)create a result array unless it already has the right shape
+ArrayError prepare_result(ArrayType **result, const int *shape, int ndim) {
+    return prepare_result_dtype(result, shape, ndim, ARRAY_DTYPE_FLOAT32);
+}
+
+// Function to (re)create a result array unless it already has the right shape and type
+ArrayError prepare_result_dtype(ArrayType **result, const int *shape, int ndim, ArrayDType dtype) {
+    if (*result) {
+        free((*result)->validity);
+        (*result)->validity = NULL;
+    }
+    if (*result && !(*result)->view && (*result)->dtype == dtype && shape_matches(*result, shape, ndim)) {
+        return array_make_writable(*result);
+    }
+    if (*result && resize_result(*result, shape, ndim, dtype)) return ARRAY_SUCCESS;
+
+    ArrayError error;
+    free_array(*result);
+    *result = create_array_dtype(shape, ndim, dtype, &error);
+    return *result ? ARRAY_SUCCESS : error;
+}
+
+// Helper function to combine the validity bitmaps of operands broadcast to a result
+// shape. Operands with the result's shape are merged with a bitwise AND one 64-bit
+// word at a time; broadcast operands fall back to looking up each element's source
+// bit. *validity stays NULL when every operand is fully valid.
+static ArrayError combine_validity(uint64_t **validity, const int *shape, int ndim,
+                                   const ArrayType *const *ops, int nops) {
+    *validity = NULL;
+    int masked = 0;
+    for (int k = 0; k < nops; k++) masked |= ops[k]->validity != NULL;
+    if (!masked) return ARRAY_SUCCESS;
+
+    size_t size = 1;
+    for (int d = 0; d < ndim; d++) size *= shape[d];
+    size_t nwords = (size + 63) / 64;
+    uint64_t *bits = (uint64_t*)malloc((nwords ? nwords : 1) * sizeof(uint64_t));
+    if (!bits) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    memset(bits, 0xff, nwords * sizeof(uint64_t));
+
+    for (int k = 0; k < nops; k++) {
+        const ArrayType *op = ops[k];
+        const uint64_t *v = op->validity;
+        if (!v) continue;
+        if (!op->view && shape_matches(op, shape, ndim)) {
+            ARRAY_OMP_SIMD
+            for (size_t w = 0; w < nwords; w++) bits[w] &= v[w];
+            continue;
+        }
+
+        int index[ARRAY_MAX_DIMS] = {0};
+        int lead = ndim - op->ndim;
+        for (size_t i = 0; i < size; i++) {
+            size_t src = 0, stride = 1;
+            for (int d = op->ndim - 1; d >= 0; d--) {
+                if (op->shape[d] != 1) src += (size_t)index[d + lead] * stride;
+                stride *= (size_t)op->shape[d];
+            }
+            if (!((v[src / 64] >> (src % 64)) & 1)) bits[i / 64] &= ~((uint64_t)1 << (i % 64));
+            for (int d = ndim - 1; d >= 0 && ++index[d] == shape[d]; d--) index[d] = 0;
+        }
+    }
+
+    *validity = bits;
+    return ARRAY_SUCCESS;
+}
+
+static int deterministic_mode = 0;
+
+// Function to turn deterministic mode on or off
+void array_set_deterministic(int enabled) {
+    deterministic_mode = enabled != 0;
+}
+
+// Function to query deterministic mode
+int array_get_deterministic(void) {
+    return deterministic_mode;
+}
+
+// Function to map a possibly negative axis onto [0, ndim)
+int normalize_axis(int axis, int ndim) {
+    if (axis < 0) axis += ndim;
+    return (axis < 0 || axis >= ndim) ? -1 : axis;
+}
+
+// Helper function to compute the shape operands broadcast to, as NumPy does: shapes
+// are aligned from the right, missing leading axes count as length 1, and along every
+// axis the operands may only disagree with a length of 1. Returns 0 when they cannot.
+static int broadcast_shape(const ArrayType *const *ops, int nops, int *shape, int *ndim) {
+    int n = 0;
+    for (int k = 0; k < nops; k++) {
+        if (ops[k]->ndim > n) n = ops[k]->ndim;
+    }
+    if (n > ARRAY_MAX_DIMS) return 0;
+
+    for (int d = 0; d < n; d++) {
+        shape[d] = 1;
+        for (int k = 0; k < nops; k++) {
+            int axis = d - (n - ops[k]->ndim);
+            if (axis < 0 || ops[k]->shape[axis] == 1) continue;
+            if (shape[d] != 1 && shape[d] != ops[k]->shape[axis]) return 0;
+            shape[d] = ops[k]->shape[axis];
+        }
+    }
+    *ndim = n;
+    return 1;
+}
+
+// Function to compare shapes and determine the broadcast shape
+ShapeInfo* compare_shapes(const ArrayType *a, const ArrayType *b) {
+    const ArrayType *ops[] = {a, b};
+    int broadcast[ARRAY_MAX_DIMS];
+    int ndim;
+    if (!broadcast_shape(ops, 2, broadcast, &ndim)) {
+        return NULL;  // Shapes are not compatible for broadcasting
+    }
+
+    int *shape = (int*)malloc((ndim > 0 ? ndim : 1) * sizeof(int));
+    ShapeInfo *info = (ShapeInfo*)malloc(sizeof(ShapeInfo));
+    if (!shape || !info) {
+        free(shape);
+        free(info);
+        return NULL;
+    }
+    memcpy(shape, broadcast, ndim * sizeof(int));
+    info->ndim = ndim;
+    info->shape = shape;
+    return info;
+}
+
+// Function to calculate the linear index from multidimensional indices
+size_t calculate_index(const int *indices, const int *shape, const int *strides, int ndim) {
+    size_t index = 0;
+    for (int i = 0; i < ndim; i++) {
+        index += indices[i] * strides[i];
+    }
+    return index;
+}
+
+// Kernel applied by batched_operation to one block of a pair
+typedef void (*BatchKernel)(float *out, const float *a, const float *b, size_t n);
+
+static void batch_add_kernel(float *out, const float *a, const float *b, size_t n) {
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+}
+
+static void batch_multiply_kernel(float *out, const float *a, const float *b, size_t n) {
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+}
+
+static int same_shape(const ArrayType *a, const ArrayType *b) {
+    if (a->ndim != b->ndim) return 0;
+    for (int i = 0; i < a->ndim; i++) {
+        if (a->shape[i] != b->shape[i]) return 0;
+    }
+    return 1;
+}
+
+// Helper function for batched element-wise operations. Pairs are validated and their
+// results prepared serially; offsets[i] is the first global block of pair i, so each
+// thread finds the start of its range by binary search and then walks pairs in order.
+static ArrayError batched_operation(ArrayType **results, const ArrayType *const *a, const ArrayType *const *b,
+                                    int count, char op) {
+    if (!results || !a || !b) return ARRAY_ERROR_NULL_POINTER;
+    if (count <= 0) return count == 0 ? ARRAY_SUCCESS : ARRAY_ERROR_INVALID_ARGUMENT;
+
+    size_t *offsets = (size_t*)malloc(((size_t)count + 1) * sizeof(size_t));
+    if (!offsets) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+    ArrayError error = ARRAY_SUCCESS;
+    size_t total = 0;
+    offsets[0] = 0;
+    for (int i = 0; i < count; i++) {
+        size_t blocks = 0;
+        if (!a[i] || !b[i]) {
+            error = ARRAY_ERROR_NULL_POINTER;
+        } else if (a[i]->view || b[i]->view || !same_shape(a[i], b[i])) {
+            error = op == '+' ? add_arrays(&results[i], a[i], b[i]) : multiply_arrays(&results[i], a[i], b[i]);
+        } else if (a[i]->dtype != ARRAY_DTYPE_FLOAT32 || b[i]->dtype != ARRAY_DTYPE_FLOAT32) {
+            error = ARRAY_ERROR_INVALID_DTYPE;
+        } else {
+            const ArrayType *pair[] = {a[i], b[i]};
+            uint64_t *validity;
+            error = combine_validity(&validity, a[i]->shape, a[i]->ndim, pair, 2);
+            if (error == ARRAY_SUCCESS) error = prepare_result(&results[i], a[i]->shape, a[i]->ndim);
+            if (error == ARRAY_SUCCESS) {
+                results[i]->validity = validity;
+            } else {
+                free(validity);
+            }
+            blocks = (a[i]->size + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+            total += a[i]->size;
+        }
+        if (error != ARRAY_SUCCESS) {
+            free(offsets);
+            return error;
+        }
+        offsets[i + 1] = offsets[i] + blocks;
+    }
+
+    BatchKernel kernel = op == '+' ? batch_add_kernel : batch_multiply_kernel;
+    size_t nblocks = offsets[count];
+
+#ifdef _OPENMP
+    #pragma omp parallel if (total >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    {
+        size_t tid = 0, nthreads = 1;
+#ifdef _OPENMP
+        tid = (size_t)omp_get_thread_num();
+        nthreads = (size_t)omp_get_num_threads();
+#endif
+        size_t first = nblocks * tid / nthreads, last = nblocks * (tid + 1) / nthreads;
+
+        // Last pair whose first block is at or before the start of the range
+        int lo = 0, hi = count - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo + 1) / 2;
+            if (offsets[mid] <= first) lo = mid; else hi = mid - 1;
+        }
+
+        for (size_t blk = first, p = (size_t)lo; blk < last; blk++) {
+            while (offsets[p + 1] <= blk) p++;
+            size_t start = (blk - offsets[p]) * ARRAY_BLOCK_SIZE;
+            size_t n = a[p]->size;
+            size_t len = (n - start < ARRAY_BLOCK_SIZE) ? n - start : ARRAY_BLOCK_SIZE;
+            kernel(results[p]->data + start, a[p]->data + start, b[p]->data + start, len);
+        }
+    }
+
+    free(offsets);
+    return ARRAY_SUCCESS;
+}
+
+// Function to add many pairs of arrays in one parallel region
+ArrayError add_arrays_batched(ArrayType **results, const ArrayType *const *a, const ArrayType *const *b, int count) {
+    return batched_operation(results, a, b, count, '+');
+}
+
+// Function to multiply many pairs of arrays in one parallel region
+ArrayError multiply_arrays_batched(ArrayType **results, const ArrayType *const *a, const ArrayType *const *b, int count) {
+    return batched_operation(results, a, b, count, '*');
+}
+
+// Function to apply a kernel element-wise, one block per loop iteration
+ArrayError unary_operation(ArrayType **result, const ArrayType *a, UnaryKernel kernel, const void *ctx) {
+    if (!result || !a || !kernel) {
+        return ARRAY_ERROR_NULL_POINTER;
+    }
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) {
+        return ARRAY_ERROR_INVALID_DTYPE;
+    }
+    if (a->view) {
+        return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint64_t *validity;
+    ArrayError error = combine_validity(&validity, a->shape, a->ndim, &a, 1);
+    if (error == ARRAY_SUCCESS) error = prepare_result(result, a->shape, a->ndim);
+    if (error != ARRAY_SUCCESS) {
+        free(validity);
+        return error;
+    }
+    (*result)->validity = validity;
+
+    float *out = (*result)->data;
+    const float *in = a->data;
+    size_t n = a->size;
+    size_t nblocks = (n + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t start = blk * ARRAY_BLOCK_SIZE;
+        size_t len = (n - start < ARRAY_BLOCK_SIZE) ? n - start : ARRAY_BLOCK_SIZE;
+        kernel(out + start, in + start, len, ctx);
+    }
+
+    return ARRAY_SUCCESS;
+}
+
+// Maximum number of input operands handled by broadcast_apply
+#define ARRAY_MAX_OPERANDS 4
+
+// Kernel applied by broadcast_apply to one contiguous run of output elements.
+// Input k is read at in[k][i * strides[k]], where a stride of 0 is a broadcast axis.
+typedef void (*ElementwiseKernel)(float *out, const float *const *in, const ptrdiff_t *strides,
+                                  size_t n, const void *ctx);
+
+// Helper function to apply a kernel over operands broadcast against each other.
+// Shapes are aligned from the right, broadcast axes get stride 0, and adjacent axes
+// that are contiguous in every operand are merged so the kernel sees the longest
+// possible runs. Work is split into blocks of at most ARRAY_BLOCK_SIZE elements.
+static ArrayError broadcast_apply(ArrayType **result, const ArrayType *const *ops, int nops,
+                                  ElementwiseKernel kernel, const void *ctx) {
+    if (!result) return ARRAY_ERROR_NULL_POINTER;
+
+    for (int k = 0; k < nops; k++) {
+        if (!ops[k] || !ops[k]->data) return ARRAY_ERROR_NULL_POINTER;
+        if (ops[k]->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    }
+
+    // Checked up front, so the loops below never wrap an index back into an operand
+    int shape[ARRAY_MAX_DIMS];
+    int ndim;
+    if (!broadcast_shape(ops, nops, shape, &ndim)) {
+        return ARRAY_ERROR_INVALID_DIMENSION;  // Shapes are not compatible for broadcasting
+    }
+
+    // A result that is also an operand is written in place only when it already has the
+    // broadcast shape; otherwise a new array replaces it once the operation has read it
+    int replace = 0;
+    for (int k = 0; k < nops; k++) {
+        if (ops[k] == *result && ((*result)->view || !shape_matches(*result, shape, ndim))) replace = 1;
+    }
+    ArrayType *target = replace ? NULL : *result;
+
+    uint64_t *validity;
+    ArrayError error = combine_validity(&validity, shape, ndim, ops, nops);
+    if (error == ARRAY_SUCCESS) error = prepare_result(&target, shape, ndim);
+    if (error != ARRAY_SUCCESS) {
+        if (!replace) *result = target;
+        free(validity);
+        return error;
+    }
+    target->validity = validity;
+
+    // Collapse the iteration space, dropping length-1 axes and merging contiguous ones
+    int run_shape[ARRAY_MAX_DIMS];
+    ptrdiff_t run_strides[ARRAY_MAX_OPERANDS][ARRAY_MAX_DIMS];
+    int nruns = 0;
+    for (int d = 0; d < ndim; d++) {
+        if (shape[d] == 1) continue;
+        ptrdiff_t strides[ARRAY_MAX_OPERANDS];
+        int mergeable = nruns > 0;
+        for (int k = 0; k < nops; k++) {
+            int axis = d - (ndim - ops[k]->ndim);
+            strides[k] = (axis < 0 || ops[k]->shape[axis] == 1) ? 0 : ops[k]->strides[axis];
+            if (nruns > 0 && run_strides[k][nruns - 1] != strides[k] * shape[d]) mergeable = 0;
+        }
+        if (mergeable) {
+            run_shape[nruns - 1] *= shape[d];
+        } else {
+            run_shape[nruns++] = shape[d];
+        }
+        for (int k = 0; k < nops; k++) run_strides[k][nruns - 1] = strides[k];
+    }
+    if (nruns == 0) {
+        run_shape[nruns++] = 1;
+        for (int k = 0; k < nops; k++) run_strides[k][0] = 0;
+    }
+
+    size_t inner = (size_t)run_shape[nruns - 1];
+    size_t blocks_per_row = (inner + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+    size_t nblocks = inner ? (target->size / inner) * blocks_per_row : 0;
+    float *out = target->data;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (target->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t row = blk / blocks_per_row;
+        size_t start = (blk % blocks_per_row) * ARRAY_BLOCK_SIZE;
+        size_t len = (inner - start < ARRAY_BLOCK_SIZE) ? inner - start : ARRAY_BLOCK_SIZE;
+
+        const float *in[ARRAY_MAX_OPERANDS];
+        ptrdiff_t inner_strides[ARRAY_MAX_OPERANDS];
+        for (int k = 0; k < nops; k++) {
+            ptrdiff_t offset = (ptrdiff_t)start * run_strides[k][nruns - 1];
+            size_t rem = row;
+            for (int d = nruns - 2; d >= 0; d--) {
+                offset += (ptrdiff_t)(rem % run_shape[d]) * run_strides[k][d];
+                rem /= run_shape[d];
+            }
+            in[k] = ops[k]->data + offset;
+            inner_strides[k] = run_strides[k][nruns - 1];
+        }
+        kernel(out + row * inner + start, in, inner_strides, len, ctx);
+    }
+
+    if (replace) free_array(*result);
+    *result = target;
+    return ARRAY_SUCCESS;
+}
+
+// Kernels for add_arrays and multiply_arrays, with vectorized loops for contiguous
+// runs and for runs where one operand is broadcast (stride 0)
+static void add_kernel(float *out, const float *const *in, const ptrdiff_t *strides, size_t n, const void *ctx) {
+    (void)ctx;
+    const float *a = in[0];
+    const float *b = in[1];
+    if (strides[0] == 1 && strides[1] == 1) {
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+    } else if (strides[0] == 1 && strides[1] == 0) {
+        float y = b[0];
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = a[i] + y;
+    } else if (strides[0] == 0 && strides[1] == 1) {
+        float x = a[0];
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = x + b[i];
+    } else {
+        for (size_t i = 0; i < n; i++) out[i] = a[i * strides[0]] + b[i * strides[1]];
+    }
+}
+
+static void multiply_kernel(float *out, const float *const *in, const ptrdiff_t *strides, size_t n, const void *ctx) {
+    (void)ctx;
+    const float *a = in[0];
+    const float *b = in[1];
+    if (strides[0] == 1 && strides[1] == 1) {
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+    } else if (strides[0] == 1 && strides[1] == 0) {
+        float y = b[0];
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = a[i] * y;
+    } else if (strides[0] == 0 && strides[1] == 1) {
+        float x = a[0];
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = x * b[i];
+    } else {
+        for (size_t i = 0; i < n; i++) out[i] = a[i * strides[0]] * b[i * strides[1]];
+    }
+}
+
+// Helper function for element-wise operations with broadcasting
+ArrayError elementwise_operation(ArrayType **result, const ArrayType *a, const ArrayType *b, char op) {
+    const ArrayType *ops[] = {a, b};
+    switch (op) {
+        case '+':
+            return broadcast_apply(result, ops, 2, add_kernel, NULL);
+        case '*':
+            return broadcast_apply(result, ops, 2, multiply_kernel, NULL);
+        default:
+            return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+// Function to add arrays element-wise with broadcasting
+ArrayError add_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b) {
+    return elementwise_operation(result, a, b, '+');
+}
+
+// Function to multiply arrays element-wise with broadcasting
+ArrayError multiply_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b) {
+    return elementwise_operation(result, a, b, '*');
+}
+
+// Function to create a read-only view of an array broadcast to a larger shape
+ArrayError array_broadcast_to(ArrayType **view, const ArrayType *a, const int *shape, int ndim) {
+    if (!view || !a || (!shape && ndim > 0)) return ARRAY_ERROR_NULL_POINTER;
+    if (ndim < a->ndim || ndim > ARRAY_MAX_DIMS) return ARRAY_ERROR_INVALID_DIMENSION;
+    for (int d = 0; d < ndim; d++) {
+        int axis = d - (ndim - a->ndim);
+        if (shape[d] < 0 || (axis >= 0 && a->shape[axis] != 1 && a->shape[axis] != shape[d])) {
+            return ARRAY_ERROR_INVALID_DIMENSION;
+        }
+    }
+
+    // The view is a second handle on the buffer of a; broadcast axes get stride 0
+    ArrayError error;
+    ArrayType *v = array_share(a, &error);
+    if (!v) return error;
+    free(v->validity);
+    v->validity = NULL;
+    int *new_shape = (int*)realloc(v->shape, (ndim > 0 ? ndim : 1) * sizeof(int));
+    if (new_shape) v->shape = new_shape;
+    int *new_strides = (int*)realloc(v->strides, (ndim > 0 ? ndim : 1) * sizeof(int));
+    if (new_strides) v->strides = new_strides;
+    if (!new_shape || !new_strides) {
+        free_array(v);
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+    v->size = 1;
+    for (int d = ndim - 1; d >= 0; d--) {
+        int axis = d - (ndim - a->ndim);
+        new_shape[d] = shape[d];
+        new_strides[d] = (axis < 0 || a->shape[axis] != shape[d]) ? 0 : a->strides[axis];
+        v->size *= shape[d];
+    }
+    v->ndim = ndim;
+    v->view = 1;
+
+    free_array(*view);
+    *view = v;
+    return ARRAY_SUCCESS;
+}
+
+// Fused multiply-add over contiguous runs. On x86 a copy compiled for FMA3 is selected at
+// run time so the loop vectorizes to hardware fused multiply-adds; elsewhere fmaf is used.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARRAY_FMA_DISPATCH 1
+__attribute__((target("avx2,fma")))
+static void fma_contiguous_hw(float *out, const float *a, const float *b, const float *c, size_t n) {
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = fmaf(a[i], b[i], c[i]);
+}
+
+__attribute__((target("avx2,fma")))
+static void axpy_contiguous_hw(float *out, float alpha, const float *x, const float *y, size_t n) {
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = fmaf(alpha, x[i], y[i]);
+}
+#endif
+
+static void fma_contiguous(float *out, const float *a, const float *b, const float *c, size_t n) {
+#ifdef ARRAY_FMA_DISPATCH
+    if (__builtin_cpu_supports("fma")) {
+        fma_contiguous_hw(out, a, b, c, n);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) out[i] = fmaf(a[i], b[i], c[i]);
+}
+
+static void axpy_contiguous(float *out, float alpha, const float *x, const float *y, size_t n) {
+#ifdef ARRAY_FMA_DISPATCH
+    if (__builtin_cpu_supports("fma")) {
+        axpy_contiguous_hw(out, alpha, x, y, n);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) out[i] = fmaf(alpha, x[i], y[i]);
+}
+
+static void fma_kernel(float *out, const float *const *in, const ptrdiff_t *strides, size_t n, const void *ctx) {
+    (void)ctx;
+    if (strides[0] == 1 && strides[1] == 1 && strides[2] == 1) {
+        fma_contiguous(out, in[0], in[1], in[2], n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = fmaf(in[0][i * strides[0]], in[1][i * strides[1]], in[2][i * strides[2]]);
+    }
+}
+
+static void axpy_kernel(float *out, const float *const *in, const ptrdiff_t *strides, size_t n, const void *ctx) {
+    float alpha = *(const float *)ctx;
+    const float *x = in[0];
+    const float *y = in[1];
+    if (strides[0] == 1 && strides[1] == 1) {
+        axpy_contiguous(out, alpha, x, y, n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) out[i] = fmaf(alpha, x[i * strides[0]], y[i * strides[1]]);
+}
+
+static void where_kernel(float *out, const float *const *in, const ptrdiff_t *strides, size_t n, const void *ctx) {
+    (void)ctx;
+    const float *cond = in[0];
+    const float *x = in[1];
+    const float *y = in[2];
+    if (strides[0] == 1 && strides[1] == 1 && strides[2] == 1) {
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = cond[i] != 0.0f ? x[i] : y[i];
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = cond[i * strides[0]] != 0.0f ? x[i * strides[1]] : y[i * strides[2]];
+    }
+}
+
+static void copy_kernel(float *out, const float *const *in, const ptrdiff_t *strides, size_t n, const void *ctx) {
+    (void)ctx;
+    const float *src = in[0];
+    if (strides[0] == 1) {
+        memcpy(out, src, n * sizeof(float));
+        return;
+    }
+    for (size_t i = 0; i < n; i++) out[i] = src[i * strides[0]];
+}
+
+typedef struct {
+    float lo;
+    float hi;
+} ClipBounds;
+
+static void clip_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    const ClipBounds *bounds = (const ClipBounds *)ctx;
+    float lo = bounds->lo;
+    float hi = bounds->hi;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) {
+        float x = in[i];
+        x = x < lo ? lo : x;
+        out[i] = x > hi ? hi : x;
+    }
+}
+
+// Function to compute a * b + c element-wise with broadcasting
+ArrayError fma_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b, const ArrayType *c) {
+    const ArrayType *ops[] = {a, b, c};
+    return broadcast_apply(result, ops, 3, fma_kernel, NULL);
+}
+
+// Function to compute alpha * x + y element-wise with broadcasting
+ArrayError axpy_arrays(ArrayType **result, float alpha, const ArrayType *x, const ArrayType *y) {
+    const ArrayType *ops[] = {x, y};
+    return broadcast_apply(result, ops, 2, axpy_kernel, &alpha);
+}
+
+// Function to select elements from x or y depending on cond, with broadcasting
+ArrayError where_arrays(ArrayType **result, const ArrayType *cond, const ArrayType *x, const ArrayType *y) {
+    const ArrayType *ops[] = {cond, x, y};
+    return broadcast_apply(result, ops, 3, where_kernel, NULL);
+}
+
+// Function to copy an array or view into a contiguous array
+ArrayError array_copy(ArrayType **result, const ArrayType *a) {
+    const ArrayType *ops[] = {a};
+    if (result && *result == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    return broadcast_apply(result, ops, 1, copy_kernel, NULL);
+}
+
+// Function to limit the values of an array to [lo, hi]
+ArrayError clip_array(ArrayType **result, const ArrayType *a, float lo, float hi) {
+    ClipBounds bounds = {lo, hi};
+    return unary_operation(result, a, clip_kernel, &bounds);
+}
@@ -0,0 +1,537 @@
+#include "convolve.h"
+#include "gemm.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Filters with at most this many taps are applied directly; larger 2-D filters use sgemm
+#define CONV_DIRECT_MAX_TAPS 25
+
+// Number of outputs accumulated in registers at a time by the direct kernel
+#define CONV_TILE 32
+
+// Largest im2col tile, in elements, unfolded by a thread before calling sgemm
+#define CONV_IM2COL_MAX (1 << 16)
+
+// Number of adjacent lines whose window sums are updated together
+#define CONV_LANES 64
+
+// Geometry of the lines along an axis: element k of line (o, i) is at
+// (o * len + k) * inner + i
+typedef struct {
+    size_t outer;
+    size_t len;
+    size_t inner;
+} ConvGeometry;
+
+static ConvGeometry conv_geometry(const ArrayType *a, int axis) {
+    ConvGeometry g = {1, (size_t)a->shape[axis], 1};
+    for (int d = 0; d < axis; d++) g.outer *= a->shape[d];
+    for (int d = axis + 1; d < a->ndim; d++) g.inner *= a->shape[d];
+    return g;
+}
+
+static inline int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Helper function to size the output along one axis. lead is the number of
+// zeros that precede the input in the padded line read by the output.
+static int output_length(int n, int m, ConvolveMode mode, int *lead) {
+    switch (mode) {
+        case CONVOLVE_FULL:
+            *lead = m - 1;
+            return n + m - 1;
+        case CONVOLVE_SAME:
+            *lead = m / 2;
+            return n;
+        case CONVOLVE_VALID:
+            *lead = 0;
+            return n - m + 1;
+        default:
+            return -1;
+    }
+}
+
+// Direct correlation of nout outputs: out[o] (+)= sum_j src[o + j] * w[j]
+static void correlate_row(float *out, const float *src, size_t nout, const float *w, int m, int accumulate) {
+    if (m == 3) {
+        float w0 = w[0], w1 = w[1], w2 = w[2];
+        ARRAY_OMP_SIMD
+        for (size_t o = 0; o < nout; o++) {
+            float s = src[o] * w0 + src[o + 1] * w1 + src[o + 2] * w2;
+            out[o] = accumulate ? out[o] + s : s;
+        }
+        return;
+    }
+    if (m == 5) {
+        float w0 = w[0], w1 = w[1], w2 = w[2], w3 = w[3], w4 = w[4];
+        ARRAY_OMP_SIMD
+        for (size_t o = 0; o < nout; o++) {
+            float s = src[o] * w0 + src[o + 1] * w1 + src[o + 2] * w2 + src[o + 3] * w3 + src[o + 4] * w4;
+            out[o] = accumulate ? out[o] + s : s;
+        }
+        return;
+    }
+
+    // Register-blocked tiles: each tap is broadcast against CONV_TILE accumulators
+    size_t o = 0;
+    for (; o + CONV_TILE <= nout; o += CONV_TILE) {
+        float acc[CONV_TILE];
+        ARRAY_OMP_SIMD
+        for (int t = 0; t < CONV_TILE; t++) acc[t] = accumulate ? out[o + t] : 0.0f;
+        for (int j = 0; j < m; j++) {
+            float wj = w[j];
+            const float *s = src + o + j;
+            ARRAY_OMP_SIMD
+            for (int t = 0; t < CONV_TILE; t++) acc[t] += wj * s[t];
+        }
+        for (int t = 0; t < CONV_TILE; t++) out[o + t] = acc[t];
+    }
+    for (; o < nout; o++) {
+        float s = accumulate ? out[o] : 0.0f;
+        for (int j = 0; j < m; j++) s += src[o + j] * w[j];
+        out[o] = s;
+    }
+}
+
+// Direct 3x3 correlation of one output row from three consecutive padded rows
+static void correlate_row_3x3(float *out, const float *r0, const float *r1, const float *r2,
+                              size_t nout, const float *w) {
+    float w00 = w[0], w01 = w[1], w02 = w[2];
+    float w10 = w[3], w11 = w[4], w12 = w[5];
+    float w20 = w[6], w21 = w[7], w22 = w[8];
+    ARRAY_OMP_SIMD
+    for (size_t x = 0; x < nout; x++) {
+        out[x] = r0[x] * w00 + r0[x + 1] * w01 + r0[x + 2] * w02
+               + r1[x] * w10 + r1[x + 1] * w11 + r1[x + 2] * w12
+               + r2[x] * w20 + r2[x + 1] * w21 + r2[x + 2] * w22;
+    }
+}
+
+// Helper function to correlate every line along an axis with a kernel of m taps
+static ArrayError correlate_lines(float *out, const float *in, const ConvGeometry *g, size_t nout,
+                                  int lead, const float *w, int m) {
+    size_t n = g->len, inner = g->inner;
+    int parallel = g->outer * nout * inner * (size_t)m >= ARRAY_PARALLEL_THRESHOLD;
+
+    if (inner > 1) {
+        // Outer axis: whole output rows are accumulated, vectorized over the inner axes
+        size_t ntasks = g->outer * nout;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (parallel)
+#endif
+        for (size_t t = 0; t < ntasks; t++) {
+            size_t row = t / nout, o = t % nout;
+            float *dst = out + t * inner;
+            memset(dst, 0, inner * sizeof(float));
+            for (int j = 0; j < m; j++) {
+                ptrdiff_t k = (ptrdiff_t)o - lead + j;
+                if (k < 0 || (size_t)k >= n) continue;
+                const float *src = in + (row * n + (size_t)k) * inner;
+                float wj = w[j];
+                ARRAY_OMP_SIMD
+                for (size_t i = 0; i < inner; i++) dst[i] += wj * src[i];
+            }
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    // Last axis: blocks of outputs, reading the input in place unless a block overlaps the padding
+    size_t span = ARRAY_BLOCK_SIZE + (size_t)m - 1;
+    size_t nblocks = (nout + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+    size_t ntasks = g->outer * nblocks;
+    int nthreads = parallel ? thread_count() : 1;
+    float *buffers = (float*)malloc((size_t)nthreads * span * sizeof(float));
+    if (!buffers) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads) if (parallel)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        float *mine = buffers + (size_t)tid * span;
+
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (size_t t = 0; t < ntasks; t++) {
+            size_t row = t / nblocks;
+            size_t o0 = (t % nblocks) * ARRAY_BLOCK_SIZE;
+            size_t len = (nout - o0 < ARRAY_BLOCK_SIZE) ? nout - o0 : ARRAY_BLOCK_SIZE;
+            size_t need = len + (size_t)m - 1;
+            const float *line = in + row * n;
+            ptrdiff_t first = (ptrdiff_t)o0 - lead;
+
+            // Windows that overhang the row are copied with zero padding; a pointer
+            // before or past the row is never formed
+            const float *src = mine;
+            if (first >= 0 && (size_t)first + need <= n) {
+                src = line + first;
+            } else {
+                for (size_t q = 0; q < need; q++) {
+                    ptrdiff_t k = first + (ptrdiff_t)q;
+                    mine[q] = (k >= 0 && (size_t)k < n) ? line[k] : 0.0f;
+                }
+            }
+            correlate_row(out + row * nout + o0, src, len, w, m, 0);
+        }
+    }
+
+    free(buffers);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function shared by convolve1d_array and correlate1d_array
+static ArrayError filter_1d(ArrayType **result, const ArrayType *a, const ArrayType *kernel,
+                            int axis, ConvolveMode mode, int flip) {
+    if (!result || !a || !kernel) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a || *result == kernel) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32 || kernel->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view || kernel->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0 || kernel->ndim != 1) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    int n = a->shape[axis], m = kernel->shape[0], lead;
+    int nout = output_length(n, m, mode, &lead);
+    if (n <= 0 || m <= 0 || nout <= 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    float *w = (float*)malloc((size_t)m * sizeof(float));
+    if (!w) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    for (int j = 0; j < m; j++) w[j] = kernel->data[flip ? m - 1 - j : j];
+
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(shape, a->shape, a->ndim * sizeof(int));
+    shape[axis] = nout;
+    ArrayError error = prepare_result(result, shape, a->ndim);
+    if (error == ARRAY_SUCCESS) {
+        ConvGeometry g = conv_geometry(a, axis);
+        error = correlate_lines((*result)->data, a->data, &g, (size_t)nout, lead, w, m);
+    }
+
+    free(w);
+    return error;
+}
+
+// Function to convolve lines along an axis with a 1-D kernel
+ArrayError convolve1d_array(ArrayType **result, const ArrayType *a, const ArrayType *kernel, int axis, ConvolveMode mode) {
+    return filter_1d(result, a, kernel, axis, mode, 1);
+}
+
+// Function to cross-correlate lines along an axis with a 1-D kernel
+ArrayError correlate1d_array(ArrayType **result, const ArrayType *a, const ArrayType *kernel, int axis, ConvolveMode mode) {
+    return filter_1d(result, a, kernel, axis, mode, 0);
+}
+
+// Sizes of a batched 2-D correlation; the padded images are ph x pw
+typedef struct {
+    size_t batch;
+    int nfilters;
+    int kh, kw;
+    int oh, ow;
+    int ph, pw;
+} ImageGeometry;
+
+// Helper function to apply small filters directly, one output row per task
+static void correlate_images_direct(float *out, const float *padded, const ImageGeometry *g, const float *w) {
+    size_t ntasks = g->batch * (size_t)g->nfilters * g->oh;
+    size_t taps = (size_t)g->kh * g->kw;
+    size_t plane = (size_t)g->ph * g->pw;
+    int parallel = ntasks * g->ow * taps >= ARRAY_PARALLEL_THRESHOLD;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (parallel)
+#endif
+    for (size_t t = 0; t < ntasks; t++) {
+        size_t y = t % g->oh;
+        size_t f = (t / g->oh) % g->nfilters;
+        size_t b = t / ((size_t)g->oh * g->nfilters);
+        const float *img = padded + b * plane + y * g->pw;
+        const float *wf = w + f * taps;
+        float *dst = out + t * g->ow;
+
+        if (g->kh == 3 && g->kw == 3) {
+            correlate_row_3x3(dst, img, img + g->pw, img + 2 * (size_t)g->pw, g->ow, wf);
+            continue;
+        }
+        for (int i = 0; i < g->kh; i++) {
+            correlate_row(dst, img + (size_t)i * g->pw, g->ow, wf + (size_t)i * g->kw, g->kw, i > 0);
+        }
+    }
+}
+
+// Helper function to lower large filters to sgemm: a tile of output rows is unfolded
+// into a (kh * kw) x (rows * ow) matrix and multiplied by the nfilters x (kh * kw) bank
+static ArrayError correlate_images_gemm(float *out, const float *padded, const ImageGeometry *g, const float *w) {
+    int taps = g->kh * g->kw;
+    size_t plane = (size_t)g->ph * g->pw;
+    size_t per_row = (size_t)taps * g->ow;
+    int rows = per_row < CONV_IM2COL_MAX ? (int)(CONV_IM2COL_MAX / per_row) : 1;
+    rows = rows < g->oh ? rows : g->oh;
+    size_t ntiles = (size_t)((g->oh + rows - 1) / rows);
+    size_t ntasks = g->batch * ntiles;
+
+    // A single tile leaves the parallelism to sgemm itself
+    int parallel = ntasks > 1 && ntasks * rows * per_row * g->nfilters >= ARRAY_PARALLEL_THRESHOLD;
+    int nthreads = parallel ? thread_count() : 1;
+    size_t col_size = (size_t)rows * per_row;
+    float *cols = (float*)malloc((size_t)nthreads * col_size * sizeof(float));
+    if (!cols) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    int failed = 0;
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads) if (parallel) reduction(|:failed)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        float *col = cols + (size_t)tid * col_size;
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (size_t t = 0; t < ntasks; t++) {
+            size_t b = t / ntiles;
+            int y0 = (int)(t % ntiles) * rows;
+            int nrows = (g->oh - y0 < rows) ? g->oh - y0 : rows;
+            int ncols = nrows * g->ow;
+            const float *img = padded + b * plane;
+
+            for (int i = 0; i < g->kh; i++) {
+                for (int j = 0; j < g->kw; j++) {
+                    float *dst = col + (size_t)(i * g->kw + j) * ncols;
+                    for (int r = 0; r < nrows; r++) {
+                        memcpy(dst + (size_t)r * g->ow, img + (size_t)(y0 + r + i) * g->pw + j,
+                               (size_t)g->ow * sizeof(float));
+                    }
+                }
+            }
+
+            float *c = out + (b * g->nfilters * g->oh + y0) * (size_t)g->ow;
+            failed |= sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, g->nfilters, ncols, taps, 1.0f,
+                            w, taps, col, ncols, 0.0f, c, g->oh * g->ow) != ARRAY_SUCCESS;
+        }
+    }
+
+    free(cols);
+    return failed ? ARRAY_ERROR_MEMORY_ALLOCATION : ARRAY_SUCCESS;
+}
+
+// Helper function shared by convolve2d_array and correlate2d_array
+static ArrayError filter_2d(ArrayType **result, const ArrayType *image, const ArrayType *kernel,
+                            ConvolveMode mode, int flip) {
+    if (!result || !image || !kernel) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == image || *result == kernel) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (image->dtype != ARRAY_DTYPE_FLOAT32 || kernel->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (image->view || kernel->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (image->ndim < 2 || kernel->ndim < 2 || kernel->ndim > 3) return ARRAY_ERROR_INVALID_DIMENSION;
+    int bank = kernel->ndim == 3;
+    if (bank && image->ndim + 1 > ARRAY_MAX_DIMS) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    ImageGeometry g;
+    int h = image->shape[image->ndim - 2], wd = image->shape[image->ndim - 1];
+    int leady, leadx;
+    g.nfilters = bank ? kernel->shape[0] : 1;
+    g.kh = kernel->shape[kernel->ndim - 2];
+    g.kw = kernel->shape[kernel->ndim - 1];
+    g.oh = output_length(h, g.kh, mode, &leady);
+    g.ow = output_length(wd, g.kw, mode, &leadx);
+    if (h <= 0 || wd <= 0 || g.nfilters <= 0 || g.kh <= 0 || g.kw <= 0 || g.oh <= 0 || g.ow <= 0) {
+        return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+    g.ph = g.oh + g.kh - 1;
+    g.pw = g.ow + g.kw - 1;
+    g.batch = image->size / ((size_t)h * wd);
+
+    int shape[ARRAY_MAX_DIMS];
+    int ndim = image->ndim + bank;
+    memcpy(shape, image->shape, (image->ndim - 2) * sizeof(int));
+    if (bank) shape[ndim - 3] = g.nfilters;
+    shape[ndim - 2] = g.oh;
+    shape[ndim - 1] = g.ow;
+
+    // Filters in correlation order, reversed along both axes for a convolution
+    size_t taps = (size_t)g.kh * g.kw;
+    float *w = (float*)malloc(kernel->size * sizeof(float));
+    if (!w) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    for (size_t f = 0; f < (size_t)g.nfilters; f++) {
+        for (size_t q = 0; q < taps; q++) w[f * taps + q] = kernel->data[f * taps + (flip ? taps - 1 - q : q)];
+    }
+
+    // Zero-padded copies of the images, unless the valid mode reads them in place
+    const float *padded = image->data;
+    float *copy = NULL;
+    if (leady != 0 || leadx != 0 || g.ph != h || g.pw != wd) {
+        size_t plane = (size_t)g.ph * g.pw;
+        copy = (float*)calloc(g.batch * plane, sizeof(float));
+        if (!copy) {
+            free(w);
+            return ARRAY_ERROR_MEMORY_ALLOCATION;
+        }
+        size_t nrows = g.batch * h;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (image->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t r = 0; r < nrows; r++) {
+            size_t b = r / h, y = r % h;
+            memcpy(copy + b * plane + (y + leady) * g.pw + leadx, image->data + r * wd, (size_t)wd * sizeof(float));
+        }
+        padded = copy;
+    }
+
+    ArrayError error = prepare_result(result, shape, ndim);
+    if (error == ARRAY_SUCCESS) {
+        if (taps <= CONV_DIRECT_MAX_TAPS) {
+            correlate_images_direct((*result)->data, padded, &g, w);
+        } else {
+            error = correlate_images_gemm((*result)->data, padded, &g, w);
+        }
+    }
+
+    free(copy);
+    free(w);
+    return error;
+}
+
+// Function to convolve images with a 2-D kernel or filter bank
+ArrayError convolve2d_array(ArrayType **result, const ArrayType *image, const ArrayType *kernel, ConvolveMode mode) {
+    return filter_2d(result, image, kernel, mode, 1);
+}
+
+// Function to cross-correlate images with a 2-D kernel or filter bank
+ArrayError correlate2d_array(ArrayType **result, const ArrayType *image, const ArrayType *kernel, ConvolveMode mode) {
+    return filter_2d(result, image, kernel, mode, 0);
+}
+
+// Function to create a zero-copy view of sliding windows along an axis
+ArrayError sliding_window_view(ArrayType **view, const ArrayType *a, int window, int axis) {
+    if (!view || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0 || a->ndim + 1 > ARRAY_MAX_DIMS) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (window < 1 || window > a->shape[axis]) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    // The view is a second handle on the buffer of a, with one more axis
+    ArrayError error;
+    ArrayType *v = array_share(a, &error);
+    if (!v) return error;
+    free(v->validity);
+    v->validity = NULL;
+    int *shape = (int*)realloc(v->shape, (a->ndim + 1) * sizeof(int));
+    if (shape) v->shape = shape;
+    int *strides = (int*)realloc(v->strides, (a->ndim + 1) * sizeof(int));
+    if (strides) v->strides = strides;
+    if (!shape || !strides) {
+        free_array(v);
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+    shape[axis] = a->shape[axis] - window + 1;
+    shape[a->ndim] = window;
+    strides[a->ndim] = a->strides[axis];
+    v->ndim = a->ndim + 1;
+    v->view = 1;
+    v->size = 1;
+    for (int d = 0; d < v->ndim; d++) v->size *= shape[d];
+
+    free_array(*view);
+    *view = v;
+    return ARRAY_SUCCESS;
+}
+
+// Helper function for windowed statistics: running sums over CONV_LANES lines at a
+// time, restarted at every block of ARRAY_BLOCK_SIZE outputs
+static ArrayError moving_window(ArrayType **result, const ArrayType *a, int window, int axis, int want_std) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (window < 1 || window > a->shape[axis]) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(shape, a->shape, a->ndim * sizeof(int));
+    shape[axis] = a->shape[axis] - window + 1;
+    ArrayError error = prepare_result(result, shape, a->ndim);
+    if (error != ARRAY_SUCCESS) return error;
+
+    ConvGeometry g = conv_geometry(a, axis);
+    size_t nout = (size_t)shape[axis];
+    size_t nblocks = (nout + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+    size_t ntiles = (g.inner + CONV_LANES - 1) / CONV_LANES;
+    size_t ntasks = g.outer * nblocks * ntiles;
+    double scale = 1.0 / window;
+    const float *in = a->data;
+    float *out = (*result)->data;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t t = 0; t < ntasks; t++) {
+        size_t c0 = (t % ntiles) * CONV_LANES;
+        size_t o0 = ((t / ntiles) % nblocks) * ARRAY_BLOCK_SIZE;
+        size_t row = t / (ntiles * nblocks);
+        size_t lanes = (g.inner - c0 < CONV_LANES) ? g.inner - c0 : CONV_LANES;
+        size_t o1 = (nout - o0 < ARRAY_BLOCK_SIZE) ? nout : o0 + ARRAY_BLOCK_SIZE;
+        const float *src = in + row * g.len * g.inner + c0;
+        float *dst = out + row * nout * g.inner + c0;
+        double sum[CONV_LANES], sumsq[CONV_LANES];
+
+        for (size_t l = 0; l < lanes; l++) sum[l] = sumsq[l] = 0.0;
+        for (size_t k = o0; k < o0 + (size_t)window; k++) {
+            for (size_t l = 0; l < lanes; l++) {
+                double x = src[k * g.inner + l];
+                sum[l] += x;
+                sumsq[l] += x * x;
+            }
+        }
+
+        for (size_t o = o0; o < o1; o++) {
+            if (o > o0) {
+                const float *enter = src + (o + window - 1) * g.inner;
+                const float *leave = src + (o - 1) * g.inner;
+                for (size_t l = 0; l < lanes; l++) {
+                    double x = enter[l], y = leave[l];
+                    sum[l] += x - y;
+                    sumsq[l] += x * x - y * y;
+                }
+            }
+            for (size_t l = 0; l < lanes; l++) {
+                double mean = sum[l] * scale;
+                if (want_std) {
+                    double var = sumsq[l] * scale - mean * mean;
+                    dst[o * g.inner + l] = (float)sqrt(var > 0.0 ? var : 0.0);
+                } else {
+                    dst[o * g.inner + l] = (float)mean;
+                }
+            }
+        }
+    }
+
+    return ARRAY_SUCCESS;
+}
+
+// Function to compute moving averages along an axis
+ArrayError moving_average_array(ArrayType **result, const ArrayType *a, int window, int axis) {
+    return moving_window(result, a, window, axis, 0);
+}
+
+// Function to compute moving standard deviations along an axis
+ArrayError moving_std_array(ArrayType **result, const ArrayType *a, int window, int axis) {
+    return moving_window(result, a, window, axis, 1);
+}
@@ -0,0 +1,121 @@
+#include "creation.h"
+#include "parallel.h"
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    double start;
+    double step;
+    size_t last;       // Index pinned to last_value, or (size_t)-1
+    float last_value;
+} LinearParams;
+
+static void full_kernel(float *out, size_t start, size_t n, const void *ctx) {
+    float value = *(const float*)ctx;
+    (void)start;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = value;
+}
+
+static void linear_kernel(float *out, size_t start, size_t n, const void *ctx) {
+    const LinearParams *p = (const LinearParams*)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = (float)(p->start + (double)(start + i) * p->step);
+    if (p->last >= start && p->last - start < n) out[p->last - start] = p->last_value;
+}
+
+typedef struct {
+    int cols;
+    int k;
+} EyeParams;
+
+// Blocks cover whole or partial rows; the one on each row is at column row + k
+static void eye_kernel(float *out, size_t start, size_t n, const void *ctx) {
+    const EyeParams *p = (const EyeParams*)ctx;
+    memset(out, 0, n * sizeof(float));
+    size_t first_row = start / p->cols, last_row = (start + n - 1) / p->cols;
+    for (size_t row = first_row; row <= last_row; row++) {
+        long long col = (long long)row + p->k;
+        if (col < 0 || col >= p->cols) continue;
+        size_t index = row * p->cols + (size_t)col;
+        if (index >= start && index - start < n) out[index - start] = 1.0f;
+    }
+}
+
+// Function to fill an array block by block with a generator
+ArrayError array_fill_fn(ArrayType *a, ArrayFillFn fn, const void *ctx) {
+    if (!a || !fn) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    ArrayError error = array_make_writable(a);
+    if (error != ARRAY_SUCCESS) return error;
+
+    float *out = a->data;
+    size_t n = a->size;
+    size_t nblocks = (n + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t start = blk * ARRAY_BLOCK_SIZE;
+        size_t len = (n - start < ARRAY_BLOCK_SIZE) ? n - start : ARRAY_BLOCK_SIZE;
+        fn(out + start, start, len, ctx);
+    }
+
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to create an uninitialized array and fill it with a generator
+static ArrayType* create_filled(const int *shape, int ndim, ArrayFillFn fn, const void *ctx, ArrayError *error) {
+    ArrayType *arr = array_empty(shape, ndim, error);
+    if (!arr) return NULL;
+    array_fill_fn(arr, fn, ctx);
+    return arr;
+}
+
+// Function to create an array filled with a value
+ArrayType* array_full(const int *shape, int ndim, float value, ArrayError *error) {
+    return create_filled(shape, ndim, full_kernel, &value, error);
+}
+
+// Function to create evenly spaced values within an interval
+ArrayType* array_arange(float start, float stop, float step, ArrayError *error) {
+    if (step == 0.0f || !isfinite(start) || !isfinite(stop) || !isfinite(step)) {
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    double count = ceil(((double)stop - start) / step);
+    if (count > INT_MAX) {
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    int shape[1] = {count > 0.0 ? (int)count : 0};
+    LinearParams params = {start, step, (size_t)-1, 0.0f};
+    return create_filled(shape, 1, linear_kernel, &params, error);
+}
+
+// Function to create a given number of evenly spaced values
+ArrayType* array_linspace(float start, float stop, int num, int endpoint, ArrayError *error) {
+    if (num <= 0) {
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    int intervals = endpoint ? num - 1 : num;
+    double step = intervals > 0 ? ((double)stop - start) / intervals : 0.0;
+    // With a single element there is no last interval to pin to stop; numpy gives [start]
+    LinearParams params = {start, step, endpoint && num > 1 ? (size_t)(num - 1) : (size_t)-1, stop};
+    int shape[1] = {num};
+    return create_filled(shape, 1, linear_kernel, &params, error);
+}
+
+// Function to create an identity-like matrix
+ArrayType* array_eye(int rows, int cols, int k, ArrayError *error) {
+    if (rows <= 0 || cols <= 0) {
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    EyeParams params = {cols, k};
+    int shape[2] = {rows, cols};
+    return create_filled(shape, 2, eye_kernel, &params, error);
+}
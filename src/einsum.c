@@ -0,0 +1,794 @@
+#include "einsum.h"
+#include "gemm.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Labels are indexed by their character code
+#define EINSUM_LABELS 128
+
+// Multiply-adds of one matrix product below which plain loops beat packing for sgemm
+#define EINSUM_SMALL_PRODUCT (32 * 32 * 32)
+
+// Multiply-adds of one matrix product above which sgemm spreads it over the threads;
+// smaller products of a batch run side by side, one per thread
+#define EINSUM_LARGE_PRODUCT (128 * 128 * 128)
+
+// Output elements summed together when a reduction keeps the fastest-varying labels
+#define EINSUM_COLUMN_BLOCK 256
+
+// An operand or intermediate result, with one axis per distinct label
+typedef struct {
+    float *data;   // First element
+    float *owned;  // Buffer released with the term, NULL when data belongs to an operand
+    int ndim;
+    char labels[ARRAY_MAX_DIMS];
+    int shape[ARRAY_MAX_DIMS];
+    ptrdiff_t strides[ARRAY_MAX_DIMS];
+} Term;
+
+// Shape and strides of a traversal in row-major order
+typedef struct {
+    int ndim;
+    size_t shape[ARRAY_MAX_DIMS];
+    ptrdiff_t strides[ARRAY_MAX_DIMS];
+} Dims;
+
+// Helper function to count the elements of a traversal
+static size_t dims_size(const Dims *d) {
+    size_t size = 1;
+    for (int i = 0; i < d->ndim; i++) size *= d->shape[i];
+    return size;
+}
+
+// Helper function to find the offset of the element with a given row-major index
+static ptrdiff_t dims_offset(const Dims *d, size_t index) {
+    ptrdiff_t offset = 0;
+    for (int i = d->ndim - 1; i >= 0; i--) {
+        offset += (ptrdiff_t)(index % d->shape[i]) * d->strides[i];
+        index /= d->shape[i];
+    }
+    return offset;
+}
+
+// Helper function to merge dimensions that are walked as one and drop those of length 1
+static void dims_coalesce(Dims *d) {
+    int n = 0;
+    for (int i = 0; i < d->ndim; i++) {
+        if (d->shape[i] == 1) continue;
+        if (n > 0 && d->strides[n - 1] == d->strides[i] * (ptrdiff_t)d->shape[i]) {
+            d->shape[n - 1] *= d->shape[i];
+            d->strides[n - 1] = d->strides[i];
+        } else {
+            d->shape[n] = d->shape[i];
+            d->strides[n] = d->strides[i];
+            n++;
+        }
+    }
+    d->ndim = n;
+}
+
+// Helper function to split off the innermost dimension of a traversal
+static size_t dims_pop(Dims *d, ptrdiff_t *step) {
+    if (d->ndim == 0) {
+        *step = 0;
+        return 1;
+    }
+    d->ndim--;
+    *step = d->strides[d->ndim];
+    return d->shape[d->ndim];
+}
+
+// Helper function to find the axis of a term carrying a label; -1 when it has none
+static int term_axis(const Term *t, char label) {
+    for (int i = 0; i < t->ndim; i++) {
+        if (t->labels[i] == label) return i;
+    }
+    return -1;
+}
+
+// Helper function to count the elements of a term
+static size_t term_size(const Term *t) {
+    size_t size = 1;
+    for (int i = 0; i < t->ndim; i++) size *= t->shape[i];
+    return size;
+}
+
+// Helper function to traverse a term with its labels in a given order
+static void term_dims(Dims *d, const Term *t, const char *labels, int n) {
+    d->ndim = n;
+    for (int i = 0; i < n; i++) {
+        int axis = term_axis(t, labels[i]);
+        d->shape[i] = t->shape[axis];
+        d->strides[i] = t->strides[axis];
+    }
+}
+
+// Helper function to check whether a term is stored row-major with its labels in a given order
+static int term_is_contiguous(const Term *t, const char *labels, int n) {
+    ptrdiff_t expected = 1;
+    for (int i = n - 1; i >= 0; i--) {
+        int axis = term_axis(t, labels[i]);
+        if (t->shape[axis] == 1) continue;
+        if (t->strides[axis] != expected) return 0;
+        expected *= t->shape[axis];
+    }
+    return 1;
+}
+
+// Helper function to list the labels of a term from the largest stride to the smallest
+static void term_memory_order(const Term *t, char *order) {
+    memcpy(order, t->labels, t->ndim);
+    for (int i = 1; i < t->ndim; i++) {
+        char label = order[i];
+        ptrdiff_t stride = t->strides[term_axis(t, label)];
+        stride = stride < 0 ? -stride : stride;
+        int j = i;
+        while (j > 0) {
+            ptrdiff_t prev = t->strides[term_axis(t, order[j - 1])];
+            if ((prev < 0 ? -prev : prev) >= stride) break;
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = label;
+    }
+}
+
+// Helper function to make a term the owner of a contiguous buffer
+static void term_assign(Term *t, float *buffer, const char *labels, const int *shape, int ndim) {
+    free(t->owned);
+    t->data = t->owned = buffer;
+    t->ndim = ndim;
+    memmove(t->labels, labels, ndim);
+    memmove(t->shape, shape, ndim * sizeof(int));
+    ptrdiff_t stride = 1;
+    for (int i = ndim - 1; i >= 0; i--) {
+        t->strides[i] = stride;
+        stride *= t->shape[i];
+    }
+}
+
+// Helper function to copy strided elements into a contiguous buffer in row-major order
+static void strided_copy(float *dst, const float *src, const Dims *dims) {
+    Dims rows = *dims;
+    dims_coalesce(&rows);
+    ptrdiff_t step;
+    size_t inner = dims_pop(&rows, &step);
+    size_t nrows = dims_size(&rows);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (nrows > 1 && nrows * inner >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t r = 0; r < nrows; r++) {
+        const float *in = src + dims_offset(&rows, r);
+        float *out = dst + r * inner;
+        if (step == 1) {
+            memcpy(out, in, inner * sizeof(float));
+        } else {
+            ARRAY_OMP_SIMD
+            for (size_t i = 0; i < inner; i++) out[i] = in[(ptrdiff_t)i * step];
+        }
+    }
+}
+
+// Helper function to lay a term out contiguously with its labels in a given order
+static ArrayError term_permute(Term *t, const char *labels) {
+    Dims d;
+    term_dims(&d, t, labels, t->ndim);
+    float *buffer = (float*)malloc((term_size(t) > 0 ? term_size(t) : 1) * sizeof(float));
+    if (!buffer) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    strided_copy(buffer, t->data, &d);
+
+    int shape[ARRAY_MAX_DIMS];
+    for (int i = 0; i < t->ndim; i++) shape[i] = (int)d.shape[i];
+    term_assign(t, buffer, labels, shape, t->ndim);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to sum the rows first..last - 1 of a reduction starting at base
+static float sum_rows(const float *base, const Dims *rows, size_t inner, ptrdiff_t step,
+                      size_t first, size_t last) {
+    float total = 0.0f;
+    for (size_t r = first; r < last; r++) {
+        const float *in = base + dims_offset(rows, r);
+        float sum = 0.0f;
+        if (step == 1) {
+            ARRAY_OMP_SIMD_REDUCTION(+:sum)
+            for (size_t i = 0; i < inner; i++) sum += in[i];
+        } else {
+            ARRAY_OMP_SIMD_REDUCTION(+:sum)
+            for (size_t i = 0; i < inner; i++) sum += in[(ptrdiff_t)i * step];
+        }
+        total += sum;
+    }
+    return total;
+}
+
+// Helper function to sum every output element over the elements it reduces. The rows
+// of each sum are split into fixed chunks whose partial sums are added in order, so
+// the result does not depend on whether the outputs or the chunks are spread over
+// the threads.
+static ArrayError reduce_by_output(float *out, const float *src, const Dims *kept, const Dims *summed) {
+    Dims rows = *summed;
+    ptrdiff_t step;
+    size_t inner = dims_pop(&rows, &step);
+    size_t nrows = dims_size(&rows);
+    size_t nout = dims_size(kept);
+    size_t chunk = inner >= ARRAY_DETERMINISTIC_CHUNK ? 1 : ARRAY_DETERMINISTIC_CHUNK / inner;
+    size_t nchunks = (nrows + chunk - 1) / chunk;
+    int parallel = nout * nrows * inner >= ARRAY_PARALLEL_THRESHOLD;
+
+    if (nchunks <= 1 || nout >= nchunks) {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (parallel)
+#endif
+        for (size_t o = 0; o < nout; o++) {
+            const float *base = src + dims_offset(kept, o);
+            float total = 0.0f;
+            for (size_t c = 0; c < nchunks; c++) {
+                size_t last = (c + 1) * chunk < nrows ? (c + 1) * chunk : nrows;
+                total += sum_rows(base, &rows, inner, step, c * chunk, last);
+            }
+            out[o] = total;
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    float *partials = (float*)malloc(nchunks * sizeof(float));
+    if (!partials) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    for (size_t o = 0; o < nout; o++) {
+        const float *base = src + dims_offset(kept, o);
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (parallel)
+#endif
+        for (size_t c = 0; c < nchunks; c++) {
+            size_t last = (c + 1) * chunk < nrows ? (c + 1) * chunk : nrows;
+            partials[c] = sum_rows(base, &rows, inner, step, c * chunk, last);
+        }
+        float total = 0.0f;
+        for (size_t c = 0; c < nchunks; c++) total += partials[c];
+        out[o] = total;
+    }
+    free(partials);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to sum whole blocks of output elements at once, used when the kept
+// labels vary faster in memory than the summed ones
+static void reduce_by_block(float *out, const float *src, const Dims *kept, const Dims *summed) {
+    Dims rows = *kept;
+    ptrdiff_t step;
+    size_t inner = dims_pop(&rows, &step);
+    size_t nrows = dims_size(&rows);
+    Dims outer = *summed;
+    ptrdiff_t stride;
+    size_t count = dims_pop(&outer, &stride);
+    size_t nouter = dims_size(&outer);
+    size_t nsum = nouter * count;
+    size_t nblocks = (inner + EINSUM_COLUMN_BLOCK - 1) / EINSUM_COLUMN_BLOCK;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (nrows * inner * nsum >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t task = 0; task < nrows * nblocks; task++) {
+        size_t row = task / nblocks, first = (task % nblocks) * EINSUM_COLUMN_BLOCK;
+        size_t n = inner - first < EINSUM_COLUMN_BLOCK ? inner - first : EINSUM_COLUMN_BLOCK;
+        const float *base = src + dims_offset(&rows, row) + (ptrdiff_t)first * step;
+        float *acc = out + row * inner + first;
+
+        for (size_t i = 0; i < n; i++) acc[i] = 0.0f;
+        for (size_t j = 0; j < nouter; j++) {
+            const float *in = base + dims_offset(&outer, j);
+            for (size_t q = 0; q < count; q++, in += stride) {
+                if (step == 1) {
+                    ARRAY_OMP_SIMD
+                    for (size_t i = 0; i < n; i++) acc[i] += in[i];
+                } else {
+                    ARRAY_OMP_SIMD
+                    for (size_t i = 0; i < n; i++) acc[i] += in[(ptrdiff_t)i * step];
+                }
+            }
+        }
+    }
+}
+
+// Helper function to sum a term over the labels not marked in keep
+static ArrayError reduce_term(Term *t, const unsigned char *keep) {
+    char kept[ARRAY_MAX_DIMS], summed[ARRAY_MAX_DIMS], order[ARRAY_MAX_DIMS];
+    int nkept = 0, nsummed = 0;
+    for (int i = 0; i < t->ndim; i++) {
+        if (keep[(unsigned char)t->labels[i]]) kept[nkept++] = t->labels[i];
+    }
+    if (nkept == t->ndim) return ARRAY_SUCCESS;
+
+    // The summed labels are walked in memory order, which does not change what is added
+    term_memory_order(t, order);
+    for (int i = 0; i < t->ndim; i++) {
+        if (!keep[(unsigned char)order[i]]) summed[nsummed++] = order[i];
+    }
+
+    Dims k, s;
+    term_dims(&k, t, kept, nkept);
+    term_dims(&s, t, summed, nsummed);
+    size_t nout = dims_size(&k);
+    float *out = (float*)malloc((nout > 0 ? nout : 1) * sizeof(float));
+    if (!out) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+    // The coalesced traversals describe the same elements in the same order
+    Dims kc = k, sc = s;
+    dims_coalesce(&kc);
+    dims_coalesce(&sc);
+    ptrdiff_t kstep = kc.ndim ? kc.strides[kc.ndim - 1] : 0;
+    ptrdiff_t sstep = sc.ndim ? sc.strides[sc.ndim - 1] : 0;
+    kstep = kstep < 0 ? -kstep : kstep;
+    sstep = sstep < 0 ? -sstep : sstep;
+    if (kc.ndim > 0 && sc.ndim > 0 && kstep < sstep) {
+        reduce_by_block(out, t->data, &kc, &sc);
+    } else {
+        ArrayError error = reduce_by_output(out, t->data, &kc, &sc);
+        if (error != ARRAY_SUCCESS) {
+            free(out);
+            return error;
+        }
+    }
+
+    int shape[ARRAY_MAX_DIMS];
+    for (int i = 0; i < nkept; i++) shape[i] = (int)k.shape[i];
+    term_assign(t, out, kept, shape, nkept);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to compute a batch of small matrix products with plain loops;
+// op(A) is m x k, op(B) is k x n and every matrix is stored contiguously
+static void small_products(float *c, const float *a, GemmTranspose ta, const float *b, GemmTranspose tb,
+                           size_t batch, int m, int n, int k) {
+    size_t sa = (size_t)m * k, sb = (size_t)k * n, sc = (size_t)m * n;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (batch > 1 && batch * sc * k >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t s = 0; s < batch; s++) {
+        const float *as = a + s * sa, *bs = b + s * sb;
+        float *cs = c + s * sc;
+        for (int i = 0; i < m; i++) {
+            float *row = cs + (size_t)i * n;
+            if (tb == GEMM_NO_TRANS) {
+                for (int j = 0; j < n; j++) row[j] = 0.0f;
+                for (int p = 0; p < k; p++) {
+                    float x = ta == GEMM_NO_TRANS ? as[(size_t)i * k + p] : as[(size_t)p * m + i];
+                    const float *brow = bs + (size_t)p * n;
+                    ARRAY_OMP_SIMD
+                    for (int j = 0; j < n; j++) row[j] += x * brow[j];
+                }
+            } else {
+                for (int j = 0; j < n; j++) {
+                    const float *bcol = bs + (size_t)j * k;
+                    float sum = 0.0f;
+                    if (ta == GEMM_NO_TRANS) {
+                        const float *arow = as + (size_t)i * k;
+                        ARRAY_OMP_SIMD_REDUCTION(+:sum)
+                        for (int p = 0; p < k; p++) sum += arow[p] * bcol[p];
+                    } else {
+                        for (int p = 0; p < k; p++) sum += as[(size_t)p * m + i] * bcol[p];
+                    }
+                    row[j] = sum;
+                }
+            }
+        }
+    }
+}
+
+// Helper function to compute a batch of matrix products; op(A) is m x k, op(B) is k x n
+// and every matrix is stored contiguously
+static ArrayError batched_products(float *c, const float *a, GemmTranspose ta, const float *b, GemmTranspose tb,
+                                   size_t batch, int m, int n, int k) {
+    size_t sa = (size_t)m * k, sb = (size_t)k * n, sc = (size_t)m * n;
+    size_t work = sc * k;
+
+    if ((n == 1 && ta == GEMM_NO_TRANS) || (m == 1 && tb == GEMM_TRANS)) {
+        // Matrix-vector products are dot products of contiguous rows with the vector
+        int rows_of_a = n == 1 && ta == GEMM_NO_TRANS;
+        size_t rows = rows_of_a ? (size_t)m : (size_t)n;
+        const float *matrix = rows_of_a ? a : b, *vector = rows_of_a ? b : a;
+        size_t smatrix = rows_of_a ? sa : sb, svector = rows_of_a ? sb : sa;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (batch * rows * k >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t t = 0; t < batch * rows; t++) {
+            size_t s = t / rows;
+            const float *x = matrix + s * smatrix + (t % rows) * k, *y = vector + s * svector;
+            float sum = 0.0f;
+            ARRAY_OMP_SIMD_REDUCTION(+:sum)
+            for (int p = 0; p < k; p++) sum += x[p] * y[p];
+            c[t] = sum;
+        }
+        return ARRAY_SUCCESS;
+    }
+    if (work <= EINSUM_SMALL_PRODUCT || k == 1) {
+        small_products(c, a, ta, b, tb, batch, m, n, k);
+        return ARRAY_SUCCESS;
+    }
+
+    int lda = ta == GEMM_NO_TRANS ? k : m, ldb = tb == GEMM_NO_TRANS ? n : k;
+    if (batch == 1 || work >= EINSUM_LARGE_PRODUCT) {
+        for (size_t s = 0; s < batch; s++) {
+            ArrayError error = sgemm(ta, tb, m, n, k, 1.0f, a + s * sa, lda, b + s * sb, ldb, 0.0f, c + s * sc, n);
+            if (error != ARRAY_SUCCESS) return error;
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    // sgemm stays on the calling thread inside the parallel region
+    int failed = 0;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(|:failed)
+#endif
+    for (size_t s = 0; s < batch; s++) {
+        failed |= sgemm(ta, tb, m, n, k, 1.0f, a + s * sa, lda, b + s * sb, ldb, 0.0f, c + s * sc, n) != ARRAY_SUCCESS;
+    }
+    return failed ? ARRAY_ERROR_MEMORY_ALLOCATION : ARRAY_SUCCESS;
+}
+
+// Helper function to tell how a term is laid out for a matrix product: 0 when it is
+// contiguous in the order [batch, outer, inner], 1 for [batch, inner, outer], -1 otherwise
+static int product_layout(const Term *t, const char *batch, int nbatch, const char *outer, int nouter,
+                          const char *inner, int ninner) {
+    char order[ARRAY_MAX_DIMS];
+    memcpy(order, batch, nbatch);
+    memcpy(order + nbatch, outer, nouter);
+    memcpy(order + nbatch + nouter, inner, ninner);
+    if (term_is_contiguous(t, order, t->ndim)) return 0;
+    memcpy(order + nbatch, inner, ninner);
+    memcpy(order + nbatch + ninner, outer, nouter);
+    if (term_is_contiguous(t, order, t->ndim)) return 1;
+    return -1;
+}
+
+// Helper function to contract two terms into a new one, keeping the labels marked in keep.
+// The result is contiguous with its labels ordered as batch, rows of a, columns of b.
+static ArrayError contract_pair(Term *out, Term *a, Term *b, const unsigned char *keep) {
+    unsigned char in_a[EINSUM_LABELS] = {0}, in_b[EINSUM_LABELS] = {0};
+    unsigned char keep_a[EINSUM_LABELS], keep_b[EINSUM_LABELS];
+    for (int i = 0; i < a->ndim; i++) in_a[(unsigned char)a->labels[i]] = 1;
+    for (int i = 0; i < b->ndim; i++) in_b[(unsigned char)b->labels[i]] = 1;
+    for (int l = 0; l < EINSUM_LABELS; l++) {
+        keep_a[l] = keep[l] || in_b[l];
+        keep_b[l] = keep[l] || in_a[l];
+    }
+
+    // Labels found in only one operand and needed nowhere else are summed out first
+    ArrayError error = reduce_term(a, keep_a);
+    if (error != ARRAY_SUCCESS) return error;
+    error = reduce_term(b, keep_b);
+    if (error != ARRAY_SUCCESS) return error;
+
+    char order_a[ARRAY_MAX_DIMS], order_b[ARRAY_MAX_DIMS];
+    char batch[ARRAY_MAX_DIMS], rows[ARRAY_MAX_DIMS], cols[ARRAY_MAX_DIMS];
+    char inner_a[ARRAY_MAX_DIMS], inner_b[ARRAY_MAX_DIMS];
+    int nbatch = 0, nrows = 0, ncols = 0, ninner = 0;
+    size_t B = 1, M = 1, N = 1, K = 1;
+    term_memory_order(a, order_a);
+    term_memory_order(b, order_b);
+    for (int i = 0; i < a->ndim; i++) {
+        unsigned char l = (unsigned char)order_a[i];
+        size_t len = (size_t)a->shape[term_axis(a, order_a[i])];
+        if (!in_b[l]) {
+            rows[nrows++] = order_a[i];
+            M *= len;
+        } else if (keep[l]) {
+            batch[nbatch++] = order_a[i];
+            B *= len;
+        } else {
+            inner_a[ninner++] = order_a[i];
+            K *= len;
+        }
+    }
+    int n = 0;
+    for (int i = 0; i < b->ndim; i++) {
+        unsigned char l = (unsigned char)order_b[i];
+        if (!in_a[l]) {
+            cols[ncols++] = order_b[i];
+            N *= (size_t)b->shape[term_axis(b, order_b[i])];
+        } else if (!keep[l]) {
+            inner_b[n++] = order_b[i];
+        }
+    }
+    if (nbatch + nrows + ncols > ARRAY_MAX_DIMS) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (M > INT_MAX || N > INT_MAX || K > INT_MAX) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    // Order the contracted labels as one of the operands stores them, whichever leaves
+    // fewer operands to copy
+    int layout_a = -1, layout_b = -1, copies = 3;
+    const char *inner = inner_a;
+    for (int choice = 0; choice < 2; choice++) {
+        const char *candidate = choice == 0 ? inner_a : inner_b;
+        int la = product_layout(a, batch, nbatch, rows, nrows, candidate, ninner);
+        int lb = product_layout(b, batch, nbatch, cols, ncols, candidate, ninner);
+        int needed = (la < 0) + (lb < 0);
+        if (needed < copies) {
+            copies = needed;
+            layout_a = la;
+            layout_b = lb;
+            inner = candidate;
+        }
+    }
+
+    char order[ARRAY_MAX_DIMS];
+    memcpy(order, batch, nbatch);
+    if (layout_a < 0) {
+        memcpy(order + nbatch, rows, nrows);
+        memcpy(order + nbatch + nrows, inner, ninner);
+        error = term_permute(a, order);
+        if (error != ARRAY_SUCCESS) return error;
+        layout_a = 0;
+    }
+    if (layout_b < 0) {
+        memcpy(order + nbatch, inner, ninner);
+        memcpy(order + nbatch + ninner, cols, ncols);
+        error = term_permute(b, order);
+        if (error != ARRAY_SUCCESS) return error;
+        layout_b = 1;
+    }
+
+    float *c = (float*)malloc((B * M * N > 0 ? B * M * N : 1) * sizeof(float));
+    if (!c) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    error = batched_products(c, a->data, layout_a == 0 ? GEMM_NO_TRANS : GEMM_TRANS,
+                             b->data, layout_b == 1 ? GEMM_NO_TRANS : GEMM_TRANS,
+                             B, (int)M, (int)N, (int)K);
+    if (error != ARRAY_SUCCESS) {
+        free(c);
+        return error;
+    }
+
+    char labels[ARRAY_MAX_DIMS];
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(labels, batch, nbatch);
+    memcpy(labels + nbatch, rows, nrows);
+    memcpy(labels + nbatch + nrows, cols, ncols);
+    int ndim = nbatch + nrows + ncols;
+    for (int i = 0; i < ndim; i++) {
+        int axis = term_axis(a, labels[i]);
+        shape[i] = axis >= 0 ? a->shape[axis] : b->shape[term_axis(b, labels[i])];
+    }
+    out->owned = NULL;
+    term_assign(out, c, labels, shape, ndim);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to mark the labels still needed once terms i and j are contracted
+static void needed_labels(unsigned char *keep, const unsigned char *in_output, const Term *terms,
+                          int count, int i, int j) {
+    memcpy(keep, in_output, EINSUM_LABELS);
+    for (int t = 0; t < count; t++) {
+        if (t == i || t == j) continue;
+        for (int d = 0; d < terms[t].ndim; d++) keep[(unsigned char)terms[t].labels[d]] = 1;
+    }
+}
+
+// Helper function to pick the next pair of terms to contract. The pair whose result
+// is smallest compared with its operands goes first, ties going to the pair with
+// fewer multiply-adds; pairs sharing no label are only taken when nothing else is left.
+static void choose_pair(const Term *terms, int count, const unsigned char *in_output, int *best_i, int *best_j) {
+    double best_gain = 0.0, best_cost = 0.0;
+    int best_shared = -1;
+    *best_i = 0;
+    *best_j = 1;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            unsigned char keep[EINSUM_LABELS], seen[EINSUM_LABELS] = {0};
+            needed_labels(keep, in_output, terms, count, i, j);
+
+            int shared = 0;
+            double kept = 1.0, cost = 1.0;
+            for (int d = 0; d < terms[i].ndim; d++) {
+                unsigned char l = (unsigned char)terms[i].labels[d];
+                seen[l] = 1;
+                cost *= terms[i].shape[d];
+                if (keep[l] || term_axis(&terms[j], terms[i].labels[d]) >= 0) kept *= terms[i].shape[d];
+            }
+            for (int d = 0; d < terms[j].ndim; d++) {
+                unsigned char l = (unsigned char)terms[j].labels[d];
+                if (seen[l]) {
+                    shared = 1;
+                    if (!keep[l]) kept /= terms[j].shape[d];
+                    continue;
+                }
+                cost *= terms[j].shape[d];
+                if (keep[l]) kept *= terms[j].shape[d];
+            }
+            double gain = kept - (double)term_size(&terms[i]) - (double)term_size(&terms[j]);
+
+            if (shared > best_shared ||
+                (shared == best_shared && (gain < best_gain || (gain == best_gain && cost < best_cost)))) {
+                best_shared = shared;
+                best_gain = gain;
+                best_cost = cost;
+                *best_i = i;
+                *best_j = j;
+            }
+        }
+    }
+}
+
+// Helper function to read the subscripts of the operands into terms, taking the
+// diagonal of repeated labels as a strided view, and the labels of the output
+static ArrayError parse_subscripts(const char *subscripts, const ArrayType *const *operands, int count,
+                                   Term *terms, char *output, int *noutput, int *sizes) {
+    int occurrences[EINSUM_LABELS] = {0};
+    const char *p = subscripts;
+    for (int l = 0; l < EINSUM_LABELS; l++) sizes[l] = -1;
+
+    for (int t = 0; t < count; t++) {
+        const ArrayType *op = operands[t];
+        Term *term = &terms[t];
+        int axis = 0;
+        term->data = op->data;
+        term->owned = NULL;
+        term->ndim = 0;
+        for (; *p != '\0' && *p != ',' && *p != '-'; p++) {
+            if (*p == ' ') continue;
+            if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z'))) return ARRAY_ERROR_INVALID_ARGUMENT;
+            if (axis >= op->ndim) return ARRAY_ERROR_INVALID_DIMENSION;
+
+            unsigned char l = (unsigned char)*p;
+            if (sizes[l] >= 0 && sizes[l] != op->shape[axis]) return ARRAY_ERROR_INVALID_DIMENSION;
+            sizes[l] = op->shape[axis];
+            occurrences[l]++;
+
+            int existing = term_axis(term, *p);
+            if (existing >= 0) {
+                term->strides[existing] += op->strides[axis];
+            } else {
+                term->labels[term->ndim] = *p;
+                term->shape[term->ndim] = op->shape[axis];
+                term->strides[term->ndim] = op->strides[axis];
+                term->ndim++;
+            }
+            axis++;
+        }
+        if (axis != op->ndim) return ARRAY_ERROR_INVALID_DIMENSION;
+        if (t < count - 1) {
+            if (*p != ',') return ARRAY_ERROR_INVALID_ARGUMENT;
+            p++;
+        }
+    }
+
+    *noutput = 0;
+    if (*p == '\0') {
+        for (int l = 0; l < EINSUM_LABELS; l++) {
+            if (occurrences[l] == 1) output[(*noutput)++] = (char)l;
+        }
+        return *noutput <= ARRAY_MAX_DIMS ? ARRAY_SUCCESS : ARRAY_ERROR_INVALID_DIMENSION;
+    }
+    if (p[0] != '-' || p[1] != '>') return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    unsigned char seen[EINSUM_LABELS] = {0};
+    for (p += 2; *p != '\0'; p++) {
+        if (*p == ' ') continue;
+        unsigned char l = (unsigned char)*p;
+        if (l >= EINSUM_LABELS || occurrences[l] == 0 || seen[l]) return ARRAY_ERROR_INVALID_ARGUMENT;
+        if (*noutput >= ARRAY_MAX_DIMS) return ARRAY_ERROR_INVALID_DIMENSION;
+        seen[l] = 1;
+        output[(*noutput)++] = *p;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Function to evaluate an Einstein summation
+ArrayError einsum_arrays(ArrayType **result, const char *subscripts, const ArrayType *const *operands, int count) {
+    if (!result || !subscripts || !operands) return ARRAY_ERROR_NULL_POINTER;
+    if (count < 1) return ARRAY_ERROR_INVALID_ARGUMENT;
+    for (int t = 0; t < count; t++) {
+        if (!operands[t]) return ARRAY_ERROR_NULL_POINTER;
+        if (operands[t]->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    }
+
+    Term *terms = (Term*)malloc(count * sizeof(Term));
+    if (!terms) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    char output[ARRAY_MAX_DIMS];
+    int noutput, sizes[EINSUM_LABELS];
+    ArrayError error = parse_subscripts(subscripts, operands, count, terms, output, &noutput, sizes);
+    if (error != ARRAY_SUCCESS) {
+        free(terms);
+        return error;
+    }
+
+    unsigned char in_output[EINSUM_LABELS] = {0};
+    for (int i = 0; i < noutput; i++) in_output[(unsigned char)output[i]] = 1;
+
+    int live = count;
+    while (live > 1 && error == ARRAY_SUCCESS) {
+        int i, j;
+        unsigned char keep[EINSUM_LABELS];
+        choose_pair(terms, live, in_output, &i, &j);
+        needed_labels(keep, in_output, terms, live, i, j);
+
+        Term fresh;
+        error = contract_pair(&fresh, &terms[i], &terms[j], keep);
+        free(terms[i].owned);
+        free(terms[j].owned);
+        terms[i] = fresh;
+        terms[j] = terms[live - 1];
+        live--;
+        if (error != ARRAY_SUCCESS) terms[i].owned = NULL;
+    }
+    Term *last = &terms[0];
+    if (error == ARRAY_SUCCESS) error = reduce_term(last, in_output);
+
+    // Copy the term out of operand storage first when the result is about to be reused
+    if (error == ARRAY_SUCCESS && !last->owned && *result) {
+        for (int t = 0; t < count; t++) {
+            if ((*result)->buffer == operands[t]->buffer) {
+                error = term_permute(last, last->labels);
+                break;
+            }
+        }
+    }
+
+    if (error == ARRAY_SUCCESS) {
+        int shape[ARRAY_MAX_DIMS] = {1};
+        for (int i = 0; i < noutput; i++) shape[i] = sizes[(unsigned char)output[i]];
+        error = prepare_result(result, shape, noutput > 0 ? noutput : 1);
+    }
+    if (error == ARRAY_SUCCESS) {
+        Dims d;
+        term_dims(&d, last, output, noutput);
+        strided_copy((*result)->data, last->data, &d);
+    }
+
+    for (int t = 0; t < live; t++) free(terms[t].owned);
+    free(terms);
+    return error;
+}
+
+// Function to sum products over pairs of axes of two arrays
+ArrayError tensordot_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b,
+                            const int *axes_a, const int *axes_b, int naxes) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    if (!result || !a || !b || (naxes > 0 && (!axes_a || !axes_b))) return ARRAY_ERROR_NULL_POINTER;
+    if (naxes < 0 || naxes > a->ndim || naxes > b->ndim) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->ndim + b->ndim - 2 * naxes > ARRAY_MAX_DIMS || a->ndim + b->ndim - naxes > (int)sizeof(letters) - 1) {
+        return ARRAY_ERROR_INVALID_DIMENSION;
+    }
+
+    // Contracted axes of b take the letters of their partners in a
+    char labels_a[ARRAY_MAX_DIMS], labels_b[ARRAY_MAX_DIMS];
+    memcpy(labels_a, letters, a->ndim);
+    memset(labels_b, 0, sizeof(labels_b));
+    for (int i = 0; i < naxes; i++) {
+        int axis_a = normalize_axis(axes_a[i], a->ndim);
+        int axis_b = normalize_axis(axes_b[i], b->ndim);
+        if (axis_a < 0 || axis_b < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+        if (labels_b[axis_b] || labels_a[axis_a] == '\0') return ARRAY_ERROR_INVALID_ARGUMENT;
+        labels_b[axis_b] = labels_a[axis_a];
+        labels_a[axis_a] = '\0';
+    }
+
+    char subscripts[4 * ARRAY_MAX_DIMS + 4];
+    char output[2 * ARRAY_MAX_DIMS];
+    int len = 0, nout = 0, next = a->ndim;
+    for (int d = 0; d < a->ndim; d++) {
+        subscripts[len++] = letters[d];
+        if (labels_a[d] != '\0') output[nout++] = letters[d];
+    }
+    subscripts[len++] = ',';
+    for (int d = 0; d < b->ndim; d++) {
+        if (!labels_b[d]) {
+            labels_b[d] = letters[next++];
+            output[nout++] = labels_b[d];
+        }
+        subscripts[len++] = labels_b[d];
+    }
+    subscripts[len++] = '-';
+    subscripts[len++] = '>';
+    memcpy(subscripts + len, output, nout);
+    subscripts[len + nout] = '\0';
+
+    const ArrayType *operands[2] = {a, b};
+    return einsum_arrays(result, subscripts, operands, 2);
+}
@@ -0,0 +1,626 @@
+#include "fft.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define FFT_PI 3.14159265358979323846
+
+// Largest prime factor handled by the mixed-radix passes; lengths with larger ones use Bluestein
+#define FFT_MAX_RADIX 13
+
+// Enough passes for any int length
+#define FFT_MAX_FACTORS 32
+
+// A single transform at least this long is parallelized within each pass
+#define FFT_PARALLEL_LENGTH 32768
+
+#if defined(__GNUC__)
+#define FFT_INLINE static inline __attribute__((always_inline))
+#else
+#define FFT_INLINE static inline
+#endif
+
+// Plan for one transform length. Complex data is interleaved (re, im) floats.
+typedef struct FFTPlan {
+    int n;
+    int real;                       // Real-input plan built on a complex plan
+    int nfactors;
+    int factors[FFT_MAX_FACTORS];   // Radix of each Stockham pass
+    float *twiddles;                // Per pass of length L = m * p: w^(j k), w = e^(-2 pi i / L)
+    size_t work;                    // Scratch floats needed by fft_execute
+    int m;                          // Bluestein: power-of-two convolution length, else 0
+    float *chirp;                   // Bluestein: e^(-i pi k^2 / n), n values
+    float *chirp_fft;               // Bluestein: transform of the conjugate chirp, m values
+    const struct FFTPlan *inner;    // Bluestein length m plan, or the complex plan of a real plan
+    float *real_twiddles;           // Even real plans: e^(-2 pi i k / n), k = 0 .. n / 2
+    struct FFTPlan *next;
+} FFTPlan;
+
+// Plans are immutable once built; the list is only modified under the fft_plan_cache lock
+static FFTPlan *plan_cache = NULL;
+
+static inline int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Butterflies: inputs at in + r * istep and outputs at out + k * ostep (in floats),
+// each output k > 0 multiplied by the twiddle w[k - 1]
+FFT_INLINE void store_twiddled(float *out, float re, float im, const float *w) {
+    out[0] = re * w[0] - im * w[1];
+    out[1] = re * w[1] + im * w[0];
+}
+
+FFT_INLINE void butterfly2(const float *in, size_t istep, float *out, size_t ostep, const float *w) {
+    float a0r = in[0], a0i = in[1];
+    float a1r = in[istep], a1i = in[istep + 1];
+    out[0] = a0r + a1r;
+    out[1] = a0i + a1i;
+    store_twiddled(out + ostep, a0r - a1r, a0i - a1i, w);
+}
+
+FFT_INLINE void butterfly3(const float *in, size_t istep, float *out, size_t ostep, const float *w) {
+    const float s3 = 0.866025403784438647f;  // sin(2 pi / 3)
+    float a0r = in[0], a0i = in[1];
+    float a1r = in[istep], a1i = in[istep + 1];
+    float a2r = in[2 * istep], a2i = in[2 * istep + 1];
+    float t1r = a1r + a2r, t1i = a1i + a2i;
+    float t2r = a0r - 0.5f * t1r, t2i = a0i - 0.5f * t1i;
+    float t3r = s3 * (a1i - a2i), t3i = -s3 * (a1r - a2r);
+    out[0] = a0r + t1r;
+    out[1] = a0i + t1i;
+    store_twiddled(out + ostep, t2r + t3r, t2i + t3i, w);
+    store_twiddled(out + 2 * ostep, t2r - t3r, t2i - t3i, w + 2);
+}
+
+FFT_INLINE void butterfly4(const float *in, size_t istep, float *out, size_t ostep, const float *w) {
+    float a0r = in[0], a0i = in[1];
+    float a1r = in[istep], a1i = in[istep + 1];
+    float a2r = in[2 * istep], a2i = in[2 * istep + 1];
+    float a3r = in[3 * istep], a3i = in[3 * istep + 1];
+    float t0r = a0r + a2r, t0i = a0i + a2i;
+    float t1r = a0r - a2r, t1i = a0i - a2i;
+    float t2r = a1r + a3r, t2i = a1i + a3i;
+    float t3r = a1i - a3i, t3i = a3r - a1r;  // -i (a1 - a3)
+    out[0] = t0r + t2r;
+    out[1] = t0i + t2i;
+    store_twiddled(out + ostep, t1r + t3r, t1i + t3i, w);
+    store_twiddled(out + 2 * ostep, t0r - t2r, t0i - t2i, w + 2);
+    store_twiddled(out + 3 * ostep, t1r - t3r, t1i - t3i, w + 4);
+}
+
+FFT_INLINE void butterfly5(const float *in, size_t istep, float *out, size_t ostep, const float *w) {
+    const float c1 = 0.309016994374947424f, c2 = -0.809016994374947424f;  // cos(2 pi / 5), cos(4 pi / 5)
+    const float s1 = 0.951056516295153572f, s2 = 0.587785252292473129f;   // sin(2 pi / 5), sin(4 pi / 5)
+    float a0r = in[0], a0i = in[1];
+    float a1r = in[istep], a1i = in[istep + 1];
+    float a2r = in[2 * istep], a2i = in[2 * istep + 1];
+    float a3r = in[3 * istep], a3i = in[3 * istep + 1];
+    float a4r = in[4 * istep], a4i = in[4 * istep + 1];
+    float t1r = a1r + a4r, t1i = a1i + a4i, t3r = a1r - a4r, t3i = a1i - a4i;
+    float t2r = a2r + a3r, t2i = a2i + a3i, t4r = a2r - a3r, t4i = a2i - a3i;
+    float m1r = a0r + c1 * t1r + c2 * t2r, m1i = a0i + c1 * t1i + c2 * t2i;
+    float m2r = a0r + c2 * t1r + c1 * t2r, m2i = a0i + c2 * t1i + c1 * t2i;
+    float n1r = s1 * t3r + s2 * t4r, n1i = s1 * t3i + s2 * t4i;
+    float n2r = s2 * t3r - s1 * t4r, n2i = s2 * t3i - s1 * t4i;
+    out[0] = a0r + t1r + t2r;
+    out[1] = a0i + t1i + t2i;
+    store_twiddled(out + ostep, m1r + n1i, m1i - n1r, w);           // m1 - i n1
+    store_twiddled(out + 2 * ostep, m2r + n2i, m2i - n2r, w + 2);   // m2 - i n2
+    store_twiddled(out + 3 * ostep, m2r - n2i, m2i + n2r, w + 4);   // m2 + i n2
+    store_twiddled(out + 4 * ostep, m1r - n1i, m1i + n1r, w + 6);   // m1 + i n1
+}
+
+// Stockham pass of radix P over a sequence of current length m * P with s interleaved
+// subsequences: inputs x[q + s (j + r m)], outputs y[q + s (P j + k)]. The first pass
+// (s == 1) is vectorized over j, later passes over the contiguous q.
+#ifdef _OPENMP
+#define FFT_PARALLEL_FOR_SIMD _Pragma("omp parallel for simd schedule(static) if (parallel)")
+#define FFT_PARALLEL_FOR _Pragma("omp parallel for schedule(static) if (parallel)")
+#else
+#define FFT_PARALLEL_FOR_SIMD
+#define FFT_PARALLEL_FOR
+#endif
+
+#define FFT_DEFINE_PASS(P)                                                                  \
+static void pass##P(const float *x, float *y, size_t s, size_t m, const float *tw, int parallel) { \
+    size_t istep = 2 * s * m, ostep = 2 * s;                                                \
+    (void)parallel;                                                                         \
+    if (s == 1) {                                                                           \
+        FFT_PARALLEL_FOR_SIMD                                                               \
+        for (size_t j = 0; j < m; j++) {                                                    \
+            butterfly##P(x + 2 * j, istep, y + 2 * P * j, 2, tw + 2 * (P - 1) * j);         \
+        }                                                                                   \
+        return;                                                                             \
+    }                                                                                       \
+    FFT_PARALLEL_FOR                                                                        \
+    for (size_t j = 0; j < m; j++) {                                                        \
+        const float *w = tw + 2 * (P - 1) * j;                                              \
+        ARRAY_OMP_SIMD                                                                      \
+        for (size_t q = 0; q < s; q++) {                                                    \
+            butterfly##P(x + 2 * (s * j + q), istep, y + 2 * (s * P * j + q), ostep, w);    \
+        }                                                                                   \
+    }                                                                                       \
+}
+
+FFT_DEFINE_PASS(2)
+FFT_DEFINE_PASS(3)
+FFT_DEFINE_PASS(4)
+FFT_DEFINE_PASS(5)
+
+// Stockham pass for the remaining prime radices, as a direct DFT of size p
+static void pass_generic(const float *x, float *y, size_t s, size_t m, int p, const float *tw, int parallel) {
+    float roots[2 * FFT_MAX_RADIX];
+    for (int t = 0; t < p; t++) {
+        double angle = -2.0 * FFT_PI * t / p;
+        roots[2 * t] = (float)cos(angle);
+        roots[2 * t + 1] = (float)sin(angle);
+    }
+    size_t istep = 2 * s * m, ostep = 2 * s;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (parallel)
+#endif
+    for (size_t j = 0; j < m; j++) {
+        const float *w = tw + 2 * (size_t)(p - 1) * j;
+        for (size_t q = 0; q < s; q++) {
+            const float *in = x + 2 * (s * j + q);
+            float *out = y + 2 * (s * p * j + q);
+            for (int k = 0; k < p; k++) {
+                float re = 0.0f, im = 0.0f;
+                for (int r = 0; r < p; r++) {
+                    const float *a = in + r * istep;
+                    const float *root = roots + 2 * ((r * k) % p);
+                    re += a[0] * root[0] - a[1] * root[1];
+                    im += a[0] * root[1] + a[1] * root[0];
+                }
+                if (k == 0) {
+                    out[0] = re;
+                    out[1] = im;
+                } else {
+                    store_twiddled(out + k * ostep, re, im, w + 2 * (k - 1));
+                }
+            }
+        }
+    }
+}
+
+static void fft_execute(const FFTPlan *plan, float *x, float *work, int parallel);
+
+// Bluestein's algorithm: the length n transform as a circular convolution of length m
+static void bluestein_execute(const FFTPlan *plan, float *x, float *work, int parallel) {
+    size_t n = (size_t)plan->n, m = (size_t)plan->m;
+    const float *chirp = plan->chirp, *filter = plan->chirp_fft;
+    float *a = work, *scratch = work + 2 * m;
+
+    for (size_t k = 0; k < n; k++) {
+        float re = x[2 * k], im = x[2 * k + 1];
+        a[2 * k] = re * chirp[2 * k] - im * chirp[2 * k + 1];
+        a[2 * k + 1] = re * chirp[2 * k + 1] + im * chirp[2 * k];
+    }
+    memset(a + 2 * n, 0, 2 * (m - n) * sizeof(float));
+    fft_execute(plan->inner, a, scratch, parallel);
+
+    // Multiply by the filter and conjugate, so a forward transform computes the inverse
+    ARRAY_OMP_SIMD
+    for (size_t k = 0; k < m; k++) {
+        float re = a[2 * k], im = a[2 * k + 1];
+        a[2 * k] = re * filter[2 * k] - im * filter[2 * k + 1];
+        a[2 * k + 1] = -(re * filter[2 * k + 1] + im * filter[2 * k]);
+    }
+    fft_execute(plan->inner, a, scratch, parallel);
+
+    float scale = 1.0f / (float)m;
+    for (size_t k = 0; k < n; k++) {
+        float re = a[2 * k] * scale, im = -a[2 * k + 1] * scale;
+        x[2 * k] = re * chirp[2 * k] - im * chirp[2 * k + 1];
+        x[2 * k + 1] = re * chirp[2 * k + 1] + im * chirp[2 * k];
+    }
+}
+
+// Helper function to run a forward complex transform of x in place
+static void fft_execute(const FFTPlan *plan, float *x, float *work, int parallel) {
+    if (plan->m > 0) {
+        bluestein_execute(plan, x, work, parallel);
+        return;
+    }
+
+    float *src = x, *dst = work;
+    size_t len = (size_t)plan->n, s = 1;
+    const float *tw = plan->twiddles;
+    for (int f = 0; f < plan->nfactors; f++) {
+        int p = plan->factors[f];
+        size_t m = len / p;
+        switch (p) {
+            case 2: pass2(src, dst, s, m, tw, parallel); break;
+            case 3: pass3(src, dst, s, m, tw, parallel); break;
+            case 4: pass4(src, dst, s, m, tw, parallel); break;
+            case 5: pass5(src, dst, s, m, tw, parallel); break;
+            default: pass_generic(src, dst, s, m, p, tw, parallel); break;
+        }
+        tw += 2 * (size_t)(p - 1) * m;
+        len = m;
+        s *= p;
+        float *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != x) memcpy(x, src, 2 * (size_t)plan->n * sizeof(float));
+}
+
+static void free_plan(FFTPlan *plan) {
+    free(plan->twiddles);
+    free(plan->chirp);
+    free(plan->chirp_fft);
+    free(plan->real_twiddles);
+    free(plan);
+}
+
+// Helper function to fill table[k] = e^(-2 pi i k / n), k = 0 .. count - 1
+static void fill_roots(float *table, size_t count, size_t n) {
+    for (size_t k = 0; k < count; k++) {
+        double angle = -2.0 * FFT_PI * (double)(k % n) / (double)n;
+        table[2 * k] = (float)cos(angle);
+        table[2 * k + 1] = (float)sin(angle);
+    }
+}
+
+// Helper function to find or build a plan; the caller holds the fft_plan_cache lock
+static const FFTPlan *build_plan(int n, int real) {
+    for (FFTPlan *p = plan_cache; p; p = p->next) {
+        if (p->n == n && p->real == real) return p;
+    }
+
+    FFTPlan *plan = (FFTPlan*)calloc(1, sizeof(FFTPlan));
+    if (!plan) return NULL;
+    plan->n = n;
+    plan->real = real;
+
+    if (real) {
+        // Even lengths pack the signal into a complex sequence of half the length
+        int even = n % 2 == 0;
+        plan->inner = build_plan(even ? n / 2 : n, 0);
+        if (!plan->inner) {
+            free_plan(plan);
+            return NULL;
+        }
+        plan->work = plan->inner->work;
+        if (even) {
+            plan->real_twiddles = (float*)malloc(2 * ((size_t)n / 2 + 1) * sizeof(float));
+            if (!plan->real_twiddles) {
+                free_plan(plan);
+                return NULL;
+            }
+            fill_roots(plan->real_twiddles, (size_t)n / 2 + 1, (size_t)n);
+        }
+    } else {
+        int rem = n;
+        while (rem % 4 == 0) plan->factors[plan->nfactors++] = 4, rem /= 4;
+        while (rem % 2 == 0) plan->factors[plan->nfactors++] = 2, rem /= 2;
+        for (int r = 3; r <= FFT_MAX_RADIX; r += 2) {
+            while (rem % r == 0) plan->factors[plan->nfactors++] = r, rem /= r;
+        }
+
+        if (rem == 1) {
+            size_t total = 0, len = (size_t)n;
+            for (int f = 0; f < plan->nfactors; f++) {
+                total += 2 * (len / plan->factors[f]) * (plan->factors[f] - 1);
+                len /= plan->factors[f];
+            }
+            plan->twiddles = (float*)malloc((total > 0 ? total : 1) * sizeof(float));
+            if (!plan->twiddles) {
+                free_plan(plan);
+                return NULL;
+            }
+            float *tw = plan->twiddles;
+            len = (size_t)n;
+            for (int f = 0; f < plan->nfactors; f++) {
+                size_t p = (size_t)plan->factors[f], m = len / p;
+                for (size_t j = 0; j < m; j++) {
+                    for (size_t k = 1; k < p; k++) {
+                        double angle = -2.0 * FFT_PI * (double)((j * k) % len) / (double)len;
+                        *tw++ = (float)cos(angle);
+                        *tw++ = (float)sin(angle);
+                    }
+                }
+                len = m;
+            }
+            plan->work = 2 * (size_t)n;
+        } else {
+            // Bluestein: chirp z-transform through a power-of-two circular convolution
+            size_t m = 1;
+            while (m < 2 * (size_t)n - 1) m *= 2;
+            plan->nfactors = 0;
+            plan->m = (int)m;
+            plan->inner = build_plan((int)m, 0);
+            plan->chirp = (float*)malloc(2 * (size_t)n * sizeof(float));
+            plan->chirp_fft = (float*)calloc(2 * m, sizeof(float));
+            float *scratch = plan->inner ? (float*)malloc(plan->inner->work * sizeof(float)) : NULL;
+            if (!plan->inner || !plan->chirp || !plan->chirp_fft || !scratch) {
+                free(scratch);
+                free_plan(plan);
+                return NULL;
+            }
+            for (size_t k = 0; k < (size_t)n; k++) {
+                double angle = -FFT_PI * (double)((k * k) % (2 * (size_t)n)) / (double)n;
+                plan->chirp[2 * k] = (float)cos(angle);
+                plan->chirp[2 * k + 1] = (float)sin(angle);
+            }
+            float *b = plan->chirp_fft;
+            for (size_t k = 0; k < (size_t)n; k++) {
+                b[2 * k] = plan->chirp[2 * k];
+                b[2 * k + 1] = -plan->chirp[2 * k + 1];
+                if (k > 0) {
+                    b[2 * (m - k)] = b[2 * k];
+                    b[2 * (m - k) + 1] = b[2 * k + 1];
+                }
+            }
+            fft_execute(plan->inner, b, scratch, 0);
+            free(scratch);
+            plan->work = 2 * m + plan->inner->work;
+        }
+    }
+
+    plan->next = plan_cache;
+    plan_cache = plan;
+    return plan;
+}
+
+static const FFTPlan *get_plan(int n, int real) {
+    const FFTPlan *plan;
+#ifdef _OPENMP
+    #pragma omp critical (fft_plan_cache)
+#endif
+    plan = build_plan(n, real);
+    return plan;
+}
+
+// Function to free every cached plan
+void fft_clear_plan_cache(void) {
+#ifdef _OPENMP
+    #pragma omp critical (fft_plan_cache)
+#endif
+    {
+        while (plan_cache) {
+            FFTPlan *next = plan_cache->next;
+            free_plan(plan_cache);
+            plan_cache = next;
+        }
+    }
+}
+
+typedef enum {
+    FFT_COMPLEX_FORWARD,
+    FFT_COMPLEX_INVERSE,
+    FFT_REAL_FORWARD,
+    FFT_REAL_INVERSE
+} FFTKind;
+
+// Even real transforms: spectrum term k from the half-length transform values
+// a = Z[k] and b = Z[h - k], with w = e^(-2 pi i k / n)
+static inline void real_combine(float *out, const float *a, const float *b, const float *w) {
+    float fer = 0.5f * (a[0] + b[0]), fei = 0.5f * (a[1] - b[1]);
+    float for_ = 0.5f * (a[1] + b[1]), foi = -0.5f * (a[0] - b[0]);
+    out[0] = fer + w[0] * for_ - w[1] * foi;
+    out[1] = fei + w[0] * foi + w[1] * for_;
+}
+
+// Inverse of real_combine: half-length value Z[k] from spectrum terms a = X[k] and b = X[h - k]
+static inline void real_split(float *out, const float *a, const float *b, const float *w) {
+    float fer = 0.5f * (a[0] + b[0]), fei = 0.5f * (a[1] - b[1]);
+    float dr = 0.5f * (a[0] - b[0]), di = 0.5f * (a[1] + b[1]);
+    float for_ = dr * w[0] + di * w[1], foi = di * w[0] - dr * w[1];  // d * conj(w)
+    out[0] = fer - foi;
+    out[1] = fei + for_;
+}
+
+// Helper function to transform one line held in buf (n values along the axis)
+static void transform_line(const FFTPlan *plan, FFTKind kind, float *buf, float *work, int n, int parallel) {
+    size_t h = (size_t)n / 2;
+    switch (kind) {
+        case FFT_COMPLEX_FORWARD:
+        case FFT_COMPLEX_INVERSE:
+            fft_execute(plan, buf, work, parallel);
+            break;
+        case FFT_REAL_FORWARD:
+            fft_execute(plan->inner, buf, work, parallel);
+            if (plan->real_twiddles) {
+                const float *w = plan->real_twiddles;
+                float z0[2] = {buf[0], buf[1]};
+                real_combine(buf, z0, z0, w);
+                real_combine(buf + 2 * h, z0, z0, w + 2 * h);
+                for (size_t k = 1; k <= h / 2; k++) {
+                    float a[2] = {buf[2 * k], buf[2 * k + 1]};
+                    float b[2] = {buf[2 * (h - k)], buf[2 * (h - k) + 1]};
+                    real_combine(buf + 2 * k, a, b, w + 2 * k);
+                    if (k != h - k) real_combine(buf + 2 * (h - k), b, a, w + 2 * (h - k));
+                }
+            }
+            break;
+        case FFT_REAL_INVERSE:
+            if (plan->real_twiddles) {
+                const float *w = plan->real_twiddles;
+                buf[1] = 0.0f;
+                buf[2 * h + 1] = 0.0f;
+                float x0[2] = {buf[0], buf[1]}, xh[2] = {buf[2 * h], buf[2 * h + 1]};
+                real_split(buf, x0, xh, w);
+                for (size_t k = 1; k <= h / 2; k++) {
+                    float a[2] = {buf[2 * k], buf[2 * k + 1]};
+                    float b[2] = {buf[2 * (h - k)], buf[2 * (h - k) + 1]};
+                    real_split(buf + 2 * k, a, b, w + 2 * k);
+                    if (k != h - k) real_split(buf + 2 * (h - k), b, a, w + 2 * (h - k));
+                }
+                // Inverse half-length transform by conjugation around a forward one
+                for (size_t k = 0; k < h; k++) buf[2 * k + 1] = -buf[2 * k + 1];
+                fft_execute(plan->inner, buf, work, parallel);
+                for (size_t k = 0; k < h; k++) buf[2 * k + 1] = -buf[2 * k + 1];
+            } else {
+                fft_execute(plan->inner, buf, work, parallel);
+            }
+            break;
+    }
+}
+
+// Helper function to run a transform over every line along an axis. The input has
+// in_len values along the axis and the output out_len; plan_len is the transform length.
+static ArrayError transform_lines(ArrayType *out, const ArrayType *a, int axis, const FFTPlan *plan,
+                                  FFTKind kind, int in_len, int out_len, int plan_len) {
+    size_t outer = 1, inner = 1;
+    for (int d = 0; d < axis; d++) outer *= a->shape[d];
+    for (int d = axis + 1; d < a->ndim; d++) inner *= a->shape[d];
+    size_t nlines = outer * inner;
+    if (nlines == 0) return ARRAY_SUCCESS;
+
+    int complex_in = a->dtype == ARRAY_DTYPE_COMPLEX64;
+    int complex_out = out->dtype == ARRAY_DTYPE_COMPLEX64;
+    int n = plan_len;
+    size_t h = (size_t)n / 2;
+    int inverse = kind == FFT_COMPLEX_INVERSE || kind == FFT_REAL_INVERSE;
+    // Even real inverses run a half-length transform, so they are scaled by 1 / h
+    float scale = inverse ? 1.0f / (float)(kind == FFT_REAL_INVERSE && plan->real_twiddles ? h : (size_t)n) : 1.0f;
+
+    // Number of complex values the line buffer holds before the transform
+    size_t span = (size_t)(in_len > out_len ? in_len : out_len);
+    span = span > (size_t)n ? span : (size_t)n;
+    size_t line_floats = 2 * span + 2;
+    size_t per_thread = line_floats + plan->work;
+
+    int parallel_lines = nlines > 1 && nlines * (size_t)n >= ARRAY_PARALLEL_THRESHOLD;
+    int parallel_passes = nlines == 1 && n >= FFT_PARALLEL_LENGTH;
+    int nthreads = parallel_lines ? thread_count() : 1;
+    float *buffers = (float*)malloc((size_t)nthreads * per_thread * sizeof(float));
+    if (!buffers) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads) if (parallel_lines)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        float *buf = buffers + (size_t)tid * per_thread;
+        float *work = buf + line_floats;
+
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (size_t t = 0; t < nlines; t++) {
+            size_t o = t / inner, i = t % inner;
+            const float *src = a->data + (o * in_len * inner + i) * (complex_in ? 2 : 1);
+            float *dst = out->data + (o * out_len * inner + i) * (complex_out ? 2 : 1);
+
+            // Gather the line: complex values, or for even real forward transforms the
+            // real values packed as n / 2 complex ones
+            if (kind == FFT_REAL_FORWARD && plan->real_twiddles) {
+                for (int k = 0; k < n; k++) buf[k] = src[k * inner];
+            } else if (kind == FFT_REAL_INVERSE) {
+                size_t terms = plan->real_twiddles ? h + 1 : (size_t)n / 2 + 1;
+                for (size_t k = 0; k < terms; k++) {
+                    int have = k < (size_t)in_len;
+                    buf[2 * k] = have ? src[2 * k * inner] : 0.0f;
+                    buf[2 * k + 1] = have ? src[2 * k * inner + 1] : 0.0f;
+                }
+                if (!plan->real_twiddles) {
+                    // Odd length: rebuild the full Hermitian spectrum, conjugated for the inverse
+                    buf[1] = 0.0f;
+                    for (size_t k = 1; k < terms; k++) {
+                        buf[2 * (n - k)] = buf[2 * k];
+                        buf[2 * (n - k) + 1] = buf[2 * k + 1];
+                        buf[2 * k + 1] = -buf[2 * k + 1];
+                    }
+                }
+            } else {
+                for (int k = 0; k < n; k++) {
+                    buf[2 * k] = complex_in ? src[2 * (size_t)k * inner] : src[(size_t)k * inner];
+                    float im = complex_in ? src[2 * (size_t)k * inner + 1] : 0.0f;
+                    buf[2 * k + 1] = inverse ? -im : im;
+                }
+            }
+
+            transform_line(plan, kind, buf, work, n, parallel_passes);
+
+            // Scatter the line, undoing the input conjugation of the inverse transforms
+            if (!complex_out) {
+                if (plan->real_twiddles) {
+                    for (int k = 0; k < n; k++) dst[k * inner] = buf[k] * scale;
+                } else {
+                    for (int k = 0; k < n; k++) dst[k * inner] = buf[2 * k] * scale;
+                }
+            } else {
+                for (int k = 0; k < out_len; k++) {
+                    dst[2 * (size_t)k * inner] = buf[2 * k] * scale;
+                    dst[2 * (size_t)k * inner + 1] = (inverse ? -buf[2 * k + 1] : buf[2 * k + 1]) * scale;
+                }
+            }
+        }
+    }
+
+    free(buffers);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function shared by the transforms: validation, plan lookup and result setup
+static ArrayError run_transform(ArrayType **result, const ArrayType *a, int axis, FFTKind kind, int n) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32 && a->dtype != ARRAY_DTYPE_COMPLEX64) return ARRAY_ERROR_INVALID_DTYPE;
+    if (kind == FFT_REAL_FORWARD && a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (kind == FFT_REAL_INVERSE && a->dtype != ARRAY_DTYPE_COMPLEX64) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    int in_len = a->shape[axis];
+    int out_len = in_len;
+    if (kind == FFT_REAL_FORWARD) {
+        n = in_len;
+        out_len = n / 2 + 1;
+    } else if (kind == FFT_REAL_INVERSE) {
+        if (n <= 0) n = 2 * (in_len - 1);
+        out_len = n;
+    } else {
+        n = in_len;
+    }
+    if (n <= 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    const FFTPlan *plan = get_plan(n, kind == FFT_REAL_FORWARD || kind == FFT_REAL_INVERSE);
+    if (!plan) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(shape, a->shape, a->ndim * sizeof(int));
+    shape[axis] = out_len;
+    ArrayDType dtype = kind == FFT_REAL_INVERSE ? ARRAY_DTYPE_FLOAT32 : ARRAY_DTYPE_COMPLEX64;
+    // Resizing or retyping the result would free a before it is read
+    if (*result == a && (dtype != a->dtype || out_len != in_len)) return ARRAY_ERROR_INVALID_ARGUMENT;
+    ArrayError error = prepare_result_dtype(result, shape, a->ndim, dtype);
+    if (error != ARRAY_SUCCESS) return error;
+    return transform_lines(*result, a, axis, plan, kind, in_len, out_len, n);
+}
+
+// Function to compute the discrete Fourier transform along an axis
+ArrayError fft_array(ArrayType **result, const ArrayType *a, int axis) {
+    return run_transform(result, a, axis, FFT_COMPLEX_FORWARD, 0);
+}
+
+// Function to compute the inverse discrete Fourier transform along an axis
+ArrayError ifft_array(ArrayType **result, const ArrayType *a, int axis) {
+    return run_transform(result, a, axis, FFT_COMPLEX_INVERSE, 0);
+}
+
+// Function to compute the transform of real input along an axis
+ArrayError rfft_array(ArrayType **result, const ArrayType *a, int axis) {
+    return run_transform(result, a, axis, FFT_REAL_FORWARD, 0);
+}
+
+// Function to compute the real inverse of rfft_array along an axis
+ArrayError irfft_array(ArrayType **result, const ArrayType *a, int n, int axis) {
+    return run_transform(result, a, axis, FFT_REAL_INVERSE, n);
+}
@@ -0,0 +1,263 @@
+#include "gemm.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Register block computed by the micro-kernel: GEMM_MR rows by GEMM_NR columns of C
+#define GEMM_MR 6
+#define GEMM_NR 16
+
+// Cache blocking: an MC x KC block of A stays in L2, a KC x NC panel of B in L3
+#define GEMM_MC 120
+#define GEMM_KC 256
+#define GEMM_NC 4096
+
+// Width of the column tiles of C handed to threads, a multiple of GEMM_NR
+#define GEMM_TILE_N 256
+
+#if defined(__GNUC__)
+#define GEMM_INLINE static inline __attribute__((always_inline))
+#else
+#define GEMM_INLINE static inline
+#endif
+
+// Micro-kernel: C[mr x nr] += alpha * Ap * Bp, where Ap holds kc columns of GEMM_MR
+// packed rows and Bp kc rows of GEMM_NR packed columns. Edge tiles are zero-padded
+// in the packed buffers, so the accumulation always runs on the full register block.
+GEMM_INLINE void gemm_micro_body(int kc, const float *ap, const float *bp, float *c, int ldc,
+                                 int mr, int nr, float alpha, int fused) {
+    float acc[GEMM_MR][GEMM_NR] = {{0.0f}};
+    for (int p = 0; p < kc; p++) {
+        const float *brow = bp + (size_t)p * GEMM_NR;
+        const float *acol = ap + (size_t)p * GEMM_MR;
+        for (int i = 0; i < GEMM_MR; i++) {
+            float ai = acol[i];
+            ARRAY_OMP_SIMD
+            for (int j = 0; j < GEMM_NR; j++) {
+                acc[i][j] = fused ? fmaf(ai, brow[j], acc[i][j]) : acc[i][j] + ai * brow[j];
+            }
+        }
+    }
+    for (int i = 0; i < mr; i++) {
+        for (int j = 0; j < nr; j++) c[(size_t)i * ldc + j] += alpha * acc[i][j];
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEMM_FMA_DISPATCH 1
+__attribute__((target("avx2,fma")))
+static void gemm_micro_hw(int kc, const float *ap, const float *bp, float *c, int ldc,
+                          int mr, int nr, float alpha) {
+    gemm_micro_body(kc, ap, bp, c, ldc, mr, nr, alpha, 1);
+}
+#endif
+
+static void gemm_micro(int kc, const float *ap, const float *bp, float *c, int ldc,
+                       int mr, int nr, float alpha) {
+    gemm_micro_body(kc, ap, bp, c, ldc, mr, nr, alpha, 0);
+}
+
+typedef void (*MicroKernel)(int kc, const float *ap, const float *bp, float *c, int ldc,
+                            int mr, int nr, float alpha);
+
+// Helper function to pack rows [i0, i0 + mc) and columns [p0, p0 + kc) of op(A)
+// into strips of GEMM_MR rows, stored column by column
+static void pack_a(float *dst, const float *a, int lda, GemmTranspose trans,
+                   int i0, int mc, int p0, int kc) {
+    for (int ir = 0; ir < mc; ir += GEMM_MR) {
+        int mr = (mc - ir < GEMM_MR) ? mc - ir : GEMM_MR;
+        for (int p = 0; p < kc; p++) {
+            for (int i = 0; i < GEMM_MR; i++) {
+                size_t row = (size_t)(i0 + ir + i), col = (size_t)(p0 + p);
+                float v = 0.0f;
+                if (i < mr) v = trans ? a[col * lda + row] : a[row * lda + col];
+                dst[i] = v;
+            }
+            dst += GEMM_MR;
+        }
+    }
+}
+
+// Helper function to pack one strip of GEMM_NR columns starting at j0 of rows
+// [p0, p0 + kc) of op(B), stored row by row
+static void pack_b_strip(float *dst, const float *b, int ldb, GemmTranspose trans,
+                         int p0, int kc, int j0, int nr) {
+    for (int p = 0; p < kc; p++) {
+        size_t row = (size_t)(p0 + p);
+        if (!trans && nr == GEMM_NR) {
+            memcpy(dst, b + row * ldb + j0, GEMM_NR * sizeof(float));
+        } else {
+            for (int j = 0; j < GEMM_NR; j++) {
+                size_t col = (size_t)(j0 + j);
+                dst[j] = j < nr ? (trans ? b[col * ldb + row] : b[row * ldb + col]) : 0.0f;
+            }
+        }
+        dst += GEMM_NR;
+    }
+}
+
+// Helper function to apply beta to C before the products are accumulated into it
+static void scale_c(float *c, int ldc, int m, int n, float beta, int parallel) {
+    if (beta == 1.0f) return;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (parallel)
+#endif
+    for (int i = 0; i < m; i++) {
+        float *row = c + (size_t)i * ldc;
+        if (beta == 0.0f) {
+            memset(row, 0, (size_t)n * sizeof(float));
+        } else {
+            ARRAY_OMP_SIMD
+            for (int j = 0; j < n; j++) row[j] *= beta;
+        }
+    }
+    (void)parallel;
+}
+
+// Function to multiply row-major matrices with packing and cache blocking
+ArrayError sgemm(GemmTranspose trans_a, GemmTranspose trans_b, int m, int n, int k,
+                 float alpha, const float *a, int lda, const float *b, int ldb,
+                 float beta, float *c, int ldc) {
+    if (m < 0 || n < 0 || k < 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (m == 0 || n == 0) return ARRAY_SUCCESS;
+    if (!c || (k > 0 && (!a || !b))) return ARRAY_ERROR_NULL_POINTER;
+    if (ldc < n || lda < (trans_a ? m : k) || ldb < (trans_b ? k : n)) {
+        return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    if (!omp_in_parallel()) nthreads = omp_get_max_threads();
+#endif
+    double work = (double)m * n * (k > 0 ? k : 1);
+    int parallel = nthreads > 1 && work >= (double)ARRAY_PARALLEL_THRESHOLD * 64;
+    if (!parallel) nthreads = 1;
+
+    scale_c(c, ldc, m, n, beta, parallel);
+    if (k == 0 || alpha == 0.0f) return ARRAY_SUCCESS;
+
+    MicroKernel micro = gemm_micro;
+#ifdef GEMM_FMA_DISPATCH
+    if (__builtin_cpu_supports("fma")) micro = gemm_micro_hw;
+#endif
+
+    // Packed buffers sized for this problem rather than the largest possible blocks
+    int kc_max = k < GEMM_KC ? k : GEMM_KC;
+    int nc_max = n < GEMM_NC ? n : GEMM_NC;
+    int mc_max = m < GEMM_MC ? m : GEMM_MC;
+    size_t b_panel = (size_t)kc_max * ((nc_max + GEMM_NR - 1) / GEMM_NR) * GEMM_NR;
+    size_t a_block = (size_t)kc_max * ((mc_max + GEMM_MR - 1) / GEMM_MR) * GEMM_MR;
+    float *bp = (float*)malloc(b_panel * sizeof(float));
+    float *ap = (float*)malloc(a_block * nthreads * sizeof(float));
+    if (!bp || !ap) {
+        free(bp);
+        free(ap);
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads) if (parallel)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        float *my_ap = ap + (size_t)tid * a_block;
+
+        for (int jc = 0; jc < n; jc += GEMM_NC) {
+            int nc = (n - jc < GEMM_NC) ? n - jc : GEMM_NC;
+            int nstrips = (nc + GEMM_NR - 1) / GEMM_NR;
+            int mblocks = (m + GEMM_MC - 1) / GEMM_MC;
+            int ntiles_n = (nc + GEMM_TILE_N - 1) / GEMM_TILE_N;
+
+            for (int pc = 0; pc < k; pc += GEMM_KC) {
+                int kc = (k - pc < GEMM_KC) ? k - pc : GEMM_KC;
+
+#ifdef _OPENMP
+                #pragma omp for schedule(static)
+#endif
+                for (int s = 0; s < nstrips; s++) {
+                    int j0 = s * GEMM_NR;
+                    int nr = (nc - j0 < GEMM_NR) ? nc - j0 : GEMM_NR;
+                    pack_b_strip(bp + (size_t)s * kc * GEMM_NR, b, ldb, trans_b, pc, kc, jc + j0, nr);
+                }
+
+                // Each tile is one MC block of rows by one GEMM_TILE_N block of columns
+#ifdef _OPENMP
+                #pragma omp for schedule(dynamic)
+#endif
+                for (int t = 0; t < mblocks * ntiles_n; t++) {
+                    int ic = (t / ntiles_n) * GEMM_MC;
+                    int jt = (t % ntiles_n) * GEMM_TILE_N;
+                    int mc = (m - ic < GEMM_MC) ? m - ic : GEMM_MC;
+                    int jt_end = (nc - jt < GEMM_TILE_N) ? nc : jt + GEMM_TILE_N;
+                    pack_a(my_ap, a, lda, trans_a, ic, mc, pc, kc);
+
+                    for (int jr = jt; jr < jt_end; jr += GEMM_NR) {
+                        int nr = (jt_end - jr < GEMM_NR) ? jt_end - jr : GEMM_NR;
+                        const float *bstrip = bp + (size_t)(jr / GEMM_NR) * kc * GEMM_NR;
+                        for (int ir = 0; ir < mc; ir += GEMM_MR) {
+                            int mr = (mc - ir < GEMM_MR) ? mc - ir : GEMM_MR;
+                            float *ctile = c + (size_t)(ic + ir) * ldc + jc + jr;
+                            micro(kc, my_ap + (size_t)ir * kc, bstrip, ctile, ldc, mr, nr, alpha);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    free(bp);
+    free(ap);
+    return ARRAY_SUCCESS;
+}
+
+// Function to multiply (stacks of) matrices
+ArrayError matmul_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b) {
+    if (!result || !a || !b) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a || *result == b) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32 || b->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view || b->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->ndim < 2 || b->ndim < 2) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    int m = a->shape[a->ndim - 2], k = a->shape[a->ndim - 1];
+    int n = b->shape[b->ndim - 1];
+    if (b->shape[b->ndim - 2] != k) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    // b is either shared by every matrix of a or has the same leading dimensions
+    int shared = b->ndim == 2;
+    if (!shared) {
+        if (b->ndim != a->ndim) return ARRAY_ERROR_INVALID_DIMENSION;
+        for (int d = 0; d < a->ndim - 2; d++) {
+            if (a->shape[d] != b->shape[d]) return ARRAY_ERROR_INVALID_DIMENSION;
+        }
+    }
+
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(shape, a->shape, a->ndim * sizeof(int));
+    shape[a->ndim - 1] = n;
+    ArrayError error = prepare_result(result, shape, a->ndim);
+    if (error != ARRAY_SUCCESS) return error;
+
+    size_t batch = 1;
+    for (int d = 0; d < a->ndim - 2; d++) batch *= a->shape[d];
+    if (shared && batch > 1) {
+        // A shared right operand turns the stack into one tall matrix product
+        return sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, (int)(batch * m), n, k, 1.0f,
+                     a->data, k, b->data, n, 0.0f, (*result)->data, n);
+    }
+
+    for (size_t s = 0; s < batch; s++) {
+        error = sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, m, n, k, 1.0f,
+                      a->data + s * m * k, k, b->data + (shared ? 0 : s * k * n), n,
+                      0.0f, (*result)->data + s * m * n, n);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+    return ARRAY_SUCCESS;
+}
@@ -0,0 +1,295 @@
+#include "histogram.h"
+#include "parallel.h"
+#include "sort.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Number of bin indices computed per vectorized batch
+#define HISTOGRAM_BATCH 256
+
+// Largest total size, in bins, of the per-thread histograms; beyond it counting uses atomics
+#define HISTOGRAM_PRIVATE_MAX (1 << 24)
+
+// Kernel computing the bin of each element of a batch, or -1 for elements that are not counted
+typedef void (*BinKernel)(int *bins, const float *in, size_t n, const void *ctx);
+
+// Helper function to count the elements of an array into bins chosen by a kernel
+static ArrayError count_bins(size_t *counts, size_t nbins, const ArrayType *a, BinKernel kernel, const void *ctx) {
+    size_t n = a->size;
+    size_t nbatches = (n + HISTOGRAM_BATCH - 1) / HISTOGRAM_BATCH;
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    memset(counts, 0, nbins * sizeof(size_t));
+
+    if (nthreads == 1 || n < ARRAY_PARALLEL_THRESHOLD) {
+        int bins[HISTOGRAM_BATCH];
+        for (size_t batch = 0; batch < nbatches; batch++) {
+            size_t start = batch * HISTOGRAM_BATCH;
+            size_t len = (n - start < HISTOGRAM_BATCH) ? n - start : HISTOGRAM_BATCH;
+            kernel(bins, a->data + start, len, ctx);
+            for (size_t i = 0; i < len; i++) {
+                if (bins[i] >= 0) counts[bins[i]]++;
+            }
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    size_t *partial = NULL;
+    if ((size_t)nthreads * nbins <= HISTOGRAM_PRIVATE_MAX) {
+        partial = (size_t*)calloc((size_t)nthreads * nbins, sizeof(size_t));
+        if (!partial) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        size_t *mine = partial ? partial + (size_t)tid * nbins : NULL;
+        int bins[HISTOGRAM_BATCH];
+
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (size_t batch = 0; batch < nbatches; batch++) {
+            size_t start = batch * HISTOGRAM_BATCH;
+            size_t len = (n - start < HISTOGRAM_BATCH) ? n - start : HISTOGRAM_BATCH;
+            kernel(bins, a->data + start, len, ctx);
+            if (mine) {
+                for (size_t i = 0; i < len; i++) {
+                    if (bins[i] >= 0) mine[bins[i]]++;
+                }
+            } else {
+                // Too many bins to replicate: sparse, rarely contended atomic increments
+                for (size_t i = 0; i < len; i++) {
+                    if (bins[i] < 0) continue;
+#ifdef _OPENMP
+                    #pragma omp atomic
+#endif
+                    counts[bins[i]]++;
+                }
+            }
+        }
+    }
+
+    if (partial) {
+        // Parallel merge: every bin sums its per-thread counts
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (nbins >= ARRAY_BLOCK_SIZE)
+#endif
+        for (size_t b = 0; b < nbins; b++) {
+            size_t sum = 0;
+            for (int t = 0; t < nthreads; t++) sum += partial[(size_t)t * nbins + b];
+            counts[b] = sum;
+        }
+        free(partial);
+    }
+    return ARRAY_SUCCESS;
+}
+
+typedef struct {
+    float lo;
+    float hi;
+    float scale;
+    int nbins;
+} UniformBins;
+
+static void uniform_bin_kernel(int *bins, const float *in, size_t n, const void *ctx) {
+    const UniformBins *u = (const UniformBins *)ctx;
+    float lo = u->lo, hi = u->hi, scale = u->scale;
+    int last = u->nbins - 1;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) {
+        float x = in[i];
+        int inside = x >= lo && x <= hi;
+        int b = (int)((inside ? x - lo : 0.0f) * scale);
+        b = b > last ? last : b;
+        bins[i] = inside ? b : -1;
+    }
+}
+
+typedef struct {
+    const float *edges;
+    int nedges;
+} EdgeBins;
+
+static void edge_bin_kernel(int *bins, const float *in, size_t n, const void *ctx) {
+    const EdgeBins *e = (const EdgeBins *)ctx;
+    const float *edges = e->edges;
+    int last = e->nedges - 1;
+    for (size_t i = 0; i < n; i++) {
+        float x = in[i];
+        if (!(x >= edges[0] && x <= edges[last])) {
+            bins[i] = -1;
+            continue;
+        }
+        // Number of edges <= x, found by binary search
+        int lo = 0, hi = last + 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (edges[mid] <= x) lo = mid + 1;
+            else hi = mid;
+        }
+        bins[i] = lo - 1 < last ? lo - 1 : last - 1;
+    }
+}
+
+static void integer_bin_kernel(int *bins, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) bins[i] = (int)in[i];
+}
+
+// Helper function to (re)allocate a count buffer
+static ArrayError prepare_counts(size_t **counts, size_t n) {
+    free(*counts);
+    *counts = (size_t*)malloc((n > 0 ? n : 1) * sizeof(size_t));
+    return *counts ? ARRAY_SUCCESS : ARRAY_ERROR_MEMORY_ALLOCATION;
+}
+
+// Function to count occurrences of non-negative integers
+ArrayError bincount_array(size_t **counts, size_t *nbins, const ArrayType *a, size_t minlength) {
+    if (!counts || !nbins || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    // Validate the values and find the largest in one parallel pass
+    float max_value = -1.0f;
+    int bad = 0;
+#ifdef _OPENMP
+    #pragma omp parallel for reduction(max:max_value) reduction(|:bad) schedule(static) \
+        if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t i = 0; i < a->size; i++) {
+        float x = a->data[i];
+        bad |= !(x >= 0.0f && x < 2147483648.0f) || x != floorf(x);
+        max_value = x > max_value ? x : max_value;
+    }
+    if (bad) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    size_t needed = a->size > 0 ? (size_t)max_value + 1 : 0;
+    *nbins = needed > minlength ? needed : minlength;
+    ArrayError error = prepare_counts(counts, *nbins);
+    if (error != ARRAY_SUCCESS) return error;
+    return count_bins(*counts, *nbins, a, integer_bin_kernel, NULL);
+}
+
+// Function to count elements into equal-width bins
+ArrayError histogram_uniform(size_t *counts, int nbins, const ArrayType *a, float lo, float hi) {
+    if (!counts || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (nbins <= 0 || !(hi > lo) || isinf(hi - lo)) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    UniformBins u = {lo, hi, (float)nbins / (hi - lo), nbins};
+    return count_bins(counts, (size_t)nbins, a, uniform_bin_kernel, &u);
+}
+
+// Function to count elements between explicit bin edges
+ArrayError histogram_edges(size_t *counts, const float *edges, int nedges, const ArrayType *a) {
+    if (!counts || !edges || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (nedges < 2) return ARRAY_ERROR_INVALID_ARGUMENT;
+    for (int b = 1; b < nedges; b++) {
+        if (!(edges[b] > edges[b - 1])) return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+
+    EdgeBins e = {edges, nedges};
+    return count_bins(counts, (size_t)(nedges - 1), a, edge_bin_kernel, &e);
+}
+
+// Helper to compare sorted neighbours, treating all NaNs as one value
+static inline int same_value(float x, float y) {
+    return x == y || (x != x && y != y);
+}
+
+// Function to find the sorted unique values and their counts
+ArrayError unique_array(ArrayType **values, size_t **counts, const ArrayType *a) {
+    if (!values || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    // Sort a flattened view of the input
+    int flat_shape[] = {(int)a->size};
+    int flat_strides[] = {1};
+    ArrayType flat = *a;
+    flat.shape = flat_shape;
+    flat.strides = flat_strides;
+    flat.ndim = 1;
+
+    ArrayType *sorted = NULL;
+    ArrayError error = sort_array(&sorted, &flat, 0);
+    if (error != ARRAY_SUCCESS) return error;
+
+    // Run-length encode in two passes: count run starts per block, then write them
+    size_t n = sorted->size;
+    const float *s = sorted->data;
+    size_t nblocks = (n + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+    size_t *offsets = (size_t*)malloc((nblocks + 1) * sizeof(size_t));
+    size_t *starts = (size_t*)malloc((n + 1) * sizeof(size_t));
+    if (!offsets || !starts) {
+        free(offsets);
+        free(starts);
+        free_array(sorted);
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t begin = blk * ARRAY_BLOCK_SIZE;
+        size_t end = (n - begin < ARRAY_BLOCK_SIZE) ? n : begin + ARRAY_BLOCK_SIZE;
+        size_t runs = 0;
+        for (size_t i = begin; i < end; i++) runs += (i == 0 || !same_value(s[i], s[i - 1]));
+        offsets[blk] = runs;
+    }
+
+    size_t nunique = 0;
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t runs = offsets[blk];
+        offsets[blk] = nunique;
+        nunique += runs;
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t begin = blk * ARRAY_BLOCK_SIZE;
+        size_t end = (n - begin < ARRAY_BLOCK_SIZE) ? n : begin + ARRAY_BLOCK_SIZE;
+        size_t u = offsets[blk];
+        for (size_t i = begin; i < end; i++) {
+            if (i == 0 || !same_value(s[i], s[i - 1])) starts[u++] = i;
+        }
+    }
+    starts[nunique] = n;
+
+    int shape[] = {(int)nunique};
+    error = prepare_result(values, shape, 1);
+    if (error == ARRAY_SUCCESS && counts) {
+        error = prepare_counts(counts, nunique);
+    }
+    if (error == ARRAY_SUCCESS) {
+        for (size_t u = 0; u < nunique; u++) {
+            (*values)->data[u] = s[starts[u]];
+            if (counts) (*counts)[u] = starts[u + 1] - starts[u];
+        }
+    }
+
+    free(offsets);
+    free(starts);
+    free_array(sorted);
+    return error;
+}
@@ -0,0 +1,349 @@
+#include "indexing.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Slices at least this wide are scattered by column block instead of by index
+#define SCATTER_WIDE_SLICE 64
+
+// Largest target, in elements, that scatter_add_array replicates once per thread
+#define SCATTER_PRIVATE_MAX (1 << 20)
+
+// Geometry of an indexing operation: element (o, k, i) of an array is at
+// (o * len + k) * inner + i, where k runs along the indexed axis
+typedef struct {
+    size_t outer;
+    size_t len;
+    size_t inner;
+} AxisGeometry;
+
+static AxisGeometry axis_geometry(const ArrayType *a, int axis) {
+    AxisGeometry g = {1, (size_t)a->shape[axis], 1};
+    for (int d = 0; d < axis; d++) g.outer *= a->shape[d];
+    for (int d = axis + 1; d < a->ndim; d++) g.inner *= a->shape[d];
+    return g;
+}
+
+// Helper function to check every index against the axis length before any data moves
+static ArrayError validate_indices(const int *indices, size_t n, size_t len) {
+    int bad = 0;
+    long long limit = (long long)len;
+#ifdef _OPENMP
+    #pragma omp parallel for reduction(|:bad) schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t j = 0; j < n; j++) {
+        bad |= (indices[j] < -limit || indices[j] >= limit);
+    }
+    return bad ? ARRAY_ERROR_INVALID_ARGUMENT : ARRAY_SUCCESS;
+}
+
+static inline size_t wrap_index(int index, size_t len) {
+    return index < 0 ? (size_t)((long long)index + (long long)len) : (size_t)index;
+}
+
+// Helper function to check that values has the shape take_array would produce
+static int values_match(const ArrayType *a, const ArrayType *values, int axis, size_t n_indices) {
+    if (values->ndim != a->ndim) return 0;
+    for (int d = 0; d < a->ndim; d++) {
+        size_t expected = (d == axis) ? n_indices : (size_t)a->shape[d];
+        if ((size_t)values->shape[d] != expected) return 0;
+    }
+    return 1;
+}
+
+// Helper function for the argument checks shared by take, put and scatter_add
+static ArrayError check_indexing(const ArrayType *a, const int *indices, size_t n_indices, int *axis) {
+    if (!a || (!indices && n_indices > 0)) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    *axis = normalize_axis(*axis, a->ndim);
+    if (*axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (n_indices > (size_t)0x7fffffff) return ARRAY_ERROR_INVALID_ARGUMENT;
+    return validate_indices(indices, n_indices, (size_t)a->shape[*axis]);
+}
+
+// Function to gather slices along an axis
+ArrayError take_array(ArrayType **result, const ArrayType *a, const int *indices, size_t n_indices, int axis) {
+    if (!result) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    ArrayError error = check_indexing(a, indices, n_indices, &axis);
+    if (error != ARRAY_SUCCESS) return error;
+
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(shape, a->shape, a->ndim * sizeof(int));
+    shape[axis] = (int)n_indices;
+    error = prepare_result(result, shape, a->ndim);
+    if (error != ARRAY_SUCCESS) return error;
+
+    AxisGeometry g = axis_geometry(a, axis);
+    size_t ntasks = g.outer * n_indices;
+    const float *src = a->data;
+    float *out = (*result)->data;
+
+    if (g.inner == 1) {
+        // Element gather: independent loads, prefetched ahead of use
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (ntasks >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t t = 0; t < ntasks; t++) {
+            size_t o = t / n_indices, j = t % n_indices;
+            if (j + ARRAY_PREFETCH_DISTANCE < n_indices) {
+                ARRAY_PREFETCH(src + o * g.len + wrap_index(indices[j + ARRAY_PREFETCH_DISTANCE], g.len));
+            }
+            out[t] = src[o * g.len + wrap_index(indices[j], g.len)];
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    // Slice gather: one contiguous copy per index, e.g. one embedding row
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (ntasks * g.inner >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t t = 0; t < ntasks; t++) {
+        size_t o = t / n_indices, j = t % n_indices;
+        if (j + ARRAY_PREFETCH_DISTANCE < n_indices) {
+            ARRAY_PREFETCH(src + (o * g.len + wrap_index(indices[j + ARRAY_PREFETCH_DISTANCE], g.len)) * g.inner);
+        }
+        memcpy(out + t * g.inner, src + (o * g.len + wrap_index(indices[j], g.len)) * g.inner,
+               g.inner * sizeof(float));
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Function to write slices along an axis
+ArrayError put_array(ArrayType *a, const int *indices, size_t n_indices, const ArrayType *values, int axis) {
+    if (!values) return ARRAY_ERROR_NULL_POINTER;
+    if (values == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (values->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (values->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    ArrayError error = check_indexing(a, indices, n_indices, &axis);
+    if (error != ARRAY_SUCCESS) return error;
+    if (!values_match(a, values, axis, n_indices)) return ARRAY_ERROR_INVALID_DIMENSION;
+    error = array_make_writable(a);
+    if (error != ARRAY_SUCCESS) return error;
+
+    AxisGeometry g = axis_geometry(a, axis);
+    size_t ntasks = g.outer * n_indices;
+    const float *src = values->data;
+    float *dst = a->data;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (ntasks * g.inner >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t t = 0; t < ntasks; t++) {
+        size_t o = t / n_indices, j = t % n_indices;
+        memcpy(dst + (o * g.len + wrap_index(indices[j], g.len)) * g.inner, src + t * g.inner,
+               g.inner * sizeof(float));
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Helper function for scatter_add in deterministic mode: a stable counting sort groups
+// the slices by target row, and each target row is accumulated by one thread in index
+// order, exactly as the serial loop does
+static ArrayError scatter_add_grouped(float *dst, const float *src, const int *indices, size_t n_indices,
+                                      AxisGeometry g) {
+    size_t nrows = g.outer * g.len;
+    size_t ntasks = g.outer * n_indices;
+    size_t *ends = (size_t*)calloc(nrows + 1, sizeof(size_t));
+    size_t *order = (size_t*)malloc((ntasks ? ntasks : 1) * sizeof(size_t));
+    if (!ends || !order) {
+        free(ends);
+        free(order);
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+    // Counts, then their prefix sums, then the placement moves each start to its end
+    for (size_t t = 0; t < ntasks; t++) {
+        ends[(t / n_indices) * g.len + wrap_index(indices[t % n_indices], g.len) + 1]++;
+    }
+    for (size_t r = 0; r < nrows; r++) ends[r + 1] += ends[r];
+    for (size_t t = 0; t < ntasks; t++) {
+        order[ends[(t / n_indices) * g.len + wrap_index(indices[t % n_indices], g.len)]++] = t;
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (size_t r = 0; r < nrows; r++) {
+        float *row = dst + r * g.inner;
+        for (size_t p = r ? ends[r - 1] : 0; p < ends[r]; p++) {
+            const float *v = src + order[p] * g.inner;
+            for (size_t i = 0; i < g.inner; i++) row[i] += v[i];
+        }
+    }
+
+    free(ends);
+    free(order);
+    return ARRAY_SUCCESS;
+}
+
+// Function to accumulate slices along an axis
+ArrayError scatter_add_array(ArrayType *a, const int *indices, size_t n_indices, const ArrayType *values, int axis) {
+    if (!values) return ARRAY_ERROR_NULL_POINTER;
+    if (values == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (values->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (values->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    ArrayError error = check_indexing(a, indices, n_indices, &axis);
+    if (error != ARRAY_SUCCESS) return error;
+    if (!values_match(a, values, axis, n_indices)) return ARRAY_ERROR_INVALID_DIMENSION;
+    error = array_make_writable(a);
+    if (error != ARRAY_SUCCESS) return error;
+
+    AxisGeometry g = axis_geometry(a, axis);
+    size_t ntasks = g.outer * n_indices;
+    size_t work = ntasks * g.inner;
+    const float *src = values->data;
+    float *dst = a->data;
+
+    if (g.inner >= SCATTER_WIDE_SLICE) {
+        // Each thread owns a block of columns, so repeated indices never collide
+        size_t col_blocks = (g.inner + SCATTER_WIDE_SLICE - 1) / SCATTER_WIDE_SLICE;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (work >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t task = 0; task < g.outer * col_blocks; task++) {
+            size_t o = task / col_blocks;
+            size_t c0 = (task % col_blocks) * SCATTER_WIDE_SLICE;
+            size_t width = (g.inner - c0 < SCATTER_WIDE_SLICE) ? g.inner - c0 : SCATTER_WIDE_SLICE;
+            for (size_t j = 0; j < n_indices; j++) {
+                float *row = dst + (o * g.len + wrap_index(indices[j], g.len)) * g.inner + c0;
+                const float *v = src + (o * n_indices + j) * g.inner + c0;
+                ARRAY_OMP_SIMD
+                for (size_t i = 0; i < width; i++) row[i] += v[i];
+            }
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    if (nthreads == 1 || work < ARRAY_PARALLEL_THRESHOLD) {
+        for (size_t t = 0; t < ntasks; t++) {
+            size_t o = t / n_indices, j = t % n_indices;
+            float *row = dst + (o * g.len + wrap_index(indices[j], g.len)) * g.inner;
+            for (size_t i = 0; i < g.inner; i++) row[i] += src[t * g.inner + i];
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    if (array_get_deterministic()) return scatter_add_grouped(dst, src, indices, n_indices, g);
+
+    if (a->size <= SCATTER_PRIVATE_MAX) {
+        // Privatized accumulation: one zeroed copy of the target per thread, summed at the end
+        float *partial = (float*)calloc((size_t)nthreads * a->size, sizeof(float));
+        if (!partial) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            float *mine = partial + (size_t)tid * a->size;
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (size_t t = 0; t < ntasks; t++) {
+                size_t o = t / n_indices, j = t % n_indices;
+                float *row = mine + (o * g.len + wrap_index(indices[j], g.len)) * g.inner;
+                for (size_t i = 0; i < g.inner; i++) row[i] += src[t * g.inner + i];
+            }
+        }
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t e = 0; e < a->size; e++) {
+            float sum = dst[e];
+            for (int t = 0; t < nthreads; t++) sum += partial[(size_t)t * a->size + e];
+            dst[e] = sum;
+        }
+        free(partial);
+        return ARRAY_SUCCESS;
+    }
+
+    // Target too large to replicate: atomic updates, which rarely contend on a large target
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (size_t t = 0; t < ntasks; t++) {
+        size_t o = t / n_indices, j = t % n_indices;
+        float *row = dst + (o * g.len + wrap_index(indices[j], g.len)) * g.inner;
+        for (size_t i = 0; i < g.inner; i++) {
+#ifdef _OPENMP
+            #pragma omp atomic
+#endif
+            row[i] += src[t * g.inner + i];
+        }
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Function to select the elements where a mask is non-zero
+ArrayError compress_array(ArrayType **result, const ArrayType *a, const ArrayType *mask) {
+    if (!result || !a || !mask) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a || *result == mask) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32 || mask->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view || mask->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (mask->ndim != a->ndim || memcmp(mask->shape, a->shape, a->ndim * sizeof(int)) != 0) {
+        return ARRAY_ERROR_INVALID_DIMENSION;
+    }
+
+    // Pass 1: count the selected elements of every block
+    size_t n = a->size;
+    size_t nblocks = (n + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+    size_t *offsets = (size_t*)malloc((nblocks + 1) * sizeof(size_t));
+    if (!offsets) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t start = blk * ARRAY_BLOCK_SIZE;
+        size_t len = (n - start < ARRAY_BLOCK_SIZE) ? n - start : ARRAY_BLOCK_SIZE;
+        size_t count = 0;
+        ARRAY_OMP_SIMD_REDUCTION(+:count)
+        for (size_t i = 0; i < len; i++) count += (mask->data[start + i] != 0.0f);
+        offsets[blk] = count;
+    }
+
+    size_t total = 0;
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t count = offsets[blk];
+        offsets[blk] = total;
+        total += count;
+    }
+
+    int shape[] = {(int)total};
+    ArrayError error = prepare_result(result, shape, 1);
+    if (error != ARRAY_SUCCESS) {
+        free(offsets);
+        return error;
+    }
+
+    // Pass 2: every block writes its selection at its offset
+    float *out = (*result)->data;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        size_t start = blk * ARRAY_BLOCK_SIZE;
+        size_t len = (n - start < ARRAY_BLOCK_SIZE) ? n - start : ARRAY_BLOCK_SIZE;
+        float *dst = out + offsets[blk];
+        for (size_t i = 0; i < len; i++) {
+            if (mask->data[start + i] != 0.0f) *dst++ = a->data[start + i];
+        }
+    }
+
+    free(offsets);
+    return ARRAY_SUCCESS;
+}
@@ -0,0 +1,461 @@
+#include "interop.h"
+#include "masked.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TENSOR_EXTENSION_NAME "arrow.fixed_shape_tensor"
+#define EXTENSION_NAME_KEY "ARROW:extension:name"
+#define EXTENSION_METADATA_KEY "ARROW:extension:metadata"
+
+// Exported DLPack tensor together with the reference keeping its buffer alive
+typedef struct {
+    DLManagedTensor tensor;
+    ArrayType *handle;
+    int64_t shape[ARRAY_MAX_DIMS];
+    int64_t strides[ARRAY_MAX_DIMS];
+} DLPackExport;
+
+static void dlpack_deleter(DLManagedTensor *self) {
+    DLPackExport *export = (DLPackExport*)self->manager_ctx;
+    free_array(export->handle);
+    free(export);
+}
+
+// Function to export an array as a DLPack tensor
+ArrayError array_to_dlpack(const ArrayType *a, DLManagedTensor **out) {
+    if (!a || !out) return ARRAY_ERROR_NULL_POINTER;
+    DLPackExport *export = (DLPackExport*)calloc(1, sizeof(DLPackExport));
+    if (!export) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+    ArrayError error;
+    export->handle = array_share(a, &error);
+    if (!export->handle) {
+        free(export);
+        return error;
+    }
+    for (int i = 0; i < a->ndim; i++) {
+        export->shape[i] = a->shape[i];
+        export->strides[i] = a->strides[i];
+    }
+
+    DLTensor *t = &export->tensor.dl_tensor;
+    t->data = a->data;
+    t->device.device_type = kDLCPU;
+    t->device.device_id = 0;
+    t->ndim = a->ndim;
+    t->dtype.code = a->dtype == ARRAY_DTYPE_COMPLEX64 ? kDLComplex :
+                    a->dtype == ARRAY_DTYPE_INT8 ? kDLInt :
+                    a->dtype == ARRAY_DTYPE_UINT8 ? kDLUInt : kDLFloat;
+    t->dtype.bits = (uint8_t)(a->itemsize * 8);
+    t->dtype.lanes = 1;
+    t->shape = export->shape;
+    t->strides = export->strides;
+    t->byte_offset = 0;
+    export->tensor.manager_ctx = export;
+    export->tensor.deleter = dlpack_deleter;
+
+    *out = &export->tensor;
+    return ARRAY_SUCCESS;
+}
+
+// Release callback of imported DLPack tensors; ctx is the tensor
+static void release_dlpack(void *data, size_t nbytes, void *ctx) {
+    DLManagedTensor *tensor = (DLManagedTensor*)ctx;
+    (void)data;
+    (void)nbytes;
+    if (tensor->deleter) tensor->deleter(tensor);
+}
+
+// Function to import a DLPack tensor
+ArrayType* array_from_dlpack(DLManagedTensor *tensor, ArrayError *error) {
+    if (!tensor || !tensor->dl_tensor.data) {
+        if (error) *error = ARRAY_ERROR_NULL_POINTER;
+        return NULL;
+    }
+    const DLTensor *t = &tensor->dl_tensor;
+    if (t->device.device_type != kDLCPU) {
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+
+    ArrayDType dtype;
+    if (t->dtype.lanes == 1 && t->dtype.code == kDLFloat && t->dtype.bits == 32) {
+        dtype = ARRAY_DTYPE_FLOAT32;
+    } else if (t->dtype.lanes == 1 && t->dtype.code == kDLComplex && t->dtype.bits == 64) {
+        dtype = ARRAY_DTYPE_COMPLEX64;
+    } else if (t->dtype.lanes == 1 && t->dtype.code == kDLInt && t->dtype.bits == 8) {
+        dtype = ARRAY_DTYPE_INT8;
+    } else if (t->dtype.lanes == 1 && t->dtype.code == kDLUInt && t->dtype.bits == 8) {
+        dtype = ARRAY_DTYPE_UINT8;
+    } else {
+        if (error) *error = ARRAY_ERROR_INVALID_DTYPE;
+        return NULL;
+    }
+    if (t->ndim < 0 || t->ndim > ARRAY_MAX_DIMS) {
+        if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
+        return NULL;
+    }
+
+    // Strides of length-1 axes never matter, so they are not checked
+    int shape[ARRAY_MAX_DIMS] = {1};
+    int64_t expected = 1;
+    for (int i = t->ndim - 1; i >= 0; i--) {
+        if (t->shape[i] < 0 || t->shape[i] > INT_MAX) {
+            if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
+            return NULL;
+        }
+        if (t->strides && t->shape[i] > 1 && t->strides[i] != expected) {
+            if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+            return NULL;
+        }
+        shape[i] = (int)t->shape[i];
+        expected *= t->shape[i];
+    }
+
+    float *data = (float*)((char*)t->data + t->byte_offset);
+    return array_wrap_dtype(data, shape, t->ndim > 0 ? t->ndim : 1, dtype, release_dlpack, tensor, error);
+}
+
+// Private data of an exported ArrowArray: a reference keeping the buffer alive and
+// the storage behind buffers and children
+typedef struct {
+    ArrayType *handle;
+    const void *buffers[2];
+    struct ArrowArray *children[1];
+} ArrowArrayPrivate;
+
+static void release_arrow_array(struct ArrowArray *array) {
+    ArrowArrayPrivate *priv = (ArrowArrayPrivate*)array->private_data;
+    for (int64_t i = 0; i < array->n_children; i++) {
+        struct ArrowArray *child = array->children[i];
+        if (child->release) child->release(child);
+        free(child);
+    }
+    free_array(priv->handle);
+    free(priv);
+    array->release = NULL;
+}
+
+// Helper function to fill an exported array: a float buffer of length elements
+// when child is NULL, otherwise a list array of length lists over child
+static ArrayError fill_arrow_array(struct ArrowArray *out, const ArrayType *a, int64_t length,
+                                   struct ArrowArray *child) {
+    ArrowArrayPrivate *priv = (ArrowArrayPrivate*)malloc(sizeof(ArrowArrayPrivate));
+    if (!priv) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    ArrayError error;
+    priv->handle = array_share(a, &error);
+    if (!priv->handle) {
+        free(priv);
+        return error;
+    }
+    // Element validity goes with the float buffer; lists themselves are never null
+    priv->buffers[0] = child ? NULL : priv->handle->validity;
+    priv->buffers[1] = a->data;
+    priv->children[0] = child;
+
+    out->length = length;
+    out->null_count = child ? 0 : (int64_t)array_null_count(a);
+    out->offset = 0;
+    out->n_buffers = child ? 1 : 2;
+    out->n_children = child ? 1 : 0;
+    out->buffers = priv->buffers;
+    out->children = child ? priv->children : NULL;
+    out->dictionary = NULL;
+    out->release = release_arrow_array;
+    out->private_data = priv;
+    return ARRAY_SUCCESS;
+}
+
+// Private data of an exported ArrowSchema
+typedef struct {
+    char format[32];
+    char *metadata;
+    struct ArrowSchema *children[1];
+} ArrowSchemaPrivate;
+
+static void release_arrow_schema(struct ArrowSchema *schema) {
+    ArrowSchemaPrivate *priv = (ArrowSchemaPrivate*)schema->private_data;
+    for (int64_t i = 0; i < schema->n_children; i++) {
+        struct ArrowSchema *child = schema->children[i];
+        if (child->release) child->release(child);
+        free(child);
+    }
+    free(priv->metadata);
+    free(priv);
+    schema->release = NULL;
+}
+
+// Helper function to fill an exported schema; takes ownership of metadata and child
+static ArrayError fill_arrow_schema(struct ArrowSchema *out, const char *format, const char *name,
+                                    char *metadata, struct ArrowSchema *child) {
+    ArrowSchemaPrivate *priv = (ArrowSchemaPrivate*)malloc(sizeof(ArrowSchemaPrivate));
+    if (!priv) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    snprintf(priv->format, sizeof(priv->format), "%s", format);
+    priv->metadata = metadata;
+    priv->children[0] = child;
+
+    out->format = priv->format;
+    out->name = name;
+    out->metadata = metadata;
+    out->flags = ARROW_FLAG_NULLABLE;
+    out->n_children = child ? 1 : 0;
+    out->children = child ? priv->children : NULL;
+    out->dictionary = NULL;
+    out->release = release_arrow_schema;
+    out->private_data = priv;
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to append an int32 length and bytes to Arrow metadata
+static char* put_metadata_string(char *p, const char *s) {
+    int32_t length = (int32_t)strlen(s);
+    memcpy(p, &length, sizeof(length));
+    memcpy(p + sizeof(length), s, (size_t)length);
+    return p + sizeof(length) + length;
+}
+
+// Helper function to encode the fixed_shape_tensor extension metadata for the
+// dimensions after the first
+static char* tensor_metadata(const ArrayType *a) {
+    char json[16 + ARRAY_MAX_DIMS * 12] = "{\"shape\":[";
+    size_t used = strlen(json);
+    for (int i = 1; i < a->ndim; i++) {
+        used += (size_t)snprintf(json + used, sizeof(json) - used, i > 1 ? ",%d" : "%d", a->shape[i]);
+    }
+    snprintf(json + used, sizeof(json) - used, "]}");
+
+    const char *pairs[4] = {EXTENSION_NAME_KEY, TENSOR_EXTENSION_NAME, EXTENSION_METADATA_KEY, json};
+    size_t size = sizeof(int32_t);
+    for (int i = 0; i < 4; i++) size += sizeof(int32_t) + strlen(pairs[i]);
+    char *metadata = (char*)malloc(size);
+    if (!metadata) return NULL;
+
+    int32_t count = 2;
+    memcpy(metadata, &count, sizeof(count));
+    char *p = metadata + sizeof(count);
+    for (int i = 0; i < 4; i++) p = put_metadata_string(p, pairs[i]);
+    return metadata;
+}
+
+// Function to export an array through the Arrow C Data Interface
+ArrayError array_to_arrow(const ArrayType *a, struct ArrowSchema *schema, struct ArrowArray *array) {
+    if (!a || !schema || !array) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    // A 0-d array is exported as its single element
+    if (a->ndim <= 1) {
+        ArrayError error = fill_arrow_schema(schema, "f", "", NULL, NULL);
+        if (error != ARRAY_SUCCESS) return error;
+        error = fill_arrow_array(array, a, (int64_t)a->size, NULL);
+        if (error != ARRAY_SUCCESS) schema->release(schema);
+        return error;
+    }
+
+    int64_t list_size = 1;
+    for (int i = 1; i < a->ndim; i++) list_size *= a->shape[i];
+    char format[32];
+    snprintf(format, sizeof(format), "+w:%lld", (long long)list_size);
+
+    struct ArrowSchema *child_schema = (struct ArrowSchema*)malloc(sizeof(struct ArrowSchema));
+    struct ArrowArray *child_array = (struct ArrowArray*)malloc(sizeof(struct ArrowArray));
+    char *metadata = tensor_metadata(a);
+    ArrayError error = ARRAY_ERROR_MEMORY_ALLOCATION;
+    if (child_schema && child_array && metadata) {
+        error = fill_arrow_schema(child_schema, "f", "item", NULL, NULL);
+    }
+    if (error != ARRAY_SUCCESS) {
+        free(child_schema);
+        free(child_array);
+        free(metadata);
+        return error;
+    }
+    error = fill_arrow_schema(schema, format, "", metadata, child_schema);
+    if (error != ARRAY_SUCCESS) {
+        child_schema->release(child_schema);
+        free(child_schema);
+        free(child_array);
+        free(metadata);
+        return error;
+    }
+
+    error = fill_arrow_array(child_array, a, (int64_t)a->size, NULL);
+    if (error == ARRAY_SUCCESS) {
+        error = fill_arrow_array(array, a, a->shape[0], child_array);
+        if (error != ARRAY_SUCCESS) child_array->release(child_array);
+    }
+    if (error != ARRAY_SUCCESS) {
+        free(child_array);
+        schema->release(schema);
+    }
+    return error;
+}
+
+// Helper function to look up a key in Arrow metadata; returns the value, not
+// NUL-terminated, and its length
+static const char* metadata_value(const char *metadata, const char *key, int32_t *length) {
+    if (!metadata) return NULL;
+    int32_t count;
+    memcpy(&count, metadata, sizeof(count));
+    const char *p = metadata + sizeof(count);
+    size_t key_length = strlen(key);
+    for (int32_t i = 0; i < count; i++) {
+        int32_t kl, vl;
+        memcpy(&kl, p, sizeof(kl));
+        const char *k = p + sizeof(kl);
+        memcpy(&vl, k + kl, sizeof(vl));
+        const char *v = k + kl + sizeof(vl);
+        if ((size_t)kl == key_length && memcmp(k, key, key_length) == 0) {
+            *length = vl;
+            return v;
+        }
+        p = v + vl;
+    }
+    return NULL;
+}
+
+// Helper function to parse the integer list of a key in a flat JSON object.
+// Returns the number of values, 0 if the key is absent, or -1 if the list is malformed.
+static int parse_json_list(const char *json, const char *key, int *values, int max_values) {
+    const char *p = strstr(json, key);
+    if (!p) return 0;
+    p = strchr(p + strlen(key), '[');
+    if (!p) return -1;
+    int count = 0;
+    for (p++;;) {
+        while (*p == ' ') p++;
+        if (*p == ']') return count;
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 0 || value > INT_MAX || count == max_values) return -1;
+        values[count++] = (int)value;
+        p = end;
+        while (*p == ' ') p++;
+        if (*p == ',') p++;
+    }
+}
+
+// Helper function to read the shape of one tensor from fixed_shape_tensor metadata.
+// Returns the number of dimensions, or -1 for missing, malformed or permuted tensors.
+static int tensor_shape(const char *metadata, int *shape, int max_dims) {
+    int32_t length;
+    const char *value = metadata_value(metadata, EXTENSION_METADATA_KEY, &length);
+    if (!value) return -1;
+    char *json = (char*)malloc((size_t)length + 1);
+    if (!json) return -1;
+    memcpy(json, value, (size_t)length);
+    json[length] = '\0';
+
+    int ndim = parse_json_list(json, "\"shape\"", shape, max_dims);
+    int permutation[ARRAY_MAX_DIMS];
+    int nperm = parse_json_list(json, "\"permutation\"", permutation, ARRAY_MAX_DIMS);
+    for (int i = 0; i < nperm; i++) {
+        if (permutation[i] != i) nperm = -1;
+    }
+    free(json);
+    return ndim > 0 && nperm >= 0 ? ndim : -1;
+}
+
+// Helper function to check that an imported array has a validity and a data buffer
+static int float_buffers(const struct ArrowArray *array) {
+    return array->n_buffers == 2 && array->buffers[1];
+}
+
+// Helper function to get the validity bitmap of an imported array, NULL without nulls
+static const uint8_t* validity_buffer(const struct ArrowArray *array) {
+    return array->null_count != 0 ? (const uint8_t*)array->buffers[0] : NULL;
+}
+
+// Release callback of imported Arrow arrays; ctx is the moved ArrowArray
+static void release_imported_arrow(void *data, size_t nbytes, void *ctx) {
+    struct ArrowArray *array = (struct ArrowArray*)ctx;
+    (void)data;
+    (void)nbytes;
+    if (array->release) array->release(array);
+    free(array);
+}
+
+// Function to import an array through the Arrow C Data Interface
+ArrayType* array_from_arrow(const struct ArrowSchema *schema, struct ArrowArray *array, ArrayError *error) {
+    if (!schema || !array || !schema->format) {
+        if (error) *error = ARRAY_ERROR_NULL_POINTER;
+        return NULL;
+    }
+    if (!array->release || array->length > INT_MAX) {
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    ArrayError status = ARRAY_ERROR_INVALID_ARGUMENT;
+    int shape[ARRAY_MAX_DIMS];
+    int ndim = 0;
+    const float *data = NULL;
+    const uint8_t *validity = NULL;
+    size_t validity_offset = 0;
+
+    if (strcmp(schema->format, "f") == 0) {
+        if (float_buffers(array)) {
+            ndim = 1;
+            shape[0] = (int)array->length;
+            data = (const float*)array->buffers[1] + array->offset;
+            validity = validity_buffer(array);
+            validity_offset = (size_t)array->offset;
+        }
+    } else if (strncmp(schema->format, "+w:", 3) == 0) {
+        long list_size = strtol(schema->format + 3, NULL, 10);
+        const struct ArrowArray *child = array->n_children == 1 ? array->children[0] : NULL;
+        int child_is_float = schema->n_children == 1 && strcmp(schema->children[0]->format, "f") == 0;
+        if (!child_is_float) {
+            status = ARRAY_ERROR_INVALID_DTYPE;
+        } else if (child && float_buffers(child) && !validity_buffer(array) &&
+                   list_size > 0 && list_size <= INT_MAX) {
+            int32_t length;
+            const char *name = metadata_value(schema->metadata, EXTENSION_NAME_KEY, &length);
+            if (name && (size_t)length == strlen(TENSOR_EXTENSION_NAME) &&
+                memcmp(name, TENSOR_EXTENSION_NAME, (size_t)length) == 0) {
+                int dims = tensor_shape(schema->metadata, shape + 1, ARRAY_MAX_DIMS - 1);
+                long product = 1;
+                for (int i = 0; i < dims; i++) product *= shape[i + 1];
+                ndim = dims > 0 && product == list_size ? dims + 1 : 0;
+            } else {
+                ndim = 2;
+                shape[1] = (int)list_size;
+            }
+            shape[0] = (int)array->length;
+            data = (const float*)child->buffers[1] + child->offset + array->offset * list_size;
+            validity = validity_buffer(child);
+            validity_offset = (size_t)(child->offset + array->offset * list_size);
+        }
+    } else {
+        status = ARRAY_ERROR_INVALID_DTYPE;
+    }
+
+    if (ndim == 0) {
+        if (error) *error = status;
+        return NULL;
+    }
+
+    struct ArrowArray *owned = (struct ArrowArray*)malloc(sizeof(struct ArrowArray));
+    if (!owned) {
+        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        return NULL;
+    }
+    *owned = *array;
+    ArrayType *arr = array_wrap_dtype((float*)data, shape, ndim, ARRAY_DTYPE_FLOAT32,
+                                      release_imported_arrow, owned, error);
+    ArrayError status_validity = arr ? array_set_validity(arr, validity, validity_offset) : ARRAY_SUCCESS;
+    if (status_validity != ARRAY_SUCCESS) {
+        // Detach the producer's array so that failing leaves it untouched
+        arr->buffer->release = NULL;
+        free_array(arr);
+        arr = NULL;
+        if (error) *error = status_validity;
+    }
+    if (!arr) {
+        free(owned);
+        return NULL;
+    }
+    array->release = NULL;
+    return arr;
+}
@@ -0,0 +1,927 @@
+#include "linalg.h"
+#include "gemm.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Block size of the blocked factorizations: panel width and row block of the triangular solves
+#define LINALG_BLOCK 64
+
+// Batches of matrices up to this order use the interleaved small-matrix path
+#define LINALG_SMALL_MAX 64
+
+// Number of matrices interleaved element by element by the small-matrix path
+#define LINALG_LANES 16
+
+// Status bits gathered from parallel loops
+#define LINALG_FLAG_SINGULAR 1
+#define LINALG_FLAG_MEMORY 2
+
+static inline int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static inline int min_int(int a, int b) {
+    return a < b ? a : b;
+}
+
+// Helper function to count the matrices stacked along the leading axes
+static size_t batch_count(const ArrayType *a, int matrix_dims) {
+    size_t batch = 1;
+    for (int d = 0; d < a->ndim - matrix_dims; d++) batch *= a->shape[d];
+    return batch;
+}
+
+// Helper function for the argument checks shared by the square-matrix operations
+static ArrayError check_square(const ArrayType *a) {
+    if (!a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->ndim < 2 || a->shape[a->ndim - 1] != a->shape[a->ndim - 2]) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (a->shape[a->ndim - 1] <= 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+    return ARRAY_SUCCESS;
+}
+
+static void swap_rows(float *x, float *y, int n) {
+    for (int c = 0; c < n; c++) {
+        float t = x[c];
+        x[c] = y[c];
+        y[c] = t;
+    }
+}
+
+// Blocked right-looking LU with partial pivoting of an n x n row-major matrix, in place
+static ArrayError lu_factor(float *a, int n, int *piv, int *singular) {
+    *singular = 0;
+    for (int j = 0; j < n; j += LINALG_BLOCK) {
+        int jb = min_int(LINALG_BLOCK, n - j);
+        int j2 = j + jb;
+
+        // Panel: unblocked elimination restricted to columns [j, j2), swapping whole rows
+        for (int k = j; k < j2; k++) {
+            int p = k;
+            float best = fabsf(a[(size_t)k * n + k]);
+            for (int i = k + 1; i < n; i++) {
+                float v = fabsf(a[(size_t)i * n + k]);
+                if (v > best) {
+                    best = v;
+                    p = i;
+                }
+            }
+            piv[k] = p;
+            if (p != k) swap_rows(a + (size_t)k * n, a + (size_t)p * n, n);
+
+            const float *urow = a + (size_t)k * n;
+            if (urow[k] == 0.0f) {
+                *singular = 1;
+                continue;
+            }
+            float r = 1.0f / urow[k];
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(static) if ((size_t)(n - k) * (j2 - k) >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+            for (int i = k + 1; i < n; i++) {
+                float *row = a + (size_t)i * n;
+                float l = row[k] * r;
+                row[k] = l;
+                ARRAY_OMP_SIMD
+                for (int c = k + 1; c < j2; c++) row[c] -= l * urow[c];
+            }
+        }
+        if (j2 >= n) continue;
+
+        // U12 = L11^-1 A12, parallel over blocks of columns
+        int nchunks = (n - j2 + LINALG_BLOCK - 1) / LINALG_BLOCK;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if ((size_t)(n - j2) * jb * jb >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (int ch = 0; ch < nchunks; ch++) {
+            int c0 = j2 + ch * LINALG_BLOCK, c1 = min_int(c0 + LINALG_BLOCK, n);
+            for (int i = j + 1; i < j2; i++) {
+                float *row = a + (size_t)i * n;
+                for (int t = j; t < i; t++) {
+                    float l = row[t];
+                    const float *urow = a + (size_t)t * n;
+                    ARRAY_OMP_SIMD
+                    for (int c = c0; c < c1; c++) row[c] -= l * urow[c];
+                }
+            }
+        }
+
+        // Trailing update A22 -= L21 U12
+        ArrayError error = sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, n - j2, n - j2, jb, -1.0f,
+                                 a + (size_t)j2 * n + j, n, a + (size_t)j * n + j2, n,
+                                 1.0f, a + (size_t)j2 * n + j2, n);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Solves A X = B in place in b (n x nrhs) from the packed factors of lu_factor
+static ArrayError lu_solve(const float *lu, const int *piv, int n, float *b, int nrhs) {
+    for (int i = 0; i < n; i++) {
+        if (piv[i] != i) swap_rows(b + (size_t)i * nrhs, b + (size_t)piv[i] * nrhs, nrhs);
+    }
+
+    // L Y = B, one block of rows at a time
+    for (int i0 = 0; i0 < n; i0 += LINALG_BLOCK) {
+        int ib = min_int(LINALG_BLOCK, n - i0);
+        if (i0 > 0) {
+            ArrayError error = sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, ib, nrhs, i0, -1.0f, lu + (size_t)i0 * n, n,
+                                     b, nrhs, 1.0f, b + (size_t)i0 * nrhs, nrhs);
+            if (error != ARRAY_SUCCESS) return error;
+        }
+        for (int i = i0; i < i0 + ib; i++) {
+            float *bi = b + (size_t)i * nrhs;
+            for (int t = i0; t < i; t++) {
+                float l = lu[(size_t)i * n + t];
+                const float *bt = b + (size_t)t * nrhs;
+                ARRAY_OMP_SIMD
+                for (int c = 0; c < nrhs; c++) bi[c] -= l * bt[c];
+            }
+        }
+    }
+
+    // U X = Y, from the last block of rows up
+    for (int i1 = n; i1 > 0; i1 -= LINALG_BLOCK) {
+        int i0 = i1 - LINALG_BLOCK > 0 ? i1 - LINALG_BLOCK : 0;
+        if (i1 < n) {
+            ArrayError error = sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, i1 - i0, nrhs, n - i1, -1.0f,
+                                     lu + (size_t)i0 * n + i1, n, b + (size_t)i1 * nrhs, nrhs,
+                                     1.0f, b + (size_t)i0 * nrhs, nrhs);
+            if (error != ARRAY_SUCCESS) return error;
+        }
+        for (int i = i1 - 1; i >= i0; i--) {
+            float *bi = b + (size_t)i * nrhs;
+            for (int t = i + 1; t < i1; t++) {
+                float u = lu[(size_t)i * n + t];
+                const float *bt = b + (size_t)t * nrhs;
+                ARRAY_OMP_SIMD
+                for (int c = 0; c < nrhs; c++) bi[c] -= u * bt[c];
+            }
+            float r = 1.0f / lu[(size_t)i * n + i];
+            ARRAY_OMP_SIMD
+            for (int c = 0; c < nrhs; c++) bi[c] *= r;
+        }
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Blocked right-looking Cholesky of the lower triangle of an n x n matrix, in place
+static ArrayError cholesky_factor(float *a, int n) {
+    for (int j = 0; j < n; j += LINALG_BLOCK) {
+        int jb = min_int(LINALG_BLOCK, n - j);
+        int j2 = j + jb;
+
+        // Diagonal block; earlier block columns were already subtracted by the trailing updates
+        for (int k = j; k < j2; k++) {
+            float *rk = a + (size_t)k * n;
+            float d = rk[k];
+            for (int t = j; t < k; t++) d -= rk[t] * rk[t];
+            if (!(d > 0.0f)) return ARRAY_ERROR_NOT_POSITIVE_DEFINITE;
+            d = sqrtf(d);
+            rk[k] = d;
+            for (int i = k + 1; i < j2; i++) {
+                float *ri = a + (size_t)i * n;
+                float s = ri[k];
+                ARRAY_OMP_SIMD_REDUCTION(-:s)
+                for (int t = j; t < k; t++) s -= ri[t] * rk[t];
+                ri[k] = s / d;
+            }
+        }
+        if (j2 >= n) break;
+
+        // L21 = A21 L11^-T, one row per iteration
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if ((size_t)(n - j2) * jb * jb >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (int i = j2; i < n; i++) {
+            float *ri = a + (size_t)i * n;
+            for (int k = j; k < j2; k++) {
+                const float *rk = a + (size_t)k * n;
+                float s = ri[k];
+                ARRAY_OMP_SIMD_REDUCTION(-:s)
+                for (int t = j; t < k; t++) s -= ri[t] * rk[t];
+                ri[k] = s / rk[k];
+            }
+        }
+
+        // Lower triangle of A22 -= L21 L21^T, one block of rows per task
+        int nblocks = (n - j2 + LINALG_BLOCK - 1) / LINALG_BLOCK;
+        int failed = 0;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic) reduction(|:failed) \
+            if ((size_t)(n - j2) * (n - j2) * jb >= (size_t)ARRAY_PARALLEL_THRESHOLD * 16)
+#endif
+        for (int blk = 0; blk < nblocks; blk++) {
+            int i0 = j2 + blk * LINALG_BLOCK;
+            int ih = min_int(LINALG_BLOCK, n - i0);
+            failed |= sgemm(GEMM_NO_TRANS, GEMM_TRANS, ih, i0 + ih - j2, jb, -1.0f,
+                            a + (size_t)i0 * n + j, n, a + (size_t)j2 * n + j, n,
+                            1.0f, a + (size_t)i0 * n + j2, n) != ARRAY_SUCCESS;
+        }
+        if (failed) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+    for (int i = 0; i < n; i++) {
+        memset(a + (size_t)i * n + i + 1, 0, (size_t)(n - 1 - i) * sizeof(float));
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Householder reflection H = I - tau v v^T with v = [1, x / (alpha - beta)] mapping
+// [alpha, x] onto [beta, 0]; x has len elements spaced stride apart
+static float householder(float *alpha, float *x, int len, int stride) {
+    float norm2 = 0.0f;
+    for (int i = 0; i < len; i++) norm2 += x[(size_t)i * stride] * x[(size_t)i * stride];
+    if (norm2 == 0.0f) return 0.0f;
+
+    float beta = -copysignf(sqrtf(*alpha * *alpha + norm2), *alpha);
+    float tau = (beta - *alpha) / beta;
+    float scale = 1.0f / (*alpha - beta);
+    for (int i = 0; i < len; i++) x[(size_t)i * stride] *= scale;
+    *alpha = beta;
+    return tau;
+}
+
+// Helper function to copy the reflectors of a panel into an explicit unit lower
+// trapezoidal rows x jb matrix
+static void copy_reflectors(float *v, const float *a, int lda, int rows, int jb) {
+    for (int s = 0; s < rows; s++) {
+        for (int t = 0; t < jb; t++) {
+            v[(size_t)s * jb + t] = s == t ? 1.0f : (s > t ? a[(size_t)s * lda + t] : 0.0f);
+        }
+    }
+}
+
+// Helper function to form the upper triangular T of the compact WY form I - V T V^T
+static void build_t(float *t, const float *v, int rows, int jb, const float *tau) {
+    for (int i = 0; i < jb; i++) {
+        float *ti = t + i;  // column i, rows spaced LINALG_BLOCK apart
+        for (int r = 0; r < i; r++) {
+            float z = 0.0f;
+            for (int s = i; s < rows; s++) z += v[(size_t)s * jb + r] * v[(size_t)s * jb + i];
+            ti[r * LINALG_BLOCK] = z;
+        }
+        for (int r = 0; r < i; r++) {
+            float sum = 0.0f;
+            for (int q = r; q < i; q++) sum += t[r * LINALG_BLOCK + q] * ti[q * LINALG_BLOCK];
+            ti[r * LINALG_BLOCK] = -tau[i] * sum;
+        }
+        ti[i * LINALG_BLOCK] = tau[i];
+    }
+}
+
+// Floats of workspace needed by qr_factor and form_q for an m x n matrix
+static size_t qr_work_size(int m, int n) {
+    return (size_t)m * LINALG_BLOCK + LINALG_BLOCK * LINALG_BLOCK + (size_t)LINALG_BLOCK * n;
+}
+
+// Blocked Householder QR of an m x n row-major matrix, in place: R on and above the
+// diagonal, the reflectors below it
+static ArrayError qr_factor(float *a, int m, int n, float *tau, float *work) {
+    int k = min_int(m, n);
+    float *v = work;
+    float *t = v + (size_t)m * LINALG_BLOCK;
+    float *w = t + LINALG_BLOCK * LINALG_BLOCK;
+
+    for (int j = 0; j < k; j += LINALG_BLOCK) {
+        int jb = min_int(LINALG_BLOCK, k - j);
+        int j2 = j + jb;
+        int rows = m - j;
+
+        // Panel: unblocked reflections applied within columns [j, j2)
+        for (int c = j; c < j2; c++) {
+            float *col = a + (size_t)c * n + c;
+            tau[c] = householder(col, col + n, m - c - 1, n);
+            if (tau[c] == 0.0f || c + 1 >= j2) continue;
+
+            int width = j2 - c - 1;
+            for (int q = 0; q < width; q++) w[q] = col[1 + q];
+            for (int i = c + 1; i < m; i++) {
+                const float *row = a + (size_t)i * n;
+                float vi = row[c];
+                ARRAY_OMP_SIMD
+                for (int q = 0; q < width; q++) w[q] += vi * row[c + 1 + q];
+            }
+            for (int q = 0; q < width; q++) col[1 + q] -= tau[c] * w[q];
+            for (int i = c + 1; i < m; i++) {
+                float *row = a + (size_t)i * n;
+                float f = tau[c] * row[c];
+                ARRAY_OMP_SIMD
+                for (int q = 0; q < width; q++) row[c + 1 + q] -= f * w[q];
+            }
+        }
+        if (j2 >= n) continue;
+
+        // Trailing columns: A2 = (I - V T^T V^T) A2 with W = T^T (V^T A2)
+        int n2 = n - j2;
+        float *a2 = a + (size_t)j * n + j2;
+        copy_reflectors(v, a + (size_t)j * n + j, n, rows, jb);
+        build_t(t, v, rows, jb, tau + j);
+        ArrayError error = sgemm(GEMM_TRANS, GEMM_NO_TRANS, jb, n2, rows, 1.0f, v, jb, a2, n, 0.0f, w, n2);
+        if (error != ARRAY_SUCCESS) return error;
+        for (int r = jb - 1; r >= 0; r--) {
+            float *wr = w + (size_t)r * n2;
+            float trr = t[r * LINALG_BLOCK + r];
+            ARRAY_OMP_SIMD
+            for (int c = 0; c < n2; c++) wr[c] *= trr;
+            for (int s = 0; s < r; s++) {
+                float tsr = t[s * LINALG_BLOCK + r];
+                const float *ws = w + (size_t)s * n2;
+                ARRAY_OMP_SIMD
+                for (int c = 0; c < n2; c++) wr[c] += tsr * ws[c];
+            }
+        }
+        error = sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, rows, n2, jb, -1.0f, v, jb, w, n2, 1.0f, a2, n);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Forms the m x k matrix Q = H_0 H_1 ... H_(k-1) [I; 0] from the output of qr_factor,
+// applying the blocks of reflectors from the last one back
+static ArrayError form_q(float *q, const float *a, int m, int n, const float *tau, float *work) {
+    int k = min_int(m, n);
+    float *v = work;
+    float *t = v + (size_t)m * LINALG_BLOCK;
+    float *w = t + LINALG_BLOCK * LINALG_BLOCK;
+
+    memset(q, 0, (size_t)m * k * sizeof(float));
+    for (int i = 0; i < k; i++) q[(size_t)i * k + i] = 1.0f;
+
+    for (int j = ((k - 1) / LINALG_BLOCK) * LINALG_BLOCK; j >= 0; j -= LINALG_BLOCK) {
+        int jb = min_int(LINALG_BLOCK, k - j);
+        int rows = m - j, ncols = k - j;
+        float *q2 = q + (size_t)j * k + j;
+
+        // Q2 = (I - V T V^T) Q2 with W = T (V^T Q2)
+        copy_reflectors(v, a + (size_t)j * n + j, n, rows, jb);
+        build_t(t, v, rows, jb, tau + j);
+        ArrayError error = sgemm(GEMM_TRANS, GEMM_NO_TRANS, jb, ncols, rows, 1.0f, v, jb, q2, k, 0.0f, w, ncols);
+        if (error != ARRAY_SUCCESS) return error;
+        for (int r = 0; r < jb; r++) {
+            float *wr = w + (size_t)r * ncols;
+            float trr = t[r * LINALG_BLOCK + r];
+            ARRAY_OMP_SIMD
+            for (int c = 0; c < ncols; c++) wr[c] *= trr;
+            for (int s = r + 1; s < jb; s++) {
+                float trs = t[r * LINALG_BLOCK + s];
+                const float *ws = w + (size_t)s * ncols;
+                ARRAY_OMP_SIMD
+                for (int c = 0; c < ncols; c++) wr[c] += trs * ws[c];
+            }
+        }
+        error = sgemm(GEMM_NO_TRANS, GEMM_NO_TRANS, rows, ncols, jb, -1.0f, v, jb, w, ncols, 1.0f, q2, k);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Interleaved small matrices: element e of lane l is at buf[e * LINALG_LANES + l].
+// Lanes past count are padded with the identity (pad_identity) or zeros.
+static void pack_lanes(float *buf, const float *src, size_t count, int rows, int cols, int pad_identity) {
+    size_t elems = (size_t)rows * cols;
+    for (size_t l = 0; l < LINALG_LANES; l++) {
+        const float *m = src + l * elems;
+        for (size_t e = 0; e < elems; e++) {
+            float pad = (pad_identity && e / cols == e % cols) ? 1.0f : 0.0f;
+            buf[e * LINALG_LANES + l] = l < count ? m[e] : pad;
+        }
+    }
+}
+
+static void unpack_lanes(float *dst, const float *buf, size_t count, size_t elems) {
+    for (size_t l = 0; l < count; l++) {
+        float *m = dst + l * elems;
+        for (size_t e = 0; e < elems; e++) m[e] = buf[e * LINALG_LANES + l];
+    }
+}
+
+// LU with partial pivoting of LINALG_LANES interleaved n x n matrices. Each lane picks
+// its own pivots; the elimination is vectorized across lanes.
+static void lu_lanes(float *a, int n, int *piv, int *singular) {
+    const size_t L = LINALG_LANES;
+    for (int k = 0; k < n; k++) {
+        int p[LINALG_LANES];
+        float best[LINALG_LANES], r[LINALG_LANES];
+        const float *akk = a + ((size_t)k * n + k) * L;
+        ARRAY_OMP_SIMD
+        for (size_t l = 0; l < L; l++) {
+            p[l] = k;
+            best[l] = fabsf(akk[l]);
+        }
+        for (int i = k + 1; i < n; i++) {
+            const float *aik = a + ((size_t)i * n + k) * L;
+            ARRAY_OMP_SIMD
+            for (size_t l = 0; l < L; l++) {
+                float v = fabsf(aik[l]);
+                p[l] = v > best[l] ? i : p[l];
+                best[l] = v > best[l] ? v : best[l];
+            }
+        }
+        for (size_t l = 0; l < L; l++) {
+            piv[(size_t)k * L + l] = p[l];
+            if (p[l] == k) continue;
+            float *rk = a + (size_t)k * n * L + l, *rp = a + (size_t)p[l] * n * L + l;
+            for (int c = 0; c < n; c++) {
+                float tmp = rk[c * L];
+                rk[c * L] = rp[c * L];
+                rp[c * L] = tmp;
+            }
+        }
+
+        ARRAY_OMP_SIMD
+        for (size_t l = 0; l < L; l++) {
+            singular[l] |= akk[l] == 0.0f;
+            r[l] = akk[l] != 0.0f ? 1.0f / akk[l] : 0.0f;
+        }
+        const float *rowk = a + (size_t)k * n * L;
+        for (int i = k + 1; i < n; i++) {
+            float *rowi = a + (size_t)i * n * L;
+            ARRAY_OMP_SIMD
+            for (size_t l = 0; l < L; l++) rowi[k * L + l] *= r[l];
+            for (int c = k + 1; c < n; c++) {
+                ARRAY_OMP_SIMD
+                for (size_t l = 0; l < L; l++) rowi[c * L + l] -= rowi[k * L + l] * rowk[c * L + l];
+            }
+        }
+    }
+}
+
+// Solves the interleaved systems A X = B in place in b (n x nrhs per lane) from lu_lanes
+static void solve_lanes(const float *lu, const int *piv, int n, float *b, int nrhs) {
+    const size_t L = LINALG_LANES;
+    size_t row = (size_t)nrhs * L;
+    for (int k = 0; k < n; k++) {
+        for (size_t l = 0; l < L; l++) {
+            int p = piv[(size_t)k * L + l];
+            if (p == k) continue;
+            float *bk = b + k * row + l, *bp = b + p * row + l;
+            for (int c = 0; c < nrhs; c++) {
+                float tmp = bk[c * L];
+                bk[c * L] = bp[c * L];
+                bp[c * L] = tmp;
+            }
+        }
+    }
+    for (int i = 1; i < n; i++) {
+        float *bi = b + i * row;
+        for (int t = 0; t < i; t++) {
+            const float *l_it = lu + ((size_t)i * n + t) * L;
+            const float *bt = b + t * row;
+            for (int c = 0; c < nrhs; c++) {
+                ARRAY_OMP_SIMD
+                for (size_t l = 0; l < L; l++) bi[c * L + l] -= l_it[l] * bt[c * L + l];
+            }
+        }
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        float *bi = b + i * row;
+        for (int t = i + 1; t < n; t++) {
+            const float *u_it = lu + ((size_t)i * n + t) * L;
+            const float *bt = b + t * row;
+            for (int c = 0; c < nrhs; c++) {
+                ARRAY_OMP_SIMD
+                for (size_t l = 0; l < L; l++) bi[c * L + l] -= u_it[l] * bt[c * L + l];
+            }
+        }
+        const float *u_ii = lu + ((size_t)i * n + i) * L;
+        for (int c = 0; c < nrhs; c++) {
+            ARRAY_OMP_SIMD
+            for (size_t l = 0; l < L; l++) bi[c * L + l] /= u_ii[l];
+        }
+    }
+}
+
+// Left-looking Cholesky of LINALG_LANES interleaved n x n matrices, zeroing the upper triangle
+static void cholesky_lanes(float *a, int n, int *bad) {
+    const size_t L = LINALG_LANES;
+    for (int k = 0; k < n; k++) {
+        float d[LINALG_LANES], r[LINALG_LANES];
+        const float *rowk = a + (size_t)k * n * L;
+        ARRAY_OMP_SIMD
+        for (size_t l = 0; l < L; l++) d[l] = rowk[k * L + l];
+        for (int t = 0; t < k; t++) {
+            ARRAY_OMP_SIMD
+            for (size_t l = 0; l < L; l++) d[l] -= rowk[t * L + l] * rowk[t * L + l];
+        }
+        ARRAY_OMP_SIMD
+        for (size_t l = 0; l < L; l++) {
+            bad[l] |= !(d[l] > 0.0f);
+            d[l] = d[l] > 0.0f ? sqrtf(d[l]) : 1.0f;
+            r[l] = 1.0f / d[l];
+        }
+        float *akk = a + ((size_t)k * n + k) * L;
+        for (size_t l = 0; l < L; l++) akk[l] = d[l];
+
+        for (int i = k + 1; i < n; i++) {
+            float *rowi = a + (size_t)i * n * L;
+            float s[LINALG_LANES];
+            ARRAY_OMP_SIMD
+            for (size_t l = 0; l < L; l++) s[l] = rowi[k * L + l];
+            for (int t = 0; t < k; t++) {
+                ARRAY_OMP_SIMD
+                for (size_t l = 0; l < L; l++) s[l] -= rowi[t * L + l] * rowk[t * L + l];
+            }
+            ARRAY_OMP_SIMD
+            for (size_t l = 0; l < L; l++) rowi[k * L + l] = s[l] * r[l];
+        }
+        float *upper = a + ((size_t)k * n + k + 1) * L;
+        memset(upper, 0, (size_t)(n - k - 1) * L * sizeof(float));
+    }
+}
+
+// Helper function to decide how a batch of n x n matrices is spread over threads:
+// across matrices when there are enough of them, otherwise inside each factorization
+static int parallel_over_batch(size_t batch, int n) {
+    return batch > 1 && (batch >= (size_t)thread_count() || n <= LINALG_SMALL_MAX) &&
+           batch * n * n >= ARRAY_PARALLEL_THRESHOLD / 8;
+}
+
+// Function to compute LU factorizations with partial pivoting
+ArrayError lu_array(ArrayType **lu, int **pivots, const ArrayType *a) {
+    if (!lu || !pivots) return ARRAY_ERROR_NULL_POINTER;
+    ArrayError error = check_square(a);
+    if (error != ARRAY_SUCCESS) return error;
+
+    int n = a->shape[a->ndim - 1];
+    size_t batch = batch_count(a, 2), elems = (size_t)n * n;
+    int *piv = (int*)malloc((batch * n > 0 ? batch * n : 1) * sizeof(int));
+    if (!piv) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    if (*lu != a) {
+        error = prepare_result(lu, a->shape, a->ndim);
+        if (error == ARRAY_SUCCESS) memcpy((*lu)->data, a->data, a->size * sizeof(float));
+    } else {
+        error = array_make_writable(*lu);
+    }
+    if (error != ARRAY_SUCCESS) {
+        free(piv);
+        return error;
+    }
+    float *data = (*lu)->data;
+    int flags = 0;
+    int parallel = parallel_over_batch(batch, n);
+
+    if (batch > 1 && n <= LINALG_SMALL_MAX) {
+        size_t ngroups = (batch + LINALG_LANES - 1) / LINALG_LANES;
+        int nthreads = parallel ? thread_count() : 1;
+        size_t per_thread = elems * LINALG_LANES;
+        float *bufs = (float*)malloc(nthreads * per_thread * sizeof(float));
+        int *pivs = (int*)malloc((size_t)nthreads * n * LINALG_LANES * sizeof(int));
+        if (!bufs || !pivs) flags |= LINALG_FLAG_MEMORY;
+
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads) if (parallel && !flags)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (size_t g = 0; g < ngroups; g++) {
+                if (flags) continue;
+                float *buf = bufs + tid * per_thread;
+                int *gp = pivs + (size_t)tid * n * LINALG_LANES;
+                int singular[LINALG_LANES] = {0};
+                size_t first = g * LINALG_LANES;
+                size_t count = batch - first < LINALG_LANES ? batch - first : LINALG_LANES;
+
+                pack_lanes(buf, data + first * elems, count, n, n, 1);
+                lu_lanes(buf, n, gp, singular);
+                unpack_lanes(data + first * elems, buf, count, elems);
+                for (size_t l = 0; l < count; l++) {
+                    for (int k = 0; k < n; k++) piv[(first + l) * n + k] = gp[(size_t)k * LINALG_LANES + l];
+                }
+            }
+        }
+        free(bufs);
+        free(pivs);
+    } else {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic) reduction(|:flags) if (parallel)
+#endif
+        for (size_t s = 0; s < batch; s++) {
+            int singular;
+            if (lu_factor(data + s * elems, n, piv + s * n, &singular) != ARRAY_SUCCESS) flags |= LINALG_FLAG_MEMORY;
+        }
+    }
+
+    if (flags & LINALG_FLAG_MEMORY) {
+        free(piv);
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+    free(*pivots);
+    *pivots = piv;
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to solve A X = B for a batch, with x holding B on entry and X on exit
+static ArrayError solve_batched(const float *coef, float *x, int n, int nrhs, size_t batch) {
+    size_t elems = (size_t)n * n, rhs = (size_t)n * nrhs;
+    int parallel = parallel_over_batch(batch, n);
+    int nthreads = parallel ? thread_count() : 1;
+    int flags = 0;
+
+    if (batch > 1 && n <= LINALG_SMALL_MAX) {
+        size_t ngroups = (batch + LINALG_LANES - 1) / LINALG_LANES;
+        size_t per_thread = (elems + rhs) * LINALG_LANES;
+        float *bufs = (float*)malloc(nthreads * per_thread * sizeof(float));
+        int *pivs = (int*)malloc((size_t)nthreads * n * LINALG_LANES * sizeof(int));
+        if (!bufs || !pivs) {
+            free(bufs);
+            free(pivs);
+            return ARRAY_ERROR_MEMORY_ALLOCATION;
+        }
+
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads) if (parallel) reduction(|:flags)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            float *abuf = bufs + tid * per_thread;
+            float *bbuf = abuf + elems * LINALG_LANES;
+            int *gp = pivs + (size_t)tid * n * LINALG_LANES;
+
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (size_t g = 0; g < ngroups; g++) {
+                int singular[LINALG_LANES] = {0};
+                size_t first = g * LINALG_LANES;
+                size_t count = batch - first < LINALG_LANES ? batch - first : LINALG_LANES;
+
+                pack_lanes(abuf, coef + first * elems, count, n, n, 1);
+                pack_lanes(bbuf, x + first * rhs, count, n, nrhs, 0);
+                lu_lanes(abuf, n, gp, singular);
+                for (size_t l = 0; l < count; l++) flags |= singular[l] ? LINALG_FLAG_SINGULAR : 0;
+                solve_lanes(abuf, gp, n, bbuf, nrhs);
+                unpack_lanes(x + first * rhs, bbuf, count, rhs);
+            }
+        }
+        free(bufs);
+        free(pivs);
+    } else {
+        size_t per_thread = elems;
+        float *bufs = (float*)malloc(nthreads * per_thread * sizeof(float));
+        int *pivs = (int*)malloc((size_t)nthreads * n * sizeof(int));
+        if (!bufs || !pivs) {
+            free(bufs);
+            free(pivs);
+            return ARRAY_ERROR_MEMORY_ALLOCATION;
+        }
+
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads) if (parallel) reduction(|:flags)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            float *lu = bufs + tid * per_thread;
+            int *piv = pivs + (size_t)tid * n;
+
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+#endif
+            for (size_t s = 0; s < batch; s++) {
+                int singular;
+                memcpy(lu, coef + s * elems, elems * sizeof(float));
+                if (lu_factor(lu, n, piv, &singular) != ARRAY_SUCCESS) {
+                    flags |= LINALG_FLAG_MEMORY;
+                } else if (singular) {
+                    flags |= LINALG_FLAG_SINGULAR;
+                } else if (lu_solve(lu, piv, n, x + s * rhs, nrhs) != ARRAY_SUCCESS) {
+                    flags |= LINALG_FLAG_MEMORY;
+                }
+            }
+        }
+        free(bufs);
+        free(pivs);
+    }
+
+    if (flags & LINALG_FLAG_MEMORY) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    return (flags & LINALG_FLAG_SINGULAR) ? ARRAY_ERROR_SINGULAR_MATRIX : ARRAY_SUCCESS;
+}
+
+// Function to solve linear systems
+ArrayError solve_array(ArrayType **result, const ArrayType *a, const ArrayType *b) {
+    if (!result || !b) return ARRAY_ERROR_NULL_POINTER;
+    ArrayError error = check_square(a);
+    if (error != ARRAY_SUCCESS) return error;
+    if (b->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (b->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (*result == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    int n = a->shape[a->ndim - 1];
+    int vector = b->ndim == a->ndim - 1;
+    if (!vector && b->ndim != a->ndim) return ARRAY_ERROR_INVALID_DIMENSION;
+    for (int d = 0; d < a->ndim - 2; d++) {
+        if (b->shape[d] != a->shape[d]) return ARRAY_ERROR_INVALID_DIMENSION;
+    }
+    if (b->shape[a->ndim - 2] != n) return ARRAY_ERROR_INVALID_DIMENSION;
+    int nrhs = vector ? 1 : b->shape[b->ndim - 1];
+
+    if (*result != b) {
+        error = prepare_result(result, b->shape, b->ndim);
+        if (error != ARRAY_SUCCESS) return error;
+        memcpy((*result)->data, b->data, b->size * sizeof(float));
+    } else {
+        error = array_make_writable(*result);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+    if (nrhs == 0) return ARRAY_SUCCESS;
+    return solve_batched(a->data, (*result)->data, n, nrhs, batch_count(a, 2));
+}
+
+// Function to invert square matrices
+ArrayError inv_array(ArrayType **result, const ArrayType *a) {
+    if (!result) return ARRAY_ERROR_NULL_POINTER;
+    ArrayError error = check_square(a);
+    if (error != ARRAY_SUCCESS) return error;
+
+    // Inverting in place needs a copy of the coefficients
+    const float *coef = a->data;
+    float *copy = NULL;
+    if (*result == a) {
+        copy = (float*)malloc(a->size * sizeof(float));
+        if (!copy) return ARRAY_ERROR_MEMORY_ALLOCATION;
+        memcpy(copy, a->data, a->size * sizeof(float));
+        coef = copy;
+        error = array_make_writable(*result);
+        if (error != ARRAY_SUCCESS) {
+            free(copy);
+            return error;
+        }
+    } else {
+        error = prepare_result(result, a->shape, a->ndim);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+
+    int n = a->shape[a->ndim - 1];
+    size_t batch = batch_count(a, 2), elems = (size_t)n * n;
+    float *x = (*result)->data;
+    memset(x, 0, a->size * sizeof(float));
+    for (size_t s = 0; s < batch; s++) {
+        for (int i = 0; i < n; i++) x[s * elems + (size_t)i * n + i] = 1.0f;
+    }
+
+    error = solve_batched(coef, x, n, n, batch);
+    free(copy);
+    return error;
+}
+
+// Function to compute Cholesky factors
+ArrayError cholesky_array(ArrayType **result, const ArrayType *a) {
+    if (!result) return ARRAY_ERROR_NULL_POINTER;
+    ArrayError error = check_square(a);
+    if (error != ARRAY_SUCCESS) return error;
+    if (*result != a) {
+        error = prepare_result(result, a->shape, a->ndim);
+        if (error != ARRAY_SUCCESS) return error;
+        memcpy((*result)->data, a->data, a->size * sizeof(float));
+    } else {
+        error = array_make_writable(*result);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+
+    int n = a->shape[a->ndim - 1];
+    size_t batch = batch_count(a, 2), elems = (size_t)n * n;
+    float *data = (*result)->data;
+    int parallel = parallel_over_batch(batch, n);
+    int flags = 0, not_pd = 0;
+
+    if (batch > 1 && n <= LINALG_SMALL_MAX) {
+        size_t ngroups = (batch + LINALG_LANES - 1) / LINALG_LANES;
+        int nthreads = parallel ? thread_count() : 1;
+        size_t per_thread = elems * LINALG_LANES;
+        float *bufs = (float*)malloc(nthreads * per_thread * sizeof(float));
+        if (!bufs) return ARRAY_ERROR_MEMORY_ALLOCATION;
+
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads) if (parallel) reduction(|:not_pd)
+#endif
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            float *buf = bufs + tid * per_thread;
+
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (size_t g = 0; g < ngroups; g++) {
+                int bad[LINALG_LANES] = {0};
+                size_t first = g * LINALG_LANES;
+                size_t count = batch - first < LINALG_LANES ? batch - first : LINALG_LANES;
+
+                pack_lanes(buf, data + first * elems, count, n, n, 1);
+                cholesky_lanes(buf, n, bad);
+                unpack_lanes(data + first * elems, buf, count, elems);
+                for (size_t l = 0; l < count; l++) not_pd |= bad[l];
+            }
+        }
+        free(bufs);
+    } else {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic) reduction(|:flags) reduction(|:not_pd) if (parallel)
+#endif
+        for (size_t s = 0; s < batch; s++) {
+            ArrayError status = cholesky_factor(data + s * elems, n);
+            not_pd |= status == ARRAY_ERROR_NOT_POSITIVE_DEFINITE;
+            flags |= status == ARRAY_ERROR_MEMORY_ALLOCATION;
+        }
+    }
+
+    if (flags) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    return not_pd ? ARRAY_ERROR_NOT_POSITIVE_DEFINITE : ARRAY_SUCCESS;
+}
+
+// Function to compute reduced QR factorizations
+ArrayError qr_array(ArrayType **q, ArrayType **r, const ArrayType *a) {
+    if (!a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->ndim < 2) return ARRAY_ERROR_INVALID_DIMENSION;
+    if ((q && *q == a) || (r && *r == a)) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    int m = a->shape[a->ndim - 2], n = a->shape[a->ndim - 1];
+    int k = min_int(m, n);
+    if (k <= 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+    size_t batch = batch_count(a, 2), elems = (size_t)m * n;
+
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(shape, a->shape, a->ndim * sizeof(int));
+    ArrayError error = ARRAY_SUCCESS;
+    if (q) {
+        shape[a->ndim - 1] = k;
+        error = prepare_result(q, shape, a->ndim);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+    if (r) {
+        shape[a->ndim - 2] = k;
+        shape[a->ndim - 1] = n;
+        error = prepare_result(r, shape, a->ndim);
+        if (error != ARRAY_SUCCESS) return error;
+    }
+
+    int parallel = parallel_over_batch(batch, n > m ? n : m);
+    int nthreads = parallel ? thread_count() : 1;
+    size_t per_thread = elems + (size_t)k + qr_work_size(m, n);
+    float *bufs = (float*)malloc(nthreads * per_thread * sizeof(float));
+    if (!bufs) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    int failed = 0;
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads) if (parallel) reduction(|:failed)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        float *fact = bufs + tid * per_thread;
+        float *tau = fact + elems;
+        float *work = tau + k;
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (size_t s = 0; s < batch; s++) {
+            memcpy(fact, a->data + s * elems, elems * sizeof(float));
+            if (qr_factor(fact, m, n, tau, work) != ARRAY_SUCCESS) {
+                failed = 1;
+                continue;
+            }
+            if (r) {
+                float *rs = (*r)->data + s * (size_t)k * n;
+                for (int i = 0; i < k; i++) {
+                    for (int c = 0; c < n; c++) rs[(size_t)i * n + c] = c < i ? 0.0f : fact[(size_t)i * n + c];
+                }
+            }
+            if (q && form_q((*q)->data + s * (size_t)m * k, fact, m, n, tau, work) != ARRAY_SUCCESS) {
+                failed = 1;
+            }
+        }
+    }
+
+    free(bufs);
+    return failed ? ARRAY_ERROR_MEMORY_ALLOCATION : ARRAY_SUCCESS;
+}
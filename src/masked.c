@@ -0,0 +1,382 @@
+#include "masked.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Elements per task when a single long row is reduced across threads, and per chunk
+// of every row in deterministic mode
+#define MASKED_CHUNK ARRAY_DETERMINISTIC_CHUNK
+
+// Partial result of a reduction: the sum or maximum of count elements
+typedef struct {
+    float value;
+    size_t count;
+} Partial;
+
+static size_t validity_words(size_t size) {
+    return (size + 63) / 64;
+}
+
+// Function to set or drop the validity bitmap of an array
+ArrayError array_set_validity(ArrayType *a, const uint8_t *bitmap, size_t offset) {
+    if (!a) return ARRAY_ERROR_NULL_POINTER;
+    if (!bitmap) {
+        free(a->validity);
+        a->validity = NULL;
+        return ARRAY_SUCCESS;
+    }
+
+    size_t nwords = validity_words(a->size);
+    uint64_t *bits = (uint64_t*)calloc(nwords ? nwords : 1, sizeof(uint64_t));
+    if (!bits) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    if (offset % 8 == 0) {
+        // Bytes in LSB-first order are the words' little-endian layout
+        memcpy(bits, bitmap + offset / 8, (a->size + 7) / 8);
+    } else {
+        for (size_t i = 0; i < a->size; i++) {
+            size_t bit = offset + i;
+            if ((bitmap[bit / 8] >> (bit % 8)) & 1) bits[i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+
+    free(a->validity);
+    a->validity = bits;
+    return ARRAY_SUCCESS;
+}
+
+// Function to mark NaN elements invalid
+ArrayError array_validity_from_nan(ArrayType *a) {
+    if (!a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    size_t nwords = validity_words(a->size);
+    uint64_t *bits = a->validity;
+    if (!bits) {
+        bits = (uint64_t*)malloc((nwords ? nwords : 1) * sizeof(uint64_t));
+        if (!bits) return ARRAY_ERROR_MEMORY_ALLOCATION;
+        memset(bits, 0xff, nwords * sizeof(uint64_t));
+    }
+
+    const float *x = a->data;
+    size_t n = a->size;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t w = 0; w < nwords; w++) {
+        size_t base = w * 64;
+        size_t len = n - base < 64 ? n - base : 64;
+        uint64_t word = 0;
+        for (size_t j = 0; j < len; j++) word |= (uint64_t)(x[base + j] == x[base + j]) << j;
+        bits[w] &= word;
+    }
+
+    a->validity = bits;
+    return ARRAY_SUCCESS;
+}
+
+// Function to count the invalid elements of an array
+size_t array_null_count(const ArrayType *a) {
+    if (!a || !a->validity) return 0;
+    size_t valid = 0, full = a->size / 64;
+    for (size_t w = 0; w < full; w++) valid += (size_t)__builtin_popcountll(a->validity[w]);
+    if (a->size % 64) {
+        uint64_t tail = ((uint64_t)1 << (a->size % 64)) - 1;
+        valid += (size_t)__builtin_popcountll(a->validity[full] & tail);
+    }
+    return a->size - valid;
+}
+
+// Function to check the validity of one element
+int array_is_valid(const ArrayType *a, size_t index) {
+    if (!a || index >= a->size) return 0;
+    return !a->validity || (int)((a->validity[index / 64] >> (index % 64)) & 1);
+}
+
+// Single-bit masks; testing bits against a table keeps the loops free of variable
+// shifts, which baseline x86-64 cannot vectorize
+static const uint32_t bit_masks[32] = {
+    1u << 0, 1u << 1, 1u << 2, 1u << 3, 1u << 4, 1u << 5, 1u << 6, 1u << 7,
+    1u << 8, 1u << 9, 1u << 10, 1u << 11, 1u << 12, 1u << 13, 1u << 14, 1u << 15,
+    1u << 16, 1u << 17, 1u << 18, 1u << 19, 1u << 20, 1u << 21, 1u << 22, 1u << 23,
+    1u << 24, 1u << 25, 1u << 26, 1u << 27, 1u << 28, 1u << 29, 1u << 30, 1u << 31
+};
+
+// Helper function to reduce up to 32 elements whose validity bits are bits 0 .. n - 1
+// of bits. op is '+' for sums, otherwise maxima.
+static void reduce_masked(Partial *p, const float *x, size_t n, uint32_t bits, char op) {
+    float value = p->value;
+    size_t count = 0;
+    if (op == '+') {
+#ifdef _OPENMP
+        #pragma omp simd reduction(+:value, count)
+#endif
+        for (size_t j = 0; j < n; j++) {
+            int ok = ((bits & bit_masks[j]) != 0) & (x[j] == x[j]);
+            value += ok ? x[j] : 0.0f;
+            count += ok;
+        }
+    } else {
+#ifdef _OPENMP
+        #pragma omp simd reduction(max:value) reduction(+:count)
+#endif
+        for (size_t j = 0; j < n; j++) {
+            int ok = ((bits & bit_masks[j]) != 0) & (x[j] == x[j]);
+            value = ok && x[j] > value ? x[j] : value;
+            count += ok;
+        }
+    }
+    p->value = value;
+    p->count += count;
+}
+
+// Helper function to reduce n elements that are all valid, skipping NaNs
+static void reduce_dense(Partial *p, const float *x, size_t n, char op) {
+    float value = p->value;
+    size_t count = 0;
+    if (op == '+') {
+#ifdef _OPENMP
+        #pragma omp simd reduction(+:value, count)
+#endif
+        for (size_t j = 0; j < n; j++) {
+            int ok = x[j] == x[j];
+            value += ok ? x[j] : 0.0f;
+            count += ok;
+        }
+    } else {
+#ifdef _OPENMP
+        #pragma omp simd reduction(max:value) reduction(+:count)
+#endif
+        for (size_t j = 0; j < n; j++) {
+            int ok = x[j] == x[j];
+            value = ok && x[j] > value ? x[j] : value;
+            count += ok;
+        }
+    }
+    p->value = value;
+    p->count += count;
+}
+
+// Helper function to reduce elements [start, start + n) of a contiguous array a bitmap
+// word at a time: words of zeros are skipped and words of ones take the dense path
+static Partial reduce_run(const float *data, const uint64_t *validity, size_t start, size_t n, char op) {
+    Partial p = {op == '+' ? 0.0f : -INFINITY, 0};
+    if (!validity) {
+        reduce_dense(&p, data + start, n, op);
+        return p;
+    }
+
+    size_t end = start + n;
+    for (size_t i = start; i < end;) {
+        size_t shift = i % 64;
+        size_t len = 64 - shift < end - i ? 64 - shift : end - i;
+        uint64_t mask = len == 64 ? ~(uint64_t)0 : ((uint64_t)1 << len) - 1;
+        uint64_t word = (validity[i / 64] >> shift) & mask;
+        if (word == mask) {
+            reduce_dense(&p, data + i, len, op);
+        } else if (word) {
+            size_t low = len < 32 ? len : 32;
+            reduce_masked(&p, data + i, low, (uint32_t)word, op);
+            if (len > 32) reduce_masked(&p, data + i + 32, len - 32, (uint32_t)(word >> 32), op);
+        }
+        i += len;
+    }
+    return p;
+}
+
+static float finish(Partial p, char op) {
+    if (op == '+') return p.value;
+    if (p.count == 0) return NAN;
+    return op == 'm' ? p.value / (float)p.count : p.value;
+}
+
+static void combine(Partial *p, Partial q, char op) {
+    if (op == '+' || op == 'm') {
+        p->value += q.value;
+    } else if (q.value > p->value) {
+        p->value = q.value;
+    }
+    p->count += q.count;
+}
+
+// Pairwise combination of the partial results of consecutive chunks, kept as a binary
+// counter of complete subtrees: level k holds the combination of 2^k chunks. The
+// shape of the tree depends only on the number of chunks.
+typedef struct {
+    Partial level[64];
+    size_t count;
+} PartialTree;
+
+static void tree_push(PartialTree *t, Partial q, char op) {
+    size_t c = t->count++;
+    int k = 0;
+    for (; (c >> k) & 1; k++) {
+        Partial left = t->level[k];
+        combine(&left, q, op);
+        q = left;
+    }
+    t->level[k] = q;
+}
+
+static Partial tree_result(const PartialTree *t, char op) {
+    Partial p = {op == 'M' ? -INFINITY : 0.0f, 0};
+    int first = 1;
+    for (int k = 63; k >= 0; k--) {
+        if (!((t->count >> k) & 1)) continue;
+        if (first) {
+            p = t->level[k];
+            first = 0;
+        } else {
+            combine(&p, t->level[k], op);
+        }
+    }
+    return p;
+}
+
+// Helper function to reduce a row chunk by chunk with a fixed combine tree
+static Partial reduce_row_chunked(const float *data, const uint64_t *validity, size_t start, size_t n,
+                                  char kind, char op) {
+    PartialTree tree;
+    tree.count = 0;
+    for (size_t c = 0; c < n; c += MASKED_CHUNK) {
+        size_t len = n - c < MASKED_CHUNK ? n - c : MASKED_CHUNK;
+        tree_push(&tree, reduce_run(data, validity, start + c, len, kind), op);
+    }
+    return tree_result(&tree, op);
+}
+
+// Helper function for NaN-aware reductions along an axis. op is '+' for nansum,
+// 'm' for nanmean and 'M' for nanmax.
+static ArrayError nan_reduce(ArrayType **result, const ArrayType *a, int axis, char op) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view || *result == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    int shape[ARRAY_MAX_DIMS];
+    int ndim = 0;
+    for (int d = 0; d < a->ndim; d++) {
+        if (d != axis) shape[ndim++] = a->shape[d];
+    }
+    if (ndim == 0) shape[ndim++] = 1;
+    ArrayError error = prepare_result(result, shape, ndim);
+    if (error != ARRAY_SUCCESS) return error;
+
+    size_t outer = 1, inner = 1;
+    size_t n = (size_t)a->shape[axis];
+    for (int d = 0; d < axis; d++) outer *= a->shape[d];
+    for (int d = axis + 1; d < a->ndim; d++) inner *= a->shape[d];
+
+    const float *data = a->data;
+    const uint64_t *validity = a->validity;
+    float *out = (*result)->data;
+    char kind = op == 'M' ? 'M' : '+';
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+
+    if (inner == 1 && outer < (size_t)nthreads && n >= 2 * MASKED_CHUNK) {
+        // Few long rows: split each row into chunks reduced in parallel
+        size_t nchunks = (n + MASKED_CHUNK - 1) / MASKED_CHUNK;
+        Partial *parts = (Partial*)malloc(nchunks * sizeof(Partial));
+        if (!parts) return ARRAY_ERROR_MEMORY_ALLOCATION;
+        for (size_t o = 0; o < outer; o++) {
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(static)
+#endif
+            for (size_t c = 0; c < nchunks; c++) {
+                size_t start = c * MASKED_CHUNK;
+                size_t len = n - start < MASKED_CHUNK ? n - start : MASKED_CHUNK;
+                parts[c] = reduce_run(data, validity, o * n + start, len, kind);
+            }
+            PartialTree tree;
+            tree.count = 0;
+            for (size_t c = 0; c < nchunks; c++) tree_push(&tree, parts[c], op);
+            out[o] = finish(tree_result(&tree, op), op);
+        }
+        free(parts);
+        return ARRAY_SUCCESS;
+    }
+
+    if (inner == 1) {
+        // Deterministic mode chunks every row as the parallel path above does
+        int deterministic = array_get_deterministic();
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t o = 0; o < outer; o++) {
+            Partial p = deterministic ? reduce_row_chunked(data, validity, o * n, n, kind, op)
+                                      : reduce_run(data, validity, o * n, n, kind);
+            out[o] = finish(p, op);
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    // Outer axes: accumulate whole rows of inner elements into per-block accumulators
+    size_t blocks_per_row = (inner + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+    size_t ntasks = outer * blocks_per_row;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t t = 0; t < ntasks; t++) {
+        float acc[ARRAY_BLOCK_SIZE];
+        uint32_t count[ARRAY_BLOCK_SIZE];
+        size_t o = t / blocks_per_row;
+        size_t j0 = (t % blocks_per_row) * ARRAY_BLOCK_SIZE;
+        size_t len = inner - j0 < ARRAY_BLOCK_SIZE ? inner - j0 : ARRAY_BLOCK_SIZE;
+        for (size_t j = 0; j < len; j++) {
+            acc[j] = kind == '+' ? 0.0f : -INFINITY;
+            count[j] = 0;
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            size_t base = (o * n + k) * inner + j0;
+            const float *x = data + base;
+            if (kind == '+') {
+                ARRAY_OMP_SIMD
+                for (size_t j = 0; j < len; j++) {
+                    size_t i = base + j;
+                    int ok = (!validity || ((validity[i / 64] >> (i % 64)) & 1)) && x[j] == x[j];
+                    acc[j] += ok ? x[j] : 0.0f;
+                    count[j] += ok;
+                }
+            } else {
+                ARRAY_OMP_SIMD
+                for (size_t j = 0; j < len; j++) {
+                    size_t i = base + j;
+                    int ok = (!validity || ((validity[i / 64] >> (i % 64)) & 1)) && x[j] == x[j];
+                    acc[j] = ok && x[j] > acc[j] ? x[j] : acc[j];
+                    count[j] += ok;
+                }
+            }
+        }
+
+        for (size_t j = 0; j < len; j++) {
+            Partial p = {acc[j], count[j]};
+            out[o * inner + j0 + j] = finish(p, op);
+        }
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Function to sum valid, non-NaN elements along an axis
+ArrayError nansum_array(ArrayType **result, const ArrayType *a, int axis) {
+    return nan_reduce(result, a, axis, '+');
+}
+
+// Function to average valid, non-NaN elements along an axis
+ArrayError nanmean_array(ArrayType **result, const ArrayType *a, int axis) {
+    return nan_reduce(result, a, axis, 'm');
+}
+
+// Function to take the maximum of valid, non-NaN elements along an axis
+ArrayError nanmax_array(ArrayType **result, const ArrayType *a, int axis) {
+    return nan_reduce(result, a, axis, 'M');
+}
@@ -1,51 +1,434 @@
-#include "memory.h"
-#include <stdlib.h>
-#include <stdio.h>
-#include <string.h>
-
-// Create a memory pool of the specified size
-MemoryPoolType* create_memory_pool(size_t size) {
-    MemoryPoolType *pool = (MemoryPoolType*)malloc(sizeof(MemoryPoolType));
-    if (!pool) {
-        fprintf(stderr, "Failed to allocate memory for memory pool structure\n");
-        return NULL;
-    }
-
-    pool->start = malloc(size);
-    if (!pool->start) {
-        free(pool);
-        fprintf(stderr, "Failed to allocate memory for memory pool\n");
-        return NULL;
-    }
-
-    pool->current = pool->start;
-    pool->size = size;
-    pool->used = 0;
-    return pool;
-}
-
-// Allocate memory from the memory pool
-void* allocate_from_pool(MemoryPoolType* pool, size_t size) {
-    if (!pool || !pool->start) {
-        fprintf(stderr, "Memory pool is not initialized\n");
-        return NULL;
-    }
-
-    if (pool->used + size > pool->size) {
-        fprintf(stderr, "Not enough memory in the pool\n");
-        return NULL;
-    }
-
-    void *ptr = pool->current;
-    pool->current = (char*)pool->current + size;
-    pool->used += size;
-    return ptr;
-}
-
-// Destroy the memory pool and free all associated memory
-void destroy_memory_pool(MemoryPoolType* pool) {
-    if (pool) {
-        free(pool->start);
-        free(pool);
-    }
-}
+#define _GNU_SOURCE
+#include "memory.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#define MEMORY_HAVE_MMAP 1
+#endif
+
+// Size and alignment of the pages requested by the huge-page allocator
+#define HUGEPAGE_SIZE ((size_t)2 << 20)
+
+// Buffer cache size classes: four per power of two, indexed by 4 * log2(size)
+// plus the two bits below the leading one
+#define CACHE_CLASSES (64 * 4)
+
+// Header written into the first bytes of a cached block; it records the
+// allocator the block must be returned to
+typedef struct CachedBlock {
+    struct CachedBlock *next;
+    size_t size;
+    void* (*alloc)(size_t size, size_t alignment, int zero, void *ctx);
+    void (*free)(void *ptr, size_t size, void *ctx);
+    void *ctx;
+    size_t alignment;
+} CachedBlock;
+
+// Blocks carved from memory pools are kept on bins of their own: their headers
+// live in the pool, so once any pool has been destroyed the thread drops them
+// all without reading them
+typedef struct {
+    CachedBlock *bins[CACHE_CLASSES];
+    CachedBlock *pool_bins[CACHE_CLASSES];
+    size_t cached_bytes;
+    size_t pool_bytes;
+    unsigned long pool_epoch;
+    size_t limit;
+    int limit_set;
+    int registered;
+    size_t hits;
+    size_t misses;
+} BufferCache;
+
+static __thread BufferCache thread_cache;
+static size_t default_cache_limit = ARRAY_CACHE_DEFAULT_LIMIT;
+static pthread_key_t cache_key;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+// Number of memory pools destroyed so far
+static unsigned long pool_epoch;
+
+static void cache_purge_ctx(const void *ctx);
+
+// Create a memory pool of the specified size
+MemoryPoolType* create_memory_pool(size_t size) {
+    MemoryPoolType *pool = (MemoryPoolType*)malloc(sizeof(MemoryPoolType));
+    if (!pool) {
+        fprintf(stderr, "Failed to allocate memory for memory pool structure\n");
+        return NULL;
+    }
+
+    pool->start = malloc(size);
+    if (!pool->start) {
+        free(pool);
+        fprintf(stderr, "Failed to allocate memory for memory pool\n");
+        return NULL;
+    }
+
+    pool->current = pool->start;
+    pool->size = size;
+    pool->used = 0;
+    return pool;
+}
+
+// Allocate memory from the memory pool
+void* allocate_from_pool(MemoryPoolType* pool, size_t size) {
+    if (!pool || !pool->start) {
+        fprintf(stderr, "Memory pool is not initialized\n");
+        return NULL;
+    }
+
+    if (pool->used + size > pool->size) {
+        fprintf(stderr, "Not enough memory in the pool\n");
+        return NULL;
+    }
+
+    void *ptr = pool->current;
+    pool->current = (char*)pool->current + size;
+    pool->used += size;
+    return ptr;
+}
+
+// Destroy the memory pool and free all associated memory
+void destroy_memory_pool(MemoryPoolType* pool) {
+    if (pool) {
+        cache_purge_ctx(pool);
+        // Other threads drop their pool blocks when they next see the epoch move;
+        // the calling thread has just purged this pool's and keeps the others
+        unsigned long epoch = __atomic_fetch_add(&pool_epoch, 1, __ATOMIC_RELEASE);
+        if (thread_cache.pool_epoch == epoch) thread_cache.pool_epoch = epoch + 1;
+        free(pool->start);
+        free(pool);
+    }
+}
+
+// Default allocator callbacks
+static void* malloc_alloc(size_t size, size_t alignment, int zero, void *ctx) {
+    (void)alignment;
+    (void)ctx;
+    if (size == 0) size = 1;
+    return zero ? calloc(size, 1) : malloc(size);
+}
+
+static void malloc_free(void *ptr, size_t size, void *ctx) {
+    (void)size;
+    (void)ctx;
+    free(ptr);
+}
+
+static void* malloc_realloc(void *ptr, size_t old_size, size_t new_size, size_t alignment, void *ctx) {
+    (void)old_size;
+    (void)alignment;
+    (void)ctx;
+    return realloc(ptr, new_size ? new_size : 1);
+}
+
+const ArrayAllocator array_allocator_malloc = {
+    malloc_alloc, malloc_free, malloc_realloc, 16, NULL
+};
+
+static const ArrayAllocator *current_allocator = &array_allocator_malloc;
+
+// Install the allocator used for new array data
+void array_set_allocator(const ArrayAllocator *allocator) {
+    __atomic_store_n(&current_allocator, allocator ? allocator : &array_allocator_malloc, __ATOMIC_RELEASE);
+}
+
+// Get the allocator used for new array data
+const ArrayAllocator* array_get_allocator(void) {
+    return __atomic_load_n(&current_allocator, __ATOMIC_ACQUIRE);
+}
+
+// Aligned allocator callbacks
+static void* aligned_alloc_block(size_t size, size_t alignment, int zero, void *ctx) {
+    (void)ctx;
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, alignment, size ? size : 1) != 0) return NULL;
+    if (zero) memset(ptr, 0, size);
+    return ptr;
+}
+
+static void* aligned_realloc_block(void *ptr, size_t old_size, size_t new_size, size_t alignment, void *ctx) {
+    void *block = aligned_alloc_block(new_size, alignment, 0, ctx);
+    if (!block) return NULL;
+    memcpy(block, ptr, old_size < new_size ? old_size : new_size);
+    free(ptr);
+    return block;
+}
+
+// Describe an allocator built on posix_memalign
+ArrayAllocator array_allocator_aligned(size_t alignment) {
+    ArrayAllocator allocator = {
+        aligned_alloc_block, malloc_free, aligned_realloc_block, alignment, NULL
+    };
+    return allocator;
+}
+
+#ifdef MEMORY_HAVE_MMAP
+static size_t round_to_hugepage(size_t size) {
+    return (size + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+}
+
+// Map a 2 MB-aligned region by over-mapping by one huge page and trimming both ends,
+// then ask for transparent huge pages on it
+static void* map_transparent(size_t length) {
+    size_t span = length + HUGEPAGE_SIZE;
+    char *raw = (char*)mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+
+    char *start = (char*)(((uintptr_t)raw + HUGEPAGE_SIZE - 1) & ~(uintptr_t)(HUGEPAGE_SIZE - 1));
+    size_t head = (size_t)(start - raw), tail = span - head - length;
+    if (head) munmap(raw, head);
+    if (tail) munmap(start + length, tail);
+#ifdef MADV_HUGEPAGE
+    madvise(start, length, MADV_HUGEPAGE);
+#endif
+    return start;
+}
+
+static void* hugepage_alloc(size_t size, size_t alignment, int zero, void *ctx) {
+    if (size < HUGEPAGE_MIN_SIZE) return aligned_alloc_block(size, alignment, zero, NULL);
+
+    size_t length = round_to_hugepage(size);
+#ifdef MAP_HUGETLB
+    if (*(const HugePageMode*)ctx == HUGEPAGE_HUGETLB) {
+        void *ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) return ptr;
+    }
+#else
+    (void)ctx;
+#endif
+    return map_transparent(length);
+}
+
+static void hugepage_free(void *ptr, size_t size, void *ctx) {
+    (void)ctx;
+    if (size < HUGEPAGE_MIN_SIZE) {
+        free(ptr);
+    } else {
+        munmap(ptr, round_to_hugepage(size));
+    }
+}
+
+static const HugePageMode hugepage_modes[] = {HUGEPAGE_TRANSPARENT, HUGEPAGE_HUGETLB};
+#endif
+
+// Describe an allocator backing large blocks with 2 MB pages
+ArrayAllocator array_allocator_hugepage(HugePageMode mode) {
+#ifdef MEMORY_HAVE_MMAP
+    ArrayAllocator allocator = {
+        hugepage_alloc, hugepage_free, NULL, 64,
+        (void*)&hugepage_modes[mode == HUGEPAGE_HUGETLB ? 1 : 0]
+    };
+    return allocator;
+#else
+    (void)mode;
+    return array_allocator_aligned(64);
+#endif
+}
+
+// Pool allocator callbacks: allocate_from_pool is a bump allocator, so blocks are
+// aligned by padding and never freed individually
+static void* pool_alloc(size_t size, size_t alignment, int zero, void *ctx) {
+    MemoryPoolType *pool = (MemoryPoolType*)ctx;
+    if (!pool || !pool->current) return NULL;
+    size_t pad = (alignment - (uintptr_t)pool->current % alignment) % alignment;
+    char *ptr = (char*)allocate_from_pool(pool, pad + (size ? size : 1));
+    if (!ptr) return NULL;
+    ptr += pad;
+    if (zero) memset(ptr, 0, size);
+    return ptr;
+}
+
+static void pool_free(void *ptr, size_t size, void *ctx) {
+    (void)ptr;
+    (void)size;
+    (void)ctx;
+}
+
+// Describe an allocator drawing from a memory pool
+ArrayAllocator array_allocator_pool(MemoryPoolType *pool) {
+    ArrayAllocator allocator = {pool_alloc, pool_free, NULL, 16, pool};
+    return allocator;
+}
+
+static size_t cache_class(size_t size) {
+    int e = 63 - __builtin_clzll((unsigned long long)size);
+    return (size_t)e * 4 + ((size >> (e - 2)) & 3);
+}
+
+static size_t cache_limit(const BufferCache *cache) {
+    return cache->limit_set ? cache->limit : __atomic_load_n(&default_cache_limit, __ATOMIC_RELAXED);
+}
+
+// Helper function to forget the pool blocks of a cache after a pool was destroyed.
+// Pool blocks are never freed individually, so dropping them releases nothing.
+static void cache_check_pools(BufferCache *cache) {
+    unsigned long epoch = __atomic_load_n(&pool_epoch, __ATOMIC_ACQUIRE);
+    if (cache->pool_epoch == epoch) return;
+    if (cache->pool_bytes) {
+        memset(cache->pool_bins, 0, sizeof(cache->pool_bins));
+        cache->cached_bytes -= cache->pool_bytes;
+        cache->pool_bytes = 0;
+    }
+    cache->pool_epoch = epoch;
+}
+
+static CachedBlock** cache_bins(BufferCache *cache, void (*release)(void*, size_t, void*)) {
+    return release == pool_free ? cache->pool_bins : cache->bins;
+}
+
+static int cache_matches(const CachedBlock *block, const ArrayAllocator *allocator) {
+    return block->alloc == allocator->alloc && block->free == allocator->free &&
+           block->ctx == allocator->ctx && block->alignment == allocator->alignment;
+}
+
+// Helper function to hand a cached block back to its allocator
+static void cache_release_block(CachedBlock *block) {
+    void (*release)(void*, size_t, void*) = block->free;
+    size_t size = block->size;
+    void *ctx = block->ctx;
+    release(block, size, ctx);
+}
+
+// Helper function to free cached blocks, largest first, until at most keep bytes remain
+static void cache_trim(BufferCache *cache, size_t keep_bytes) {
+    cache_check_pools(cache);
+    for (size_t c = CACHE_CLASSES; c-- > 0 && cache->cached_bytes > keep_bytes;) {
+        while (cache->bins[c] && cache->cached_bytes > keep_bytes) {
+            CachedBlock *block = cache->bins[c];
+            cache->bins[c] = block->next;
+            cache->cached_bytes -= block->size;
+            cache_release_block(block);
+        }
+        while (cache->pool_bins[c] && cache->cached_bytes > keep_bytes) {
+            CachedBlock *block = cache->pool_bins[c];
+            cache->pool_bins[c] = block->next;
+            cache->cached_bytes -= block->size;
+            cache->pool_bytes -= block->size;
+        }
+    }
+}
+
+// Thread exit hook returning every cached block to its allocator
+static void cache_destroy(void *arg) {
+    cache_trim((BufferCache*)arg, 0);
+}
+
+static void cache_create_key(void) {
+    pthread_key_create(&cache_key, cache_destroy);
+}
+
+// Helper function to drop the calling thread's cached blocks of a memory pool
+static void cache_purge_ctx(const void *ctx) {
+    BufferCache *cache = &thread_cache;
+    cache_check_pools(cache);
+    for (size_t c = 0; c < CACHE_CLASSES && cache->pool_bytes; c++) {
+        CachedBlock **link = &cache->pool_bins[c];
+        while (*link) {
+            CachedBlock *block = *link;
+            if (block->ctx != ctx) {
+                link = &block->next;
+                continue;
+            }
+            *link = block->next;
+            cache->cached_bytes -= block->size;
+            cache->pool_bytes -= block->size;
+        }
+    }
+}
+
+// Allocate a block, reusing one from the calling thread's cache when possible
+void* array_cache_alloc(const ArrayAllocator *allocator, size_t *size, int zero) {
+    if (!allocator || !size) return NULL;
+    size_t request = *size;
+    BufferCache *cache = &thread_cache;
+
+    if (request >= ARRAY_CACHE_MIN_SIZE && cache_limit(cache) > 0) {
+        cache_check_pools(cache);
+        CachedBlock **bins = cache_bins(cache, allocator->free);
+        // Blocks in the request's class may be smaller; the next three classes
+        // hold blocks larger than the request but below twice its size
+        size_t first = cache_class(request);
+        for (size_t c = first; c < first + 4 && c < CACHE_CLASSES; c++) {
+            for (CachedBlock **link = &bins[c]; *link; link = &(*link)->next) {
+                CachedBlock *block = *link;
+                if (block->size < request || !cache_matches(block, allocator)) continue;
+                *link = block->next;
+                cache->cached_bytes -= block->size;
+                if (bins == cache->pool_bins) cache->pool_bytes -= block->size;
+                cache->hits++;
+                *size = block->size;
+                if (zero) memset(block, 0, request);
+                return block;
+            }
+        }
+        cache->misses++;
+    }
+
+    return allocator->alloc(request, allocator->alignment, zero, allocator->ctx);
+}
+
+// Release a block into the calling thread's cache, or to its allocator
+void array_cache_free(const ArrayAllocator *allocator, void *ptr, size_t size) {
+    if (!allocator || !ptr) return;
+    BufferCache *cache = &thread_cache;
+    size_t limit = cache_limit(cache);
+
+    cache_check_pools(cache);
+    if (size < ARRAY_CACHE_MIN_SIZE || size > limit || cache->cached_bytes > limit - size) {
+        allocator->free(ptr, size, allocator->ctx);
+        return;
+    }
+
+    if (!cache->registered) {
+        pthread_once(&cache_key_once, cache_create_key);
+        pthread_setspecific(cache_key, cache);
+        cache->registered = 1;
+    }
+
+    CachedBlock *block = (CachedBlock*)ptr;
+    CachedBlock **bins = cache_bins(cache, allocator->free);
+    size_t c = cache_class(size);
+    block->size = size;
+    block->alloc = allocator->alloc;
+    block->free = allocator->free;
+    block->ctx = allocator->ctx;
+    block->alignment = allocator->alignment;
+    block->next = bins[c];
+    bins[c] = block;
+    cache->cached_bytes += size;
+    if (bins == cache->pool_bins) cache->pool_bytes += size;
+}
+
+// Set the calling thread's cache limit
+void array_cache_set_limit(size_t bytes) {
+    thread_cache.limit = bytes;
+    thread_cache.limit_set = 1;
+    cache_trim(&thread_cache, bytes);
+}
+
+// Set the cache limit of threads without their own
+void array_cache_set_default_limit(size_t bytes) {
+    __atomic_store_n(&default_cache_limit, bytes, __ATOMIC_RELAXED);
+}
+
+// Free cached blocks of the calling thread down to a number of bytes
+void array_cache_trim(size_t keep_bytes) {
+    cache_trim(&thread_cache, keep_bytes);
+}
+
+// Report the calling thread's cache counters
+void array_cache_get_stats(ArrayCacheStats *stats) {
+    if (!stats) return;
+    cache_check_pools(&thread_cache);
+    stats->cached_bytes = thread_cache.cached_bytes;
+    stats->limit = cache_limit(&thread_cache);
+    stats->hits = thread_cache.hits;
+    stats->misses = thread_cache.misses;
+}
@@ -0,0 +1,469 @@
+#define _GNU_SOURCE
+#include "pipeline.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#define PIPELINE_POSIX 1
+#endif
+
+// Unproductive passes over its workers after which a thread yields its core
+#define PIPELINE_SPIN_LIMIT 64
+
+// Alignment of the arrays carved from the pool and of the pipeline's own structures
+#define PIPELINE_ALIGNMENT 64
+
+enum { WAIT_NONE = 0, WAIT_INPUT, WAIT_OUTPUT };
+
+// An array travelling through a ring, with the item it holds
+typedef struct {
+    ArrayType *array;
+    long index;
+    double ready;  // Time the item was handed to the next stage
+} PipelineSlot;
+
+typedef struct {
+    size_t sequence;
+    PipelineSlot *slot;
+} QueueCell;
+
+// Bounded multi-producer multi-consumer queue (Dmitry Vyukov). Each cell carries a
+// sequence number telling whether it is ready to be written (sequence == position) or
+// read (sequence == position + 1) at a given position, so producers and consumers
+// only contend on their own position counter.
+typedef struct {
+    QueueCell *cells;
+    size_t mask;
+    size_t enqueue_pos __attribute__((aligned(64)));
+    size_t dequeue_pos __attribute__((aligned(64)));
+} PipelineQueue;
+
+// Arrays between two stages: free ones go upstream, full ones downstream
+typedef struct {
+    PipelineSlot *slots;
+    PipelineQueue free_queue;
+    PipelineQueue full_queue;
+} PipelineRing;
+
+// Worker state, padded to cache lines so that workers on different threads do not share one
+typedef struct {
+    int stage __attribute__((aligned(64)));
+    int finished;
+    PipelineSlot *pending;  // Input taken while waiting for a free output array
+    int waiting;            // WAIT_* kind of the current wait
+    double wait_start;
+    PipelineStats stats;
+} PipelineWorker;
+
+struct Pipeline {
+    PipelineStage *stages;  // Copies, with shapes pointing into shapes
+    int *shapes;
+    int nstages;
+    int depth;
+    PipelineRing *rings;    // nstages - 1 rings; ring s is filled by stage s
+    PipelineWorker *workers;
+    int nworkers;
+    MemoryPoolType *pool;
+    int owns_pool;
+    long items;
+    long next_index __attribute__((aligned(64)));  // Next item the first stage produces
+    long *taken;                                   // Items each stage took from its input queue
+    int error;                                     // First error, ARRAY_SUCCESS while running
+};
+
+static double now_seconds(void) {
+#if defined(_OPENMP)
+    return omp_get_wtime();
+#elif defined(PIPELINE_POSIX)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static void yield_core(void) {
+#ifdef PIPELINE_POSIX
+    sched_yield();
+#endif
+}
+
+// Helper function to allocate zeroed structures with cache-line aligned members, which
+// calloc only aligns to 16 bytes; the memory is released with free
+static void* calloc_aligned(size_t count, size_t size) {
+    void *ptr = NULL;
+    size_t bytes = count * size;
+    if (posix_memalign(&ptr, PIPELINE_ALIGNMENT, bytes ? bytes : 1) != 0) return NULL;
+    memset(ptr, 0, bytes);
+    return ptr;
+}
+
+static int queue_init(PipelineQueue *q, int capacity) {
+    size_t size = 1;
+    while (size < (size_t)capacity) size *= 2;
+    q->cells = (QueueCell*)malloc(size * sizeof(QueueCell));
+    q->mask = size - 1;
+    return q->cells != NULL;
+}
+
+static void queue_reset(PipelineQueue *q) {
+    for (size_t i = 0; i <= q->mask; i++) {
+        q->cells[i].sequence = i;
+        q->cells[i].slot = NULL;
+    }
+    q->enqueue_pos = 0;
+    q->dequeue_pos = 0;
+}
+
+// Helper function to append a slot; returns 0 when the queue is full
+static int queue_push(PipelineQueue *q, PipelineSlot *slot) {
+    size_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    QueueCell *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    cell->slot = slot;
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Helper function to take the oldest slot; returns NULL when the queue is empty
+static PipelineSlot* queue_pop(PipelineQueue *q) {
+    size_t pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+    QueueCell *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->dequeue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    PipelineSlot *slot = cell->slot;
+    __atomic_store_n(&cell->sequence, pos + q->mask + 1, __ATOMIC_RELEASE);
+    return slot;
+}
+
+// Helper function to create the array of a slot in the pool
+static ArrayType* create_slot_array(Pipeline *p, int stage, ArrayError *error) {
+    const PipelineStage *st = &p->stages[stage];
+    size_t size = 1;
+    for (int d = 0; d < st->ndim; d++) size *= st->shape[d];
+    ArrayAllocator allocator = array_allocator_pool(p->pool);
+    float *data = (float*)allocator.alloc(size * sizeof(float), PIPELINE_ALIGNMENT, 1, allocator.ctx);
+    if (!data) {
+        // The pool is exhausted once an array was replaced by a stage; use the heap
+        return create_array(st->shape, st->ndim, error);
+    }
+    return array_wrap(data, st->shape, st->ndim, NULL, NULL, error);
+}
+
+// Function to create a pipeline
+Pipeline* pipeline_create(const PipelineStage *stages, int nstages, int depth, MemoryPoolType *pool, ArrayError *error) {
+    if (!stages) {
+        if (error) *error = ARRAY_ERROR_NULL_POINTER;
+        return NULL;
+    }
+    if (nstages < 2 || depth < 1) {
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    int nworkers = 0, shape_len = 0;
+    size_t pool_bytes = 0;
+    for (int s = 0; s < nstages; s++) {
+        if (!stages[s].fn || stages[s].workers < 1) {
+            if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+            return NULL;
+        }
+        nworkers += stages[s].workers;
+        if (s == nstages - 1) continue;
+        if (!stages[s].shape || stages[s].ndim < 1) {
+            if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
+            return NULL;
+        }
+        size_t size = 1;
+        for (int d = 0; d < stages[s].ndim; d++) {
+            if (stages[s].shape[d] <= 0) {
+                if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
+                return NULL;
+            }
+            size *= stages[s].shape[d];
+        }
+        shape_len += stages[s].ndim;
+        pool_bytes += (size_t)depth * (size * sizeof(float) + PIPELINE_ALIGNMENT);
+    }
+
+    Pipeline *p = (Pipeline*)calloc_aligned(1, sizeof(Pipeline));
+    if (!p) {
+        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        return NULL;
+    }
+    p->nstages = nstages;
+    p->depth = depth;
+    p->nworkers = nworkers;
+    p->stages = (PipelineStage*)malloc(nstages * sizeof(PipelineStage));
+    p->shapes = (int*)malloc((shape_len ? shape_len : 1) * sizeof(int));
+    p->rings = (PipelineRing*)calloc_aligned(nstages - 1, sizeof(PipelineRing));
+    p->workers = (PipelineWorker*)calloc_aligned(nworkers, sizeof(PipelineWorker));
+    p->taken = (long*)calloc(nstages, sizeof(long));
+    p->pool = pool ? pool : create_memory_pool(pool_bytes);
+    p->owns_pool = pool == NULL;
+    if (!p->stages || !p->shapes || !p->rings || !p->workers || !p->taken || !p->pool) {
+        pipeline_free(p);
+        if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        return NULL;
+    }
+
+    int offset = 0, w = 0;
+    for (int s = 0; s < nstages; s++) {
+        p->stages[s] = stages[s];
+        for (int k = 0; k < stages[s].workers; k++) p->workers[w++].stage = s;
+        if (s == nstages - 1) {
+            p->stages[s].shape = NULL;
+            p->stages[s].ndim = 0;
+            continue;
+        }
+        memcpy(p->shapes + offset, stages[s].shape, stages[s].ndim * sizeof(int));
+        p->stages[s].shape = p->shapes + offset;
+        offset += stages[s].ndim;
+    }
+
+    for (int r = 0; r < nstages - 1; r++) {
+        PipelineRing *ring = &p->rings[r];
+        ring->slots = (PipelineSlot*)calloc(depth, sizeof(PipelineSlot));
+        if (!ring->slots || !queue_init(&ring->free_queue, depth) || !queue_init(&ring->full_queue, depth)) {
+            pipeline_free(p);
+            if (error) *error = ARRAY_ERROR_MEMORY_ALLOCATION;
+            return NULL;
+        }
+        for (int k = 0; k < depth; k++) {
+            ArrayError err;
+            ring->slots[k].array = create_slot_array(p, r, &err);
+            if (!ring->slots[k].array) {
+                pipeline_free(p);
+                if (error) *error = err;
+                return NULL;
+            }
+        }
+    }
+    if (error) *error = ARRAY_SUCCESS;
+    return p;
+}
+
+// Helper function to close the current wait of a worker and add up its duration
+static void end_wait(PipelineWorker *w, double now) {
+    if (w->waiting == WAIT_INPUT) w->stats.input_wait += now - w->wait_start;
+    if (w->waiting == WAIT_OUTPUT) w->stats.output_wait += now - w->wait_start;
+    w->waiting = WAIT_NONE;
+}
+
+// Helper function to note that a worker cannot proceed; a wait counts as one stall however long it lasts
+static int stall(PipelineWorker *w, int kind) {
+    if (w->waiting == kind) return 0;
+    double now = now_seconds();
+    end_wait(w, now);
+    w->waiting = kind;
+    w->wait_start = now;
+    if (kind == WAIT_INPUT) w->stats.input_stalls++;
+    else w->stats.output_stalls++;
+    return 0;
+}
+
+static void set_error(Pipeline *p, ArrayError error) {
+    int expected = ARRAY_SUCCESS;
+    __atomic_compare_exchange_n(&p->error, &expected, (int)error, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// Helper function to advance a worker by at most one item without blocking.
+// Returns 1 after processing an item, 0 when it has to wait and -1 once it is done.
+static int worker_step(Pipeline *p, PipelineWorker *w) {
+    int s = w->stage;
+    const PipelineStage *stage = &p->stages[s];
+    PipelineRing *in_ring = s > 0 ? &p->rings[s - 1] : NULL;
+    PipelineRing *out_ring = s < p->nstages - 1 ? &p->rings[s] : NULL;
+    PipelineSlot *in = w->pending, *out = NULL;
+
+    if (in_ring && !in) {
+        if (__atomic_load_n(&p->taken[s], __ATOMIC_ACQUIRE) >= p->items) {
+            end_wait(w, now_seconds());
+            return -1;
+        }
+        in = queue_pop(&in_ring->full_queue);
+        if (!in) return stall(w, WAIT_INPUT);
+        __atomic_fetch_add(&p->taken[s], 1, __ATOMIC_ACQ_REL);
+        double queued = now_seconds() - in->ready;
+        w->stats.queue_latency += queued;
+        if (queued > w->stats.max_queue_latency) w->stats.max_queue_latency = queued;
+        w->pending = in;
+    }
+    if (out_ring) {
+        out = queue_pop(&out_ring->free_queue);
+        if (!out) return stall(w, WAIT_OUTPUT);
+    }
+
+    long index;
+    if (in) {
+        index = in->index;
+    } else {
+        // The first stage claims an item only once it holds a free array
+        index = __atomic_fetch_add(&p->next_index, 1, __ATOMIC_RELAXED);
+        if (index >= p->items) {
+            queue_push(&out_ring->free_queue, out);
+            end_wait(w, now_seconds());
+            return -1;
+        }
+    }
+
+    double start = now_seconds();
+    end_wait(w, start);
+    ArrayError error = stage->fn(in ? in->array : NULL, out ? &out->array : NULL, index, stage->ctx);
+    if (error == ARRAY_SUCCESS && out && !out->array) error = ARRAY_ERROR_NULL_POINTER;
+    double end = now_seconds();
+    w->stats.items++;
+    w->stats.busy += end - start;
+    if (end - start > w->stats.max_latency) w->stats.max_latency = end - start;
+
+    w->pending = NULL;
+    if (in) queue_push(&in_ring->free_queue, in);
+    if (error != ARRAY_SUCCESS) {
+        if (out) queue_push(&out_ring->free_queue, out);
+        set_error(p, error);
+        return -1;
+    }
+    if (out) {
+        out->index = index;
+        out->ready = end;
+        queue_push(&out_ring->full_queue, out);
+    }
+    return 1;
+}
+
+// Helper function to step the workers first, first + stride, ... until all are done
+static void run_workers(Pipeline *p, int first, int stride) {
+    int active = 0, idle = 0;
+    for (int w = first; w < p->nworkers; w += stride) active++;
+    while (active > 0 && __atomic_load_n(&p->error, __ATOMIC_ACQUIRE) == ARRAY_SUCCESS) {
+        int progress = 0;
+        for (int w = first; w < p->nworkers; w += stride) {
+            PipelineWorker *worker = &p->workers[w];
+            if (worker->finished) continue;
+            int status = worker_step(p, worker);
+            if (status < 0) {
+                worker->finished = 1;
+                active--;
+            }
+            progress |= status != 0;
+        }
+        if (progress) {
+            idle = 0;
+        } else if (++idle >= PIPELINE_SPIN_LIMIT) {
+            idle = 0;
+            yield_core();
+        }
+    }
+}
+
+// Function to run items through a pipeline
+ArrayError pipeline_run(Pipeline *p, long items) {
+    if (!p) return ARRAY_ERROR_NULL_POINTER;
+    if (items < 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    for (int r = 0; r < p->nstages - 1; r++) {
+        PipelineRing *ring = &p->rings[r];
+        queue_reset(&ring->free_queue);
+        queue_reset(&ring->full_queue);
+        for (int k = 0; k < p->depth; k++) {
+            // A failed run may have left a stage's array freed
+            if (!ring->slots[k].array) {
+                ArrayError error;
+                ring->slots[k].array = create_slot_array(p, r, &error);
+                if (!ring->slots[k].array) return error;
+            }
+            queue_push(&ring->free_queue, &ring->slots[k]);
+        }
+    }
+    for (int w = 0; w < p->nworkers; w++) {
+        PipelineWorker *worker = &p->workers[w];
+        worker->finished = 0;
+        worker->pending = NULL;
+        worker->waiting = WAIT_NONE;
+        memset(&worker->stats, 0, sizeof(PipelineStats));
+    }
+    memset(p->taken, 0, p->nstages * sizeof(long));
+    p->items = items;
+    p->next_index = 0;
+    p->error = ARRAY_SUCCESS;
+
+#ifdef _OPENMP
+    // One thread per worker; a smaller team steps several workers per thread
+    #pragma omp parallel num_threads(p->nworkers)
+    run_workers(p, omp_get_thread_num(), omp_get_num_threads());
+#else
+    run_workers(p, 0, 1);
+#endif
+    return (ArrayError)p->error;
+}
+
+// Function to read the counters of a stage
+ArrayError pipeline_get_stats(const Pipeline *p, int stage, PipelineStats *stats) {
+    if (!p || !stats) return ARRAY_ERROR_NULL_POINTER;
+    if (stage < 0 || stage >= p->nstages) return ARRAY_ERROR_INVALID_ARGUMENT;
+    memset(stats, 0, sizeof(PipelineStats));
+    for (int w = 0; w < p->nworkers; w++) {
+        const PipelineStats *ws = &p->workers[w].stats;
+        if (p->workers[w].stage != stage) continue;
+        stats->items += ws->items;
+        stats->input_stalls += ws->input_stalls;
+        stats->output_stalls += ws->output_stalls;
+        stats->input_wait += ws->input_wait;
+        stats->output_wait += ws->output_wait;
+        stats->busy += ws->busy;
+        stats->queue_latency += ws->queue_latency;
+        if (ws->max_latency > stats->max_latency) stats->max_latency = ws->max_latency;
+        if (ws->max_queue_latency > stats->max_queue_latency) stats->max_queue_latency = ws->max_queue_latency;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Function to free a pipeline
+void pipeline_free(Pipeline *p) {
+    if (!p) return;
+    if (p->rings) {
+        for (int r = 0; r < p->nstages - 1; r++) {
+            PipelineRing *ring = &p->rings[r];
+            if (ring->slots) {
+                for (int k = 0; k < p->depth; k++) free_array(ring->slots[k].array);
+            }
+            free(ring->slots);
+            free(ring->free_queue.cells);
+            free(ring->full_queue.cells);
+        }
+    }
+    if (p->owns_pool) destroy_memory_pool(p->pool);
+    free(p->rings);
+    free(p->workers);
+    free(p->taken);
+    free(p->stages);
+    free(p->shapes);
+    free(p);
+}
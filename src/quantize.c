@@ -0,0 +1,449 @@
+#include "quantize.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Fixed-point multipliers stay below 2^14, so a 16-bit product times a multiplier plus
+// the rounding term fits in 32 bits
+#define QUANT_MULTIPLIER_LIMIT (1 << 14)
+#define QUANT_MAX_SHIFT 30
+
+// Elements a dot kernel accumulates in 32 bits: |u * s| <= 255 * 128, so 65536 of them fit
+#define QUANT_DOT_CHUNK 65536
+
+// Integer requantization: out = clamp(((x * multiplier + 2^(shift - 1)) >> shift) + zero_point)
+typedef struct {
+    int32_t multiplier[2];
+    int shift;
+    int32_t zero_point;
+    int32_t lo;
+    int32_t hi;
+} Requantize;
+
+// Rows of a quantized 1-D or 2-D operand of a dot product
+typedef struct {
+    const uint8_t *data;  // Raw bytes, read as int8_t when is_signed is set
+    size_t rows;
+    int32_t zero_point;
+    int is_signed;
+} QuantRows;
+
+// Helper function to get the range of a quantized type; returns 0 for other types
+static int dtype_range(ArrayDType dtype, int32_t *lo, int32_t *hi) {
+    if (dtype == ARRAY_DTYPE_INT8) {
+        *lo = -128;
+        *hi = 127;
+        return 1;
+    }
+    if (dtype == ARRAY_DTYPE_UINT8) {
+        *lo = 0;
+        *hi = 255;
+        return 1;
+    }
+    return 0;
+}
+
+// Helper function to write positive ratios as multipliers over a shared power of two
+static void fixed_point(Requantize *rq, const double *ratios, int count) {
+    double largest = 0.0;
+    for (int k = 0; k < count; k++) largest = ratios[k] > largest ? ratios[k] : largest;
+
+    int shift = QUANT_MAX_SHIFT;
+    while (shift > 0 && ldexp(largest, shift) >= QUANT_MULTIPLIER_LIMIT) shift--;
+    for (int k = 0; k < count; k++) {
+        double m = nearbyint(ldexp(ratios[k], shift));
+        rq->multiplier[k] = m < QUANT_MULTIPLIER_LIMIT ? (int32_t)m : QUANT_MULTIPLIER_LIMIT - 1;
+    }
+    rq->shift = shift;
+}
+
+// Helper function to load a block of quantized elements as int16 with the zero point subtracted
+static void widen_block(int16_t *out, const ArrayType *q, size_t start, size_t n) {
+    int32_t z = q->zero_point;
+    if (q->dtype == ARRAY_DTYPE_INT8) {
+        const int8_t *in = (const int8_t*)q->data + start;
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = (int16_t)(in[i] - z);
+    } else {
+        const uint8_t *in = (const uint8_t*)q->data + start;
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) out[i] = (int16_t)(in[i] - z);
+    }
+}
+
+// Helper function to add the zero point to a block of requantized values, saturate and store them
+static void narrow_block(ArrayType *out, size_t start, const int32_t *v, size_t n, const Requantize *rq) {
+    int32_t z = rq->zero_point, lo = rq->lo, hi = rq->hi;
+    if (out->dtype == ARRAY_DTYPE_INT8) {
+        int8_t *dst = (int8_t*)out->data + start;
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) {
+            int32_t x = v[i] + z;
+            x = x < lo ? lo : x;
+            dst[i] = (int8_t)(x > hi ? hi : x);
+        }
+    } else {
+        uint8_t *dst = (uint8_t*)out->data + start;
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < n; i++) {
+            int32_t x = v[i] + z;
+            x = x < lo ? lo : x;
+            dst[i] = (uint8_t)(x > hi ? hi : x);
+        }
+    }
+}
+
+static void add_kernel(int32_t *v, const int16_t *a, const int16_t *b, size_t n, const Requantize *rq) {
+    int32_t ma = rq->multiplier[0], mb = rq->multiplier[1];
+    int32_t round = rq->shift > 0 ? 1 << (rq->shift - 1) : 0;
+    int shift = rq->shift;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) v[i] = (a[i] * ma + b[i] * mb + round) >> shift;
+}
+
+static void multiply_kernel(int32_t *v, const int16_t *a, const int16_t *b, size_t n, const Requantize *rq) {
+    int32_t m = rq->multiplier[0];
+    int32_t round = rq->shift > 0 ? 1 << (rq->shift - 1) : 0;
+    int shift = rq->shift;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) v[i] = (a[i] * b[i] * m + round) >> shift;
+}
+
+// Helper function to check that two quantized operands of an element-wise operation match
+static ArrayError check_operands(const ArrayType *a, const ArrayType *b) {
+    int32_t lo, hi;
+    if (!dtype_range(a->dtype, &lo, &hi) || b->dtype != a->dtype) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view || b->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->ndim != b->ndim) return ARRAY_ERROR_INVALID_DIMENSION;
+    for (int d = 0; d < a->ndim; d++) {
+        if (a->shape[d] != b->shape[d]) return ARRAY_ERROR_INVALID_DIMENSION;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to apply a requantizing kernel to two quantized arrays block by block
+static ArrayError quantized_binary(ArrayType **result, const ArrayType *a, const ArrayType *b,
+                                   float scale, int zero_point, int multiply) {
+    if (!result || !a || !b) return ARRAY_ERROR_NULL_POINTER;
+    ArrayError error = check_operands(a, b);
+    if (error != ARRAY_SUCCESS) return error;
+
+    Requantize rq;
+    dtype_range(a->dtype, &rq.lo, &rq.hi);
+    if (!(scale > 0.0f) || !isfinite(scale) || zero_point < rq.lo || zero_point > rq.hi) {
+        return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+    rq.zero_point = zero_point;
+    if (multiply) {
+        double ratio = (double)a->scale * b->scale / scale;
+        fixed_point(&rq, &ratio, 1);
+    } else {
+        double ratios[2] = {(double)a->scale / scale, (double)b->scale / scale};
+        fixed_point(&rq, ratios, 2);
+    }
+
+    // *result may be a or b; neither is read after its block has been written
+    error = prepare_result_dtype(result, a->shape, a->ndim, a->dtype);
+    if (error != ARRAY_SUCCESS) return error;
+    ArrayType *out = *result;
+
+    size_t n = a->size;
+    size_t nblocks = (n + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        int16_t wa[ARRAY_BLOCK_SIZE], wb[ARRAY_BLOCK_SIZE];
+        int32_t v[ARRAY_BLOCK_SIZE];
+        size_t start = blk * ARRAY_BLOCK_SIZE;
+        size_t len = (n - start < ARRAY_BLOCK_SIZE) ? n - start : ARRAY_BLOCK_SIZE;
+        widen_block(wa, a, start, len);
+        widen_block(wb, b, start, len);
+        if (multiply) {
+            multiply_kernel(v, wa, wb, len, &rq);
+        } else {
+            add_kernel(v, wa, wb, len, &rq);
+        }
+        narrow_block(out, start, v, len, &rq);
+    }
+
+    out->scale = scale;
+    out->zero_point = zero_point;
+    return ARRAY_SUCCESS;
+}
+
+// Function to choose quantization parameters covering the range of an array
+ArrayError quantize_params(const ArrayType *a, ArrayDType dtype, float *scale, int *zero_point) {
+    if (!a || !scale || !zero_point) return ARRAY_ERROR_NULL_POINTER;
+    int32_t qlo, qhi;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32 || !dtype_range(dtype, &qlo, &qhi)) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    const float *data = a->data;
+    size_t n = a->size;
+    float lo = 0.0f, hi = 0.0f;
+
+#ifdef _OPENMP
+    #pragma omp parallel for simd reduction(min:lo) reduction(max:hi) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t i = 0; i < n; i++) {
+        float x = data[i];
+        int finite = fabsf(x) <= FLT_MAX;
+        lo = (finite && x < lo) ? x : lo;
+        hi = (finite && x > hi) ? x : hi;
+    }
+
+    if (dtype == ARRAY_DTYPE_INT8) {
+        float m = -lo > hi ? -lo : hi;
+        *scale = m > 0.0f ? m / 127.0f : 1.0f;
+        *zero_point = 0;
+    } else if (hi > lo) {
+        *scale = (hi - lo) / 255.0f;
+        int z = (int)nearbyintf(-lo / *scale);
+        *zero_point = z < qlo ? qlo : (z > qhi ? qhi : z);
+    } else {
+        *scale = 1.0f;
+        *zero_point = 0;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Function to quantize a float32 array
+ArrayError quantize_array(ArrayType **result, const ArrayType *a, ArrayDType dtype, float scale, int zero_point) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    int32_t lo, hi;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32 || !dtype_range(dtype, &lo, &hi)) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view || *result == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (!(scale > 0.0f) || !isfinite(scale) || zero_point < lo || zero_point > hi) {
+        return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+
+    ArrayError error = prepare_result_dtype(result, a->shape, a->ndim, dtype);
+    if (error != ARRAY_SUCCESS) return error;
+    ArrayType *out = *result;
+    out->scale = scale;
+    out->zero_point = zero_point;
+
+    const float *in = a->data;
+    size_t n = a->size;
+    size_t nblocks = (n + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        int32_t v[ARRAY_BLOCK_SIZE];
+        size_t start = blk * ARRAY_BLOCK_SIZE;
+        size_t len = (n - start < ARRAY_BLOCK_SIZE) ? n - start : ARRAY_BLOCK_SIZE;
+        // Clamping to +-512 saturates like the unclamped value and keeps the
+        // add-and-subtract of 1.5 * 2^23, which rounds half to even, exact
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < len; i++) {
+            float t = in[start + i] / scale;
+            t = t == t ? t : 0.0f;
+            t = t < -512.0f ? -512.0f : t;
+            t = t > 512.0f ? 512.0f : t;
+            v[i] = (int32_t)((t + 12582912.0f) - 12582912.0f);
+        }
+        Requantize rq = {{0, 0}, 0, zero_point, lo, hi};
+        narrow_block(out, start, v, len, &rq);
+    }
+
+    return ARRAY_SUCCESS;
+}
+
+// Function to dequantize an array into float32
+ArrayError dequantize_array(ArrayType **result, const ArrayType *q) {
+    if (!result || !q) return ARRAY_ERROR_NULL_POINTER;
+    int32_t lo, hi;
+    if (!dtype_range(q->dtype, &lo, &hi)) return ARRAY_ERROR_INVALID_DTYPE;
+    if (q->view || *result == q) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    ArrayError error = prepare_result(result, q->shape, q->ndim);
+    if (error != ARRAY_SUCCESS) return error;
+
+    float *out = (*result)->data;
+    float scale = q->scale;
+    int32_t z = q->zero_point;
+    size_t n = q->size;
+
+    if (q->dtype == ARRAY_DTYPE_INT8) {
+        const int8_t *in = (const int8_t*)q->data;
+#ifdef _OPENMP
+        #pragma omp parallel for simd schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t i = 0; i < n; i++) out[i] = scale * (float)(in[i] - z);
+    } else {
+        const uint8_t *in = (const uint8_t*)q->data;
+#ifdef _OPENMP
+        #pragma omp parallel for simd schedule(static) if (n >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t i = 0; i < n; i++) out[i] = scale * (float)(in[i] - z);
+    }
+
+    return ARRAY_SUCCESS;
+}
+
+// Function to add two quantized arrays
+ArrayError quantized_add_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b,
+                                float scale, int zero_point) {
+    return quantized_binary(result, a, b, scale, zero_point, 0);
+}
+
+// Function to multiply two quantized arrays
+ArrayError quantized_multiply_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b,
+                                     float scale, int zero_point) {
+    return quantized_binary(result, a, b, scale, zero_point, 1);
+}
+
+// Sum of u[i] * s[i] over at most QUANT_DOT_CHUNK elements. Compilers turn the
+// unsigned-by-signed byte products into vpdpbusd on VNNI targets and into 16-bit
+// multiplies elsewhere; pmaddubsw is avoided because it saturates pairs of products.
+typedef int32_t (*DotKernel)(const uint8_t *u, const int8_t *s, size_t n);
+
+static inline int32_t dot_body(const uint8_t *u, const int8_t *s, size_t n) {
+    int32_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += (int32_t)u[i] * s[i];
+    return acc;
+}
+
+static int32_t dot_kernel(const uint8_t *u, const int8_t *s, size_t n) {
+    return dot_body(u, s, n);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUANT_AVX2_DISPATCH 1
+__attribute__((target("avx2")))
+static int32_t dot_kernel_avx2(const uint8_t *u, const int8_t *s, size_t n) {
+    return dot_body(u, s, n);
+}
+
+#if defined(__clang__) || __GNUC__ >= 11
+#define QUANT_VNNI_DISPATCH 1
+__attribute__((target("avx2,avxvnni")))
+static int32_t dot_kernel_avxvnni(const uint8_t *u, const int8_t *s, size_t n) {
+    return dot_body(u, s, n);
+}
+
+__attribute__((target("avx512vnni,avx512vl,avx512bw")))
+static int32_t dot_kernel_avx512vnni(const uint8_t *u, const int8_t *s, size_t n) {
+    return dot_body(u, s, n);
+}
+#endif
+#endif
+
+static DotKernel select_dot_kernel(void) {
+#ifdef QUANT_VNNI_DISPATCH
+    if (__builtin_cpu_supports("avxvnni")) return dot_kernel_avxvnni;
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl")) return dot_kernel_avx512vnni;
+#endif
+#ifdef QUANT_AVX2_DISPATCH
+    if (__builtin_cpu_supports("avx2")) return dot_kernel_avx2;
+#endif
+    return dot_kernel;
+}
+
+// Helper function to sum the byte products of row i of x and row j of y exactly;
+// exactly one of the two operands is signed
+static int64_t dot_rows(DotKernel kernel, const QuantRows *x, size_t i, const QuantRows *y, size_t j, size_t k) {
+    const uint8_t *xr = x->data + i * k, *yr = y->data + j * k;
+    const uint8_t *u = x->is_signed ? yr : xr;
+    const int8_t *s = (const int8_t*)(x->is_signed ? xr : yr);
+    int64_t total = 0;
+    for (size_t p = 0; p < k; p += QUANT_DOT_CHUNK) {
+        total += kernel(u + p, s + p, (k - p < QUANT_DOT_CHUNK) ? k - p : QUANT_DOT_CHUNK);
+    }
+    return total;
+}
+
+// Function to compute the dot products of the rows of two quantized arrays
+ArrayError quantized_dot_arrays(ArrayType **result, const ArrayType *a, const ArrayType *b) {
+    if (!result || !a || !b) return ARRAY_ERROR_NULL_POINTER;
+    int32_t lo, hi;
+    if (!dtype_range(a->dtype, &lo, &hi) || !dtype_range(b->dtype, &lo, &hi)) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view || b->view || *result == a || *result == b) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->ndim < 1 || b->ndim < 1 || a->ndim > 2 || b->ndim > 2 || a->shape[a->ndim - 1] != b->shape[b->ndim - 1]) {
+        return ARRAY_ERROR_INVALID_DIMENSION;
+    }
+
+    size_t k = (size_t)a->shape[a->ndim - 1];
+    size_t m = a->ndim == 2 ? (size_t)a->shape[0] : 1;
+    size_t n = b->ndim == 2 ? (size_t)b->shape[0] : 1;
+    int shape[2], ndim = 0;
+    if (a->ndim == 2) shape[ndim++] = (int)m;
+    if (b->ndim == 2) shape[ndim++] = (int)n;
+    if (ndim == 0) shape[ndim++] = 1;
+
+    // The operand with more rows is streamed once, by the parallel loop, and the other
+    // is reused for each of its rows. When both have the same signedness the smaller
+    // one is flipped to the other with q ^ 0x80, which moves its zero point by 128.
+    QuantRows qa = {(const uint8_t*)a->data, m, a->zero_point, a->dtype == ARRAY_DTYPE_INT8};
+    QuantRows qb = {(const uint8_t*)b->data, n, b->zero_point, b->dtype == ARRAY_DTYPE_INT8};
+    int outer_is_a = m > n;
+    QuantRows *outer = outer_is_a ? &qa : &qb;
+    QuantRows *inner = outer_is_a ? &qb : &qa;
+
+    size_t inner_bytes = inner->rows * k;
+    uint8_t *flipped = NULL;
+    int64_t *inner_sums = (int64_t*)malloc((inner->rows ? inner->rows : 1) * sizeof(int64_t));
+    uint8_t *ones = (uint8_t*)malloc(k ? k : 1);
+    if (inner->is_signed == outer->is_signed) flipped = (uint8_t*)malloc(inner_bytes ? inner_bytes : 1);
+    if (!inner_sums || !ones || (inner->is_signed == outer->is_signed && !flipped)) {
+        free(inner_sums);
+        free(ones);
+        free(flipped);
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+    ArrayError error = prepare_result(result, shape, ndim);
+    if (error != ARRAY_SUCCESS) {
+        free(inner_sums);
+        free(ones);
+        free(flipped);
+        return error;
+    }
+
+    if (flipped) {
+        ARRAY_OMP_SIMD
+        for (size_t i = 0; i < inner_bytes; i++) flipped[i] = inner->data[i] ^ 0x80;
+        inner->data = flipped;
+        inner->zero_point += inner->is_signed ? 128 : -128;
+        inner->is_signed = !inner->is_signed;
+    }
+
+    // Row sums come from the same kernel against a row of ones of the other signedness
+    memset(ones, 1, k);
+    QuantRows unit = {ones, 1, 0, !inner->is_signed};
+    DotKernel kernel = select_dot_kernel();
+    for (size_t i = 0; i < inner->rows; i++) inner_sums[i] = dot_rows(kernel, inner, i, &unit, 0, k);
+
+    float *out = (*result)->data;
+    double scale = (double)a->scale * b->scale;
+    int64_t zo = outer->zero_point, zi = inner->zero_point;
+    QuantRows outer_unit = {ones, 1, 0, !outer->is_signed};
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (m * n * k >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t o = 0; o < outer->rows; o++) {
+        int64_t outer_sum = dot_rows(kernel, outer, o, &outer_unit, 0, k);
+        for (size_t i = 0; i < inner->rows; i++) {
+            int64_t dot = dot_rows(kernel, outer, o, inner, i, k);
+            dot += -zi * outer_sum - zo * inner_sums[i] + (int64_t)k * zo * zi;
+            size_t index = outer_is_a ? o * n + i : i * n + o;
+            out[index] = (float)(scale * (double)dot);
+        }
+    }
+
+    free(inner_sums);
+    free(ones);
+    free(flipped);
+    return ARRAY_SUCCESS;
+}
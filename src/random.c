@@ -0,0 +1,214 @@
+#include "random.h"
+#include "parallel.h"
+#include "vmath_inline.h"
+#include <math.h>
+#include <stdint.h>
+
+// Philox4x32-10 multipliers and key schedule increments
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+// Counter blocks encrypted side by side by one pass of the vectorized rounds
+#define RANDOM_LANES 16
+
+// Counter blocks per unit of parallel work; a multiple of RANDOM_LANES
+#define RANDOM_CHUNK_BLOCKS 1024
+
+#if defined(__GNUC__)
+#define RANDOM_INLINE static inline __attribute__((always_inline))
+#else
+#define RANDOM_INLINE static inline
+#endif
+
+// Generator of RANDOM_LANES consecutive counter blocks
+typedef void (*PhiloxKernel)(uint32_t *words, const RandomState *state, uint64_t counter);
+
+// Kernel turning n elements' worth of random words into output values
+typedef void (*RandomKernel)(float *out, const uint32_t *words, size_t n, const void *ctx);
+
+// Function to initialize a generator state
+void random_seed(RandomState *state, uint64_t seed, uint32_t stream) {
+    if (!state) return;
+    state->key[0] = (uint32_t)seed;
+    state->key[1] = (uint32_t)(seed >> 32);
+    state->stream = stream;
+    state->counter = 0;
+}
+
+// Function to jump a generator state ahead
+void random_skip(RandomState *state, uint64_t blocks) {
+    if (state) state->counter += blocks;
+}
+
+// Encrypts RANDOM_LANES consecutive counter blocks, writing the four words of
+// block counter + l to words[4 * l .. 4 * l + 3]
+RANDOM_INLINE void philox_body(uint32_t *words, const RandomState *state, uint64_t counter) {
+    uint32_t c0[RANDOM_LANES], c1[RANDOM_LANES], c2[RANDOM_LANES], c3[RANDOM_LANES];
+    ARRAY_OMP_SIMD
+    for (int l = 0; l < RANDOM_LANES; l++) {
+        uint64_t c = counter + (uint64_t)l;
+        c0[l] = (uint32_t)c;
+        c1[l] = (uint32_t)(c >> 32);
+        c2[l] = state->stream;
+        c3[l] = 0;
+    }
+
+    uint32_t k0 = state->key[0], k1 = state->key[1];
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        ARRAY_OMP_SIMD
+        for (int l = 0; l < RANDOM_LANES; l++) {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0[l];
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2[l];
+            uint32_t x0 = (uint32_t)(p1 >> 32) ^ c1[l] ^ k0;
+            uint32_t x2 = (uint32_t)(p0 >> 32) ^ c3[l] ^ k1;
+            c1[l] = (uint32_t)p1;
+            c3[l] = (uint32_t)p0;
+            c0[l] = x0;
+            c2[l] = x2;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (int l = 0; l < RANDOM_LANES; l++) {
+        words[4 * l] = c0[l];
+        words[4 * l + 1] = c1[l];
+        words[4 * l + 2] = c2[l];
+        words[4 * l + 3] = c3[l];
+    }
+}
+
+static void philox_lanes(uint32_t *words, const RandomState *state, uint64_t counter) {
+    philox_body(words, state, counter);
+}
+
+// AVX2 doubles the number of 32 x 32 -> 64-bit products per instruction
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RANDOM_AVX2_DISPATCH 1
+__attribute__((target("avx2")))
+static void philox_lanes_hw(uint32_t *words, const RandomState *state, uint64_t counter) {
+    philox_body(words, state, counter);
+}
+#endif
+
+// Helper function to convert the top 24 bits of a word to a float in [0, 1)
+static inline float unit_float(uint32_t w) {
+    return (float)(int32_t)(w >> 8) * 5.9604644775390625e-8f;
+}
+
+typedef struct {
+    float low;
+    float scale;
+    float top;  // Largest float below the upper bound of a uniform fill
+} AffineParams;
+
+// low + scale * u can round up to high for u close to 1, so results are capped at top
+static void uniform_kernel(float *out, const uint32_t *words, size_t n, const void *ctx) {
+    const AffineParams *p = (const AffineParams*)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) {
+        float v = p->low + p->scale * unit_float(words[i]);
+        out[i] = v < p->top ? v : p->top;
+    }
+}
+
+// Box-Muller turning words 2i and 2i + 1 into elements 2i and 2i + 1; u1 is kept in
+// (0, 1) so its log stays finite
+static inline void box_muller(float *z, const uint32_t *w, const AffineParams *p) {
+    float u1 = unit_float(w[0]) + 2.98023223876953125e-8f;
+    float theta = unit_float(w[1]) * 6.28318530717958648f - 3.14159265358979324f;
+    float radius = p->scale * sqrtf(-2.0f * fast_log(u1));
+    z[0] = p->low + radius * fast_sincos(theta, 1);
+    z[1] = p->low + radius * fast_sincos(theta, 0);
+}
+
+// An odd n reads one word past the last element, which the caller always generates
+static void normal_kernel(float *out, const uint32_t *words, size_t n, const void *ctx) {
+    const AffineParams *p = (const AffineParams*)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n / 2; i++) box_muller(out + 2 * i, words + 2 * i, p);
+    if (n & 1) {
+        float z[2];
+        box_muller(z, words + n - 1, p);
+        out[n - 1] = z[0];
+    }
+}
+
+typedef struct {
+    int32_t low;
+    uint32_t range;
+} IntegerParams;
+
+// floor(x * range / 2^64) for the 64-bit draw x = words[2i + 1] : words[2i]
+static void integer_kernel(float *out, const uint32_t *words, size_t n, const void *ctx) {
+    const IntegerParams *p = (const IntegerParams*)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) {
+        uint64_t lo = (uint64_t)words[2 * i] * p->range;
+        uint64_t hi = (uint64_t)words[2 * i + 1] * p->range + (lo >> 32);
+        out[i] = (float)(p->low + (int32_t)(hi >> 32));
+    }
+}
+
+// Helper function running a kernel over an array in chunks of RANDOM_CHUNK_BLOCKS
+// blocks. Chunk c always starts at block state->counter + c * RANDOM_CHUNK_BLOCKS,
+// so the values do not depend on how chunks are assigned to threads.
+static ArrayError random_fill(ArrayType *a, RandomState *state, int words_per_element,
+                              RandomKernel kernel, const void *ctx) {
+    if (!a || !state) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    ArrayError error = array_make_writable(a);
+    if (error != ARRAY_SUCCESS) return error;
+
+    const size_t chunk_elements = (size_t)RANDOM_CHUNK_BLOCKS * 4 / words_per_element;
+    size_t nchunks = (a->size + chunk_elements - 1) / chunk_elements;
+    uint64_t start = state->counter;
+
+    PhiloxKernel philox = philox_lanes;
+#ifdef RANDOM_AVX2_DISPATCH
+    if (__builtin_cpu_supports("avx2")) philox = philox_lanes_hw;
+#endif
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t c = 0; c < nchunks; c++) {
+        uint32_t words[RANDOM_CHUNK_BLOCKS * 4];
+        size_t first = c * chunk_elements;
+        size_t count = a->size - first < chunk_elements ? a->size - first : chunk_elements;
+        size_t blocks = (count * words_per_element + 3) / 4;
+        uint64_t counter = start + (uint64_t)c * RANDOM_CHUNK_BLOCKS;
+
+        for (size_t b = 0; b < blocks; b += RANDOM_LANES) {
+            philox(words + 4 * b, state, counter + b);
+        }
+        kernel(a->data + first, words, count, ctx);
+    }
+
+    state->counter += ((uint64_t)a->size * words_per_element + 3) / 4;
+    return ARRAY_SUCCESS;
+}
+
+// Function to fill an array with uniform random numbers
+ArrayError random_uniform(ArrayType *a, RandomState *state, float low, float high) {
+    AffineParams params = {low, high - low, nextafterf(high, low)};
+    return random_fill(a, state, 1, uniform_kernel, &params);
+}
+
+// Function to fill an array with normal random numbers
+ArrayError random_normal(ArrayType *a, RandomState *state, float mean, float stddev) {
+    if (!(stddev >= 0.0f)) return ARRAY_ERROR_INVALID_ARGUMENT;
+    AffineParams params = {mean, stddev, 0.0f};
+    return random_fill(a, state, 1, normal_kernel, &params);
+}
+
+// Function to fill an array with random integers
+ArrayError random_integers(ArrayType *a, RandomState *state, int32_t low, int32_t high) {
+    const int32_t limit = 1 << 24;
+    if (low >= high || low < -limit || high > limit) return ARRAY_ERROR_INVALID_ARGUMENT;
+    IntegerParams params = {low, (uint32_t)(high - low)};
+    return random_fill(a, state, 2, integer_kernel, &params);
+}
@@ -0,0 +1,208 @@
+#include "scan.h"
+#include "parallel.h"
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Helper function to scan one contiguous row, starting from an initial value
+static void scan_row(float *out, const float *in, size_t n, float init, char op) {
+    float acc = init;
+    if (op == '+') {
+        for (size_t i = 0; i < n; i++) {
+            acc += in[i];
+            out[i] = acc;
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            acc *= in[i];
+            out[i] = acc;
+        }
+    }
+}
+
+// Helper function to reduce one contiguous chunk; the reduction is order-free and vectorizes
+static float reduce_chunk(const float *in, size_t n, char op) {
+    float acc;
+    if (op == '+') {
+        acc = 0.0f;
+        ARRAY_OMP_SIMD_REDUCTION(+:acc)
+        for (size_t i = 0; i < n; i++) acc += in[i];
+    } else {
+        acc = 1.0f;
+        ARRAY_OMP_SIMD_REDUCTION(*:acc)
+        for (size_t i = 0; i < n; i++) acc *= in[i];
+    }
+    return acc;
+}
+
+// Helper function to scan a row chunk by chunk, seeding each chunk with the combined
+// totals of the chunks before it; gives the same result as scan_row_parallel with
+// the same chunk size
+static void scan_row_chunked(float *out, const float *in, size_t n, size_t chunk, char op) {
+    float acc = (op == '+') ? 0.0f : 1.0f;
+    for (size_t start = 0; start < n; start += chunk) {
+        size_t len = (n - start < chunk) ? n - start : chunk;
+        // Reducing the chunk after the scan finds it in cache, but in place the scan
+        // overwrites it, so the total is then taken first
+        float total = (out == in) ? reduce_chunk(in + start, len, op) : 0.0f;
+        scan_row(out + start, in + start, len, acc, op);
+        if (out != in) total = reduce_chunk(in + start, len, op);
+        acc = (op == '+') ? acc + total : acc * total;
+    }
+}
+
+// Helper function for a single long row: reduce-then-scan over one chunk per thread,
+// or over chunks of ARRAY_DETERMINISTIC_CHUNK elements in deterministic mode
+static ArrayError scan_row_parallel(float *out, const float *in, size_t n, char op) {
+    size_t nchunks = 1;
+#ifdef _OPENMP
+    nchunks = (size_t)omp_get_max_threads();
+#endif
+    if (array_get_deterministic()) nchunks = (n + ARRAY_DETERMINISTIC_CHUNK - 1) / ARRAY_DETERMINISTIC_CHUNK;
+    if (nchunks <= 1) {
+        scan_row(out, in, n, op == '+' ? 0.0f : 1.0f, op);
+        return ARRAY_SUCCESS;
+    }
+
+    float *offsets = (float*)malloc(nchunks * sizeof(float));
+    if (!offsets) {
+        return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+    size_t chunk = array_get_deterministic() ? ARRAY_DETERMINISTIC_CHUNK : (n + nchunks - 1) / nchunks;
+
+    // Pass 1: each chunk's total
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (size_t c = 0; c < nchunks; c++) {
+        size_t start = c * chunk < n ? c * chunk : n;
+        size_t len = (n - start < chunk) ? n - start : chunk;
+        offsets[c] = reduce_chunk(in + start, len, op);
+    }
+
+    // Exclusive scan of the chunk totals gives each chunk its starting value
+    float acc = (op == '+') ? 0.0f : 1.0f;
+    for (size_t c = 0; c < nchunks; c++) {
+        float total = offsets[c];
+        offsets[c] = acc;
+        acc = (op == '+') ? acc + total : acc * total;
+    }
+
+    // Pass 2: independent scans seeded with the chunk offsets
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (size_t c = 0; c < nchunks; c++) {
+        size_t start = c * chunk < n ? c * chunk : n;
+        size_t len = (n - start < chunk) ? n - start : chunk;
+        scan_row(out + start, in + start, len, offsets[c], op);
+    }
+
+    free(offsets);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function for cumulative operations along any axis
+static ArrayError scan_operation(ArrayType **result, const ArrayType *a, int axis, char op) {
+    if (!result || !a) {
+        return ARRAY_ERROR_NULL_POINTER;
+    }
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) {
+        return ARRAY_ERROR_INVALID_DTYPE;
+    }
+    if (a->view) {
+        return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) {
+        return ARRAY_ERROR_INVALID_DIMENSION;
+    }
+
+    ArrayError error = prepare_result(result, a->shape, a->ndim);
+    if (error != ARRAY_SUCCESS) {
+        return error;
+    }
+
+    size_t outer = 1, inner = 1;
+    size_t len = (size_t)a->shape[axis];
+    for (int d = 0; d < axis; d++) outer *= a->shape[d];
+    for (int d = axis + 1; d < a->ndim; d++) inner *= a->shape[d];
+    if (a->size == 0) {
+        return ARRAY_SUCCESS;
+    }
+
+    float *out = (*result)->data;
+    const float *in = a->data;
+
+    if (inner == 1) {
+        int nthreads = 1;
+#ifdef _OPENMP
+        nthreads = omp_get_max_threads();
+#endif
+        // Few long rows: split each row across threads
+        if (outer < (size_t)nthreads && len >= ARRAY_PARALLEL_THRESHOLD) {
+            for (size_t o = 0; o < outer; o++) {
+                error = scan_row_parallel(out + o * len, in + o * len, len, op);
+                if (error != ARRAY_SUCCESS) return error;
+            }
+            return ARRAY_SUCCESS;
+        }
+
+        // Many rows: one sequential scan per row, rows spread over threads
+        int deterministic = array_get_deterministic();
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+        for (size_t o = 0; o < outer; o++) {
+            if (deterministic) {
+                scan_row_chunked(out + o * len, in + o * len, len, ARRAY_DETERMINISTIC_CHUNK, op);
+            } else {
+                scan_row(out + o * len, in + o * len, len, op == '+' ? 0.0f : 1.0f, op);
+            }
+        }
+        return ARRAY_SUCCESS;
+    }
+
+    // Outer axis: accumulate whole slices so the inner loop runs over contiguous elements
+    size_t blocks_per_slab = (inner + ARRAY_BLOCK_SIZE - 1) / ARRAY_BLOCK_SIZE;
+    size_t ntiles = outer * blocks_per_slab;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    for (size_t tile = 0; tile < ntiles; tile++) {
+        size_t o = tile / blocks_per_slab;
+        size_t start = (tile % blocks_per_slab) * ARRAY_BLOCK_SIZE;
+        size_t width = (inner - start < ARRAY_BLOCK_SIZE) ? inner - start : ARRAY_BLOCK_SIZE;
+        const float *src = in + o * len * inner + start;
+        float *dst = out + o * len * inner + start;
+
+        for (size_t i = 0; i < width; i++) dst[i] = src[i];
+        for (size_t k = 1; k < len; k++) {
+            const float *row = src + k * inner;
+            const float *prev = dst + (k - 1) * inner;
+            float *cur = dst + k * inner;
+            if (op == '+') {
+                ARRAY_OMP_SIMD
+                for (size_t i = 0; i < width; i++) cur[i] = prev[i] + row[i];
+            } else {
+                ARRAY_OMP_SIMD
+                for (size_t i = 0; i < width; i++) cur[i] = prev[i] * row[i];
+            }
+        }
+    }
+
+    return ARRAY_SUCCESS;
+}
+
+// Function to compute the cumulative sum along an axis
+ArrayError cumsum_array(ArrayType **result, const ArrayType *a, int axis) {
+    return scan_operation(result, a, axis, '+');
+}
+
+// Function to compute the cumulative product along an axis
+ArrayError cumprod_array(ArrayType **result, const ArrayType *a, int axis) {
+    return scan_operation(result, a, axis, '*');
+}
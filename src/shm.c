@@ -0,0 +1,254 @@
+#define _GNU_SOURCE
+#include "shm.h"
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHM_AVAILABLE 1
+#endif
+
+#define SHARED_MAGIC 0x48534e41u  // "ANSH"
+#define SHARED_VERSION 1u
+
+// Offset of the elements from the start of the mapping; a page on every common system
+#define SHARED_DATA_OFFSET 4096
+
+// Layout at the start of every shared memory object. magic is written last, so
+// an attacher never sees a half-written header.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t data_offset;   // Bytes from the start of the object to the elements
+    uint64_t nbytes;        // Size of the elements in bytes
+    int32_t dtype;
+    int32_t ndim;
+    int32_t shape[ARRAY_MAX_DIMS];
+    int32_t strides[ARRAY_MAX_DIMS];  // In elements, row-major
+    uint64_t sequence __attribute__((aligned(64)));  // Odd while a write is in progress
+} SharedHeader;
+
+#ifdef SHM_AVAILABLE
+// Release callback unmapping a shared array; ctx is the header at the start of the mapping
+static void shared_release(void *data, size_t nbytes, void *ctx) {
+    (void)data;
+    SharedHeader *header = (SharedHeader*)ctx;
+    munmap(header, (size_t)header->data_offset + nbytes);
+}
+
+// Helper function to wrap a mapped object in an array. Writes through any handle
+// on the buffer must reach the mapping, so it is exempt from copy-on-write.
+static ArrayType* wrap_mapping(SharedHeader *header, size_t length, ArrayError *error) {
+    ArrayType *arr = array_wrap_dtype((float*)((char*)header + header->data_offset), header->shape, header->ndim,
+                                      (ArrayDType)header->dtype, shared_release, header, error);
+    if (!arr) munmap(header, length);
+    else arr->buffer->write_shared = 1;
+    return arr;
+}
+#endif
+
+// Helper function to find the header of the shared memory behind an array
+static SharedHeader* find_header(const ArrayType *arr) {
+#ifdef SHM_AVAILABLE
+    if (arr && arr->buffer && arr->buffer->release == shared_release) {
+        return (SharedHeader*)arr->buffer->release_ctx;
+    }
+#else
+    (void)arr;
+#endif
+    return NULL;
+}
+
+// Function to create an array in a new shared memory object
+ArrayType* array_create_shared(const char *name, const int *shape, int ndim, ArrayDType dtype, ArrayError *error) {
+    if (!name || !shape) {
+        if (error) *error = ARRAY_ERROR_NULL_POINTER;
+        return NULL;
+    }
+    if (ndim <= 0 || ndim > ARRAY_MAX_DIMS) {
+        if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
+        return NULL;
+    }
+    if (dtype != ARRAY_DTYPE_FLOAT32 && dtype != ARRAY_DTYPE_COMPLEX64) {
+        if (error) *error = ARRAY_ERROR_INVALID_DTYPE;
+        return NULL;
+    }
+#ifdef SHM_AVAILABLE
+    size_t size = 1;
+    for (int i = 0; i < ndim; i++) {
+        if (shape[i] <= 0) {
+            if (error) *error = ARRAY_ERROR_INVALID_DIMENSION;
+            return NULL;
+        }
+        size *= (size_t)shape[i];
+    }
+    size_t nbytes = size * (dtype == ARRAY_DTYPE_COMPLEX64 ? 2 : 1) * sizeof(float);
+    size_t length = SHARED_DATA_OFFSET + nbytes;
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        if (error) *error = ARRAY_ERROR_SYSTEM;
+        return NULL;
+    }
+    void *base = MAP_FAILED;
+    if (ftruncate(fd, (off_t)length) == 0) {
+        base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int saved = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        errno = saved;
+        if (error) *error = ARRAY_ERROR_SYSTEM;
+        return NULL;
+    }
+
+    SharedHeader *header = (SharedHeader*)base;
+    header->version = SHARED_VERSION;
+    header->data_offset = SHARED_DATA_OFFSET;
+    header->nbytes = nbytes;
+    header->dtype = (int32_t)dtype;
+    header->ndim = ndim;
+    for (int i = 0; i < ndim; i++) header->shape[i] = shape[i];
+    header->strides[ndim - 1] = 1;
+    for (int i = ndim - 2; i >= 0; i--) header->strides[i] = header->strides[i + 1] * shape[i + 1];
+    header->sequence = 0;
+    __atomic_store_n(&header->magic, SHARED_MAGIC, __ATOMIC_RELEASE);
+
+    return wrap_mapping(header, length, error);
+#else
+    if (error) *error = ARRAY_ERROR_SYSTEM;
+    return NULL;
+#endif
+}
+
+#ifdef SHM_AVAILABLE
+// Helper function to check that a header describes a contiguous array inside length bytes
+static int header_valid(const SharedHeader *header, size_t length) {
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHARED_MAGIC) return 0;
+    if (header->version != SHARED_VERSION || header->data_offset < sizeof(SharedHeader)) return 0;
+    if (header->dtype != ARRAY_DTYPE_FLOAT32 && header->dtype != ARRAY_DTYPE_COMPLEX64) return 0;
+    if (header->ndim <= 0 || header->ndim > ARRAY_MAX_DIMS) return 0;
+
+    size_t size = 1, stride = 1;
+    for (int i = header->ndim - 1; i >= 0; i--) {
+        if (header->shape[i] <= 0 || (size_t)header->strides[i] != stride) return 0;
+        stride *= (size_t)header->shape[i];
+        size *= (size_t)header->shape[i];
+    }
+    size_t nbytes = size * (header->dtype == ARRAY_DTYPE_COMPLEX64 ? 2 : 1) * sizeof(float);
+    return header->nbytes == nbytes && header->data_offset + nbytes <= length;
+}
+#endif
+
+// Function to map an existing shared array
+ArrayType* array_attach_shared(const char *name, ArrayError *error) {
+    if (!name) {
+        if (error) *error = ARRAY_ERROR_NULL_POINTER;
+        return NULL;
+    }
+#ifdef SHM_AVAILABLE
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        if (error) *error = ARRAY_ERROR_SYSTEM;
+        return NULL;
+    }
+    struct stat st;
+    ArrayError status = ARRAY_ERROR_SYSTEM;
+    void *base = MAP_FAILED;
+    size_t length = 0;
+    if (fstat(fd, &st) == 0) {
+        length = (size_t)st.st_size;
+        if (length < sizeof(SharedHeader)) {
+            status = ARRAY_ERROR_INVALID_ARGUMENT;
+        } else {
+            base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+    }
+    int saved = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = saved;
+        if (error) *error = status;
+        return NULL;
+    }
+
+    SharedHeader *header = (SharedHeader*)base;
+    if (!header_valid(header, length)) {
+        munmap(base, length);
+        if (error) *error = ARRAY_ERROR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    return wrap_mapping(header, length, error);
+#else
+    if (error) *error = ARRAY_ERROR_SYSTEM;
+    return NULL;
+#endif
+}
+
+// Function to remove the name of a shared array
+ArrayError array_unlink_shared(const char *name) {
+    if (!name) return ARRAY_ERROR_NULL_POINTER;
+#ifdef SHM_AVAILABLE
+    return shm_unlink(name) == 0 ? ARRAY_SUCCESS : ARRAY_ERROR_SYSTEM;
+#else
+    return ARRAY_ERROR_SYSTEM;
+#endif
+}
+
+// Function to start writing a shared array
+ArrayError array_shared_write_begin(ArrayType *arr) {
+    if (!arr) return ARRAY_ERROR_NULL_POINTER;
+    SharedHeader *header = find_header(arr);
+    if (!header) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    for (;;) {
+        uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+        if (!(sequence & 1) && __atomic_compare_exchange_n(&header->sequence, &sequence, sequence + 1, 0,
+                                                           __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+#ifdef SHM_AVAILABLE
+        sched_yield();
+#endif
+    }
+    // Keep the element stores that follow from becoming visible before the odd sequence
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return ARRAY_SUCCESS;
+}
+
+// Function to finish writing a shared array
+ArrayError array_shared_write_end(ArrayType *arr) {
+    if (!arr) return ARRAY_ERROR_NULL_POINTER;
+    SharedHeader *header = find_header(arr);
+    if (!header) return ARRAY_ERROR_INVALID_ARGUMENT;
+    uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    if (!(sequence & 1)) return ARRAY_ERROR_INVALID_ARGUMENT;
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELEASE);
+    return ARRAY_SUCCESS;
+}
+
+// Function to start reading a shared array
+uint64_t array_shared_read_begin(const ArrayType *arr) {
+    SharedHeader *header = find_header(arr);
+    if (!header) return 0;
+    for (;;) {
+        uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (!(sequence & 1)) return sequence;
+#ifdef SHM_AVAILABLE
+        sched_yield();
+#endif
+    }
+}
+
+// Function to check a read of a shared array against concurrent writes
+int array_shared_read_validate(const ArrayType *arr, uint64_t sequence) {
+    SharedHeader *header = find_header(arr);
+    if (!header) return 0;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&header->sequence, __ATOMIC_RELAXED) == sequence;
+}
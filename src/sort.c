@@ -0,0 +1,432 @@
+#include "sort.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Rows up to this length are sorted with a sorting network
+#define SORT_NETWORK_MAX 32
+
+// Geometry of the rows along the sorted axis: element k of row (o, i) is at
+// (o * len + k) * inner + i
+typedef struct {
+    size_t outer;
+    size_t len;
+    size_t inner;
+} RowGeometry;
+
+// Kernel run on one row of keys; parallel is set when the row is long enough
+// to be worth splitting across threads
+typedef ArrayError (*RowKernel)(uint64_t *keys, uint64_t *tmp, const RowGeometry *g,
+                                size_t o, size_t i, int parallel, void *ctx);
+
+// Helper functions to map floats onto unsigned integers with the same ordering
+static inline uint32_t float_key(float x) {
+    uint32_t u;
+    if (x != x) return 0xffffffffu;  // All NaNs after +inf
+    if (x == 0.0f) x = 0.0f;         // -0.0 sorts equal to 0.0
+    memcpy(&u, &x, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+static inline float key_float(uint64_t key) {
+    uint32_t u = (uint32_t)(key >> 32);
+    float x;
+    if (u == 0xffffffffu) return NAN;
+    u = (u & 0x80000000u) ? (u & 0x7fffffffu) : ~u;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+static inline int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Branch-free merge-exchange network (Knuth, Algorithm 5.2.2M) for short rows. The
+// pairs (i, i + d) of a pass with (i & p) == r come in runs of p consecutive i, and
+// d >= p keeps the two ends of a run apart, so each run is one loop without dependences.
+// It vectorizes on targets with 64-bit integer compares (SSE4.2 or AVX2 and later); the
+// baseline x86-64 target has none, and there the runs stay scalar but skip no indices.
+static void sort_network(uint64_t *keys, size_t n) {
+    if (n < 2) return;
+    size_t top = 1;
+    while (top * 2 < n) top *= 2;
+
+    for (size_t p = top; p > 0; p >>= 1) {
+        size_t q = top, r = 0, d = p;
+        for (;;) {
+            for (size_t start = r; start + d < n; start += 2 * p) {
+                size_t end = start + p < n - d ? start + p : n - d;
+                ARRAY_OMP_SIMD
+                for (size_t i = start; i < end; i++) {
+                    uint64_t x = keys[i], y = keys[i + d];
+                    keys[i] = x < y ? x : y;
+                    keys[i + d] = x < y ? y : x;
+                }
+            }
+            if (q == p) break;
+            d = q - p;
+            q >>= 1;
+            r = p;
+        }
+    }
+}
+
+// Stable LSD radix sort on the value half of the keys, one byte per pass.
+// Passes where every key has the same byte are skipped.
+static void radix_sort(uint64_t *keys, uint64_t *tmp, size_t n) {
+    uint64_t *src = keys, *dst = tmp;
+    for (int shift = 32; shift < 64; shift += 8) {
+        size_t count[256] = {0};
+        for (size_t i = 0; i < n; i++) count[(src[i] >> shift) & 0xff]++;
+        if (count[(src[0] >> shift) & 0xff] == n) continue;
+
+        size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; i++) dst[count[(src[i] >> shift) & 0xff]++] = src[i];
+
+        uint64_t *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != keys) memcpy(keys, src, n * sizeof(uint64_t));
+}
+
+static void sort_keys(uint64_t *keys, uint64_t *tmp, size_t n) {
+    if (n <= SORT_NETWORK_MAX) {
+        sort_network(keys, n);
+    } else {
+        radix_sort(keys, tmp, n);
+    }
+}
+
+// Helper function to merge the output range [d0, d1) of a and b into out, locating
+// the matching input ranges with a binary search along the merge path
+static void merge_path_part(const uint64_t *a, size_t na, const uint64_t *b, size_t nb,
+                            uint64_t *out, size_t d0, size_t d1) {
+    size_t split[2];
+    size_t diagonals[2] = {d0, d1};
+    for (int s = 0; s < 2; s++) {
+        size_t d = diagonals[s];
+        size_t lo = d > nb ? d - nb : 0;
+        size_t hi = d < na ? d : na;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (a[mid] < b[d - mid - 1]) lo = mid + 1;
+            else hi = mid;
+        }
+        split[s] = lo;
+    }
+
+    size_t i = split[0], j = d0 - split[0];
+    size_t i_end = split[1], j_end = d1 - split[1];
+    for (size_t k = d0; k < d1; k++) {
+        if (j >= j_end || (i < i_end && a[i] < b[j])) out[k] = a[i++];
+        else out[k] = b[j++];
+    }
+}
+
+// Parallel sort of one long row: sort one chunk per thread, then merge runs pairwise
+static void parallel_sort_keys(uint64_t *keys, uint64_t *tmp, size_t n) {
+    int nthreads = thread_count();
+    size_t chunk = (n + nthreads - 1) / nthreads;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int c = 0; c < nthreads; c++) {
+        size_t start = (size_t)c * chunk < n ? (size_t)c * chunk : n;
+        size_t len = (n - start < chunk) ? n - start : chunk;
+        sort_keys(keys + start, tmp + start, len);
+    }
+
+    uint64_t *src = keys, *dst = tmp;
+    for (size_t width = chunk; width < n; width *= 2) {
+        size_t npairs = (n + 2 * width - 1) / (2 * width);
+        size_t parts = (size_t)nthreads / npairs;
+        if (parts < 1) parts = 1;
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (size_t task = 0; task < npairs * parts; task++) {
+            size_t pair = task / parts, part = task % parts;
+            size_t start = pair * 2 * width;
+            size_t mid = start + width < n ? start + width : n;
+            size_t end = start + 2 * width < n ? start + 2 * width : n;
+            size_t total = end - start;
+            merge_path_part(src + start, mid - start, src + mid, end - mid, dst + start,
+                            total * part / parts, total * (part + 1) / parts);
+        }
+
+        uint64_t *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != keys) memcpy(keys, src, n * sizeof(uint64_t));
+}
+
+// Quickselect: afterwards keys[kth] holds the kth smallest key, with smaller keys before it
+// and larger keys after it
+static void select_keys(uint64_t *keys, size_t n, size_t kth) {
+    ptrdiff_t lo = 0, hi = (ptrdiff_t)n - 1, k = (ptrdiff_t)kth;
+    while (hi - lo > SORT_NETWORK_MAX) {
+        ptrdiff_t mid = lo + (hi - lo) / 2;
+        uint64_t t;
+        if (keys[mid] < keys[lo]) { t = keys[mid]; keys[mid] = keys[lo]; keys[lo] = t; }
+        if (keys[hi] < keys[lo]) { t = keys[hi]; keys[hi] = keys[lo]; keys[lo] = t; }
+        if (keys[hi] < keys[mid]) { t = keys[hi]; keys[hi] = keys[mid]; keys[mid] = t; }
+        uint64_t pivot = keys[mid];
+
+        ptrdiff_t i = lo, j = hi;
+        while (i <= j) {
+            while (keys[i] < pivot) i++;
+            while (keys[j] > pivot) j--;
+            if (i <= j) {
+                t = keys[i];
+                keys[i] = keys[j];
+                keys[j] = t;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else return;
+    }
+    sort_network(keys + lo, (size_t)(hi - lo + 1));
+}
+
+// Helper function to load, process and store every row along an axis. Batches of rows are
+// spread over threads with one pair of key buffers per thread; when there are fewer rows
+// than threads and rows are long, rows are processed one at a time with parallel kernels.
+static ArrayError for_each_row(const ArrayType *a, int axis, int reverse_ties, RowKernel kernel, void *ctx) {
+    RowGeometry g = {1, (size_t)a->shape[axis], 1};
+    for (int d = 0; d < axis; d++) g.outer *= a->shape[d];
+    for (int d = axis + 1; d < a->ndim; d++) g.inner *= a->shape[d];
+    size_t nrows = g.outer * g.inner;
+    if (a->size == 0) return ARRAY_SUCCESS;
+
+    int parallel_rows = nrows < (size_t)thread_count() && g.len >= ARRAY_PARALLEL_THRESHOLD;
+    ArrayError error = ARRAY_SUCCESS;
+
+#ifdef _OPENMP
+    #pragma omp parallel if (!parallel_rows && a->size >= ARRAY_PARALLEL_THRESHOLD)
+#endif
+    {
+        uint64_t *keys = (uint64_t*)malloc(2 * g.len * sizeof(uint64_t));
+        if (!keys) {
+#ifdef _OPENMP
+            #pragma omp atomic write
+#endif
+            error = ARRAY_ERROR_MEMORY_ALLOCATION;
+        }
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif
+        for (size_t row = 0; row < nrows; row++) {
+            if (!keys) continue;
+            size_t o = row / g.inner, i = row % g.inner;
+            const float *src = a->data + o * g.len * g.inner + i;
+
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(static) if (parallel_rows)
+#endif
+            for (size_t k = 0; k < g.len; k++) {
+                uint32_t position = reverse_ties ? ~(uint32_t)k : (uint32_t)k;
+                keys[k] = ((uint64_t)float_key(src[k * g.inner]) << 32) | position;
+            }
+
+            ArrayError row_error = kernel(keys, keys + g.len, &g, o, i, parallel_rows, ctx);
+            if (row_error != ARRAY_SUCCESS) {
+#ifdef _OPENMP
+                #pragma omp atomic write
+#endif
+                error = row_error;
+            }
+        }
+        free(keys);
+    }
+    return error;
+}
+
+typedef struct {
+    float *values;
+    int *indices;
+    int kth;
+} RowOutput;
+
+static ArrayError sort_row_kernel(uint64_t *keys, uint64_t *tmp, const RowGeometry *g,
+                                  size_t o, size_t i, int parallel, void *ctx) {
+    RowOutput *out = (RowOutput*)ctx;
+    if (parallel) parallel_sort_keys(keys, tmp, g->len);
+    else sort_keys(keys, tmp, g->len);
+
+    size_t base = o * g->len * g->inner + i;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (parallel)
+#endif
+    for (size_t k = 0; k < g->len; k++) {
+        if (out->values) out->values[base + k * g->inner] = key_float(keys[k]);
+        if (out->indices) out->indices[base + k * g->inner] = (int)(uint32_t)keys[k];
+    }
+    return ARRAY_SUCCESS;
+}
+
+static ArrayError partition_row_kernel(uint64_t *keys, uint64_t *tmp, const RowGeometry *g,
+                                       size_t o, size_t i, int parallel, void *ctx) {
+    (void)tmp;
+    (void)parallel;
+    RowOutput *out = (RowOutput*)ctx;
+    select_keys(keys, g->len, (size_t)out->kth);
+
+    size_t base = o * g->len * g->inner + i;
+    for (size_t k = 0; k < g->len; k++) {
+        out->values[base + k * g->inner] = key_float(keys[k]);
+    }
+    return ARRAY_SUCCESS;
+}
+
+static ArrayError topk_row_kernel(uint64_t *keys, uint64_t *tmp, const RowGeometry *g,
+                                  size_t o, size_t i, int parallel, void *ctx) {
+    RowOutput *out = (RowOutput*)ctx;
+    size_t k = (size_t)out->kth;
+    uint64_t *top;
+
+    if (parallel) {
+        // Every chunk keeps its own k largest keys; the final selection runs on the candidates
+        int nthreads = thread_count();
+        size_t chunk = (g->len + nthreads - 1) / nthreads;
+        size_t counts[nthreads];
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (int c = 0; c < nthreads; c++) {
+            size_t start = (size_t)c * chunk < g->len ? (size_t)c * chunk : g->len;
+            size_t len = (g->len - start < chunk) ? g->len - start : chunk;
+            size_t keep = len < k ? len : k;
+            if (keep > 0 && keep < len) select_keys(keys + start, len, len - keep);
+            counts[c] = keep;
+        }
+
+        size_t ncandidates = 0;
+        for (int c = 0; c < nthreads; c++) {
+            size_t start = (size_t)c * chunk < g->len ? (size_t)c * chunk : g->len;
+            size_t len = (g->len - start < chunk) ? g->len - start : chunk;
+            memcpy(tmp + ncandidates, keys + start + len - counts[c], counts[c] * sizeof(uint64_t));
+            ncandidates += counts[c];
+        }
+        select_keys(tmp, ncandidates, ncandidates - k);
+        top = tmp + ncandidates - k;
+        sort_keys(top, keys, k);
+    } else {
+        select_keys(keys, g->len, g->len - k);
+        top = keys + g->len - k;
+        sort_keys(top, tmp, k);
+    }
+
+    size_t base = o * k * g->inner + i;
+    for (size_t j = 0; j < k; j++) {
+        uint64_t key = top[k - 1 - j];
+        if (out->values) out->values[base + j * g->inner] = key_float(key);
+        if (out->indices) out->indices[base + j * g->inner] = (int)~(uint32_t)key;
+    }
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to (re)allocate an index buffer
+static ArrayError prepare_indices(int **indices, size_t count) {
+    free(*indices);
+    *indices = (int*)malloc((count > 0 ? count : 1) * sizeof(int));
+    return *indices ? ARRAY_SUCCESS : ARRAY_ERROR_MEMORY_ALLOCATION;
+}
+
+// Function to sort an array along an axis
+ArrayError sort_array(ArrayType **result, const ArrayType *a, int axis) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    ArrayError error = prepare_result(result, a->shape, a->ndim);
+    if (error != ARRAY_SUCCESS) return error;
+
+    RowOutput out = {(*result)->data, NULL, 0};
+    return for_each_row(a, axis, 0, sort_row_kernel, &out);
+}
+
+// Function to compute the indices that sort an array along an axis
+ArrayError argsort_array(int **indices, const ArrayType *a, int axis) {
+    if (!indices || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+
+    ArrayError error = prepare_indices(indices, a->size);
+    if (error != ARRAY_SUCCESS) return error;
+
+    RowOutput out = {NULL, *indices, 0};
+    return for_each_row(a, axis, 0, sort_row_kernel, &out);
+}
+
+// Function to partition an array around its kth element along an axis
+ArrayError partition_array(ArrayType **result, const ArrayType *a, int kth, int axis) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (kth < 0 || kth >= a->shape[axis]) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    ArrayError error = prepare_result(result, a->shape, a->ndim);
+    if (error != ARRAY_SUCCESS) return error;
+
+    RowOutput out = {(*result)->data, NULL, kth};
+    return for_each_row(a, axis, 0, partition_row_kernel, &out);
+}
+
+// Function to find the k largest elements along an axis
+ArrayError topk_array(ArrayType **values, int **indices, const ArrayType *a, int k, int axis) {
+    if (!a || (!values && !indices)) return ARRAY_ERROR_NULL_POINTER;
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (values && *values == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    axis = normalize_axis(axis, a->ndim);
+    if (axis < 0) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (k <= 0 || k > a->shape[axis]) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    int shape[ARRAY_MAX_DIMS];
+    memcpy(shape, a->shape, a->ndim * sizeof(int));
+    shape[axis] = k;
+
+    RowOutput out = {NULL, NULL, k};
+    ArrayError error;
+    if (values) {
+        error = prepare_result(values, shape, a->ndim);
+        if (error != ARRAY_SUCCESS) return error;
+        out.values = (*values)->data;
+    }
+    if (indices) {
+        error = prepare_indices(indices, a->size / a->shape[axis] * k);
+        if (error != ARRAY_SUCCESS) return error;
+        out.indices = *indices;
+    }
+    return for_each_row(a, axis, 1, topk_row_kernel, &out);
+}
@@ -0,0 +1,543 @@
+#include "stencil.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Tile extents along y and x for 2-D grids, and along z, y and x for 3-D grids. A tile
+// and its halo stay in the L2 cache of the thread stepping it.
+#define STENCIL_TILE_ROWS 64
+#define STENCIL_TILE_COLS 512
+#define STENCIL_TILE_PLANES_3D 16
+#define STENCIL_TILE_ROWS_3D 32
+#define STENCIL_TILE_COLS_3D 128
+
+// Most steps of an iterated stencil fused into one sweep over the grid
+#define STENCIL_MAX_FUSED 8
+
+// The halo of a fused sweep is at most 1 / STENCIL_HALO_FRACTION of the tile along
+// each axis, bounding the cells computed again by neighbouring tiles
+#define STENCIL_HALO_FRACTION 4
+
+// A nonzero weight and the offset along z, y and x of the cell it multiplies
+typedef struct {
+    int offset[3];
+    float weight;
+} StencilTap;
+
+// One sweep over the grids: the taps, their reach along each axis and the steps fused
+typedef struct {
+    const StencilTap *taps;
+    int ntaps;
+    int radius[3];
+    int steps;
+} StencilPass;
+
+// Grids a stencil runs over and how they are tiled; 2-D grids have a single plane
+typedef struct {
+    size_t batch;
+    int n[3];
+    int tile[3];
+    StencilBoundary boundary;
+    float cval;
+} StencilGrid;
+
+// Cells held by a tile buffer: the grid coordinates of the first one and the extents
+typedef struct {
+    int origin[3];
+    int len[3];
+} TileFrame;
+
+static inline int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Helper function to find the cell read for coordinate i of an axis of length n;
+// -1 when it holds the constant
+static int boundary_index(long i, int n, StencilBoundary boundary) {
+    if (i >= 0 && i < n) return (int)i;
+    long period = 2L * n, m;
+    switch (boundary) {
+        case STENCIL_NEAREST:
+            return i < 0 ? 0 : n - 1;
+        case STENCIL_REFLECT:
+            m = i % period;
+            m = m < 0 ? m + period : m;
+            return (int)(m < n ? m : period - 1 - m);
+        case STENCIL_WRAP:
+            m = i % n;
+            return (int)(m < 0 ? m + n : m);
+        default:
+            return -1;
+    }
+}
+
+// Helper function to set up the grids in the last dims axes of an array
+static ArrayError stencil_grid(StencilGrid *g, const ArrayType *a, int dims, StencilBoundary boundary, float cval) {
+    if (a->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (a->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (dims != 2 && dims != 3) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (a->ndim < dims) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (boundary < STENCIL_CONSTANT || boundary > STENCIL_WRAP) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    g->n[0] = dims == 3 ? a->shape[a->ndim - 3] : 1;
+    g->n[1] = a->shape[a->ndim - 2];
+    g->n[2] = a->shape[a->ndim - 1];
+    g->tile[0] = dims == 3 ? STENCIL_TILE_PLANES_3D : 1;
+    g->tile[1] = dims == 3 ? STENCIL_TILE_ROWS_3D : STENCIL_TILE_ROWS;
+    g->tile[2] = dims == 3 ? STENCIL_TILE_COLS_3D : STENCIL_TILE_COLS;
+    for (int d = 0; d < 3; d++) {
+        if (g->n[d] <= 0) return ARRAY_ERROR_INVALID_DIMENSION;
+        g->tile[d] = g->tile[d] < g->n[d] ? g->tile[d] : g->n[d];
+    }
+    g->batch = a->size / ((size_t)g->n[0] * g->n[1] * g->n[2]);
+    g->boundary = boundary;
+    g->cval = cval;
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to choose how many steps of an iterated stencil one sweep fuses.
+// Cells beyond the edges are refilled from the tile between fused steps, which
+// needs their source within the halo: wrapped cells never are, and mirrored ones
+// only while the halo is no wider than the grid.
+static int fused_steps(const StencilGrid *g, const int *radius, int remaining) {
+    if (g->boundary == STENCIL_WRAP) return 1;
+    int steps = remaining < STENCIL_MAX_FUSED ? remaining : STENCIL_MAX_FUSED;
+    for (int d = 0; d < 3; d++) {
+        if (radius[d] == 0) continue;
+        int reach = g->tile[d] / STENCIL_HALO_FRACTION;
+        reach = reach < g->n[d] ? reach : g->n[d];
+        steps = reach / radius[d] < steps ? reach / radius[d] : steps;
+    }
+    return steps > 1 ? steps : 1;
+}
+
+// Helper function to copy a tile and its halo out of a grid, applying the boundary rule
+static void load_tile(float *buf, const float *grid, const StencilGrid *g, const TileFrame *f) {
+    int nx = g->n[2], x0 = f->origin[2], lx = f->len[2];
+    int xa = x0 < 0 ? -x0 : 0;
+    int xb = nx - x0 < lx ? nx - x0 : lx;
+
+    for (int z = 0; z < f->len[0]; z++) {
+        int gz = boundary_index((long)f->origin[0] + z, g->n[0], g->boundary);
+        for (int y = 0; y < f->len[1]; y++) {
+            int gy = boundary_index((long)f->origin[1] + y, g->n[1], g->boundary);
+            float *row = buf + ((size_t)z * f->len[1] + y) * lx;
+            if (gz < 0 || gy < 0) {
+                for (int x = 0; x < lx; x++) row[x] = g->cval;
+                continue;
+            }
+            const float *src = grid + ((size_t)gz * g->n[1] + gy) * nx;
+            memcpy(row + xa, src + x0 + xa, (size_t)(xb - xa) * sizeof(float));
+            for (int x = 0; x < xa; x++) {
+                int gx = boundary_index((long)x0 + x, nx, g->boundary);
+                row[x] = gx < 0 ? g->cval : src[gx];
+            }
+            for (int x = xb; x < lx; x++) {
+                int gx = boundary_index((long)x0 + x, nx, g->boundary);
+                row[x] = gx < 0 ? g->cval : src[gx];
+            }
+        }
+    }
+}
+
+// Helper function to refill the cells of a tile buffer beyond the edges of the grid
+// from the cells of the buffer they mirror, between two fused steps
+static void refresh_tile(float *buf, const StencilGrid *g, const TileFrame *f) {
+    int lo[3], hi[3];
+    for (int d = 0; d < 3; d++) {
+        lo[d] = f->origin[d] < 0 ? -f->origin[d] : 0;
+        hi[d] = g->n[d] - f->origin[d] < f->len[d] ? g->n[d] - f->origin[d] : f->len[d];
+    }
+    int lx = f->len[2];
+    size_t plane = (size_t)f->len[1] * lx;
+
+    // Along x within rows inside the grid, then whole rows, then whole planes
+    for (int z = lo[0]; z < hi[0]; z++) {
+        for (int y = lo[1]; y < hi[1]; y++) {
+            float *row = buf + z * plane + (size_t)y * lx;
+            for (int x = 0; x < lo[2]; x++) {
+                int gx = boundary_index((long)f->origin[2] + x, g->n[2], g->boundary);
+                row[x] = gx < 0 ? g->cval : row[gx - f->origin[2]];
+            }
+            for (int x = hi[2]; x < lx; x++) {
+                int gx = boundary_index((long)f->origin[2] + x, g->n[2], g->boundary);
+                row[x] = gx < 0 ? g->cval : row[gx - f->origin[2]];
+            }
+        }
+        for (int y = 0; y < f->len[1]; y++) {
+            if (y >= lo[1] && y < hi[1]) continue;
+            int gy = boundary_index((long)f->origin[1] + y, g->n[1], g->boundary);
+            float *row = buf + z * plane + (size_t)y * lx;
+            if (gy < 0) {
+                for (int x = 0; x < lx; x++) row[x] = g->cval;
+            } else {
+                memcpy(row, buf + z * plane + (size_t)(gy - f->origin[1]) * lx, (size_t)lx * sizeof(float));
+            }
+        }
+    }
+    for (int z = 0; z < f->len[0]; z++) {
+        if (z >= lo[0] && z < hi[0]) continue;
+        int gz = boundary_index((long)f->origin[0] + z, g->n[0], g->boundary);
+        if (gz < 0) {
+            for (size_t i = 0; i < plane; i++) buf[z * plane + i] = g->cval;
+        } else {
+            memcpy(buf + z * plane, buf + (gz - f->origin[0]) * plane, plane * sizeof(float));
+        }
+    }
+}
+
+// Row kernel: out[x] = (out[x] +) w[0] * in[0][x] + ... + w[count - 1] * in[count - 1][x],
+// added left to right, for up to four taps; first starts the sum instead of adding to out
+typedef void (*StencilRowKernel)(float *out, const float *const *in, const float *w, int count, int first, int n);
+
+static inline void stencil_row_body(float *out, const float *const *in, const float *w, int count, int first, int n) {
+    const float *i0 = in[0], *i1 = in[count > 1], *i2 = in[count > 2 ? 2 : 0], *i3 = in[count > 3 ? 3 : 0];
+    float w0 = w[0], w1 = w[count > 1], w2 = w[count > 2 ? 2 : 0], w3 = w[count > 3 ? 3 : 0];
+    switch (count * 2 + first) {
+        case 9:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = w0 * i0[x] + w1 * i1[x] + w2 * i2[x] + w3 * i3[x];
+            break;
+        case 8:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = out[x] + w0 * i0[x] + w1 * i1[x] + w2 * i2[x] + w3 * i3[x];
+            break;
+        case 7:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = w0 * i0[x] + w1 * i1[x] + w2 * i2[x];
+            break;
+        case 6:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = out[x] + w0 * i0[x] + w1 * i1[x] + w2 * i2[x];
+            break;
+        case 5:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = w0 * i0[x] + w1 * i1[x];
+            break;
+        case 4:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = out[x] + w0 * i0[x] + w1 * i1[x];
+            break;
+        case 3:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = w0 * i0[x];
+            break;
+        default:
+            ARRAY_OMP_SIMD
+            for (int x = 0; x < n; x++) out[x] = out[x] + w0 * i0[x];
+            break;
+    }
+}
+
+static void stencil_row(float *out, const float *const *in, const float *w, int count, int first, int n) {
+    stencil_row_body(out, in, w, count, first, n);
+}
+
+// On x86 a copy compiled for AVX2 is selected at run time. Products and sums are not
+// fused, so both copies round every cell the same way.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STENCIL_AVX2_DISPATCH 1
+__attribute__((target("avx2")))
+static void stencil_row_avx2(float *out, const float *const *in, const float *w, int count, int first, int n) {
+    stencil_row_body(out, in, w, count, first, n);
+}
+#endif
+
+static StencilRowKernel select_row_kernel(void) {
+#ifdef STENCIL_AVX2_DISPATCH
+    if (__builtin_cpu_supports("avx2")) return stencil_row_avx2;
+#endif
+    return stencil_row;
+}
+
+// Helper function to run one step of a stencil over a tile buffer. Step s updates the
+// cells at least s radii from the buffer edges; the rest only feed cells that are
+// discarded. Taps are applied four at a time, in order, along each row.
+static void step_tile(float *dst, const float *src, const TileFrame *f, const StencilPass *p, int step,
+                      StencilRowKernel kernel) {
+    int lo[3], hi[3];
+    for (int d = 0; d < 3; d++) {
+        lo[d] = step * p->radius[d];
+        hi[d] = f->len[d] - lo[d];
+    }
+    ptrdiff_t lx = f->len[2], plane = (ptrdiff_t)f->len[1] * lx;
+    int n = hi[2] - lo[2];
+
+    for (int z = lo[0]; z < hi[0]; z++) {
+        for (int y = lo[1]; y < hi[1]; y++) {
+            float *out = dst + z * plane + y * lx + lo[2];
+            for (int t = 0; t < p->ntaps; t += 4) {
+                const float *in[4];
+                float w[4];
+                int count = p->ntaps - t < 4 ? p->ntaps - t : 4;
+                for (int k = 0; k < count; k++) {
+                    const StencilTap *tap = &p->taps[t + k];
+                    in[k] = src + (z + tap->offset[0]) * plane + (y + tap->offset[1]) * lx + lo[2] + tap->offset[2];
+                    w[k] = tap->weight;
+                }
+                kernel(out, in, w, count, t == 0, n);
+            }
+        }
+    }
+}
+
+// Helper function to sweep a pass over every grid, one tile per task
+static ArrayError run_pass(float *dst, const float *src, const StencilGrid *g, const StencilPass *p) {
+    int halo[3], tiles[3];
+    size_t ntiles = 1, cap = 1;
+    for (int d = 0; d < 3; d++) {
+        halo[d] = p->radius[d] * p->steps;
+        tiles[d] = (g->n[d] + g->tile[d] - 1) / g->tile[d];
+        ntiles *= tiles[d];
+        cap *= (size_t)g->tile[d] + 2 * halo[d];
+    }
+    size_t grid_size = (size_t)g->n[0] * g->n[1] * g->n[2];
+    size_t ntasks = g->batch * ntiles;
+
+    int parallel = ntasks > 1 && g->batch * grid_size * p->ntaps * p->steps >= ARRAY_PARALLEL_THRESHOLD;
+    int nthreads = parallel ? thread_count() : 1;
+    float *buffers = (float*)calloc((size_t)nthreads * 2 * cap, sizeof(float));
+    if (!buffers) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    StencilRowKernel kernel = select_row_kernel();
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads) if (parallel)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        float *front = buffers + (size_t)tid * 2 * cap;
+        float *back = front + cap;
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (size_t t = 0; t < ntasks; t++) {
+            size_t b = t / ntiles, rest = t % ntiles;
+            int start[3], extent[3];
+            TileFrame f;
+            for (int d = 2; d >= 0; d--) {
+                start[d] = (int)(rest % tiles[d]) * g->tile[d];
+                rest /= tiles[d];
+                extent[d] = g->n[d] - start[d] < g->tile[d] ? g->n[d] - start[d] : g->tile[d];
+                f.origin[d] = start[d] - halo[d];
+                f.len[d] = extent[d] + 2 * halo[d];
+            }
+
+            float *a = front, *c = back;
+            load_tile(a, src + b * grid_size, g, &f);
+            for (int s = 1; s <= p->steps; s++) {
+                step_tile(c, a, &f, p, s, kernel);
+                if (s < p->steps) refresh_tile(c, g, &f);
+                float *swap = a;
+                a = c;
+                c = swap;
+            }
+
+            size_t lx = (size_t)f.len[2], plane = (size_t)f.len[1] * lx;
+            for (int z = 0; z < extent[0]; z++) {
+                for (int y = 0; y < extent[1]; y++) {
+                    memcpy(dst + b * grid_size + ((size_t)(start[0] + z) * g->n[1] + start[1] + y) * g->n[2] + start[2],
+                           a + (z + halo[0]) * plane + (y + halo[1]) * lx + halo[2], (size_t)extent[2] * sizeof(float));
+                }
+            }
+        }
+    }
+
+    free(buffers);
+    return ARRAY_SUCCESS;
+}
+
+// Helper function to run passes one after the other, from in to out. Intermediate
+// grids alternate between out and a scratch array so that the last pass writes out.
+static ArrayError run_passes(float *out, const float *in, const StencilGrid *g, const StencilPass *passes, int npasses) {
+    float *scratch = NULL;
+    if (npasses > 1) {
+        size_t size = g->batch * g->n[0] * g->n[1] * (size_t)g->n[2];
+        scratch = (float*)malloc(size * sizeof(float));
+        if (!scratch) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    }
+
+    ArrayError error = ARRAY_SUCCESS;
+    const float *src = in;
+    for (int k = 0; k < npasses && error == ARRAY_SUCCESS; k++) {
+        float *dst = (npasses - 1 - k) % 2 == 0 ? out : scratch;
+        error = run_pass(dst, src, g, &passes[k]);
+        src = dst;
+    }
+    free(scratch);
+    return error;
+}
+
+// Helper function to apply taps a given number of times, fusing steps into sweeps
+static ArrayError iterate_stencil(ArrayType **result, const ArrayType *a, const StencilGrid *g,
+                                  const StencilTap *taps, int ntaps, int iterations) {
+    int radius[3] = {0, 0, 0};
+    for (int t = 0; t < ntaps; t++) {
+        for (int d = 0; d < 3; d++) {
+            int r = abs(taps[t].offset[d]);
+            radius[d] = r > radius[d] ? r : radius[d];
+        }
+    }
+
+    int npasses = 0;
+    for (int left = iterations; left > 0; left -= fused_steps(g, radius, left)) npasses++;
+    StencilPass *passes = (StencilPass*)malloc(npasses * sizeof(StencilPass));
+    if (!passes) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    int left = iterations;
+    for (int k = 0; k < npasses; k++) {
+        passes[k].taps = taps;
+        passes[k].ntaps = ntaps;
+        memcpy(passes[k].radius, radius, sizeof(radius));
+        passes[k].steps = fused_steps(g, radius, left);
+        left -= passes[k].steps;
+    }
+
+    ArrayError error = prepare_result(result, a->shape, a->ndim);
+    if (error == ARRAY_SUCCESS) error = run_passes((*result)->data, a->data, g, passes, npasses);
+    free(passes);
+    return error;
+}
+
+// Helper function to apply a symmetric 1-D filter along each axis of the grids in turn
+static ArrayError separable_filter(ArrayType **result, const ArrayType *a, const float *weights, int radius,
+                                   int dims, StencilBoundary boundary, float cval) {
+    StencilGrid g;
+    ArrayError error = stencil_grid(&g, a, dims, boundary, cval);
+    if (error != ARRAY_SUCCESS) return error;
+
+    int ntaps = 2 * radius + 1;
+    StencilTap *taps = (StencilTap*)calloc((size_t)dims * ntaps, sizeof(StencilTap));
+    if (!taps) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    StencilPass passes[3];
+    for (int k = 0; k < dims; k++) {
+        int axis = 3 - dims + k;
+        StencilTap *axis_taps = taps + (size_t)k * ntaps;
+        for (int t = 0; t < ntaps; t++) {
+            axis_taps[t].offset[axis] = t - radius;
+            axis_taps[t].weight = weights[t];
+        }
+        passes[k].taps = axis_taps;
+        passes[k].ntaps = ntaps;
+        passes[k].radius[0] = passes[k].radius[1] = passes[k].radius[2] = 0;
+        passes[k].radius[axis] = radius;
+        passes[k].steps = 1;
+    }
+
+    error = prepare_result(result, a->shape, a->ndim);
+    if (error == ARRAY_SUCCESS) error = run_passes((*result)->data, a->data, &g, passes, dims);
+    free(taps);
+    return error;
+}
+
+// Function to apply a stencil given by its weights
+ArrayError stencil_array(ArrayType **result, const ArrayType *a, const ArrayType *weights,
+                         int iterations, StencilBoundary boundary, float cval) {
+    if (!result || !a || !weights) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a || iterations < 1) return ARRAY_ERROR_INVALID_ARGUMENT;
+    if (weights->dtype != ARRAY_DTYPE_FLOAT32) return ARRAY_ERROR_INVALID_DTYPE;
+    if (weights->ndim != 2 && weights->ndim != 3) return ARRAY_ERROR_INVALID_DIMENSION;
+    if (weights->view) return ARRAY_ERROR_INVALID_ARGUMENT;
+    StencilGrid g;
+    ArrayError error = stencil_grid(&g, a, weights->ndim, boundary, cval);
+    if (error != ARRAY_SUCCESS) return error;
+
+    int k[3] = {1, 1, 1};
+    for (int d = 0; d < weights->ndim; d++) {
+        k[3 - weights->ndim + d] = weights->shape[d];
+        if (weights->shape[d] % 2 == 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Nonzero weights in row-major order; a stencil of zeros keeps its centre tap
+    StencilTap *taps = (StencilTap*)malloc((weights->size + 1) * sizeof(StencilTap));
+    if (!taps) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    int ntaps = 0;
+    for (size_t i = 0; i < weights->size; i++) {
+        if (weights->data[i] == 0.0f) continue;
+        taps[ntaps].offset[0] = (int)(i / ((size_t)k[1] * k[2])) - k[0] / 2;
+        taps[ntaps].offset[1] = (int)(i / k[2] % k[1]) - k[1] / 2;
+        taps[ntaps].offset[2] = (int)(i % k[2]) - k[2] / 2;
+        taps[ntaps].weight = weights->data[i];
+        ntaps++;
+    }
+    if (ntaps == 0) {
+        memset(&taps[0], 0, sizeof(StencilTap));
+        ntaps = 1;
+    }
+
+    error = iterate_stencil(result, a, &g, taps, ntaps, iterations);
+    free(taps);
+    return error;
+}
+
+// Function to compute the discrete Laplacian
+ArrayError laplacian_array(ArrayType **result, const ArrayType *a, int dims, StencilBoundary boundary, float cval) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a) return ARRAY_ERROR_INVALID_ARGUMENT;
+    StencilGrid g;
+    ArrayError error = stencil_grid(&g, a, dims, boundary, cval);
+    if (error != ARRAY_SUCCESS) return error;
+
+    // Neighbours in row-major order around the centre, as the 3 x 3 (x 3) weights list them
+    StencilTap taps[7];
+    int ntaps = 0;
+    for (int d = 3 - dims; d < 3; d++) {
+        memset(&taps[ntaps], 0, sizeof(StencilTap));
+        taps[ntaps].offset[d] = -1;
+        taps[ntaps++].weight = 1.0f;
+    }
+    memset(&taps[ntaps], 0, sizeof(StencilTap));
+    taps[ntaps++].weight = -2.0f * dims;
+    for (int d = 2; d >= 3 - dims; d--) {
+        memset(&taps[ntaps], 0, sizeof(StencilTap));
+        taps[ntaps].offset[d] = 1;
+        taps[ntaps++].weight = 1.0f;
+    }
+    return iterate_stencil(result, a, &g, taps, ntaps, 1);
+}
+
+// Function to blur with a truncated Gaussian
+ArrayError gaussian_filter_array(ArrayType **result, const ArrayType *a, float sigma, int dims,
+                                 StencilBoundary boundary, float cval) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a || !(sigma > 0.0f) || sigma > 1e6f) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    int radius = (int)(4.0f * sigma + 0.5f);
+    float *weights = (float*)malloc((2 * (size_t)radius + 1) * sizeof(float));
+    if (!weights) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    double total = 0.0;
+    for (int i = -radius; i <= radius; i++) total += exp(-0.5 * i * i / ((double)sigma * sigma));
+    for (int i = -radius; i <= radius; i++) {
+        weights[i + radius] = (float)(exp(-0.5 * i * i / ((double)sigma * sigma)) / total);
+    }
+
+    ArrayError error = separable_filter(result, a, weights, radius, dims, boundary, cval);
+    free(weights);
+    return error;
+}
+
+// Function to average over boxes
+ArrayError box_filter_array(ArrayType **result, const ArrayType *a, int size, int dims,
+                            StencilBoundary boundary, float cval) {
+    if (!result || !a) return ARRAY_ERROR_NULL_POINTER;
+    if (*result == a || size < 1 || size % 2 == 0) return ARRAY_ERROR_INVALID_ARGUMENT;
+
+    float *weights = (float*)malloc((size_t)size * sizeof(float));
+    if (!weights) return ARRAY_ERROR_MEMORY_ALLOCATION;
+    for (int i = 0; i < size; i++) weights[i] = 1.0f / (float)size;
+
+    ArrayError error = separable_filter(result, a, weights, size / 2, dims, boundary, cval);
+    free(weights);
+    return error;
+}
@@ -0,0 +1,260 @@
+#include "vmath.h"
+#include "parallel.h"
+#include "vmath_inline.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Arguments beyond this magnitude leave the fast sin/cos range reduction and go through libm
+#define VMATH_TRIG_LIMIT 64.0f
+
+static VMathAccuracy vmath_accuracy = VMATH_ACCURACY_FAST;
+
+// Function to select the accuracy mode of the vectorized math functions
+void vmath_set_accuracy(VMathAccuracy accuracy) {
+    vmath_accuracy = accuracy;
+}
+
+// Function to query the accuracy mode of the vectorized math functions
+VMathAccuracy vmath_get_accuracy(void) {
+    return vmath_accuracy;
+}
+
+// exp: x = n*ln2 + r with |r| <= ln2/2, degree 6 polynomial for e^r, 2^n applied in two halves
+// so that results stay correct down into the subnormal range
+static inline float fast_exp(float x) {
+    x = x > 89.0f ? 89.0f : x;
+    x = x < -104.0f ? -104.0f : x;
+
+    const float shifter = 12582912.0f;  // 1.5 * 2^23, rounds to nearest integer
+    float t = x * 1.44269504088896341f + shifter;
+    int32_t n = (int32_t)(float_to_bits(t) - float_to_bits(shifter));
+    float fn = t - shifter;
+
+    float r = x - fn * 0.693359375f;
+    r = r - fn * -2.12194440e-4f;
+
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * (r * r) + r + 1.0f;
+
+    int32_t n1 = n / 2;
+    int32_t n2 = n - n1;
+    float s1 = bits_to_float((uint32_t)(n1 + 127) << 23);
+    float s2 = bits_to_float((uint32_t)(n2 + 127) << 23);
+    return p * s1 * s2;
+}
+
+// tanh: odd polynomial near zero, 1 - 2 / (e^2x + 1) elsewhere
+static inline float fast_tanh(float x) {
+    float ax = fabsf(x);
+    float z = x * x;
+    float p = -5.70498872745e-3f;
+    p = p * z + 2.06390887954e-2f;
+    p = p * z - 5.37397155531e-2f;
+    p = p * z + 1.33314422036e-1f;
+    p = p * z - 3.33332819422e-1f;
+    p = p * z * x + x;
+
+    float e = fast_exp(2.0f * ax);
+    float q = 1.0f - 2.0f / (e + 1.0f);
+    q = x < 0.0f ? -q : q;
+    return ax < 0.625f ? p : q;
+}
+
+// erf: Taylor series for |x| < 1, erfc rational-exponential fit (Numerical Recipes) elsewhere.
+// The series is summed as x + x * (2/sqrt(pi) - 1 - ...) so that its rounding error stays
+// small against x; near 0.5 the erfc fit's relative error would cost up to 4 ULP.
+static inline float fast_erf(float x) {
+    float ax = fabsf(x);
+    float z = x * x;
+    float p = -1.636584469e-7f;
+    p = p * z + 1.646211437e-6f;
+    p = p * z - 1.492565036e-5f;
+    p = p * z + 1.205533298e-4f;
+    p = p * z - 8.548327023e-4f;
+    p = p * z + 5.223977625e-3f;
+    p = p * z - 2.686617065e-2f;
+    p = p * z + 1.128379167e-1f;
+    p = p * z - 3.761263890e-1f;
+    p = p * z + 1.283791671e-1f;
+    p = x + x * p;
+
+    float t = 1.0f / (1.0f + 0.5f * ax);
+    float q = 0.17087277f;
+    q = q * t - 0.82215223f;
+    q = q * t + 1.48851587f;
+    q = q * t - 1.13520398f;
+    q = q * t + 0.27886807f;
+    q = q * t - 0.18628806f;
+    q = q * t + 0.09678418f;
+    q = q * t + 0.37409196f;
+    q = q * t + 1.00002368f;
+    q = q * t - 1.26551223f;
+    float erfc = t * fast_exp(q - z);
+    float tail = 1.0f - erfc;
+    tail = x < 0.0f ? -tail : tail;
+    return ax < 1.0f ? p : tail;
+}
+
+// Fast kernels: branch-free loops that the compiler vectorizes
+static void exp_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = fast_exp(in[i]);
+}
+
+static void log_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = fast_log(in[i]);
+}
+
+// Large or non-finite arguments are rare; they are patched up with libm after the vector pass
+static void sincos_kernel(float *out, const float *in, size_t n, int cosine) {
+    int out_of_range = 0;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) {
+        float x = in[i];
+        out_of_range |= !(fabsf(x) <= VMATH_TRIG_LIMIT);
+        out[i] = fast_sincos(fabsf(x) <= VMATH_TRIG_LIMIT ? x : 0.0f, cosine);
+    }
+    if (!out_of_range) return;
+    for (size_t i = 0; i < n; i++) {
+        if (!(fabsf(in[i]) <= VMATH_TRIG_LIMIT)) {
+            out[i] = cosine ? cosf(in[i]) : sinf(in[i]);
+        }
+    }
+}
+
+static void sin_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    sincos_kernel(out, in, n, 0);
+}
+
+static void cos_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    sincos_kernel(out, in, n, 1);
+}
+
+static void tanh_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = fast_tanh(in[i]);
+}
+
+static void sigmoid_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) {
+        // e^-|x| never overflows, so negative inputs keep full precision down to subnormals
+        float e = fast_exp(-fabsf(in[i]));
+        float s = 1.0f / (1.0f + e);
+        out[i] = in[i] < 0.0f ? e * s : s;
+    }
+}
+
+static void erf_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = fast_erf(in[i]);
+}
+
+static void sqrt_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = sqrtf(in[i]);
+}
+
+static void rsqrt_kernel(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    ARRAY_OMP_SIMD
+    for (size_t i = 0; i < n; i++) out[i] = 1.0f / sqrtf(in[i]);
+}
+
+// Strict kernels: correctly rounded double-precision libm results narrowed to float
+static void exp_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)exp(in[i]);
+}
+
+static void log_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)log(in[i]);
+}
+
+static void sin_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)sin(in[i]);
+}
+
+static void cos_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)cos(in[i]);
+}
+
+static void tanh_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)tanh(in[i]);
+}
+
+static void sigmoid_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)(1.0 / (1.0 + exp(-(double)in[i])));
+}
+
+static void erf_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)erf(in[i]);
+}
+
+static void rsqrt_strict(float *out, const float *in, size_t n, const void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = (float)(1.0 / sqrt(in[i]));
+}
+
+// Helper function to dispatch on the current accuracy mode
+static ArrayError vmath_apply(ArrayType **result, const ArrayType *a, UnaryKernel fast, UnaryKernel strict) {
+    return unary_operation(result, a, vmath_accuracy == VMATH_ACCURACY_STRICT ? strict : fast, NULL);
+}
+
+ArrayError exp_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, exp_kernel, exp_strict);
+}
+
+ArrayError log_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, log_kernel, log_strict);
+}
+
+ArrayError sin_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, sin_kernel, sin_strict);
+}
+
+ArrayError cos_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, cos_kernel, cos_strict);
+}
+
+ArrayError tanh_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, tanh_kernel, tanh_strict);
+}
+
+ArrayError sigmoid_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, sigmoid_kernel, sigmoid_strict);
+}
+
+ArrayError erf_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, erf_kernel, erf_strict);
+}
+
+// sqrtf is correctly rounded and vectorizes directly, so both modes share the kernel
+ArrayError sqrt_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, sqrt_kernel, sqrt_kernel);
+}
+
+ArrayError rsqrt_array(ArrayType **result, const ArrayType *a) {
+    return vmath_apply(result, a, rsqrt_kernel, rsqrt_strict);
+}
@@ -0,0 +1,522 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "array.h"
+#include "masked.h"
+#include "memory.h"
+#include "scan.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Performance regression check
+//
+// Runs a fixed set of micro-benchmarks and compares them with a baseline file:
+// "bench_array FILE" checks against it and exits with status 1 on a
+// regression, "bench_array --record FILE" rewrites it. Every case is timed in
+// SAMPLES samples of enough iterations to last SAMPLE_SECONDS, each taken
+// between two samples of a plain C reference loop. A case is compared through
+// the median of its time relative to the reference, so that a baseline carries
+// over to a faster or slower machine and to a machine whose speed drifts while
+// the check runs, and its noise is the median absolute deviation of those
+// ratios, which includes the noise of the reference. A case regresses when it
+// is more than the tolerance slower than its baseline and the gap is also more
+// than NOISE_SIGMAS times the combined noise of both runs; regressed cases are
+// measured once more and only fail if they regress again.
+
+#define SAMPLES 15
+#define SAMPLE_SECONDS 0.005
+#define NOISE_SIGMAS 4.0
+#define DEFAULT_TOLERANCE 0.15
+#define MAX_CASES 64
+
+// Scale from the median absolute deviation to the standard deviation of a normal distribution
+#define MAD_TO_SIGMA 1.4826
+
+#define LARGE_ROWS 1024
+#define LARGE_COLS 1024
+#define SMALL_SIDE 16
+#define SCAN_LENGTH (1 << 20)
+#define POOL_ARRAYS 64
+
+typedef struct {
+    ArrayType *a;        // [LARGE_ROWS, LARGE_COLS]
+    ArrayType *b;        // [LARGE_ROWS, LARGE_COLS]
+    ArrayType *row;      // [LARGE_COLS], broadcast along the rows
+    ArrayType *col;      // [LARGE_ROWS, 1], broadcast along the columns
+    ArrayType *small_a;  // [SMALL_SIDE, SMALL_SIDE]
+    ArrayType *small_b;  // [SMALL_SIDE, SMALL_SIDE]
+    ArrayType *vector;   // [SCAN_LENGTH]
+    ArrayType *out;      // Result reused by every case
+    float *ref_out;      // Output of the reference loop
+} Fixture;
+
+typedef struct BenchCase {
+    const char *name;
+    void (*run)(Fixture *f);
+    const struct BenchCase *reference;  // Reference loop the case is measured against
+} BenchCase;
+
+typedef struct {
+    char name[64];
+    double median_ns;
+    double mad_ns;
+    double ratio;       // Time relative to the reference loop timed alongside the case
+    double ratio_mad;
+} Timing;
+
+static int failures = 0;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Helper function to record a failed library call; a broken case must not pass as fast
+static void check(ArrayError error) {
+    if (error != ARRAY_SUCCESS) failures++;
+}
+
+// Reference loops compiled with the benchmark, not the library: they track the speed of
+// the machine. Cases streaming large arrays are measured against the memory-bound loop,
+// and cases that stay in cache against a small allocation and loop, since the two kinds
+// of work speed up and slow down independently on a shared machine.
+static void bench_reference(Fixture *f) {
+    const float *a = f->a->data;
+    const float *b = f->b->data;
+    float *out = f->ref_out;
+    for (int i = 0; i < f->a->size; i++) out[i] = a[i] + b[i];
+}
+
+static void bench_reference_cache(Fixture *f) {
+    const float *a = f->small_a->data;
+    const float *b = f->small_b->data;
+    float *out = (float*)malloc(f->small_a->size * sizeof(float));
+    if (!out) {
+        failures++;
+        return;
+    }
+    for (int i = 0; i < f->small_a->size; i++) out[i] = a[i] + b[i];
+    f->ref_out[0] = out[f->small_a->size - 1];
+    free(out);
+}
+
+static void bench_add_contiguous(Fixture *f) {
+    check(add_arrays(&f->out, f->a, f->b));
+}
+
+static void bench_multiply_contiguous(Fixture *f) {
+    check(multiply_arrays(&f->out, f->a, f->b));
+}
+
+static void bench_add_broadcast_row(Fixture *f) {
+    check(add_arrays(&f->out, f->a, f->row));
+}
+
+static void bench_multiply_broadcast_row(Fixture *f) {
+    check(multiply_arrays(&f->out, f->a, f->row));
+}
+
+static void bench_add_broadcast_col(Fixture *f) {
+    check(add_arrays(&f->out, f->a, f->col));
+}
+
+static void bench_multiply_broadcast_col(Fixture *f) {
+    check(multiply_arrays(&f->out, f->a, f->col));
+}
+
+// Small operands measure the fixed cost of a call rather than bandwidth
+static void bench_add_small(Fixture *f) {
+    ArrayType *out = NULL;
+    check(add_arrays(&out, f->small_a, f->small_b));
+    free_array(out);
+}
+
+static void bench_multiply_small(Fixture *f) {
+    ArrayType *out = NULL;
+    check(multiply_arrays(&out, f->small_a, f->small_b));
+    free_array(out);
+}
+
+static void bench_create_small(Fixture *f) {
+    int shape[] = {SMALL_SIDE, SMALL_SIDE};
+    ArrayError error;
+    (void)f;
+    free_array(create_array(shape, 2, &error));
+    check(error);
+}
+
+static void bench_create_large(Fixture *f) {
+    int shape[] = {LARGE_ROWS, LARGE_COLS};
+    ArrayError error;
+    (void)f;
+    free_array(create_array(shape, 2, &error));
+    check(error);
+}
+
+static void bench_empty_large(Fixture *f) {
+    int shape[] = {LARGE_ROWS, LARGE_COLS};
+    ArrayError error;
+    (void)f;
+    free_array(array_empty(shape, 2, &error));
+    check(error);
+}
+
+static void bench_pool_blocks(Fixture *f) {
+    MemoryPoolType *pool = create_memory_pool((size_t)1 << 20);
+    (void)f;
+    if (!pool) {
+        failures++;
+        return;
+    }
+    for (int i = 0; i < 4096; i++) {
+        if (!allocate_from_pool(pool, 256)) failures++;
+    }
+    destroy_memory_pool(pool);
+}
+
+static void bench_pool_arrays(Fixture *f) {
+    int shape[] = {32, 32};
+    ArrayType *arrays[POOL_ARRAYS];
+    ArrayError error;
+    (void)f;
+    MemoryPoolType *pool = create_memory_pool((size_t)POOL_ARRAYS * (32 * 32 * sizeof(float) + 64));
+    if (!pool) {
+        failures++;
+        return;
+    }
+    ArrayAllocator allocator = array_allocator_pool(pool);
+    const ArrayAllocator *previous = array_get_allocator();
+    array_set_allocator(&allocator);
+    for (int i = 0; i < POOL_ARRAYS; i++) {
+        arrays[i] = create_array(shape, 2, &error);
+        check(error);
+    }
+    for (int i = 0; i < POOL_ARRAYS; i++) free_array(arrays[i]);
+    array_set_allocator(previous);
+    destroy_memory_pool(pool);
+}
+
+static void bench_cumsum(Fixture *f) {
+    array_set_deterministic(0);
+    check(cumsum_array(&f->out, f->vector, 0));
+}
+
+static void bench_cumsum_deterministic(Fixture *f) {
+    array_set_deterministic(1);
+    check(cumsum_array(&f->out, f->vector, 0));
+    array_set_deterministic(0);
+}
+
+static void bench_nansum(Fixture *f) {
+    array_set_deterministic(0);
+    check(nansum_array(&f->out, f->vector, 0));
+}
+
+static void bench_nansum_deterministic(Fixture *f) {
+    array_set_deterministic(1);
+    check(nansum_array(&f->out, f->vector, 0));
+    array_set_deterministic(0);
+}
+
+static const BenchCase stream_reference = {"reference", bench_reference, NULL};
+static const BenchCase cache_reference = {"reference_cache", bench_reference_cache, NULL};
+
+static const BenchCase cases[] = {
+    {"add_contiguous", bench_add_contiguous, &stream_reference},
+    {"multiply_contiguous", bench_multiply_contiguous, &stream_reference},
+    {"add_broadcast_row", bench_add_broadcast_row, &stream_reference},
+    {"multiply_broadcast_row", bench_multiply_broadcast_row, &stream_reference},
+    {"add_broadcast_col", bench_add_broadcast_col, &stream_reference},
+    {"multiply_broadcast_col", bench_multiply_broadcast_col, &stream_reference},
+    {"add_small", bench_add_small, &cache_reference},
+    {"multiply_small", bench_multiply_small, &cache_reference},
+    {"create_small", bench_create_small, &cache_reference},
+    {"create_large", bench_create_large, &stream_reference},
+    {"empty_large", bench_empty_large, &cache_reference},
+    {"pool_blocks", bench_pool_blocks, &cache_reference},
+    {"pool_arrays", bench_pool_arrays, &cache_reference},
+    {"cumsum", bench_cumsum, &stream_reference},
+    {"cumsum_deterministic", bench_cumsum_deterministic, &stream_reference},
+    {"nansum", bench_nansum, &stream_reference},
+    {"nansum_deterministic", bench_nansum_deterministic, &stream_reference},
+};
+
+#define NUM_CASES ((int)(sizeof(cases) / sizeof(cases[0])))
+
+static int compare_doubles(const void *x, const void *y) {
+    double a = *(const double*)x, b = *(const double*)y;
+    return (a > b) - (a < b);
+}
+
+// Helper function to compute the median of values, reordering them
+static double median(double *values, int n) {
+    qsort(values, n, sizeof(double), compare_doubles);
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// Helper function to find the number of calls of a case that lasts SAMPLE_SECONDS by
+// doubling it, which also warms caches and the buffer cache
+static long calibrate(const BenchCase *c, Fixture *f) {
+    long iterations = 1;
+    for (;;) {
+        double start = now_seconds();
+        for (long i = 0; i < iterations; i++) c->run(f);
+        if (now_seconds() - start >= SAMPLE_SECONDS || iterations >= (1L << 24)) return iterations;
+        iterations *= 2;
+    }
+}
+
+// Helper function to time one sample, in ns per call
+static double time_sample(const BenchCase *c, Fixture *f, long iterations) {
+    double start = now_seconds();
+    for (long i = 0; i < iterations; i++) c->run(f);
+    return (now_seconds() - start) * 1e9 / (double)iterations;
+}
+
+// Helper function to reduce samples to their median and median absolute deviation
+static void summarize(double *samples, double *mid, double *mad) {
+    *mid = median(samples, SAMPLES);
+    for (int s = 0; s < SAMPLES; s++) samples[s] = fabs(samples[s] - *mid);
+    *mad = median(samples, SAMPLES);
+}
+
+// Function to time one case. Every sample is taken between two samples of its reference
+// loop and divided by their mean, so the ratios carry the noise of both loops while a
+// change in the speed of the machine cancels out.
+static void measure(const BenchCase *c, Fixture *f, Timing *timing) {
+    double samples[SAMPLES], ratios[SAMPLES];
+    long iterations = calibrate(c, f);
+    long ref_iterations = calibrate(c->reference, f);
+    double before = time_sample(c->reference, f, ref_iterations);
+    for (int s = 0; s < SAMPLES; s++) {
+        samples[s] = time_sample(c, f, iterations);
+        double after = time_sample(c->reference, f, ref_iterations);
+        ratios[s] = samples[s] / (0.5 * (before + after));
+        before = after;
+    }
+    snprintf(timing->name, sizeof(timing->name), "%s", c->name);
+    summarize(samples, &timing->median_ns, &timing->mad_ns);
+    summarize(ratios, &timing->ratio, &timing->ratio_mad);
+}
+
+// Function to read a baseline file; lines are "name median_ns mad_ns ratio ratio_mad" and
+// '#' starts a comment
+static int load_baseline(const char *path, Timing *timings, int *count, int *threads) {
+    FILE *file = fopen(path, "r");
+    char line[256];
+    if (!file) return 0;
+    *count = 0;
+    *threads = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') {
+            sscanf(line, "# threads %d", threads);
+            continue;
+        }
+        Timing *t = &timings[*count];
+        if (*count < MAX_CASES && sscanf(line, "%63s %lf %lf %lf %lf", t->name, &t->median_ns, &t->mad_ns,
+                                         &t->ratio, &t->ratio_mad) == 5) {
+            (*count)++;
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+static int save_baseline(const char *path, const Timing *timings, int count, int threads) {
+    FILE *file = fopen(path, "w");
+    if (!file) return 0;
+    fprintf(file, "# Baseline of bench_array: case, median ns per call and median absolute deviation in ns,\n");
+    fprintf(file, "# then the same for the time relative to the case's reference loop\n");
+    fprintf(file, "# Recorded with make perfbaseline; checked with make perfcheck\n");
+    fprintf(file, "# threads %d\n", threads);
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%-24s %14.1f %12.1f %12.5g %12.5g\n", timings[i].name, timings[i].median_ns,
+                timings[i].mad_ns, timings[i].ratio, timings[i].ratio_mad);
+    }
+    return fclose(file) == 0;
+}
+
+static const Timing* find_timing(const Timing *timings, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(timings[i].name, name) == 0) return &timings[i];
+    }
+    return NULL;
+}
+
+// Helper function to compute the standard deviation of the relative change of a case
+// between two runs, from the spread of its reference ratios in both
+static double relative_noise(const Timing *base, const Timing *now) {
+    double x = base->ratio_mad / base->ratio, y = now->ratio_mad / now->ratio;
+    return MAD_TO_SIGMA * sqrt(x * x + y * y);
+}
+
+// Function to tell whether a case regressed: slower relative to its reference loop by more
+// than the tolerance and by more than NOISE_SIGMAS standard deviations of the noise
+static int is_regression(const Timing *base, const Timing *now, double tolerance) {
+    double change = now->ratio / base->ratio - 1.0;
+    return change > tolerance && change > NOISE_SIGMAS * relative_noise(base, now);
+}
+
+static int is_improvement(const Timing *base, const Timing *now, double tolerance) {
+    double change = base->ratio / now->ratio - 1.0;
+    return change > tolerance && change > NOISE_SIGMAS * relative_noise(base, now);
+}
+
+static Fixture* create_fixture(void) {
+    int large[] = {LARGE_ROWS, LARGE_COLS};
+    int row[] = {LARGE_COLS};
+    int col[] = {LARGE_ROWS, 1};
+    int small[] = {SMALL_SIDE, SMALL_SIDE};
+    int vector[] = {SCAN_LENGTH};
+    ArrayError error;
+    Fixture *f = (Fixture*)calloc(1, sizeof(Fixture));
+    if (!f) return NULL;
+    f->a = create_array(large, 2, &error);
+    f->b = create_array(large, 2, &error);
+    f->row = create_array(row, 1, &error);
+    f->col = create_array(col, 2, &error);
+    f->small_a = create_array(small, 2, &error);
+    f->small_b = create_array(small, 2, &error);
+    f->vector = create_array(vector, 1, &error);
+    f->ref_out = (float*)malloc((size_t)LARGE_ROWS * LARGE_COLS * sizeof(float));
+    if (!f->a || !f->b || !f->row || !f->col || !f->small_a || !f->small_b || !f->vector || !f->ref_out) {
+        return f;
+    }
+    for (int i = 0; i < f->a->size; i++) {
+        f->a->data[i] = (float)(i % 97) * 0.25f;
+        f->b->data[i] = (float)(i % 89) * 0.5f + 1.0f;
+    }
+    for (int i = 0; i < LARGE_COLS; i++) f->row->data[i] = (float)(i % 7) + 0.5f;
+    for (int i = 0; i < LARGE_ROWS; i++) f->col->data[i] = (float)(i % 5) + 1.5f;
+    for (int i = 0; i < f->small_a->size; i++) {
+        f->small_a->data[i] = (float)i;
+        f->small_b->data[i] = (float)(i % 3) + 1.0f;
+    }
+    for (int i = 0; i < SCAN_LENGTH; i++) f->vector->data[i] = (float)(i % 13) * 0.125f;
+    return f;
+}
+
+static void free_fixture(Fixture *f) {
+    if (!f) return;
+    free_array(f->a);
+    free_array(f->b);
+    free_array(f->row);
+    free_array(f->col);
+    free_array(f->small_a);
+    free_array(f->small_b);
+    free_array(f->vector);
+    free_array(f->out);
+    free(f->ref_out);
+    free(f);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--record] [--tolerance FRACTION] BASELINE_FILE\n", program);
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    double tolerance = DEFAULT_TOLERANCE;
+    int record = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0) {
+            record = 1;
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path || tolerance < 0.0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+
+    Fixture *f = create_fixture();
+    if (!f || !f->ref_out) {
+        fprintf(stderr, "Failed to allocate the benchmark inputs\n");
+        free_fixture(f);
+        return 2;
+    }
+
+    Timing timings[MAX_CASES];
+    for (int i = 0; i < NUM_CASES; i++) measure(&cases[i], f, &timings[i]);
+    if (failures) {
+        fprintf(stderr, "%d benchmark calls failed\n", failures);
+        free_fixture(f);
+        return 2;
+    }
+
+    if (record) {
+        int saved = save_baseline(path, timings, NUM_CASES, threads);
+        for (int i = 0; i < NUM_CASES; i++) {
+            printf("%-24s %12.1f ns  (+/- %.1f, %.4g x reference)\n", timings[i].name, timings[i].median_ns,
+                   timings[i].mad_ns, timings[i].ratio);
+        }
+        printf(saved ? "Baseline written to %s\n" : "Failed to write %s\n", path);
+        free_fixture(f);
+        return saved ? 0 : 2;
+    }
+
+    Timing baseline[MAX_CASES];
+    int base_count, base_threads;
+    if (!load_baseline(path, baseline, &base_count, &base_threads)) {
+        fprintf(stderr, "Failed to read baseline %s; record one with make perfbaseline\n", path);
+        free_fixture(f);
+        return 2;
+    }
+    if (base_threads && base_threads != threads) {
+        printf("Warning: baseline recorded with %d threads, running with %d\n", base_threads, threads);
+    }
+
+    printf("Current times are scaled by the reference loop timed with each case (tolerance %.0f%%)\n",
+           tolerance * 100.0);
+    printf("%-24s %14s %14s %8s %8s  %s\n", "case", "baseline ns", "current ns", "scale", "ratio", "status");
+
+    int regressions = 0;
+    for (int i = 0; i < NUM_CASES; i++) {
+        const Timing *base = find_timing(baseline, base_count, timings[i].name);
+        const char *status = "ok";
+        if (!base) {
+            status = "new";
+        } else if (is_regression(base, &timings[i], tolerance)) {
+            // Confirm before failing, so that a burst of noise does not fail the check
+            measure(&cases[i], f, &timings[i]);
+            if (is_regression(base, &timings[i], tolerance)) {
+                status = "REGRESSION";
+                regressions++;
+            } else {
+                status = "ok (after rerun)";
+            }
+        } else if (is_improvement(base, &timings[i], tolerance)) {
+            status = "faster";
+        }
+        // The current time converted to the speed of the machine the baseline was recorded on
+        double current = base ? base->median_ns * timings[i].ratio / base->ratio : timings[i].median_ns;
+        double scale = current / timings[i].median_ns;
+        printf("%-24s %14.1f %14.1f %8.3f %8.2f  %s\n", timings[i].name, base ? base->median_ns : 0.0, current,
+               scale, base ? current / base->median_ns : 0.0, status);
+    }
+    free_fixture(f);
+
+    if (regressions) {
+        printf("%d case%s regressed\n", regressions, regressions == 1 ? "" : "s");
+        return 1;
+    }
+    printf("No performance regressions\n");
+    return 0;
+}
@@ -1,341 +1,2320 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include "array.h"
-
-void print_test_result(const char *test_name, int passed, const char *details) {
-    printf("[%s] %s: %s\n", passed ? "PASS" : "FAIL", test_name, details);
-}
-
-void test_create_array() {
-    int shape[] = {2, 3};
-    ArrayError error;
-    ArrayType *arr = create_array(shape, 2, &error);
-    int passed = (arr != NULL && error == ARRAY_SUCCESS);
-    char details[256];
-
-    if (passed) {
-        snprintf(details, sizeof(details), "Array created with shape [%d, %d]", shape[0], shape[1]);
-    } else {
-        snprintf(details, sizeof(details), "Failed to create array");
-    }
-
-    print_test_result("test_create_array", passed, details);
-    free_array(arr);
-}
-
-void test_add_arrays() {
-    int shape_a[] = {2, 1};
-    int shape_b[] = {1, 3};
-    ArrayError error;
-    char details[256];
-
-    ArrayType *a = create_array(shape_a, 2, &error);
-    ArrayType *b = create_array(shape_b, 2, &error);
-    ArrayType *result = NULL;
-    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
-
-    if (!passed) {
-        printf("Error creating arrays for addition: %d\n", error);
-        return;
-    }
-
-    // Initialize arrays
-    for (size_t i = 0; i < a->size; i++) {
-        a->data[i] = (float)i + 1;  // Initialize 'a' with [1, 2]
-    }
-    for (size_t i = 0; i < b->size; i++) {
-        b->data[i] = (float)(i + 1) * 2;  // Initialize 'b' with [2, 4, 6]
-    }
-
-    // Debug prints
-    printf("Array a:\n");
-    for (size_t i = 0; i < a->size; i++) {
-        printf("%f ", a->data[i]);
-    }
-    printf("\n");
-
-    printf("Array b:\n");
-    for (size_t i = 0; i < b->size; i++) {
-        printf("%f ", b->data[i]);
-    }
-    printf("\n");
-
-    // Perform addition
-    error = add_arrays(&result, a, b);
-    passed = (error == ARRAY_SUCCESS);
-
-    printf("Result array:\n");
-    for (size_t i = 0; i < result->size; i++) {
-        printf("%f ", result->data[i]);
-    }
-    printf("\n");
-
-    // Manually broadcast 'b' to match the shape of 'a'
-    ArrayType *b_broadcasted = create_array(shape_a, 2, &error);
-    for (size_t i = 0; i < b_broadcasted->size; i++) {
-        b_broadcasted->data[i] = b->data[i % b->size];
-    }
-
-    // Compare result with expected values and print differences
-    for (size_t i = 0; i < result->size; i++) {
-        float expected = a->data[i] + b_broadcasted->data[i];
-        printf("Index %zu: Expected %f, Got %f\n", i, expected, result->data[i]);
-        passed &= (result->data[i] == expected);
-    }
-
-    free_array(b_broadcasted);
-
-    snprintf(details, sizeof(details), "Addition result array - Size: %zu", result->size);
-    print_test_result("test_add_arrays", passed, details);
-
-    free_array(a);
-    free_array(b);
-    free_array(result);
-}
-
-void test_multiply_arrays() {
-    int shape_a[] = {2, 1};
-    int shape_b[] = {1, 3};
-    ArrayError error;
-    char details[256];
-
-    ArrayType *a = create_array(shape_a, 2, &error);
-    ArrayType *b = create_array(shape_b, 2, &error);
-    ArrayType *result = NULL;
-    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
-
-    if (!passed) {
-        printf("Error creating arrays for multiplication: %d\n", error);
-        return;
-    }
-
-    // Initialize arrays
-    for (size_t i = 0; i < a->size; i++) {
-        a->data[i] = (float)i + 1;  // Initialize 'a' with [1, 2]
-    }
-    for (size_t i = 0; i < b->size; i++) {
-        b->data[i] = (float)(i + 1) * 2;  // Initialize 'b' with [2, 4, 6]
-    }
-
-    // Perform multiplication
-    error = multiply_arrays(&result, a, b);
-    passed = (error == ARRAY_SUCCESS);
-
-    // Manually broadcast 'b' to match the shape of 'a'
-    ArrayType *b_broadcasted = create_array(shape_a, 2, &error);
-    for (size_t i = 0; i < b_broadcasted->size; i++) {
-        b_broadcasted->data[i] = b->data[i % b->size];
-    }
-
-    // Compare result with expected values
-    for (size_t i = 0; i < result->size; i++) {
-        passed &= (result->data[i] == a->data[i] * b_broadcasted->data[i]);
-    }
-
-    free_array(b_broadcasted);
-
-    snprintf(details, sizeof(details), "Multiplication result array - Size: %zu", result->size);
-    print_test_result("test_multiply_arrays", passed, details);
-
-    free_array(a);
-    free_array(b);
-    free_array(result);
-}
-
-void test_broadcast_simple() {
-    int shape_a[] = {2, 1};
-    int shape_b[] = {2, 3};
-    ArrayError error;
-    char details[256];
-
-    ArrayType *a = create_array(shape_a, 2, &error);
-    ArrayType *b = create_array(shape_b, 2, &error);
-    ArrayType *result = NULL;
-    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
-
-    if (!passed) {
-        printf("Error creating arrays for simple broadcast: %d\n", error);
-        return;
-    }
-
-    // Initialize arrays
-    for (size_t i = 0; i < a->size; i++) {
-        a->data[i] = (float)i + 1;  // Initialize 'a' with [1, 2]
-    }
-    for (size_t i = 0; i < b->size; i++) {
-        b->data[i] = (float)(i + 1);  // Initialize 'b' with [1, 2, 3, 4, 5, 6]
-    }
-
-    // Debug prints
-    printf("Array a:\n");
-    for (size_t i = 0; i < a->size; i++) {
-        printf("%f ", a->data[i]);
-    }
-    printf("\n");
-
-    printf("Array b:\n");
-    for (size_t i = 0; i < b->size; i++) {
-        printf("%f ", b->data[i]);
-    }
-    printf("\n");
-
-    // Perform addition
-    error = add_arrays(&result, a, b);
-    passed = (error == ARRAY_SUCCESS);
-
-    printf("Result array:\n");
-    for (size_t i = 0; i < result->size; i++) {
-        printf("%f ", result->data[i]);
-    }
-    printf("\n");
-
-    // Manually broadcast 'a' to match the shape of 'b'
-    ArrayType *a_broadcasted = create_array(shape_b, 2, &error);
-    for (size_t i = 0; i < a_broadcasted->size; i++) {
-        a_broadcasted->data[i] = a->data[i / b->shape[1]];
-    }
-
-    // Compare result with expected values and print differences
-    for (size_t i = 0; i < result->size; i++) {
-        float expected = a_broadcasted->data[i] + b->data[i];
-        printf("Index %zu: Expected %f, Got %f\n", i, expected, result->data[i]);
-        passed &= (result->data[i] == expected);
-    }
-
-    free_array(a_broadcasted);
-
-    snprintf(details, sizeof(details), "Simple broadcast result array - Size: %zu", result->size);
-    print_test_result("test_broadcast_simple", passed, details);
-
-    free_array(a);
-    free_array(b);
-    free_array(result);
-}
-
-void test_broadcast_different_dimensions() {
-    int shape_a[] = {2, 1, 3};
-    int shape_b[] = {1, 3};
-    ArrayError error;
-    char details[256];
-
-    ArrayType *a = create_array(shape_a, 3, &error);
-    ArrayType *b = create_array(shape_b, 2, &error);
-    ArrayType *result = NULL;
-    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
-
-    if (!passed) {
-        printf("Error creating arrays for different dimensions broadcast: %d\n", error);
-        return;
-    }
-
-    // Initialize arrays
-    for (size_t i = 0; i < a->size; i++) {
-        a->data[i] = (float)(i + 1);  // Initialize 'a' with increasing values
-    }
-    for (size_t i = 0; i < b->size; i++) {
-        b->data[i] = (float)(i + 1);  // Initialize 'b' with [1, 2, 3]
-    }
-
-    // Debug prints
-    printf("Array a:\n");
-    for (size_t i = 0; i < a->size; i++) {
-        printf("%f ", a->data[i]);
-    }
-    printf("\n");
-
-    printf("Array b:\n");
-    for (size_t i = 0; i < b->size; i++) {
-        printf("%f ", b->data[i]);
-    }
-    printf("\n");
-
-    // Perform addition
-    error = add_arrays(&result, a, b);
-    passed = (error == ARRAY_SUCCESS);
-
-    printf("Result array:\n");
-    for (size_t i = 0; i < result->size; i++) {
-        printf("%f ", result->data[i]);
-    }
-    printf("\n");
-
-    // Manually broadcast 'b' to match the shape of 'a'
-    ArrayType *b_broadcasted = create_array(shape_a, 3, &error);
-    for (size_t i = 0; i < b_broadcasted->size; i++) {
-        b_broadcasted->data[i] = b->data[i % b->size];
-    }
-
-    // Compare result with expected values and print differences
-    for (size_t i = 0; i < result->size; i++) {
-        float expected = a->data[i] + b_broadcasted->data[i];
-        printf("Index %zu: Expected %f, Got %f\n", i, expected, result->data[i]);
-        passed &= (result->data[i] == expected);
-    }
-
-    free_array(b_broadcasted);
-
-    snprintf(details, sizeof(details), "Different dimensions broadcast result array - Size: %zu", result->size);
-    print_test_result("test_broadcast_different_dimensions", passed, details);
-
-    free_array(a);
-    free_array(b);
-    free_array(result);
-}
-
-void test_broadcast_scalar() {
-    int shape_a[] = {};
-    int shape_b[] = {2, 3};
-    ArrayError error;
-    char details[256];
-
-    ArrayType *a = create_array(shape_a, 0, &error);
-    ArrayType *b = create_array(shape_b, 2, &error);
-    ArrayType *result = NULL;
-    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
-
-    if (!passed) {
-        printf("Error creating arrays for scalar broadcast: %d\n", error);
-        return;
-    }
-
-    // Initialize arrays
-    a->data[0] = 2.0;  // Initialize 'a' as scalar [2]
-    for (size_t i = 0; i < b->size; i++) {
-        b->data[i] = (float)(i + 1);  // Initialize 'b' with [1, 2, 3, 4, 5, 6]
-    }
-
-    // Perform multiplication
-    error = multiply_arrays(&result, a, b);
-    passed = (error == ARRAY_SUCCESS);
-
-    // Manually broadcast 'a' to match the shape of 'b'
-    ArrayType *a_broadcasted = create_array(shape_b, 2, &error);
-    for (size_t i = 0; i < a_broadcasted->size; i++) {
-        a_broadcasted->data[i] = a->data[0];
-    }
-
-    // Compare result with expected values
-    for (size_t i = 0; i < result->size; i++) {
-        passed &= (result->data[i] == a_broadcasted->data[i] * b->data[i]);
-    }
-
-    free_array(a_broadcasted);
-
-    snprintf(details, sizeof(details), "Scalar broadcast result array - Size: %zu", result->size);
-    print_test_result("test_broadcast_scalar", passed, details);
-
-    free_array(a);
-    free_array(b);
-    free_array(result);
-}
-
-// Main function to run all tests
-int main() {
-    test_create_array();
-    test_add_arrays();
-    test_multiply_arrays();
-    test_broadcast_simple();
-    test_broadcast_different_dimensions();
-    test_broadcast_scalar();
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "array.h"
+#include "vmath.h"
+#include "scan.h"
+#include "sort.h"
+#include "indexing.h"
+#include "histogram.h"
+#include "gemm.h"
+#include "convolve.h"
+#include "creation.h"
+#include "einsum.h"
+#include "fft.h"
+#include "interop.h"
+#include "linalg.h"
+#include "masked.h"
+#include "memory.h"
+#include "pipeline.h"
+#include "quantize.h"
+#include "random.h"
+#include "shm.h"
+#include "stencil.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+void print_test_result(const char *test_name, int passed, const char *details) {
+    printf("[%s] %s: %s\n", passed ? "PASS" : "FAIL", test_name, details);
+}
+
+void test_create_array() {
+    int shape[] = {2, 3};
+    ArrayError error;
+    ArrayType *arr = create_array(shape, 2, &error);
+    int passed = (arr != NULL && error == ARRAY_SUCCESS);
+    char details[256];
+
+    if (passed) {
+        snprintf(details, sizeof(details), "Array created with shape [%d, %d]", shape[0], shape[1]);
+    } else {
+        snprintf(details, sizeof(details), "Failed to create array");
+    }
+
+    print_test_result("test_create_array", passed, details);
+    free_array(arr);
+}
+
+void test_add_arrays() {
+    int shape_a[] = {2, 1};
+    int shape_b[] = {1, 3};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape_a, 2, &error);
+    ArrayType *b = create_array(shape_b, 2, &error);
+    ArrayType *result = NULL;
+    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for addition: %d\n", error);
+        return;
+    }
+
+    // Initialize arrays
+    for (size_t i = 0; i < a->size; i++) {
+        a->data[i] = (float)i + 1;  // Initialize 'a' with [1, 2]
+    }
+    for (size_t i = 0; i < b->size; i++) {
+        b->data[i] = (float)(i + 1) * 2;  // Initialize 'b' with [2, 4, 6]
+    }
+
+    // Debug prints
+    printf("Array a:\n");
+    for (size_t i = 0; i < a->size; i++) {
+        printf("%f ", a->data[i]);
+    }
+    printf("\n");
+
+    printf("Array b:\n");
+    for (size_t i = 0; i < b->size; i++) {
+        printf("%f ", b->data[i]);
+    }
+    printf("\n");
+
+    // Perform addition
+    error = add_arrays(&result, a, b);
+    passed = (error == ARRAY_SUCCESS);
+
+    printf("Result array:\n");
+    for (size_t i = 0; i < result->size; i++) {
+        printf("%f ", result->data[i]);
+    }
+    printf("\n");
+
+    // [[1], [2]] + [[2, 4, 6]] broadcasts to shape [2, 3] (values from NumPy)
+    float expected_values[] = {3, 5, 7, 4, 6, 8};
+    passed &= (result->ndim == 2 && result->shape[0] == 2 && result->shape[1] == 3);
+
+    // Compare result with expected values and print differences
+    for (size_t i = 0; passed && i < result->size; i++) {
+        float expected = expected_values[i];
+        printf("Index %zu: Expected %f, Got %f\n", i, expected, result->data[i]);
+        passed &= (result->data[i] == expected);
+    }
+
+    snprintf(details, sizeof(details), "Addition result array - Size: %zu", result->size);
+    print_test_result("test_add_arrays", passed, details);
+
+    free_array(a);
+    free_array(b);
+    free_array(result);
+}
+
+void test_multiply_arrays() {
+    int shape_a[] = {2, 1};
+    int shape_b[] = {1, 3};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape_a, 2, &error);
+    ArrayType *b = create_array(shape_b, 2, &error);
+    ArrayType *result = NULL;
+    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for multiplication: %d\n", error);
+        return;
+    }
+
+    // Initialize arrays
+    for (size_t i = 0; i < a->size; i++) {
+        a->data[i] = (float)i + 1;  // Initialize 'a' with [1, 2]
+    }
+    for (size_t i = 0; i < b->size; i++) {
+        b->data[i] = (float)(i + 1) * 2;  // Initialize 'b' with [2, 4, 6]
+    }
+
+    // Perform multiplication
+    error = multiply_arrays(&result, a, b);
+    passed = (error == ARRAY_SUCCESS);
+
+    // [[1], [2]] * [[2, 4, 6]] broadcasts to shape [2, 3] (values from NumPy)
+    float expected_values[] = {2, 4, 6, 4, 8, 12};
+    passed &= (result->ndim == 2 && result->shape[0] == 2 && result->shape[1] == 3);
+
+    // Compare result with expected values
+    for (size_t i = 0; passed && i < result->size; i++) {
+        passed &= (result->data[i] == expected_values[i]);
+    }
+
+    snprintf(details, sizeof(details), "Multiplication result array - Size: %zu", result->size);
+    print_test_result("test_multiply_arrays", passed, details);
+
+    free_array(a);
+    free_array(b);
+    free_array(result);
+}
+
+void test_broadcast_simple() {
+    int shape_a[] = {2, 1};
+    int shape_b[] = {2, 3};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape_a, 2, &error);
+    ArrayType *b = create_array(shape_b, 2, &error);
+    ArrayType *result = NULL;
+    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for simple broadcast: %d\n", error);
+        return;
+    }
+
+    // Initialize arrays
+    for (size_t i = 0; i < a->size; i++) {
+        a->data[i] = (float)i + 1;  // Initialize 'a' with [1, 2]
+    }
+    for (size_t i = 0; i < b->size; i++) {
+        b->data[i] = (float)(i + 1);  // Initialize 'b' with [1, 2, 3, 4, 5, 6]
+    }
+
+    // Debug prints
+    printf("Array a:\n");
+    for (size_t i = 0; i < a->size; i++) {
+        printf("%f ", a->data[i]);
+    }
+    printf("\n");
+
+    printf("Array b:\n");
+    for (size_t i = 0; i < b->size; i++) {
+        printf("%f ", b->data[i]);
+    }
+    printf("\n");
+
+    // Perform addition
+    error = add_arrays(&result, a, b);
+    passed = (error == ARRAY_SUCCESS);
+
+    printf("Result array:\n");
+    for (size_t i = 0; i < result->size; i++) {
+        printf("%f ", result->data[i]);
+    }
+    printf("\n");
+
+    // Manually broadcast 'a' to match the shape of 'b'
+    ArrayType *a_broadcasted = create_array(shape_b, 2, &error);
+    for (size_t i = 0; i < a_broadcasted->size; i++) {
+        a_broadcasted->data[i] = a->data[i / b->shape[1]];
+    }
+
+    // Compare result with expected values and print differences
+    for (size_t i = 0; i < result->size; i++) {
+        float expected = a_broadcasted->data[i] + b->data[i];
+        printf("Index %zu: Expected %f, Got %f\n", i, expected, result->data[i]);
+        passed &= (result->data[i] == expected);
+    }
+
+    free_array(a_broadcasted);
+
+    snprintf(details, sizeof(details), "Simple broadcast result array - Size: %zu", result->size);
+    print_test_result("test_broadcast_simple", passed, details);
+
+    free_array(a);
+    free_array(b);
+    free_array(result);
+}
+
+void test_broadcast_different_dimensions() {
+    int shape_a[] = {2, 1, 3};
+    int shape_b[] = {1, 3};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape_a, 3, &error);
+    ArrayType *b = create_array(shape_b, 2, &error);
+    ArrayType *result = NULL;
+    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for different dimensions broadcast: %d\n", error);
+        return;
+    }
+
+    // Initialize arrays
+    for (size_t i = 0; i < a->size; i++) {
+        a->data[i] = (float)(i + 1);  // Initialize 'a' with increasing values
+    }
+    for (size_t i = 0; i < b->size; i++) {
+        b->data[i] = (float)(i + 1);  // Initialize 'b' with [1, 2, 3]
+    }
+
+    // Debug prints
+    printf("Array a:\n");
+    for (size_t i = 0; i < a->size; i++) {
+        printf("%f ", a->data[i]);
+    }
+    printf("\n");
+
+    printf("Array b:\n");
+    for (size_t i = 0; i < b->size; i++) {
+        printf("%f ", b->data[i]);
+    }
+    printf("\n");
+
+    // Perform addition
+    error = add_arrays(&result, a, b);
+    passed = (error == ARRAY_SUCCESS);
+
+    printf("Result array:\n");
+    for (size_t i = 0; i < result->size; i++) {
+        printf("%f ", result->data[i]);
+    }
+    printf("\n");
+
+    // Manually broadcast 'b' to match the shape of 'a'
+    ArrayType *b_broadcasted = create_array(shape_a, 3, &error);
+    for (size_t i = 0; i < b_broadcasted->size; i++) {
+        b_broadcasted->data[i] = b->data[i % b->size];
+    }
+
+    // Compare result with expected values and print differences
+    for (size_t i = 0; i < result->size; i++) {
+        float expected = a->data[i] + b_broadcasted->data[i];
+        printf("Index %zu: Expected %f, Got %f\n", i, expected, result->data[i]);
+        passed &= (result->data[i] == expected);
+    }
+
+    free_array(b_broadcasted);
+
+    snprintf(details, sizeof(details), "Different dimensions broadcast result array - Size: %zu", result->size);
+    print_test_result("test_broadcast_different_dimensions", passed, details);
+
+    free_array(a);
+    free_array(b);
+    free_array(result);
+}
+
+void test_broadcast_scalar() {
+    int shape_a[] = {};
+    int shape_b[] = {2, 3};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape_a, 0, &error);
+    ArrayType *b = create_array(shape_b, 2, &error);
+    ArrayType *result = NULL;
+    int passed = a != NULL && b != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for scalar broadcast: %d\n", error);
+        return;
+    }
+
+    // Initialize arrays
+    a->data[0] = 2.0;  // Initialize 'a' as scalar [2]
+    for (size_t i = 0; i < b->size; i++) {
+        b->data[i] = (float)(i + 1);  // Initialize 'b' with [1, 2, 3, 4, 5, 6]
+    }
+
+    // Perform multiplication
+    error = multiply_arrays(&result, a, b);
+    passed = (error == ARRAY_SUCCESS);
+
+    // Manually broadcast 'a' to match the shape of 'b'
+    ArrayType *a_broadcasted = create_array(shape_b, 2, &error);
+    for (size_t i = 0; i < a_broadcasted->size; i++) {
+        a_broadcasted->data[i] = a->data[0];
+    }
+
+    // Compare result with expected values
+    for (size_t i = 0; i < result->size; i++) {
+        passed &= (result->data[i] == a_broadcasted->data[i] * b->data[i]);
+    }
+
+    free_array(a_broadcasted);
+
+    snprintf(details, sizeof(details), "Scalar broadcast result array - Size: %zu", result->size);
+    print_test_result("test_broadcast_scalar", passed, details);
+
+    free_array(a);
+    free_array(b);
+    free_array(result);
+}
+
+// Helper to measure the distance between two floats in units in the last place
+static int64_t ulp_distance(float x, float y) {
+    int32_t ix, iy;
+    memcpy(&ix, &x, sizeof(ix));
+    memcpy(&iy, &y, sizeof(iy));
+    int64_t ox = ix < 0 ? (int64_t)INT32_MIN - ix : ix;
+    int64_t oy = iy < 0 ? (int64_t)INT32_MIN - iy : iy;
+    return ox > oy ? ox - oy : oy - ox;
+}
+
+static double sigmoid_reference(double x) {
+    return 1.0 / (1.0 + exp(-x));
+}
+
+void test_vmath_functions() {
+    typedef ArrayError (*VMathFunction)(ArrayType **, const ArrayType *);
+    struct {
+        const char *name;
+        VMathFunction function;
+        double (*reference)(double);
+        float lo, hi;
+        int64_t max_ulp;
+    } cases[] = {
+        {"exp", exp_array, exp, -100.0f, 88.0f, 1},
+        {"log", log_array, log, 1e-30f, 1e30f, 1},
+        {"sin", sin_array, sin, -100.0f, 100.0f, 2},
+        {"cos", cos_array, cos, -100.0f, 100.0f, 2},
+        {"tanh", tanh_array, tanh, -10.0f, 10.0f, 2},
+        {"sigmoid", sigmoid_array, sigmoid_reference, -90.0f, 30.0f, 3},
+        {"erf", erf_array, erf, -5.0f, 5.0f, 2},
+        {"sqrt", sqrt_array, sqrt, 0.0f, 1e6f, 0},
+    };
+    int shape[] = {100003};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape, 1, &error);
+    ArrayType *result = NULL;
+    int passed = (a != NULL && error == ARRAY_SUCCESS);
+    int64_t worst = 0;
+    const char *worst_name = "none";
+
+    for (size_t c = 0; passed && c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (size_t i = 0; i < a->size; i++) {
+            double t = (double)i / (double)(a->size - 1);
+            a->data[i] = (c == 1) ? (float)(cases[c].lo * pow(cases[c].hi / cases[c].lo, t))
+                                  : (float)(cases[c].lo + (cases[c].hi - cases[c].lo) * t);
+        }
+        passed &= (cases[c].function(&result, a) == ARRAY_SUCCESS);
+        for (size_t i = 0; passed && i < a->size; i++) {
+            int64_t d = ulp_distance(result->data[i], (float)cases[c].reference(a->data[i]));
+            if (d > worst) {
+                worst = d;
+                worst_name = cases[c].name;
+            }
+            passed &= (d <= cases[c].max_ulp);
+        }
+    }
+
+    // Special values and the strict fallback
+    a->data[0] = -1.0f;
+    a->data[1] = 0.0f;
+    a->data[2] = 1e20f;
+    passed &= (log_array(&result, a) == ARRAY_SUCCESS);
+    passed &= isnan(result->data[0]) && isinf(result->data[1]) && result->data[1] < 0;
+    passed &= (sin_array(&result, a) == ARRAY_SUCCESS && result->data[2] == sinf(1e20f));
+
+    vmath_set_accuracy(VMATH_ACCURACY_STRICT);
+    passed &= (exp_array(&result, a) == ARRAY_SUCCESS && result->data[0] == (float)exp(-1.0));
+    vmath_set_accuracy(VMATH_ACCURACY_FAST);
+
+    // Arguments next to zeros of sin (3*pi, 12*pi) and cos (3*pi/2), where range reduction cancels
+    const float zeros[] = {9.42477798f, 37.6991119f, 4.71238899f, -4.71238899f};
+    for (size_t z = 0; passed && z < sizeof(zeros) / sizeof(zeros[0]); z++) {
+        int cosine = z >= 2;
+        for (int i = 0; i < 9; i++) a->data[i] = nextafterf(zeros[z], (i & 1) ? INFINITY : -INFINITY) + (i / 2) * 1e-6f;
+        passed &= ((cosine ? cos_array : sin_array)(&result, a) == ARRAY_SUCCESS);
+        for (int i = 0; passed && i < 9; i++) {
+            double reference = cosine ? cos(a->data[i]) : sin(a->data[i]);
+            passed &= (ulp_distance(result->data[i], (float)reference) <= 2);
+        }
+    }
+
+    // erf around the switch from the series to the erfc fit, and its former worst case near 0.5
+    const float erf_points[] = {0x1.044dbcp-1f, -0x1.044dbcp-1f, 0x1.fffffep-1f, 1.0f, 0x1.0130a2p+0f, 0x1.e607e4p-1f};
+    for (int i = 0; i < 6; i++) a->data[i] = erf_points[i];
+    passed &= (erf_array(&result, a) == ARRAY_SUCCESS);
+    for (int i = 0; passed && i < 6; i++) passed &= (ulp_distance(result->data[i], (float)erf(a->data[i])) <= 2);
+
+    // Views are rejected rather than read as contiguous data
+    int wide_shape[] = {2, 100003};
+    ArrayType *wide = NULL;
+    passed &= (array_broadcast_to(&wide, a, wide_shape, 2) == ARRAY_SUCCESS);
+    passed &= (exp_array(&result, wide) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (clip_array(&result, wide, 0.0f, 1.0f) == ARRAY_ERROR_INVALID_ARGUMENT);
+    free_array(wide);
+
+    snprintf(details, sizeof(details), "Worst error %lld ULP (%s)", (long long)worst, worst_name);
+    print_test_result("test_vmath_functions", passed, details);
+
+    free_array(a);
+    free_array(result);
+}
+
+void test_ternary_operations() {
+    int shape_a[] = {2, 1, 3};
+    int shape_b[] = {4, 1};
+    int shape_c[] = {3};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape_a, 3, &error);
+    ArrayType *b = create_array(shape_b, 2, &error);
+    ArrayType *c = create_array(shape_c, 1, &error);
+    ArrayType *result = NULL;
+    int passed = a != NULL && b != NULL && c != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for ternary operations: %d\n", error);
+        return;
+    }
+
+    for (size_t i = 0; i < a->size; i++) a->data[i] = 0.1f * (float)(i + 1);
+    for (size_t i = 0; i < b->size; i++) b->data[i] = (float)i - 1.5f;
+    for (size_t i = 0; i < c->size; i++) c->data[i] = (float)(i % 2);
+
+    // fma: result has shape [2, 4, 3], computed with a single rounding
+    error = fma_arrays(&result, a, b, c);
+    passed &= (error == ARRAY_SUCCESS && result->ndim == 3 && result->size == 24);
+    for (int i = 0; passed && i < 2; i++) {
+        for (int j = 0; j < 4; j++) {
+            for (int k = 0; k < 3; k++) {
+                float expected = (float)((double)a->data[i * 3 + k] * b->data[j] + c->data[k]);
+                passed &= (result->data[(i * 4 + j) * 3 + k] == expected);
+            }
+        }
+    }
+
+    // axpy: 2 * b + c with shape [4, 3]
+    error = axpy_arrays(&result, 2.0f, b, c);
+    passed &= (error == ARRAY_SUCCESS && result->ndim == 2 && result->size == 12);
+    for (int j = 0; passed && j < 4; j++) {
+        for (int k = 0; k < 3; k++) {
+            passed &= (result->data[j * 3 + k] == 2.0f * b->data[j] + c->data[k]);
+        }
+    }
+
+    // where: pick a where c is non-zero, b otherwise
+    error = where_arrays(&result, c, a, b);
+    passed &= (error == ARRAY_SUCCESS && result->size == 24);
+    for (int i = 0; passed && i < 2; i++) {
+        for (int j = 0; j < 4; j++) {
+            for (int k = 0; k < 3; k++) {
+                float expected = c->data[k] != 0.0f ? a->data[i * 3 + k] : b->data[j];
+                passed &= (result->data[(i * 4 + j) * 3 + k] == expected);
+            }
+        }
+    }
+
+    // clip and incompatible shapes
+    error = clip_array(&result, b, -1.0f, 0.0f);
+    passed &= (error == ARRAY_SUCCESS && result->data[0] == -1.0f && result->data[1] == -0.5f &&
+               result->data[3] == 0.0f);
+    ArrayType *mismatched = create_array(shape_b, 1, &error);
+    passed &= (fma_arrays(&result, a, mismatched, c) == ARRAY_ERROR_INVALID_DIMENSION);
+
+    snprintf(details, sizeof(details), "fma/axpy/where/clip over broadcast shapes");
+    print_test_result("test_ternary_operations", passed, details);
+
+    free_array(mismatched);
+    free_array(a);
+    free_array(b);
+    free_array(c);
+    free_array(result);
+}
+
+void test_cumulative_operations() {
+    int shape[] = {3, 4, 2};
+    int long_shape[] = {100000};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape, 3, &error);
+    ArrayType *series = create_array(long_shape, 1, &error);
+    ArrayType *result = NULL;
+    int passed = a != NULL && series != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for cumulative operations: %d\n", error);
+        return;
+    }
+
+    for (size_t i = 0; i < a->size; i++) a->data[i] = (float)(i % 5) - 1.0f;
+    for (size_t i = 0; i < series->size; i++) series->data[i] = (float)(i % 7);
+
+    // Scan along every axis and compare with a straightforward strided loop
+    for (int axis = -1; passed && axis < 3; axis++) {
+        int ax = axis < 0 ? axis + 3 : axis;
+        size_t stride = 1;
+        for (int d = ax + 1; d < 3; d++) stride *= shape[d];
+
+        for (int op = 0; op < 2 && passed; op++) {
+            error = op == 0 ? cumsum_array(&result, a, axis) : cumprod_array(&result, a, axis);
+            passed &= (error == ARRAY_SUCCESS && result->size == a->size);
+            for (size_t i = 0; passed && i < a->size; i++) {
+                size_t k = (i / stride) % shape[ax];
+                float expected = a->data[i];
+                if (k > 0) {
+                    float prev = result->data[i - stride];
+                    expected = op == 0 ? prev + a->data[i] : prev * a->data[i];
+                }
+                passed &= (result->data[i] == expected);
+            }
+        }
+    }
+
+    // Long series exercises the chunked prefix scan; partial sums are exact integers
+    error = cumsum_array(&result, series, 0);
+    passed &= (error == ARRAY_SUCCESS);
+    double running = 0.0;
+    for (size_t i = 0; passed && i < series->size; i++) {
+        running += series->data[i];
+        passed &= (result->data[i] == (float)running);
+    }
+
+    passed &= (cumsum_array(&result, a, 3) == ARRAY_ERROR_INVALID_DIMENSION);
+
+    // Quantized inputs are rejected
+    ArrayType *bytes = create_array_dtype(shape, 3, ARRAY_DTYPE_INT8, &error);
+    passed &= (cumsum_array(&result, bytes, 2) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (cumprod_array(&result, bytes, 0) == ARRAY_ERROR_INVALID_DTYPE);
+    free_array(bytes);
+
+    // Views are rejected rather than read as contiguous data
+    int wide_shape[] = {5, 3, 4, 2};
+    ArrayType *wide = NULL;
+    passed &= (array_broadcast_to(&wide, a, wide_shape, 4) == ARRAY_SUCCESS);
+    passed &= (cumsum_array(&result, wide, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+    free_array(wide);
+
+    snprintf(details, sizeof(details), "cumsum/cumprod along all axes, last sum %.0f", running);
+    print_test_result("test_cumulative_operations", passed, details);
+
+    free_array(a);
+    free_array(series);
+    free_array(result);
+}
+
+// Helper to check that a row is in ascending order with NaNs last
+static int is_sorted_row(const float *row, size_t n, size_t stride) {
+    for (size_t k = 1; k < n; k++) {
+        float prev = row[(k - 1) * stride], cur = row[k * stride];
+        if (isnan(prev) && !isnan(cur)) return 0;
+        if (!isnan(cur) && prev > cur) return 0;
+    }
+    return 1;
+}
+
+void test_sort_operations() {
+    int shape[] = {3, 40, 5};
+    int long_shape[] = {200000};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape, 3, &error);
+    ArrayType *series = create_array(long_shape, 1, &error);
+    ArrayType *result = NULL;
+    ArrayType *values = NULL;
+    int *indices = NULL;
+    int passed = a != NULL && series != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for sorting: %d\n", error);
+        return;
+    }
+
+    srand(42);
+    for (size_t i = 0; i < a->size; i++) a->data[i] = (float)(rand() % 21) - 10.0f;
+    a->data[7] = NAN;
+    for (size_t i = 0; i < series->size; i++) series->data[i] = (float)rand() / RAND_MAX - 0.5f;
+
+    // Sort and argsort along the middle axis: rows of 40 strided elements
+    error = sort_array(&result, a, 1);
+    passed &= (error == ARRAY_SUCCESS);
+    error = argsort_array(&indices, a, 1);
+    passed &= (error == ARRAY_SUCCESS);
+    for (int o = 0; passed && o < 3; o++) {
+        for (int i = 0; i < 5; i++) {
+            size_t base = (size_t)o * 40 * 5 + i;
+            passed &= is_sorted_row(result->data + base, 40, 5);
+            for (int k = 0; k < 40; k++) {
+                float gathered = a->data[base + (size_t)indices[base + k * 5] * 5];
+                float sorted = result->data[base + k * 5];
+                passed &= (gathered == sorted || (isnan(gathered) && isnan(sorted)));
+                // Stable: equal values keep their original order
+                if (k > 0 && gathered == a->data[base + (size_t)indices[base + (k - 1) * 5] * 5]) {
+                    passed &= (indices[base + k * 5] > indices[base + (k - 1) * 5]);
+                }
+            }
+        }
+    }
+
+    // Partition along the last axis of short rows
+    error = partition_array(&result, a, 2, -1);
+    passed &= (error == ARRAY_SUCCESS);
+    for (size_t row = 0; passed && row < a->size / 5; row++) {
+        const float *r = result->data + row * 5;
+        for (int k = 0; k < 5; k++) {
+            if (k < 2) passed &= !(r[k] > r[2]);
+            if (k > 2) passed &= !(r[k] < r[2]) || isnan(r[k]);
+        }
+    }
+
+    // Long 1-D array: radix sort and the parallel merge
+    error = sort_array(&result, series, 0);
+    passed &= (error == ARRAY_SUCCESS && is_sorted_row(result->data, series->size, 1));
+
+    // Top-k on the long array matches the tail of the full sort
+    error = topk_array(&values, &indices, series, 10, 0);
+    passed &= (error == ARRAY_SUCCESS && values->size == 10);
+    for (int j = 0; passed && j < 10; j++) {
+        passed &= (values->data[j] == result->data[series->size - 1 - j]);
+        passed &= (series->data[indices[j]] == values->data[j]);
+    }
+
+    // Top-k ties prefer the lower index
+    error = topk_array(&values, &indices, a, 3, 1);
+    passed &= (error == ARRAY_SUCCESS && values->shape[1] == 3);
+    for (size_t r = 0; passed && r < 15; r++) {
+        size_t base = (r / 5) * 3 * 5 + r % 5;
+        for (int j = 1; j < 3; j++) {
+            if (values->data[base + j * 5] == values->data[base + (j - 1) * 5]) {
+                passed &= (indices[base + j * 5] > indices[base + (j - 1) * 5]);
+            }
+        }
+    }
+    passed &= (topk_array(&values, &indices, a, 41, 1) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (topk_array(&series, NULL, series, 10, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    // Quantized inputs are rejected
+    ArrayType *bytes = create_array_dtype(shape, 3, ARRAY_DTYPE_INT8, &error);
+    passed &= (sort_array(&result, bytes, 1) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (topk_array(&values, &indices, bytes, 3, 1) == ARRAY_ERROR_INVALID_DTYPE);
+    free_array(bytes);
+
+    // Views are rejected rather than read as contiguous data
+    int wide_shape[] = {2, 3, 40, 5};
+    ArrayType *wide = NULL;
+    passed &= (array_broadcast_to(&wide, a, wide_shape, 4) == ARRAY_SUCCESS);
+    passed &= (sort_array(&result, wide, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (argsort_array(&indices, wide, 3) == ARRAY_ERROR_INVALID_ARGUMENT);
+    free_array(wide);
+
+    snprintf(details, sizeof(details), "sort/argsort/partition/topk, %zu-element 1-D sort", series->size);
+    print_test_result("test_sort_operations", passed, details);
+
+    free(indices);
+    free_array(a);
+    free_array(series);
+    free_array(result);
+    free_array(values);
+}
+
+void test_indexing_operations() {
+    int table_shape[] = {50, 8};
+    int small_shape[] = {6};
+    int indices[] = {3, -1, 0, 3, 49, 3};
+    size_t n_indices = sizeof(indices) / sizeof(indices[0]);
+    ArrayError error;
+    char details[256];
+
+    ArrayType *table = create_array(table_shape, 2, &error);
+    ArrayType *small = create_array(small_shape, 1, &error);
+    ArrayType *result = NULL;
+    ArrayType *values = NULL;
+    int passed = table != NULL && small != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for indexing: %d\n", error);
+        return;
+    }
+
+    for (size_t i = 0; i < table->size; i++) table->data[i] = (float)i;
+    for (size_t i = 0; i < small->size; i++) small->data[i] = (float)(i % 2);
+
+    // Row gather along axis 0, like an embedding lookup
+    error = take_array(&result, table, indices, n_indices, 0);
+    passed &= (error == ARRAY_SUCCESS && result->shape[0] == 6 && result->shape[1] == 8);
+    for (size_t j = 0; passed && j < n_indices; j++) {
+        int row = indices[j] < 0 ? indices[j] + 50 : indices[j];
+        for (int c = 0; c < 8; c++) passed &= (result->data[j * 8 + c] == table->data[row * 8 + c]);
+    }
+
+    // Column gather along axis 1
+    int cols[] = {7, 0};
+    error = take_array(&values, table, cols, 2, 1);
+    passed &= (error == ARRAY_SUCCESS && values->shape[0] == 50 && values->shape[1] == 2);
+    passed &= (values->data[2] == table->data[15] && values->data[3] == table->data[8]);
+
+    // Scatter-add accumulates the repeated row 3 three times
+    float before = table->data[3 * 8 + 1];
+    error = scatter_add_array(table, indices, n_indices, result, 0);
+    passed &= (error == ARRAY_SUCCESS && table->data[3 * 8 + 1] == 4.0f * before);
+
+    // Put writes back and compress keeps the masked elements in order
+    error = put_array(table, cols, 2, values, 1);
+    passed &= (error == ARRAY_SUCCESS);
+    error = compress_array(&result, small, small);
+    passed &= (error == ARRAY_SUCCESS && result->size == 3 && result->data[2] == 1.0f);
+
+    // Out-of-range indices are rejected before anything is written
+    int bad[] = {0, 50};
+    passed &= (take_array(&result, table, bad, 2, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (scatter_add_array(table, indices, n_indices, small, 0) == ARRAY_ERROR_INVALID_DIMENSION);
+
+    // Results and values may not be the indexed array
+    passed &= (take_array(&table, table, indices, n_indices, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (compress_array(&small, small, small) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (put_array(table, indices, 1, table, 1) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    // Quantized inputs are rejected
+    ArrayType *bytes = create_array_dtype(table_shape, 2, ARRAY_DTYPE_UINT8, &error);
+    passed &= (take_array(&result, bytes, indices, n_indices, 0) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (compress_array(&result, table, bytes) == ARRAY_ERROR_INVALID_DTYPE);
+    free_array(bytes);
+
+    // Views are rejected rather than read as contiguous data
+    int wide_shape[] = {4, 6};
+    ArrayType *wide = NULL;
+    passed &= (array_broadcast_to(&wide, small, wide_shape, 2) == ARRAY_SUCCESS);
+    passed &= (take_array(&result, wide, indices, 1, 1) == ARRAY_ERROR_INVALID_ARGUMENT);
+    free_array(wide);
+
+    snprintf(details, sizeof(details), "take/put/scatter_add/compress with %zu indices", n_indices);
+    print_test_result("test_indexing_operations", passed, details);
+
+    free_array(table);
+    free_array(small);
+    free_array(result);
+    free_array(values);
+}
+
+void test_histogram_operations() {
+    int shape[] = {100000};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape, 1, &error);
+    ArrayType *values = NULL;
+    size_t *counts = NULL;
+    size_t nbins = 0;
+    int passed = a != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for histograms: %d\n", error);
+        return;
+    }
+
+    // Values 0..9 where value v occurs (v + 1) times per 55 elements
+    size_t expected[10] = {0};
+    for (size_t i = 0; i < a->size; i++) {
+        size_t r = i % 55, v = 0;
+        while (r >= v + 1) {
+            r -= v + 1;
+            v++;
+        }
+        a->data[i] = (float)v;
+        expected[v]++;
+    }
+
+    error = bincount_array(&counts, &nbins, a, 12);
+    passed &= (error == ARRAY_SUCCESS && nbins == 12 && counts[10] == 0 && counts[11] == 0);
+    for (int v = 0; passed && v < 10; v++) passed &= (counts[v] == expected[v]);
+
+    // Uniform bins over [0, 10]: bin v holds value v, and 10 would land in the last bin
+    size_t uniform[5];
+    error = histogram_uniform(uniform, 5, a, 0.0f, 10.0f);
+    passed &= (error == ARRAY_SUCCESS);
+    for (int b = 0; passed && b < 5; b++) passed &= (uniform[b] == expected[2 * b] + expected[2 * b + 1]);
+
+    // Explicit edges, values outside are dropped
+    float edges[] = {1.0f, 2.5f, 9.0f};
+    size_t edge_counts[2];
+    error = histogram_edges(edge_counts, edges, 3, a);
+    passed &= (error == ARRAY_SUCCESS && edge_counts[0] == expected[1] + expected[2]);
+    passed &= (edge_counts[1] == a->size - expected[0] - expected[1] - expected[2]);
+
+    // Unique values with counts agree with bincount
+    a->data[0] = NAN;
+    a->data[55] = NAN;
+    error = unique_array(&values, &counts, a);
+    passed &= (error == ARRAY_SUCCESS && values->size == 11 && isnan(values->data[10]) && counts[10] == 2);
+    for (int v = 0; passed && v < 10; v++) {
+        passed &= (values->data[v] == (float)v && counts[v] == expected[v] - (v == 0 ? 2 : 0));
+    }
+
+    passed &= (bincount_array(&counts, &nbins, a, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    // Quantized inputs are rejected
+    ArrayType *bytes = create_array_dtype(shape, 1, ARRAY_DTYPE_INT8, &error);
+    passed &= (histogram_uniform(counts, 10, bytes, 0.0f, 10.0f) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (unique_array(&values, NULL, bytes) == ARRAY_ERROR_INVALID_DTYPE);
+    free_array(bytes);
+
+    // Views are rejected rather than read as contiguous data
+    int wide_shape[] = {2, 100000};
+    ArrayType *wide = NULL;
+    passed &= (array_broadcast_to(&wide, a, wide_shape, 2) == ARRAY_SUCCESS);
+    passed &= (histogram_uniform(counts, 10, wide, 0.0f, 10.0f) == ARRAY_ERROR_INVALID_ARGUMENT);
+    free_array(wide);
+
+    snprintf(details, sizeof(details), "bincount/histogram/unique over %zu samples", a->size);
+    print_test_result("test_histogram_operations", passed, details);
+
+    free(counts);
+    free_array(a);
+    free_array(values);
+}
+
+void test_convolution_operations() {
+    int signal_shape[] = {5};
+    int taps_shape[] = {4};
+    int image_shape[] = {6, 7};
+    int bank_shape[] = {2, 7, 7};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *signal = create_array(signal_shape, 1, &error);
+    ArrayType *taps = create_array(taps_shape, 1, &error);
+    ArrayType *image = create_array(image_shape, 2, &error);
+    ArrayType *bank = create_array(bank_shape, 3, &error);
+    ArrayType *result = NULL;
+    ArrayType *view = NULL;
+    int passed = signal != NULL && taps != NULL && image != NULL && bank != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for convolution: %d\n", error);
+        return;
+    }
+
+    // signal = [1, 2, 3, 4, 5], taps = [1, 0, -1, 2]
+    const float tap_values[] = {1.0f, 0.0f, -1.0f, 2.0f};
+    for (size_t i = 0; i < signal->size; i++) signal->data[i] = (float)(i + 1);
+    memcpy(taps->data, tap_values, sizeof(tap_values));
+
+    const float full[] = {1, 2, 2, 4, 6, 2, 3, 10};
+    error = convolve1d_array(&result, signal, taps, 0, CONVOLVE_FULL);
+    passed &= (error == ARRAY_SUCCESS && result->size == 8);
+    for (int i = 0; passed && i < 8; i++) passed &= (result->data[i] == full[i]);
+    error = convolve1d_array(&result, signal, taps, 0, CONVOLVE_SAME);
+    passed &= (error == ARRAY_SUCCESS && result->size == 5 && result->data[0] == 2.0f && result->data[4] == 2.0f);
+    error = correlate1d_array(&result, signal, taps, 0, CONVOLVE_VALID);
+    passed &= (error == ARRAY_SUCCESS && result->size == 2 && result->data[0] == 6.0f && result->data[1] == 8.0f);
+
+    // 3x3 box filter (direct path): interior outputs are nine times the centre value
+    int box_shape[] = {3, 3};
+    ArrayType *box = create_array(box_shape, 2, &error);
+    for (size_t i = 0; i < box->size; i++) box->data[i] = 1.0f;
+    for (size_t i = 0; i < image->size; i++) image->data[i] = (float)(i % 7 + 7 * (i / 7));
+    error = convolve2d_array(&result, image, box, CONVOLVE_VALID);
+    passed &= (error == ARRAY_SUCCESS && result->shape[0] == 4 && result->shape[1] == 5);
+    passed &= (result->data[0] == 9.0f * image->data[8]);
+    error = convolve2d_array(&result, image, box, CONVOLVE_SAME);
+    passed &= (error == ARRAY_SUCCESS && result->shape[0] == 6 && result->data[0] == image->data[0] + image->data[1] + image->data[7] + image->data[8]);
+
+    // 7x7 filter bank (im2col + sgemm path): a centred delta filter reproduces the image,
+    // and the second filter shifts it by one column
+    memset(bank->data, 0, bank->size * sizeof(float));
+    bank->data[3 * 7 + 3] = 1.0f;
+    bank->data[49 + 3 * 7 + 2] = 1.0f;
+    error = correlate2d_array(&result, image, bank, CONVOLVE_SAME);
+    passed &= (error == ARRAY_SUCCESS && result->ndim == 3 && result->shape[0] == 2);
+    for (size_t i = 0; passed && i < image->size; i++) {
+        size_t x = i % 7;
+        passed &= (result->data[i] == image->data[i]);
+        passed &= (result->data[42 + i] == (x > 0 ? image->data[i - 1] : 0.0f));
+    }
+
+    // Matrix product of a 6x7 image with a 7x7 delta matrix
+    int eye_shape[] = {7, 7};
+    ArrayType *eye = create_array(eye_shape, 2, &error);
+    for (int i = 0; i < 7; i++) eye->data[i * 8] = 2.0f;
+    error = matmul_arrays(&result, image, eye);
+    passed &= (error == ARRAY_SUCCESS && result->shape[0] == 6 && result->shape[1] == 7);
+    for (size_t i = 0; passed && i < image->size; i++) passed &= (result->data[i] == 2.0f * image->data[i]);
+
+    // Sliding windows share the signal's data; moving averages match the window means
+    error = sliding_window_view(&view, signal, 3, 0);
+    passed &= (error == ARRAY_SUCCESS && view->data == signal->data && view->shape[0] == 3 && view->shape[1] == 3);
+    passed &= (view->strides[0] == 1 && view->strides[1] == 1);
+    error = array_copy(&result, view);
+    passed &= (error == ARRAY_SUCCESS && result->data[4] == 3.0f && result->data[8] == 5.0f);
+    error = moving_average_array(&result, signal, 3, 0);
+    passed &= (error == ARRAY_SUCCESS && result->size == 3 && result->data[0] == 2.0f && result->data[2] == 4.0f);
+    error = moving_std_array(&result, signal, 5, 0);
+    passed &= (error == ARRAY_SUCCESS && result->size == 1 && fabsf(result->data[0] - sqrtf(2.0f)) < 1e-6f);
+
+    passed &= (convolve1d_array(&result, taps, image, 0, CONVOLVE_FULL) == ARRAY_ERROR_INVALID_DIMENSION);
+    passed &= (moving_average_array(&result, signal, 6, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    // The result may not be an operand
+    passed &= (convolve1d_array(&signal, signal, taps, 0, CONVOLVE_SAME) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (correlate2d_array(&image, image, box, CONVOLVE_SAME) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (moving_average_array(&signal, signal, 3, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (matmul_arrays(&eye, image, eye) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (signal->size == 5 && image->shape[0] == 6 && eye->data[8] == 2.0f);
+
+    // Quantized inputs are rejected
+    ArrayType *bytes = create_array_dtype(image_shape, 2, ARRAY_DTYPE_INT8, &error);
+    passed &= (convolve1d_array(&result, bytes, taps, 1, CONVOLVE_SAME) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (correlate2d_array(&result, bytes, box, CONVOLVE_VALID) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (matmul_arrays(&result, bytes, eye) == ARRAY_ERROR_INVALID_DTYPE);
+    free_array(bytes);
+
+    // Views are rejected rather than read as contiguous data
+    passed &= (convolve1d_array(&result, view, taps, 1, CONVOLVE_FULL) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (matmul_arrays(&result, view, view) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    snprintf(details, sizeof(details), "1-D modes, 3x3 direct and 7x7 GEMM filters, %zu-element sliding windows", view->size);
+    print_test_result("test_convolution_operations", passed, details);
+
+    free_array(view);
+    free_array(signal);
+    free_array(taps);
+    free_array(image);
+    free_array(bank);
+    free_array(box);
+    free_array(eye);
+    free_array(result);
+}
+
+void test_fft_operations() {
+    int shape[] = {4};
+    int prime_shape[] = {3, 17};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape, 1, &error);
+    ArrayType *prime = create_array(prime_shape, 2, &error);
+    ArrayType *spectrum = NULL;
+    ArrayType *result = NULL;
+    int passed = a != NULL && prime != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for FFT: %d\n", error);
+        return;
+    }
+
+    // fft([1, 2, 3, 4]) = [10, -2 + 2i, -2, -2 - 2i]
+    const float expected[] = {10, 0, -2, 2, -2, 0, -2, -2};
+    for (size_t i = 0; i < a->size; i++) a->data[i] = (float)(i + 1);
+    error = fft_array(&spectrum, a, 0);
+    passed &= (error == ARRAY_SUCCESS && spectrum->dtype == ARRAY_DTYPE_COMPLEX64 && spectrum->size == 4);
+    for (int i = 0; passed && i < 8; i++) passed &= fabsf(spectrum->data[i] - expected[i]) < 1e-5f;
+
+    // ifft inverts fft in place; rfft keeps the first n / 2 + 1 terms and irfft inverts it
+    error = ifft_array(&spectrum, spectrum, 0);
+    passed &= (error == ARRAY_SUCCESS && fabsf(spectrum->data[6] - 4.0f) < 1e-5f && fabsf(spectrum->data[7]) < 1e-5f);
+    error = rfft_array(&spectrum, a, 0);
+    passed &= (error == ARRAY_SUCCESS && spectrum->size == 3);
+    for (int i = 0; passed && i < 6; i++) passed &= fabsf(spectrum->data[i] - expected[i]) < 1e-5f;
+    error = irfft_array(&result, spectrum, 0, 0);
+    passed &= (error == ARRAY_SUCCESS && result->dtype == ARRAY_DTYPE_FLOAT32 && result->size == 4);
+    for (int i = 0; passed && i < 4; i++) passed &= fabsf(result->data[i] - a->data[i]) < 1e-5f;
+
+    // Prime length 17 (Bluestein), batched over rows: row r is a delta at position r,
+    // whose transform is e^(-2 pi i r k / 17)
+    memset(prime->data, 0, prime->size * sizeof(float));
+    for (int r = 0; r < 3; r++) prime->data[r * 17 + r] = 1.0f;
+    error = fft_array(&spectrum, prime, -1);
+    passed &= (error == ARRAY_SUCCESS && spectrum->shape[0] == 3 && spectrum->shape[1] == 17);
+    for (int r = 0; passed && r < 3; r++) {
+        for (int k = 0; k < 17; k++) {
+            double angle = -2.0 * 3.14159265358979323846 * ((r * k) % 17) / 17.0;
+            const float *z = spectrum->data + 2 * (r * 17 + k);
+            passed &= fabs(z[0] - cos(angle)) < 1e-5 && fabs(z[1] - sin(angle)) < 1e-5;
+        }
+    }
+    error = irfft_array(&result, spectrum, 17, 1);
+    passed &= (error == ARRAY_SUCCESS && result->shape[1] == 17 && fabsf(result->data[17 + 1] - 1.0f) < 1e-5f);
+
+    // Real-only operations reject complex arrays
+    passed &= (add_arrays(&result, spectrum, spectrum) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (rfft_array(&result, spectrum, 0) == ARRAY_ERROR_INVALID_DTYPE);
+
+    // Quantized inputs are rejected
+    ArrayType *bytes = create_array_dtype(shape, 1, ARRAY_DTYPE_INT8, &error);
+    passed &= (fft_array(&spectrum, bytes, 0) == ARRAY_ERROR_INVALID_DTYPE);
+    free_array(bytes);
+
+    // Views are rejected rather than read as contiguous data
+    int wide_shape[] = {3, 4};
+    ArrayType *wide = NULL;
+    passed &= (array_broadcast_to(&wide, a, wide_shape, 2) == ARRAY_SUCCESS);
+    passed &= (fft_array(&spectrum, wide, 1) == ARRAY_ERROR_INVALID_ARGUMENT);
+    free_array(wide);
+
+    // Transforms that change the dtype or length cannot run in place, and leave a intact
+    passed &= (rfft_array(&a, a, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (fft_array(&a, a, 0) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (irfft_array(&spectrum, spectrum, 0, 1) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (a->dtype == ARRAY_DTYPE_FLOAT32 && a->size == 4 && a->data[3] == 4.0f);
+
+    snprintf(details, sizeof(details), "fft/ifft/rfft/irfft, radix-4 and Bluestein lengths");
+    print_test_result("test_fft_operations", passed, details);
+
+    fft_clear_plan_cache();
+    free_array(a);
+    free_array(prime);
+    free_array(spectrum);
+    free_array(result);
+}
+
+void test_linalg_operations() {
+    int shape[] = {2, 2};
+    int vector_shape[] = {2};
+    int batch_shape[] = {20, 8, 8};
+    int rhs_shape[] = {20, 8};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape, 2, &error);
+    ArrayType *b = create_array(vector_shape, 1, &error);
+    ArrayType *batch = create_array(batch_shape, 3, &error);
+    ArrayType *rhs = create_array(rhs_shape, 2, &error);
+    ArrayType *result = NULL;
+    ArrayType *q = NULL;
+    ArrayType *r = NULL;
+    int *pivots = NULL;
+    int passed = a != NULL && b != NULL && batch != NULL && rhs != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for linear algebra: %d\n", error);
+        return;
+    }
+
+    // [[4, 3], [6, 3]] pivots on its second row: L = [[1, 0], [2/3, 1]], U = [[6, 3], [0, 1]]
+    const float matrix[] = {4, 3, 6, 3};
+    memcpy(a->data, matrix, sizeof(matrix));
+    error = lu_array(&result, &pivots, a);
+    passed &= (error == ARRAY_SUCCESS && pivots[0] == 1 && pivots[1] == 1);
+    passed &= (fabsf(result->data[0] - 6.0f) < 1e-6f && fabsf(result->data[2] - 2.0f / 3.0f) < 1e-6f &&
+               fabsf(result->data[3] - 1.0f) < 1e-6f);
+
+    // 4x + 3y = 10, 6x + 3y = 12 gives x = 1, y = 2; the inverse is [[-1/2, 1/2], [1, -2/3]]
+    b->data[0] = 10.0f;
+    b->data[1] = 12.0f;
+    error = solve_array(&result, a, b);
+    passed &= (error == ARRAY_SUCCESS && result->ndim == 1);
+    passed &= (fabsf(result->data[0] - 1.0f) < 1e-5f && fabsf(result->data[1] - 2.0f) < 1e-5f);
+    error = inv_array(&result, a);
+    passed &= (error == ARRAY_SUCCESS && fabsf(result->data[0] + 0.5f) < 1e-6f && fabsf(result->data[3] + 2.0f / 3.0f) < 1e-6f);
+
+    // QR of [[4, 3], [6, 3]]: Q R reproduces the matrix and Q has orthonormal columns
+    error = qr_array(&q, &r, a);
+    passed &= (error == ARRAY_SUCCESS && r->data[2] == 0.0f);
+    for (int i = 0; passed && i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            float qr = q->data[i * 2] * r->data[j] + q->data[i * 2 + 1] * r->data[2 + j];
+            float qtq = q->data[i] * q->data[j] + q->data[2 + i] * q->data[2 + j];
+            passed &= fabsf(qr - matrix[i * 2 + j]) < 1e-5f && fabsf(qtq - (i == j)) < 1e-5f;
+        }
+    }
+
+    // cholesky([[4, 2], [2, 3]]) = [[2, 0], [1, sqrt(2)]]; an indefinite matrix is rejected
+    const float spd[] = {4, 2, 2, 3};
+    memcpy(a->data, spd, sizeof(spd));
+    error = cholesky_array(&result, a);
+    passed &= (error == ARRAY_SUCCESS && fabsf(result->data[0] - 2.0f) < 1e-6f && result->data[1] == 0.0f &&
+               fabsf(result->data[2] - 1.0f) < 1e-6f && fabsf(result->data[3] - sqrtf(2.0f)) < 1e-6f);
+    a->data[3] = 0.0f;
+    passed &= (cholesky_array(&result, a) == ARRAY_ERROR_NOT_POSITIVE_DEFINITE);
+
+    // A batch of 20 diagonally dominant 8x8 systems takes the interleaved small-matrix path
+    for (size_t i = 0; i < batch->size; i++) batch->data[i] = (float)((i * 7) % 11) / 11.0f;
+    for (int s = 0; s < 20; s++) {
+        for (int i = 0; i < 8; i++) {
+            batch->data[s * 64 + i * 9] += 8.0f;
+            rhs->data[s * 8 + i] = (float)(s - i);
+        }
+    }
+    error = solve_array(&result, batch, rhs);
+    passed &= (error == ARRAY_SUCCESS && result->shape[0] == 20 && result->shape[1] == 8);
+    for (int s = 0; passed && s < 20; s++) {
+        for (int i = 0; i < 8; i++) {
+            float sum = 0.0f;
+            for (int t = 0; t < 8; t++) sum += batch->data[s * 64 + i * 8 + t] * result->data[s * 8 + t];
+            passed &= fabsf(sum - rhs->data[s * 8 + i]) < 1e-4f;
+        }
+    }
+
+    // A singular matrix in the batch is reported
+    memset(batch->data + 5 * 64, 0, 64 * sizeof(float));
+    passed &= (solve_array(&result, batch, rhs) == ARRAY_ERROR_SINGULAR_MATRIX);
+
+    // Views are rejected rather than read as contiguous data
+    int wide_shape[] = {3, 2, 2};
+    ArrayType *wide = NULL;
+    passed &= (array_broadcast_to(&wide, a, wide_shape, 3) == ARRAY_SUCCESS);
+    passed &= (inv_array(&result, wide) == ARRAY_ERROR_INVALID_ARGUMENT);
+    free_array(wide);
+
+    snprintf(details, sizeof(details), "lu/solve/inv/qr/cholesky on 2x2 and a batch of 8x8 systems");
+    print_test_result("test_linalg_operations", passed, details);
+
+    free(pivots);
+    free_array(a);
+    free_array(b);
+    free_array(batch);
+    free_array(rhs);
+    free_array(result);
+    free_array(q);
+    free_array(r);
+}
+
+void test_random_operations() {
+    int shape[] = {3, 1001};
+    int small_shape[] = {8};
+    ArrayError error;
+    char details[256];
+
+    ArrayType *a = create_array(shape, 2, &error);
+    ArrayType *b = create_array(shape, 2, &error);
+    ArrayType *tail = create_array(small_shape, 1, &error);
+    RandomState state;
+    int passed = a != NULL && b != NULL && tail != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for random numbers: %d\n", error);
+        return;
+    }
+
+    // Uniform values stay in [low, high) and a fill of 3003 elements uses ceil(3003 / 4) blocks
+    random_seed(&state, 42, 0);
+    error = random_uniform(a, &state, -2.0f, 2.0f);
+    passed &= (error == ARRAY_SUCCESS && state.counter == 751);
+    double mean = 0.0;
+    for (size_t i = 0; passed && i < a->size; i++) {
+        passed &= a->data[i] >= -2.0f && a->data[i] < 2.0f;
+        mean += a->data[i];
+    }
+    passed &= fabs(mean / a->size) < 0.1;
+
+    // Half of the draws round up to high here; they are kept below it
+    random_uniform(b, &state, 16777215.0f, 16777216.0f);
+    for (size_t i = 0; passed && i < b->size; i++) passed &= (b->data[i] == 16777215.0f);
+
+    // Reseeding reproduces the sequence; skipping ahead matches the tail of a longer fill
+    random_seed(&state, 42, 0);
+    random_uniform(b, &state, -2.0f, 2.0f);
+    passed &= memcmp(a->data, b->data, a->size * sizeof(float)) == 0;
+    random_seed(&state, 42, 0);
+    random_skip(&state, 100);
+    random_uniform(tail, &state, -2.0f, 2.0f);
+    passed &= memcmp(a->data + 400, tail->data, tail->size * sizeof(float)) == 0;
+
+    // A different stream gives different numbers
+    random_seed(&state, 42, 1);
+    random_uniform(b, &state, -2.0f, 2.0f);
+    passed &= memcmp(a->data, b->data, a->size * sizeof(float)) != 0;
+
+    // Normal samples have roughly the requested mean and standard deviation
+    random_seed(&state, 7, 0);
+    error = random_normal(a, &state, 1.0f, 2.0f);
+    double sum = 0.0, sum_sq = 0.0;
+    for (size_t i = 0; i < a->size; i++) {
+        sum += a->data[i];
+        sum_sq += a->data[i] * a->data[i];
+    }
+    mean = sum / a->size;
+    double variance = sum_sq / a->size - mean * mean;
+    passed &= (error == ARRAY_SUCCESS && fabs(mean - 1.0) < 0.15 && fabs(variance - 4.0) < 0.4);
+
+    // Integers cover [low, high) exactly
+    int seen[7] = {0};
+    error = random_integers(a, &state, -3, 4);
+    passed &= (error == ARRAY_SUCCESS);
+    for (size_t i = 0; passed && i < a->size; i++) {
+        float v = a->data[i];
+        passed &= v == floorf(v) && v >= -3.0f && v < 4.0f;
+        if (passed) seen[(int)v + 3] = 1;
+    }
+    for (int i = 0; i < 7; i++) passed &= seen[i];
+    passed &= (random_integers(a, &state, 5, 5) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    snprintf(details, sizeof(details), "Philox uniform/normal/integers, reseeding, streams and skip-ahead");
+    print_test_result("test_random_operations", passed, details);
+
+    free_array(a);
+    free_array(b);
+    free_array(tail);
+}
+
+static void index_pattern_kernel(float *out, size_t start, size_t n, const void *ctx) {
+    float scale = *(const float*)ctx;
+    for (size_t i = 0; i < n; i++) out[i] = scale * (float)((start + i) % 1000);
+}
+
+void test_creation_operations() {
+    int shape[] = {2, 3};
+    int large_shape[] = {100000};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    // array_full writes every element; array_empty only allocates
+    ArrayType *full = array_full(shape, 2, 2.5f, &error);
+    passed &= (full != NULL && error == ARRAY_SUCCESS && full->size == 6);
+    for (size_t i = 0; passed && i < full->size; i++) passed &= full->data[i] == 2.5f;
+    ArrayType *empty = array_empty(shape, 2, &error);
+    passed &= (empty != NULL && error == ARRAY_SUCCESS && empty->shape[1] == 3 && empty->strides[0] == 3);
+
+    // arange(0, 1, 0.25) = [0, 0.25, 0.5, 0.75]; arange(5, 0, -2) = [5, 3, 1]
+    ArrayType *range = array_arange(0.0f, 1.0f, 0.25f, &error);
+    passed &= (range != NULL && range->size == 4 && range->data[3] == 0.75f);
+    ArrayType *down = array_arange(5.0f, 0.0f, -2.0f, &error);
+    passed &= (down != NULL && down->size == 3 && down->data[0] == 5.0f && down->data[2] == 1.0f);
+    passed &= (array_arange(0.0f, 1.0f, 0.0f, &error) == NULL && error == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    // linspace(0, 1, 5) = [0, 0.25, 0.5, 0.75, 1]; without the endpoint the spacing is 0.2
+    ArrayType *space = array_linspace(0.0f, 1.0f, 5, 1, &error);
+    passed &= (space != NULL && space->size == 5 && space->data[1] == 0.25f && space->data[4] == 1.0f);
+    ArrayType *open_space = array_linspace(0.0f, 1.0f, 5, 0, &error);
+    passed &= (open_space != NULL && fabsf(open_space->data[4] - 0.8f) < 1e-7f);
+    ArrayType *single = array_linspace(0.0f, 1.0f, 1, 1, &error);
+    passed &= (single != NULL && single->size == 1 && single->data[0] == 0.0f);
+    free_array(single);
+
+    // eye(3, 4, k=1) has ones at (0, 1), (1, 2) and (2, 3)
+    ArrayType *eye = array_eye(3, 4, 1, &error);
+    passed &= (eye != NULL && eye->shape[0] == 3 && eye->shape[1] == 4);
+    for (int i = 0; passed && i < 3; i++) {
+        for (int j = 0; j < 4; j++) passed &= eye->data[i * 4 + j] == (j == i + 1 ? 1.0f : 0.0f);
+    }
+
+    // array_fill_fn hands each block its flat starting index
+    ArrayType *large = array_empty(large_shape, 1, &error);
+    float scale = 0.5f;
+    passed &= (large != NULL && array_fill_fn(large, index_pattern_kernel, &scale) == ARRAY_SUCCESS);
+    for (size_t i = 0; passed && i < large->size; i += 997) passed &= large->data[i] == 0.5f * (float)(i % 1000);
+
+    snprintf(details, sizeof(details), "full, empty, arange, linspace, eye and fill_fn");
+    print_test_result("test_creation_operations", passed, details);
+
+    free_array(full);
+    free_array(empty);
+    free_array(range);
+    free_array(down);
+    free_array(space);
+    free_array(open_space);
+    free_array(eye);
+    free_array(large);
+}
+
+static void count_release(void *data, size_t nbytes, void *ctx) {
+    (void)data;
+    (void)nbytes;
+    ++*(int*)ctx;
+}
+
+void test_shared_buffers() {
+    int shape[] = {2, 3};
+    ArrayError error;
+    char details[256];
+    float external[6] = {1, 2, 3, 4, 5, 6};
+    int releases = 0;
+
+    ArrayType *a = create_array(shape, 2, &error);
+    ArrayType *ones = array_full(shape, 2, 1.0f, &error);
+    ArrayType *shared = NULL;
+    ArrayType *window = NULL;
+    int passed = a != NULL && ones != NULL && error == ARRAY_SUCCESS;
+
+    if (!passed) {
+        printf("Error creating arrays for shared buffers: %d\n", error);
+        return;
+    }
+
+    // Sharing is O(1): both handles point at the same data
+    for (size_t i = 0; i < a->size; i++) a->data[i] = (float)i;
+    shared = array_share(a, &error);
+    passed &= (shared != NULL && shared->data == a->data && a->buffer->refcount == 2);
+
+    // Writing into a shared handle copies it first and leaves the other handle untouched
+    error = add_arrays(&shared, shared, ones);
+    passed &= (error == ARRAY_SUCCESS && shared->data != a->data && a->buffer->refcount == 1);
+    passed &= (a->data[4] == 4.0f && shared->data[4] == 5.0f);
+
+    // A sliding window view keeps the buffer alive after its source is freed, and is read-only
+    error = sliding_window_view(&window, a, 2, 1);
+    passed &= (error == ARRAY_SUCCESS && window->buffer == a->buffer);
+    free_array(a);
+    a = NULL;
+    passed &= (window->shape[1] == 2 && window->shape[2] == 2 && window->data[5] == 5.0f);
+    passed &= (array_make_writable(window) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    // Wrapped memory is released once, when its last handle goes away
+    ArrayType *wrapped = array_wrap(external, shape, 2, count_release, &releases, &error);
+    ArrayType *copy = array_share(wrapped, &error);
+    passed &= (wrapped != NULL && copy != NULL && copy->data == external);
+    free_array(wrapped);
+    passed &= (releases == 0);
+    free_array(copy);
+    passed &= (releases == 1);
+
+    // Handles on one buffer can be created and freed concurrently
+    ArrayType *handles[64] = {NULL};
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = 0; i < 64; i++) handles[i] = array_share(ones, NULL);
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = 0; i < 64; i++) free_array(handles[i]);
+    passed &= (ones->buffer->refcount == 1);
+
+    snprintf(details, sizeof(details), "array_share, copy-on-write, views outliving sources, array_wrap release");
+    print_test_result("test_shared_buffers", passed, details);
+
+    free_array(ones);
+    free_array(shared);
+    free_array(window);
+}
+
+void test_allocators() {
+    int shape[] = {3, 5};
+    int large_shape[] = {1024, 1024};
+    int resized_shape[] = {4, 5};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    // Cache-line aligned data; an array outlives a change of allocator
+    ArrayAllocator aligned = array_allocator_aligned(64);
+    array_set_allocator(&aligned);
+    ArrayType *a = create_array(shape, 2, &error);
+    passed &= (a != NULL && array_get_allocator() == &aligned && (uintptr_t)a->data % 64 == 0);
+    for (size_t i = 0; passed && i < a->size; i++) passed &= a->data[i] == 0.0f;
+
+    // Huge pages for a 4 MB array: 2 MB aligned and zero-filled
+    ArrayAllocator huge = array_allocator_hugepage(HUGEPAGE_TRANSPARENT);
+    array_set_allocator(&huge);
+    ArrayType *large = create_array(large_shape, 2, &error);
+    passed &= (large != NULL && (uintptr_t)large->data % HUGEPAGE_MIN_SIZE == 0);
+    passed &= (large->data[0] == 0.0f && large->data[large->size - 1] == 0.0f);
+    large->data[large->size - 1] = 1.0f;
+
+    // Pool-backed arrays; results are allocated from the pool as well
+    MemoryPoolType *pool = create_memory_pool(4096);
+    ArrayAllocator pooled = array_allocator_pool(pool);
+    array_set_allocator(&pooled);
+    ArrayType *b = array_full(shape, 2, 2.0f, &error);
+    ArrayType *sum = NULL;
+    passed &= (b != NULL && (char*)b->data >= (char*)pool->start && (char*)b->data < (char*)pool->start + pool->size);
+    error = add_arrays(&sum, b, b);
+    passed &= (error == ARRAY_SUCCESS && (char*)sum->data >= (char*)pool->start && sum->data[14] == 4.0f);
+    free_array(b);
+    free_array(sum);
+
+    // With the default allocator a result of a new size is resized in place
+    array_set_allocator(NULL);
+    passed &= (array_get_allocator() == &array_allocator_malloc);
+    ArrayType *result = create_array(shape, 2, &error);
+    ArrayType *handle = result;
+    error = prepare_result(&result, resized_shape, 2);
+    passed &= (error == ARRAY_SUCCESS && result == handle && result->size == 20 && result->strides[0] == 5);
+
+    snprintf(details, sizeof(details), "aligned, huge-page and pool allocators, realloc-based result resizing");
+    print_test_result("test_allocators", passed, details);
+
+    free_array(a);
+    free_array(large);
+    free_array(result);
+    destroy_memory_pool(pool);
+}
+
+void test_buffer_cache() {
+    int shape[] = {512, 512};
+    int smaller_shape[] = {400, 512};
+    size_t nbytes = 512 * 512 * sizeof(float);
+    ArrayError error;
+    ArrayCacheStats before, after;
+    char details[256];
+    int passed = 1;
+
+    array_cache_trim(0);
+    array_cache_get_stats(&before);
+
+    // A freed 1 MB buffer comes back zero-filled for the next array of its size
+    ArrayType *a = create_array(shape, 2, &error);
+    float *data = a->data;
+    a->data[a->size - 1] = 5.0f;
+    free_array(a);
+    array_cache_get_stats(&after);
+    passed &= (after.cached_bytes == nbytes);
+    a = create_array(shape, 2, &error);
+    passed &= (a != NULL && a->data == data && a->data[a->size - 1] == 0.0f);
+
+    // A smaller array reuses it too, uninitialized arrays skip the clearing
+    free_array(a);
+    a = array_empty(smaller_shape, 2, &error);
+    passed &= (a != NULL && a->data == data);
+    array_cache_get_stats(&after);
+    passed &= (after.hits == before.hits + 2 && after.cached_bytes == 0);
+
+    // Blocks only return to allocators with the same callbacks and alignment
+    free_array(a);
+    ArrayAllocator aligned = array_allocator_aligned(4096);
+    array_set_allocator(&aligned);
+    ArrayType *b = create_array(shape, 2, &error);
+    passed &= (b != NULL && b->data != data && (uintptr_t)b->data % 4096 == 0);
+    array_set_allocator(NULL);
+    free_array(b);
+    array_cache_get_stats(&after);
+    passed &= (after.cached_bytes == 2 * nbytes);
+
+    // Destroying a pool drops its blocks from every thread's cache and keeps
+    // the calling thread's blocks of other pools
+    MemoryPoolType *pools[2] = {create_memory_pool(4 * nbytes), create_memory_pool(4 * nbytes)};
+    ArrayAllocator pooled[2] = {array_allocator_pool(pools[0]), array_allocator_pool(pools[1])};
+    size_t cached[2] = {0, 0};
+    #pragma omp parallel num_threads(2)
+    {
+        int t = omp_get_thread_num();
+        size_t size = nbytes;
+        void *block = array_cache_alloc(&pooled[0], &size, 0);
+        array_cache_free(&pooled[0], block, size);
+        if (t == 0) {
+            block = array_cache_alloc(&pooled[1], &size, 0);
+            array_cache_free(&pooled[1], block, size);
+        }
+    }
+    array_cache_get_stats(&after);
+    size_t own = after.cached_bytes;
+    destroy_memory_pool(pools[0]);
+    #pragma omp parallel num_threads(2)
+    {
+        ArrayCacheStats stats;
+        array_cache_get_stats(&stats);
+        cached[omp_get_thread_num()] = stats.cached_bytes;
+        array_cache_trim(0);
+    }
+    passed &= (own == 4 * nbytes && cached[0] == 3 * nbytes && cached[1] == 0);
+    destroy_memory_pool(pools[1]);
+
+    // A zero limit empties the cache and frees buffers immediately
+    array_cache_set_limit(0);
+    a = create_array(shape, 2, &error);
+    free_array(a);
+    array_cache_get_stats(&after);
+    passed &= (after.cached_bytes == 0 && after.limit == 0);
+    array_cache_set_limit(ARRAY_CACHE_DEFAULT_LIMIT);
+
+    snprintf(details, sizeof(details), "%zu hits, %zu misses", after.hits - before.hits, after.misses - before.misses);
+    print_test_result("test_buffer_cache", passed, details);
+}
+
+void test_batched_operations() {
+    enum { PAIRS = 65 };
+    int tile_shape[] = {16, 16};
+    int large_shape[] = {300, 300};
+    ArrayType *a[PAIRS], *b[PAIRS], *sums[PAIRS] = {NULL}, *products[PAIRS] = {NULL};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    for (int i = 0; i < PAIRS; i++) {
+        int *shape = i == PAIRS / 2 ? large_shape : tile_shape;
+        a[i] = array_full(shape, 2, (float)i, &error);
+        b[i] = array_full(shape, 2, 2.0f, &error);
+    }
+    sums[0] = a[0];
+
+    error = add_arrays_batched(sums, (const ArrayType *const *)a, (const ArrayType *const *)b, PAIRS);
+    passed &= (error == ARRAY_SUCCESS);
+    error = multiply_arrays_batched(products, (const ArrayType *const *)a, (const ArrayType *const *)b, PAIRS);
+    passed &= (error == ARRAY_SUCCESS);
+    for (int i = 0; passed && i < PAIRS; i++) {
+        float base = i == 0 ? 2.0f : (float)i;
+        for (size_t j = 0; j < a[i]->size; j++) {
+            passed &= (sums[i]->data[j] == (float)i + 2.0f && products[i]->data[j] == 2.0f * base);
+        }
+    }
+
+    ArrayType *missing[] = {a[1], NULL};
+    error = add_arrays_batched(sums + 1, (const ArrayType *const *)missing, (const ArrayType *const *)b, 2);
+    passed &= (error == ARRAY_ERROR_NULL_POINTER);
+
+    snprintf(details, sizeof(details), "%d pairs of 16x16 and 300x300 arrays, in-place result, missing operand", PAIRS);
+    print_test_result("test_batched_operations", passed, details);
+
+    for (int i = 0; i < PAIRS; i++) {
+        if (i > 0) free_array(sums[i]);
+        free_array(products[i]);
+        free_array(a[i]);
+        free_array(b[i]);
+    }
+}
+
+void test_shared_memory() {
+    const char *name = "/numpy_in_c_test_shared";
+    int shape[] = {3, 1000};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    array_unlink_shared(name);
+    ArrayType *writer = array_create_shared(name, shape, 2, ARRAY_DTYPE_FLOAT32, &error);
+    passed &= (writer != NULL && writer->data[2999] == 0.0f);
+    passed &= (array_create_shared(name, shape, 2, ARRAY_DTYPE_FLOAT32, &error) == NULL && error == ARRAY_ERROR_SYSTEM);
+
+    // A second mapping sees the same pages, shape and dtype from the header alone
+    ArrayType *reader = array_attach_shared(name, &error);
+    passed &= (reader != NULL && reader->ndim == 2 && reader->shape[1] == 1000 && reader->data != writer->data);
+
+    uint64_t sequence = array_shared_read_begin(reader);
+    passed &= (array_shared_write_begin(writer) == ARRAY_SUCCESS);
+    for (size_t i = 0; i < writer->size; i++) writer->data[i] = (float)i;
+    passed &= !array_shared_read_validate(reader, sequence);
+    passed &= (array_shared_write_end(writer) == ARRAY_SUCCESS);
+
+    sequence = array_shared_read_begin(reader);
+    float sum = 0.0f;
+    for (size_t i = 0; i < reader->size; i++) sum += reader->data[i];
+    passed &= (array_shared_read_validate(reader, sequence) && sequence == 2 && sum == 4498500.0f);
+
+    // Library writes through a second handle stay in the mapping instead of copying it
+    float scale = 7.0f;
+    ArrayType *alias = array_share(writer, &error);
+    passed &= (alias != NULL && array_shared_write_begin(alias) == ARRAY_SUCCESS);
+    passed &= (array_fill_fn(alias, index_pattern_kernel, &scale) == ARRAY_SUCCESS && alias->data == writer->data);
+    passed &= (array_shared_write_end(alias) == ARRAY_SUCCESS);
+    passed &= (writer->data[1] == 7.0f && reader->data[1] == 7.0f && reader->data[2999] == 6993.0f);
+    free_array(alias);
+    for (size_t i = 0; i < writer->size; i++) writer->data[i] = (float)i;
+
+    // The mapping outlives the name and the creating handle
+    passed &= (array_unlink_shared(name) == ARRAY_SUCCESS);
+    passed &= (array_attach_shared(name, &error) == NULL && error == ARRAY_ERROR_SYSTEM);
+    free_array(writer);
+    passed &= (reader->data[2999] == 2999.0f);
+    passed &= (array_shared_write_begin(reader) == ARRAY_SUCCESS && array_shared_write_end(reader) == ARRAY_SUCCESS);
+
+    ArrayType *local = create_array(shape, 2, &error);
+    passed &= (array_shared_write_begin(local) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    snprintf(details, sizeof(details), "create, attach, sequence lock, unlink");
+    print_test_result("test_shared_memory", passed, details);
+
+    free_array(reader);
+    free_array(local);
+}
+
+void test_interop() {
+    int shape[] = {3, 2, 2};
+    int vector_shape[] = {5};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    ArrayType *tensor = array_empty(shape, 3, &error);
+    for (size_t i = 0; i < tensor->size; i++) tensor->data[i] = (float)i;
+
+    // DLPack round trip: the import sees the exported memory, which outlives the source
+    DLManagedTensor *managed = NULL;
+    passed &= (array_to_dlpack(tensor, &managed) == ARRAY_SUCCESS);
+    passed &= (managed->dl_tensor.ndim == 3 && managed->dl_tensor.shape[2] == 2 && managed->dl_tensor.strides[0] == 4);
+    passed &= (managed->dl_tensor.dtype.code == kDLFloat && managed->dl_tensor.dtype.bits == 32);
+    float *exported = (float*)managed->dl_tensor.data;
+    ArrayType *imported = array_from_dlpack(managed, &error);
+    passed &= (imported != NULL && imported->data == exported && imported->ndim == 3 && imported->data[11] == 11.0f);
+    free_array(imported);
+
+    DLManagedTensor *device = NULL;
+    array_to_dlpack(tensor, &device);
+    device->dl_tensor.device.device_type = kDLCUDA;
+    passed &= (array_from_dlpack(device, &error) == NULL && error == ARRAY_ERROR_INVALID_ARGUMENT);
+    device->deleter(device);
+
+    // Arrow fixed-shape tensor round trip
+    struct ArrowSchema schema;
+    struct ArrowArray array;
+    passed &= (array_to_arrow(tensor, &schema, &array) == ARRAY_SUCCESS);
+    passed &= (strcmp(schema.format, "+w:4") == 0 && array.length == 3 && array.children[0]->length == 12);
+    free_array(tensor);
+    imported = array_from_arrow(&schema, &array, &error);
+    passed &= (imported != NULL && array.release == NULL && imported->ndim == 3 && imported->shape[1] == 2);
+    passed &= (imported->data[7] == 7.0f);
+    schema.release(&schema);
+    free_array(imported);
+
+    // Primitive float arrays, with an offset applied on import
+    ArrayType *vector = array_full(vector_shape, 1, 1.5f, &error);
+    vector->data[4] = 9.0f;
+    array_to_arrow(vector, &schema, &array);
+    passed &= (strcmp(schema.format, "f") == 0 && array.n_buffers == 2 && array.buffers[1] == vector->data);
+    array.offset = 2;
+    array.length = 3;
+    imported = array_from_arrow(&schema, &array, &error);
+    passed &= (imported != NULL && imported->size == 3 && imported->data[2] == 9.0f);
+    schema.release(&schema);
+    free_array(imported);
+    free_array(vector);
+
+    // A 0-d array becomes a float array of length 1
+    ArrayType *scalar = array_full(NULL, 0, 2.5f, &error);
+    passed &= (array_to_arrow(scalar, &schema, &array) == ARRAY_SUCCESS);
+    passed &= (strcmp(schema.format, "f") == 0 && schema.n_children == 0 && array.length == 1);
+    imported = array_from_arrow(&schema, &array, &error);
+    passed &= (imported != NULL && imported->ndim == 1 && imported->size == 1 && imported->data[0] == 2.5f);
+    schema.release(&schema);
+    free_array(imported);
+    free_array(scalar);
+
+    snprintf(details, sizeof(details), "DLPack and Arrow C data export/import without copies");
+    print_test_result("test_interop", passed, details);
+}
+
+void test_masked_operations() {
+    int shape[] = {2, 4};
+    int row_shape[] = {4};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    ArrayType *a = create_array(shape, 2, &error);
+    ArrayType *b = create_array(shape, 2, &error);
+    ArrayType *row = array_full(row_shape, 1, 1.0f, &error);
+    for (int i = 0; i < 8; i++) {
+        a->data[i] = (float)(i + 1);
+        b->data[i] = 1.0f;
+    }
+    a->data[5] = NAN;
+
+    // Element 2 of a and element 6 of b are invalid
+    uint8_t mask_a = 0xFB, mask_b = 0xBF, mask_row = 0x0E;
+    passed &= (array_set_validity(a, &mask_a, 0) == ARRAY_SUCCESS);
+    passed &= (array_set_validity(b, &mask_b, 0) == ARRAY_SUCCESS);
+    passed &= (array_null_count(a) == 1 && !array_is_valid(a, 2) && array_is_valid(a, 5));
+
+    // Propagation: the result is invalid where any operand is
+    ArrayType *sum = NULL;
+    passed &= (add_arrays(&sum, a, b) == ARRAY_SUCCESS);
+    passed &= (array_null_count(sum) == 2 && !array_is_valid(sum, 2) && !array_is_valid(sum, 6));
+    ArrayType *fused = NULL;
+    array_set_validity(row, &mask_row, 0);
+    passed &= (fma_arrays(&fused, a, b, row) == ARRAY_SUCCESS);
+    passed &= (array_null_count(fused) == 4 && !array_is_valid(fused, 0) && !array_is_valid(fused, 4));
+    passed &= (!array_is_valid(fused, 2) && !array_is_valid(fused, 6) && fused->data[1] == 3.0f);
+
+    // NaN-aware reductions skip NaNs and invalid elements
+    ArrayType *reduced = NULL;
+    passed &= (nansum_array(&reduced, a, 1) == ARRAY_SUCCESS);
+    passed &= (reduced->size == 2 && reduced->data[0] == 7.0f && reduced->data[1] == 20.0f);
+    passed &= (nanmean_array(&reduced, a, 0) == ARRAY_SUCCESS);
+    passed &= (reduced->data[0] == 3.0f && reduced->data[1] == 2.0f && reduced->data[2] == 7.0f);
+    passed &= (nanmax_array(&reduced, a, -1) == ARRAY_SUCCESS && reduced->data[1] == 8.0f);
+    passed &= (nansum_array(&reduced, a, 2) == ARRAY_ERROR_INVALID_DIMENSION);
+
+    // NaNs become invalid, and shared handles keep their own copy of the bitmap
+    ArrayType *shared = array_share(a, &error);
+    passed &= (array_validity_from_nan(a) == ARRAY_SUCCESS && array_null_count(a) == 2);
+    passed &= (array_null_count(shared) == 1);
+    passed &= (array_set_validity(shared, NULL, 0) == ARRAY_SUCCESS && array_null_count(shared) == 0);
+
+    // Nulls travel through the Arrow validity buffer, honouring the offset
+    struct ArrowSchema schema;
+    struct ArrowArray array;
+    array_set_validity(row, &mask_row, 0);
+    passed &= (array_to_arrow(row, &schema, &array) == ARRAY_SUCCESS);
+    passed &= (array.null_count == 1 && array.buffers[0] != NULL);
+    array.offset = 1;
+    array.length = 3;
+    ArrayType *imported = array_from_arrow(&schema, &array, &error);
+    passed &= (imported != NULL && array_null_count(imported) == 0);
+    schema.release(&schema);
+    free_array(imported);
+
+    free_array(a);
+    free_array(b);
+    free_array(row);
+    free_array(sum);
+    free_array(fused);
+    free_array(reduced);
+    free_array(shared);
+
+    snprintf(details, sizeof(details), "Validity bitmaps, mask propagation and NaN-aware reductions");
+    print_test_result("test_masked_operations", passed, details);
+}
+
+void test_quantized_operations() {
+    int shape[] = {2, 4};
+    int table_shape[] = {3, 4};
+    int query_shape[] = {4};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    // Round trip: halves round to even and out-of-range values saturate
+    ArrayType *a = create_array(shape, 2, &error);
+    float values[] = {0.0f, 0.5f, 1.5f, -2.0f, 100.0f, -100.0f, 3.0f, NAN};
+    for (int i = 0; i < 8; i++) a->data[i] = values[i];
+    ArrayType *q = NULL;
+    passed &= (quantize_array(&q, a, ARRAY_DTYPE_INT8, 0.5f, 0) == ARRAY_SUCCESS);
+    const int8_t *qi = (const int8_t*)q->data;
+    passed &= (q->dtype == ARRAY_DTYPE_INT8 && q->itemsize == 1 && q->scale == 0.5f);
+    passed &= (qi[1] == 1 && qi[2] == 3 && qi[3] == -4 && qi[4] == 127 && qi[5] == -128 && qi[7] == 0);
+    ArrayType *back = NULL;
+    passed &= (dequantize_array(&back, q) == ARRAY_SUCCESS && back->data[3] == -2.0f && back->data[4] == 63.5f);
+
+    float scale;
+    int zero_point;
+    a->data[4] = 10.0f;
+    a->data[5] = -5.5f;
+    passed &= (quantize_params(a, ARRAY_DTYPE_UINT8, &scale, &zero_point) == ARRAY_SUCCESS);
+    passed &= (fabsf(scale - 15.5f / 255.0f) < 1e-7f && zero_point == 90);
+    ArrayType *u = NULL;
+    quantize_array(&u, a, ARRAY_DTYPE_UINT8, scale, zero_point);
+    dequantize_array(&back, u);
+    for (int i = 0; i < 7; i++) passed &= (fabsf(back->data[i] - a->data[i]) <= scale / 2 + 1e-6f);
+
+    // Element-wise arithmetic requantizes to the output parameters
+    ArrayType *sum = NULL;
+    passed &= (quantized_add_arrays(&sum, q, q, 1.0f, 0) == ARRAY_SUCCESS);
+    passed &= (((const int8_t*)sum->data)[3] == -4 && ((const int8_t*)sum->data)[2] == 3);
+    ArrayType *product = NULL;
+    passed &= (quantized_multiply_arrays(&product, q, q, 0.25f, -128) == ARRAY_SUCCESS);
+    passed &= (((const int8_t*)product->data)[3] == -112 && ((const int8_t*)product->data)[4] == 127);
+    passed &= (quantized_add_arrays(&sum, q, u, 1.0f, 0) == ARRAY_ERROR_INVALID_DTYPE);
+    passed &= (add_arrays(&sum, q, q) == ARRAY_ERROR_INVALID_DTYPE);
+
+    // Dot products of a table against a query match the dequantized values
+    ArrayType *table = create_array(table_shape, 2, &error);
+    ArrayType *query = create_array(query_shape, 1, &error);
+    for (int i = 0; i < 12; i++) table->data[i] = (float)(i % 5) - 1.5f;
+    for (int i = 0; i < 4; i++) query->data[i] = 0.25f * (float)i;
+    ArrayType *qt = NULL, *qq = NULL, *dots = NULL;
+    quantize_params(table, ARRAY_DTYPE_INT8, &scale, &zero_point);
+    quantize_array(&qt, table, ARRAY_DTYPE_INT8, scale, zero_point);
+    quantize_params(query, ARRAY_DTYPE_UINT8, &scale, &zero_point);
+    quantize_array(&qq, query, ARRAY_DTYPE_UINT8, scale, zero_point);
+    passed &= (quantized_dot_arrays(&dots, qt, qq) == ARRAY_SUCCESS && dots->ndim == 1 && dots->shape[0] == 3);
+    ArrayType *dt = NULL, *dq = NULL;
+    dequantize_array(&dt, qt);
+    dequantize_array(&dq, qq);
+    for (int r = 0; r < 3; r++) {
+        float expected = 0.0f;
+        for (int i = 0; i < 4; i++) expected += dt->data[r * 4 + i] * dq->data[i];
+        passed &= (fabsf(dots->data[r] - expected) < 1e-4f);
+    }
+    float last = dots->data[2];
+    passed &= (quantized_dot_arrays(&dots, qq, qt) == ARRAY_SUCCESS && dots->data[2] == last);
+
+    free_array(a);
+    free_array(q);
+    free_array(u);
+    free_array(back);
+    free_array(sum);
+    free_array(product);
+    free_array(table);
+    free_array(query);
+    free_array(qt);
+    free_array(qq);
+    free_array(dots);
+    free_array(dt);
+    free_array(dq);
+
+    snprintf(details, sizeof(details), "int8/uint8 quantize, dequantize, add, multiply and dot");
+    print_test_result("test_quantized_operations", passed, details);
+}
+
+void test_deterministic_mode() {
+    int row_shape[] = {2, 200003};
+    int target_shape[] = {50, 2};
+    int values_shape[] = {100000, 2};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    ArrayType *a = create_array(row_shape, 2, &error);
+    for (size_t i = 0; i < a->size; i++) a->data[i] = (float)((i * 7919) % 1000) * 1e-3f - 0.4f;
+    ArrayType *values = create_array(values_shape, 2, &error);
+    for (size_t i = 0; i < values->size; i++) values->data[i] = (float)((i * 104729) % 997) * 1e-2f;
+    int *indices = (int*)malloc(100000 * sizeof(int));
+    for (int j = 0; j < 100000; j++) indices[j] = (j * 31) % 50;
+
+    array_set_deterministic(1);
+    passed &= (array_get_deterministic() == 1);
+
+    // Results must not change with the number of threads
+    ArrayType *sums[2] = {NULL, NULL}, *totals[2] = {NULL, NULL}, *targets[2] = {NULL, NULL};
+    int max_threads = 1;
+#ifdef _OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+    for (int run = 0; run < 2; run++) {
+#ifdef _OPENMP
+        omp_set_num_threads(run == 0 ? 1 : 3);
+#endif
+        passed &= (cumsum_array(&sums[run], a, 1) == ARRAY_SUCCESS);
+        passed &= (nansum_array(&totals[run], a, 1) == ARRAY_SUCCESS);
+        targets[run] = create_array(target_shape, 2, &error);
+        passed &= (scatter_add_array(targets[run], indices, 100000, values, 0) == ARRAY_SUCCESS);
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    passed &= (memcmp(sums[0]->data, sums[1]->data, a->size * sizeof(float)) == 0);
+    passed &= (memcmp(totals[0]->data, totals[1]->data, 2 * sizeof(float)) == 0);
+    passed &= (memcmp(targets[0]->data, targets[1]->data, 100 * sizeof(float)) == 0);
+
+    // scatter_add matches the serial loop bit for bit
+    float expected[100] = {0.0f};
+    for (int j = 0; j < 100000; j++) {
+        for (int i = 0; i < 2; i++) expected[indices[j] * 2 + i] += values->data[j * 2 + i];
+    }
+    passed &= (memcmp(targets[1]->data, expected, sizeof(expected)) == 0);
+
+    // An in-place scan gives the same result at any thread count
+    ArrayType *inplace = NULL;
+    for (int run = 0; run < 2; run++) {
+#ifdef _OPENMP
+        omp_set_num_threads(run == 0 ? 1 : 3);
+#endif
+        passed &= (array_copy(&inplace, a) == ARRAY_SUCCESS);
+        passed &= (cumsum_array(&inplace, inplace, 1) == ARRAY_SUCCESS);
+        passed &= (memcmp(inplace->data, sums[0]->data, a->size * sizeof(float)) == 0);
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    free_array(inplace);
+
+    array_set_deterministic(0);
+    passed &= (array_get_deterministic() == 0);
+
+    free_array(a);
+    free_array(values);
+    free(indices);
+    for (int run = 0; run < 2; run++) {
+        free_array(sums[run]);
+        free_array(totals[run]);
+        free_array(targets[run]);
+    }
+
+    snprintf(details, sizeof(details), "Bit-identical scans, reductions and scatter_add across thread counts");
+    print_test_result("test_deterministic_mode", passed, details);
+}
+
+void test_einsum_operations() {
+    int a_shape[] = {3, 4};
+    int b_shape[] = {4, 5};
+    int square_shape[] = {4, 4};
+    int batch_a_shape[] = {2, 3, 4};
+    int batch_b_shape[] = {2, 4, 5};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    ArrayType *a = create_array(a_shape, 2, &error);
+    ArrayType *b = create_array(b_shape, 2, &error);
+    ArrayType *square = create_array(square_shape, 2, &error);
+    ArrayType *ba = create_array(batch_a_shape, 3, &error);
+    ArrayType *bb = create_array(batch_b_shape, 3, &error);
+    for (int i = 0; i < 12; i++) a->data[i] = (float)(i % 5) - 2.0f;
+    for (int i = 0; i < 20; i++) b->data[i] = 0.5f * (float)(i % 7);
+    for (int i = 0; i < 16; i++) square->data[i] = (float)i;
+    for (int i = 0; i < 24; i++) ba->data[i] = (float)(i % 3) + 1.0f;
+    for (int i = 0; i < 40; i++) bb->data[i] = (float)(i % 4) - 1.5f;
+
+    // Matrix product, explicit and implicit, against matmul
+    ArrayType *expected = NULL, *out = NULL;
+    const ArrayType *ab[] = {a, b};
+    matmul_arrays(&expected, a, b);
+    passed &= (einsum_arrays(&out, "ij,jk->ik", ab, 2) == ARRAY_SUCCESS);
+    passed &= (out->ndim == 2 && out->shape[0] == 3 && out->shape[1] == 5);
+    for (int i = 0; i < 15; i++) passed &= (fabsf(out->data[i] - expected->data[i]) < 1e-5f);
+    passed &= (einsum_arrays(&out, "ij,jk", ab, 2) == ARRAY_SUCCESS);
+    for (int i = 0; i < 15; i++) passed &= (fabsf(out->data[i] - expected->data[i]) < 1e-5f);
+
+    // Transpose, diagonal, trace and full sum of a single operand
+    const ArrayType *sq[] = {square};
+    passed &= (einsum_arrays(&out, "ij->ji", sq, 1) == ARRAY_SUCCESS && out->data[1] == 4.0f && out->data[4] == 1.0f);
+    passed &= (einsum_arrays(&out, "ii->i", sq, 1) == ARRAY_SUCCESS && out->size == 4 && out->data[3] == 15.0f);
+    passed &= (einsum_arrays(&out, "ii", sq, 1) == ARRAY_SUCCESS && out->size == 1 && out->data[0] == 30.0f);
+    passed &= (einsum_arrays(&out, "ij->", sq, 1) == ARRAY_SUCCESS && out->data[0] == 120.0f);
+    passed &= (einsum_arrays(&out, "ij->j", sq, 1) == ARRAY_SUCCESS && out->data[0] == 24.0f && out->data[3] == 36.0f);
+
+    // Batched matrix product against matmul
+    const ArrayType *batch[] = {ba, bb};
+    matmul_arrays(&expected, ba, bb);
+    passed &= (einsum_arrays(&out, "bij,bjk->bik", batch, 2) == ARRAY_SUCCESS && out->size == 30);
+    for (int i = 0; i < 30; i++) passed &= (fabsf(out->data[i] - expected->data[i]) < 1e-5f);
+
+    // A three-operand chain equals two matmuls
+    const ArrayType *chain[] = {a, b, b};
+    const ArrayType *only_b[] = {b};
+    ArrayType *bt = NULL, *ab_expected = NULL;
+    matmul_arrays(&ab_expected, a, b);
+    passed &= (einsum_arrays(&bt, "ij->ji", only_b, 1) == ARRAY_SUCCESS);
+    matmul_arrays(&expected, ab_expected, bt);
+    passed &= (einsum_arrays(&out, "ij,jk,lk->il", chain, 3) == ARRAY_SUCCESS);
+    passed &= (out->ndim == 2 && out->shape[0] == 3 && out->shape[1] == 4);
+    for (int i = 0; i < 12; i++) passed &= (fabsf(out->data[i] - expected->data[i]) < 1e-4f);
+
+    // tensordot over the last axis of a and the first of b is a matrix product
+    int axes_a[] = {-1}, axes_b[] = {0};
+    matmul_arrays(&expected, a, b);
+    passed &= (tensordot_arrays(&out, a, b, axes_a, axes_b, 1) == ARRAY_SUCCESS);
+    for (int i = 0; i < 15; i++) passed &= (fabsf(out->data[i] - expected->data[i]) < 1e-5f);
+    passed &= (tensordot_arrays(&out, a, b, NULL, NULL, 0) == ARRAY_SUCCESS && out->ndim == 4);
+
+    // Malformed subscripts and mismatched lengths
+    const ArrayType *aa[] = {a, a};
+    passed &= (einsum_arrays(&out, "ij,jk->ik", aa, 2) == ARRAY_ERROR_INVALID_DIMENSION);
+    passed &= (einsum_arrays(&out, "ij->ik", sq, 1) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (einsum_arrays(&out, "ij,jk", sq, 1) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (einsum_arrays(&out, "ijk", sq, 1) == ARRAY_ERROR_INVALID_DIMENSION);
+
+    free_array(a);
+    free_array(b);
+    free_array(square);
+    free_array(ba);
+    free_array(bb);
+    free_array(bt);
+    free_array(ab_expected);
+    free_array(expected);
+    free_array(out);
+
+    snprintf(details, sizeof(details), "einsum matmul, transpose, trace, batched, chain; tensordot");
+    print_test_result("test_einsum_operations", passed, details);
+}
+
+void test_stencil_operations() {
+    int grid_shape[] = {150, 700};
+    int cube_shape[] = {6, 7, 8};
+    int weights_shape[] = {3, 3};
+    int even_shape[] = {2, 3};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+
+    // The 5-point Laplacian of x^2 + y^2 is 4 away from the edges
+    ArrayType *a = create_array(grid_shape, 2, &error);
+    for (int y = 0; y < 150; y++) {
+        for (int x = 0; x < 700; x++) a->data[y * 700 + x] = (float)(x * x + y * y) * 1e-4f;
+    }
+    ArrayType *lap = NULL;
+    passed &= (laplacian_array(&lap, a, 2, STENCIL_CONSTANT, 0.0f) == ARRAY_SUCCESS);
+    passed &= (fabsf(lap->data[75 * 700 + 350] - 4e-4f) < 1e-5f && fabsf(lap->data[1 * 700 + 698] - 4e-4f) < 1e-5f);
+
+    ArrayType *cube = create_array(cube_shape, 3, &error);
+    for (int z = 0; z < 6; z++) {
+        for (int y = 0; y < 7; y++) {
+            for (int x = 0; x < 8; x++) cube->data[(z * 7 + y) * 8 + x] = (float)(x * x + y * y + z * z);
+        }
+    }
+    ArrayType *cube_lap = NULL;
+    passed &= (laplacian_array(&cube_lap, cube, 3, STENCIL_NEAREST, 0.0f) == ARRAY_SUCCESS);
+    passed &= (cube_lap->data[(3 * 7 + 3) * 8 + 4] == 6.0f);
+
+    // Fused iterations match the steps run one at a time, bit for bit
+    ArrayType *weights = create_array(weights_shape, 2, &error);
+    float heat[] = {0.0f, 0.2f, 0.0f, 0.2f, 0.2f, 0.2f, 0.0f, 0.2f, 0.0f};
+    memcpy(weights->data, heat, sizeof(heat));
+    StencilBoundary boundaries[] = {STENCIL_CONSTANT, STENCIL_REFLECT, STENCIL_WRAP};
+    for (int k = 0; k < 3; k++) {
+        ArrayType *fused = NULL, *step = NULL, *next = NULL;
+        passed &= (stencil_array(&fused, a, weights, 12, boundaries[k], 1.0f) == ARRAY_SUCCESS);
+        array_copy(&step, a);
+        for (int i = 0; i < 12; i++) {
+            stencil_array(&next, step, weights, 1, boundaries[k], 1.0f);
+            ArrayType *swap = step;
+            step = next;
+            next = swap;
+        }
+        passed &= (memcmp(fused->data, step->data, a->size * sizeof(float)) == 0);
+        free_array(fused);
+        free_array(step);
+        free_array(next);
+    }
+
+    // Filters keep constants, and wrapped boxes reach across the edges
+    ArrayType *flat = NULL, *box = NULL, *blur = NULL;
+    array_copy(&flat, a);
+    for (size_t i = 0; i < flat->size; i++) flat->data[i] = 2.5f;
+    passed &= (gaussian_filter_array(&blur, flat, 1.5f, 2, STENCIL_REFLECT, 0.0f) == ARRAY_SUCCESS);
+    passed &= (fabsf(blur->data[0] - 2.5f) < 1e-5f && fabsf(blur->data[flat->size / 2] - 2.5f) < 1e-5f);
+    memset(flat->data, 0, flat->size * sizeof(float));
+    flat->data[0] = 9.0f;
+    passed &= (box_filter_array(&box, flat, 3, 2, STENCIL_WRAP, 0.0f) == ARRAY_SUCCESS);
+    passed &= (fabsf(box->data[flat->size - 1] - 1.0f) < 1e-6f && fabsf(box->data[1] - 1.0f) < 1e-6f);
+    passed &= (box->data[2] == 0.0f);
+
+    // Invalid weights, sizes and aliasing
+    ArrayType *even = create_array(even_shape, 2, &error);
+    passed &= (stencil_array(&box, a, even, 1, STENCIL_CONSTANT, 0.0f) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (stencil_array(&box, a, weights, 0, STENCIL_CONSTANT, 0.0f) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (box_filter_array(&box, a, 4, 2, STENCIL_CONSTANT, 0.0f) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (laplacian_array(&a, a, 2, STENCIL_CONSTANT, 0.0f) == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (laplacian_array(&box, a, 3, STENCIL_CONSTANT, 0.0f) == ARRAY_ERROR_INVALID_DIMENSION);
+
+    free_array(a);
+    free_array(lap);
+    free_array(cube);
+    free_array(cube_lap);
+    free_array(weights);
+    free_array(flat);
+    free_array(box);
+    free_array(blur);
+    free_array(even);
+
+    snprintf(details, sizeof(details), "Laplacian, fused iterated stencils, Gaussian and box filters");
+    print_test_result("test_stencil_operations", passed, details);
+}
+
+typedef struct {
+    long seen[100];
+    double sum;
+    long fail_at;
+} PipelineTestState;
+
+static ArrayError pipeline_test_ingest(const ArrayType *in, ArrayType **out, long index, void *ctx) {
+    (void)in;
+    (void)ctx;
+    for (size_t i = 0; i < (*out)->size; i++) (*out)->data[i] = (float)index;
+    return ARRAY_SUCCESS;
+}
+
+static ArrayError pipeline_test_transform(const ArrayType *in, ArrayType **out, long index, void *ctx) {
+    PipelineTestState *state = (PipelineTestState*)ctx;
+    if (index == state->fail_at) return ARRAY_ERROR_INVALID_ARGUMENT;
+    // Written through an operation, which reuses the ring's array in place
+    return add_arrays(out, in, in);
+}
+
+static ArrayError pipeline_test_write(const ArrayType *in, ArrayType **out, long index, void *ctx) {
+    PipelineTestState *state = (PipelineTestState*)ctx;
+    (void)out;
+    state->seen[index]++;
+    for (size_t i = 0; i < in->size; i++) state->sum += in->data[i];
+    return in->data[0] == 2.0f * (float)index ? ARRAY_SUCCESS : ARRAY_ERROR_INVALID_ARGUMENT;
+}
+
+void test_pipeline_operations() {
+    int shape[] = {8, 16};
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+    PipelineTestState state;
+    memset(&state, 0, sizeof(state));
+    state.fail_at = -1;
+
+    // ingest -> transform (two workers) -> write, double-buffered
+    PipelineStage stages[] = {
+        {pipeline_test_ingest, NULL, shape, 2, 1},
+        {pipeline_test_transform, &state, shape, 2, 2},
+        {pipeline_test_write, &state, NULL, 0, 1},
+    };
+    Pipeline *p = pipeline_create(stages, 3, 2, NULL, &error);
+    passed &= (p != NULL && error == ARRAY_SUCCESS);
+    passed &= (pipeline_run(p, 100) == ARRAY_SUCCESS);
+    int once = 1;
+    for (int i = 0; i < 100; i++) once &= state.seen[i] == 1;
+    passed &= once && state.sum == 128.0 * 2.0 * 4950.0;
+
+    PipelineStats stats[3];
+    for (int s = 0; s < 3; s++) {
+        passed &= (pipeline_get_stats(p, s, &stats[s]) == ARRAY_SUCCESS && stats[s].items == 100);
+        passed &= (stats[s].busy >= 0.0 && stats[s].max_latency <= stats[s].busy);
+    }
+    passed &= (stats[0].input_stalls == 0 && stats[2].output_stalls == 0);
+    passed &= (pipeline_get_stats(p, 3, &stats[0]) == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    // A failing stage stops the run with its error, and the pipeline can run again
+    state.fail_at = 37;
+    passed &= (pipeline_run(p, 100) == ARRAY_ERROR_INVALID_ARGUMENT);
+    memset(state.seen, 0, sizeof(state.seen));
+    state.sum = 0.0;
+    state.fail_at = -1;
+    passed &= (pipeline_run(p, 10) == ARRAY_SUCCESS && state.sum == 128.0 * 2.0 * 45.0);
+    pipeline_free(p);
+
+    // Rings carved from a caller's pool; a single ring slot still completes
+    MemoryPoolType *pool = create_memory_pool(1 << 16);
+    memset(&state, 0, sizeof(state));
+    state.fail_at = -1;
+    p = pipeline_create(stages, 3, 1, pool, &error);
+    passed &= (p != NULL && pipeline_run(p, 20) == ARRAY_SUCCESS && state.sum == 128.0 * 2.0 * 190.0);
+    passed &= (pool->used > 0);
+    pipeline_free(p);
+    destroy_memory_pool(pool);
+
+    stages[1].workers = 0;
+    passed &= (pipeline_create(stages, 3, 2, NULL, &error) == NULL && error == ARRAY_ERROR_INVALID_ARGUMENT);
+    passed &= (pipeline_create(stages, 1, 2, NULL, &error) == NULL && error == ARRAY_ERROR_INVALID_ARGUMENT);
+
+    snprintf(details, sizeof(details), "Pipeline - transform busy %.3f ms, write waited %ld times",
+             stats[1].busy * 1e3, stats[2].input_stalls);
+    print_test_result("test_pipeline_operations", passed, details);
+}
+
+static ArrayType* create_broadcast_input(const int *shape, int ndim, int second) {
+    ArrayError error;
+    ArrayType *a = create_array(shape, ndim, &error);
+    int n = (int)a->size;
+    for (int i = 0; i < n; i++) {
+        a->data[i] = second ? (float)i * 0.25f + 1.0f : (float)(i - n / 2) * 0.5f + 0.75f;
+    }
+    return a;
+}
+
+static int matches_golden(const ArrayType *r, int ndim, const int *shape, const float *expected) {
+    if (!r || r->ndim != ndim) return 0;
+    for (int d = 0; d < ndim; d++) {
+        if (r->shape[d] != shape[d]) return 0;
+    }
+    for (size_t i = 0; i < r->size; i++) {
+        if (r->data[i] != expected[i]) return 0;
+    }
+    return 1;
+}
+
+void test_broadcast_golden() {
+    // Expected values computed by NumPy (float32) from the inputs of create_broadcast_input
+    static const float sum_0[] = {1.25, 2, 2.75, 2, 2.75, 3.5};
+    static const float product_0[] = {0.25, 0.9375, 1.875, 0.4375, 1.5, 2.8125};
+    static const float sum_1[] = {-0.25, 0.25, 0.75, 1.25, 0, 0.5, 1, 1.5, 0.25, 0.75, 1.25, 1.75, 1.75, 2.25, 2.75, 3.25, 2, 2.5, 3, 3.5, 2.25, 2.75, 3.25, 3.75};
+    static const float product_1[] = {-1.25, -0.75, -0.25, 0.25, -1.5625, -0.9375, -0.3125, 0.3125, -1.875, -1.125, -0.375, 0.375, 0.75, 1.25, 1.75, 2.25, 0.9375, 1.5625, 2.1875, 2.8125, 1.125, 1.875, 2.625, 3.375};
+    static const float sum_2[] = {1.75, 2, 2.25, 2.5};
+    static const float product_2[] = {0.75, 0.9375, 1.125, 1.3125};
+    static const float sum_3[] = {0.75, 1, 1.25, 1.5, 1.75, 2, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 1.75, 2, 2.25, 2.5, 2.75, 3, 2.25, 2.5, 2.75, 3, 3.25, 3.5};
+    static const float product_3[] = {-0.25, -0.3125, -0.375, -0.4375, -0.5, -0.5625, 0.25, 0.3125, 0.375, 0.4375, 0.5, 0.5625, 0.75, 0.9375, 1.125, 1.3125, 1.5, 1.6875, 1.25, 1.5625, 1.875, 2.1875, 2.5, 2.8125};
+    static const float sum_4[] = {1.75, 2, 2.25, 2.5, 2.75, 3};
+    static const float product_4[] = {0.75, 0.9375, 1.125, 1.3125, 1.5, 1.6875};
+    static const float sum_5[] = {0.25, 0.75, 1.25, 0.5, 1, 1.5, 0.75, 1.25, 1.75, 1, 1.5, 2, 1.75, 2.25, 2.75, 2, 2.5, 3, 2.25, 2.75, 3.25, 2.5, 3, 3.5};
+    static const float product_5[] = {-0.75, -0.25, 0.25, -0.9375, -0.3125, 0.3125, -1.125, -0.375, 0.375, -1.3125, -0.4375, 0.4375, 0.75, 1.25, 1.75, 0.9375, 1.5625, 2.1875, 1.125, 1.875, 2.625, 1.3125, 2.1875, 3.0625};
+    static const float sum_6[] = {0.75, 1.5, 2.25, 3, 3.75};
+    static const float product_6[] = {-0.25, 0.3125, 1.125, 2.1875, 3.5};
+    static const float sum_7[] = {1.25, 1.75, 2.25};
+    static const float product_7[] = {0.25, 0.75, 1.25};
+    struct {
+        int ndim_a, shape_a[4], ndim_b, shape_b[4], ndim, shape[4];
+        const float *sum, *product;
+    } cases[] = {
+        {1, {3}, 2, {2, 3}, 2, {2, 3}, sum_0, product_0},
+        {3, {2, 1, 4}, 2, {3, 1}, 3, {2, 3, 4}, sum_1, product_1},
+        {0, {0}, 2, {2, 2}, 2, {2, 2}, sum_2, product_2},
+        {3, {4, 1, 1}, 3, {1, 3, 2}, 3, {4, 3, 2}, sum_3, product_3},
+        {1, {1}, 3, {2, 3, 1}, 3, {2, 3, 1}, sum_4, product_4},
+        {4, {2, 1, 3, 1}, 3, {4, 1, 1}, 4, {2, 4, 3, 1}, sum_5, product_5},
+        {1, {5}, 1, {5}, 1, {5}, sum_6, product_6},
+        {2, {3, 1}, 1, {1}, 2, {3, 1}, sum_7, product_7},
+    };
+    ArrayError error;
+    char details[256];
+    int passed = 1;
+    int ncases = (int)(sizeof(cases) / sizeof(cases[0]));
+
+    for (int c = 0; c < ncases; c++) {
+        ArrayType *a = create_broadcast_input(cases[c].shape_a, cases[c].ndim_a, 0);
+        ArrayType *b = create_broadcast_input(cases[c].shape_b, cases[c].ndim_b, 1);
+        ArrayType *r = NULL;
+        passed &= (add_arrays(&r, a, b) == ARRAY_SUCCESS && matches_golden(r, cases[c].ndim, cases[c].shape, cases[c].sum));
+        passed &= (add_arrays(&r, b, a) == ARRAY_SUCCESS && matches_golden(r, cases[c].ndim, cases[c].shape, cases[c].sum));
+        passed &= (multiply_arrays(&r, a, b) == ARRAY_SUCCESS &&
+                   matches_golden(r, cases[c].ndim, cases[c].shape, cases[c].product));
+
+        // Broadcast views read in place give the same results
+        ArrayType *va = NULL, *vb = NULL;
+        passed &= (array_broadcast_to(&va, a, cases[c].shape, cases[c].ndim) == ARRAY_SUCCESS);
+        passed &= (array_broadcast_to(&vb, b, cases[c].shape, cases[c].ndim) == ARRAY_SUCCESS);
+        passed &= (va->view && va->size == r->size);
+        passed &= (multiply_arrays(&r, va, vb) == ARRAY_SUCCESS &&
+                   matches_golden(r, cases[c].ndim, cases[c].shape, cases[c].product));
+
+        // A result of another shape is replaced, and so is an operand used as the result
+        int wrong_shape[] = {2, 2};
+        ArrayType *w = create_array(wrong_shape, 2, &error);
+        passed &= (add_arrays(&w, a, b) == ARRAY_SUCCESS && matches_golden(w, cases[c].ndim, cases[c].shape, cases[c].sum));
+        passed &= (add_arrays(&a, a, b) == ARRAY_SUCCESS && matches_golden(a, cases[c].ndim, cases[c].shape, cases[c].sum));
+        free_array(w);
+        free_array(va);
+        free_array(vb);
+        free_array(r);
+        free_array(a);
+        free_array(b);
+    }
+
+    // Incompatible shapes are rejected before anything is written
+    int s23[] = {2, 3}, s32[] = {3, 2}, s3[] = {3}, s4[] = {4}, s234[] = {2, 3, 4}, s24[] = {2, 4};
+    ArrayType *x = create_array(s23, 2, &error), *y = create_array(s32, 2, &error);
+    ArrayType *r = create_array(s23, 2, &error);
+    float *kept = r->data;
+    passed &= (add_arrays(&r, x, y) == ARRAY_ERROR_INVALID_DIMENSION && r->data == kept);
+    free_array(x);
+    free_array(y);
+    x = create_array(s3, 1, &error);
+    y = create_array(s4, 1, &error);
+    passed &= (multiply_arrays(&r, x, y) == ARRAY_ERROR_INVALID_DIMENSION);
+    passed &= (array_broadcast_to(&y, x, s4, 1) == ARRAY_ERROR_INVALID_DIMENSION);
+    free_array(x);
+    free_array(y);
+    x = create_array(s234, 3, &error);
+    y = create_array(s24, 2, &error);
+    passed &= (add_arrays(&r, x, y) == ARRAY_ERROR_INVALID_DIMENSION);
+    passed &= (array_broadcast_to(&r, x, s24, 2) == ARRAY_ERROR_INVALID_DIMENSION);
+    free_array(x);
+    free_array(y);
+    free_array(r);
+
+    // Large operands take the blocked parallel path
+    int col_shape[] = {300, 1}, row_shape[] = {1, 5000};
+    ArrayType *col = create_broadcast_input(col_shape, 2, 0);
+    ArrayType *row = create_broadcast_input(row_shape, 2, 1);
+    r = NULL;
+    passed &= (add_arrays(&r, col, row) == ARRAY_SUCCESS && r->shape[0] == 300 && r->shape[1] == 5000);
+    for (int i = 0; passed && i < 300; i++) {
+        for (int j = 0; j < 5000; j++) passed &= (r->data[i * 5000 + j] == col->data[i] + row->data[j]);
+    }
+
+    // 0-d operands broadcast as scalars and give a 0-d result between themselves
+    ArrayType *s0 = create_array(NULL, 0, &error), *s1 = create_array(NULL, 0, &error);
+    s0->data[0] = 3.0f;
+    s1->data[0] = 0.5f;
+    passed &= (multiply_arrays(&r, s0, s1) == ARRAY_SUCCESS && r->ndim == 0 && r->size == 1 && r->data[0] == 1.5f);
+    free_array(col);
+    free_array(row);
+    free_array(s0);
+    free_array(s1);
+    free_array(r);
+
+    snprintf(details, sizeof(details), "Broadcasting - %d rank combinations match NumPy", ncases);
+    print_test_result("test_broadcast_golden", passed, details);
+}
+
+// Main function to run all tests
+int main() {
+    test_create_array();
+    test_add_arrays();
+    test_multiply_arrays();
+    test_broadcast_simple();
+    test_broadcast_different_dimensions();
+    test_broadcast_scalar();
+    test_vmath_functions();
+    test_ternary_operations();
+    test_cumulative_operations();
+    test_sort_operations();
+    test_indexing_operations();
+    test_histogram_operations();
+    test_convolution_operations();
+    test_fft_operations();
+    test_linalg_operations();
+    test_random_operations();
+    test_creation_operations();
+    test_shared_buffers();
+    test_allocators();
+    test_buffer_cache();
+    test_batched_operations();
+    test_shared_memory();
+    test_interop();
+    test_masked_operations();
+    test_quantized_operations();
+    test_deterministic_mode();
+    test_einsum_operations();
+    test_stencil_operations();
+    test_pipeline_operations();
+    test_broadcast_golden();
+    return 0;
+}